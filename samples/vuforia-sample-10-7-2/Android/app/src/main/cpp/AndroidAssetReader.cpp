@@ -0,0 +1,114 @@
+/*===============================================================================
+Copyright (c) 2022 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#include "AndroidAssetReader.h"
+
+#include <Log.h>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+
+namespace
+{
+
+/// Unmap an asset mapped from the APK, handle is the start of the page aligned mapping
+void unmapAsset(void* handle, const char* data, size_t size)
+{
+    char* mapping = static_cast<char*>(handle);
+    munmap(mapping, static_cast<size_t>(data - mapping) + size);
+}
+
+
+/// Close an asset whose buffer was used, handle is the AAsset
+void closeAsset(void* handle, const char* data, size_t size)
+{
+    (void)data;
+    (void)size;
+    AAsset_close(static_cast<AAsset*>(handle));
+}
+
+
+/// Map an uncompressed asset from the APK, returns false if the asset is compressed
+bool mapAsset(AAsset* asset, AssetData& data)
+{
+    off64_t start = 0;
+    off64_t length = 0;
+    int fd = AAsset_openFileDescriptor64(asset, &start, &length);
+    if (fd < 0)
+    {
+        return false;
+    }
+    if (length == 0)
+    {
+        close(fd);
+        data.reset();
+        return true;
+    }
+
+    // The asset starts anywhere in the APK but mappings start on a page boundary
+    off64_t pageSize = sysconf(_SC_PAGESIZE);
+    off64_t mapStart = start - start % pageSize;
+    size_t mapLength = static_cast<size_t>(length + (start - mapStart));
+    void* mapping = mmap64(nullptr, mapLength, PROT_READ, MAP_PRIVATE, fd, mapStart);
+    close(fd);
+    if (mapping == MAP_FAILED)
+    {
+        return false;
+    }
+
+    // Models are parsed from start to end
+    madvise(mapping, mapLength, MADV_SEQUENTIAL);
+    data.reset(static_cast<const char*>(mapping) + (start - mapStart), static_cast<size_t>(length), unmapAsset, mapping);
+    return true;
+}
+
+} // namespace
+
+
+bool AndroidAssetReader::exists(const char* name) const
+{
+    AAsset* asset = AAssetManager_open(mAssetManager, name, AASSET_MODE_UNKNOWN);
+    if (asset == nullptr)
+    {
+        return false;
+    }
+    AAsset_close(asset);
+    return true;
+}
+
+
+bool AndroidAssetReader::read(const char* name, AssetData& data) const
+{
+    LOG("Reading asset %s", name);
+    data.reset();
+
+    AAsset* asset = AAssetManager_open(mAssetManager, name, AASSET_MODE_BUFFER);
+    if (asset == nullptr)
+    {
+        LOG("Error opening asset file %s", name);
+        return false;
+    }
+
+    if (mapAsset(asset, data))
+    {
+        // The mapping doesn't depend on the asset
+        AAsset_close(asset);
+        return true;
+    }
+
+    // Compressed assets are inflated into a buffer owned by the asset
+    const void* buffer = AAsset_getBuffer(asset);
+    if (buffer == nullptr)
+    {
+        LOG("Error reading asset file %s", name);
+        AAsset_close(asset);
+        return false;
+    }
+    data.reset(static_cast<const char*>(buffer), static_cast<size_t>(AAsset_getLength64(asset)), closeAsset, asset);
+    return true;
+}
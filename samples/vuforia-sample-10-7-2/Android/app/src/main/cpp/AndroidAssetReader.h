@@ -0,0 +1,37 @@
+/*===============================================================================
+Copyright (c) 2022 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#ifndef _VUFORIA_ANDROIDASSETREADER_H_
+#define _VUFORIA_ANDROIDASSETREADER_H_
+
+#include <AssetReader.h>
+
+#include <android/asset_manager.h>
+
+
+/// Reads the assets packaged in the APK
+/**
+ * Assets stored uncompressed are mapped into memory straight from the APK file. Compressed
+ * assets are inflated by the asset manager into a buffer it owns, which is released with the
+ * AssetData. In neither case is the asset copied.
+ *
+ * The app's build.gradle stores the models uncompressed (aaptOptions noCompress) so that they
+ * are mapped.
+ */
+class AndroidAssetReader : public AssetReader
+{
+public:
+    explicit AndroidAssetReader(AAssetManager* assetManager) : mAssetManager(assetManager) {}
+
+    bool exists(const char* name) const override;
+    bool read(const char* name, AssetData& data) const override;
+
+private:
+    AAssetManager* mAssetManager;
+};
+
+#endif // _VUFORIA_ANDROIDASSETREADER_H_
@@ -0,0 +1,172 @@
+/*===============================================================================
+Copyright (c) 2022 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#include "GLESGpuTimer.h"
+
+#include <Log.h>
+
+#include <EGL/egl.h>
+
+#include <cstring>
+
+
+void GLESGpuTimer::init()
+{
+    deinit();
+
+    const char* extensions = reinterpret_cast<const char*>(glGetString(GL_EXTENSIONS));
+    if (extensions == nullptr || strstr(extensions, "GL_EXT_disjoint_timer_query") == nullptr)
+    {
+        LOG("GL_EXT_disjoint_timer_query isn't supported, GPU times won't be measured");
+        return;
+    }
+
+    // The 64 bit result query is only provided by the extension
+    mGetQueryObjectui64v = reinterpret_cast<PFNGLGETQUERYOBJECTUI64VEXTPROC>(
+        eglGetProcAddress("glGetQueryObjectui64vEXT"));
+    if (mGetQueryObjectui64v == nullptr)
+    {
+        LOG("Failed to get glGetQueryObjectui64vEXT, GPU times won't be measured");
+        return;
+    }
+
+    for (QuerySet& set : mQuerySets)
+    {
+        glGenQueries(MAX_QUERIES_PER_FRAME, set.queries);
+        set.numIssued = 0;
+    }
+
+    // Clear any disjoint operation reported before the first frame
+    GLint disjoint = 0;
+    glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint);
+
+    mCurrentSet = 0;
+    mQueryActive = false;
+    mSupported = true;
+}
+
+
+void GLESGpuTimer::deinit()
+{
+    if (!mSupported)
+    {
+        return;
+    }
+
+    for (QuerySet& set : mQuerySets)
+    {
+        glDeleteQueries(MAX_QUERIES_PER_FRAME, set.queries);
+        set.numIssued = 0;
+    }
+    mGetQueryObjectui64v = nullptr;
+    mSupported = false;
+}
+
+
+void GLESGpuTimer::beginFrame()
+{
+    if (!mSupported)
+    {
+        return;
+    }
+
+    if (mQueryActive)
+    {
+        // A pass wasn't ended in the last frame
+        end();
+    }
+
+    // The oldest set is reused for the new frame
+    mCurrentSet = (mCurrentSet + 1) % NUM_QUERY_SETS;
+    collect(mQuerySets[mCurrentSet]);
+}
+
+
+bool GLESGpuTimer::begin(Pass pass)
+{
+    QuerySet& set = mQuerySets[mCurrentSet];
+    if (!mSupported || mQueryActive || set.numIssued == MAX_QUERIES_PER_FRAME)
+    {
+        return false;
+    }
+
+    set.passes[set.numIssued] = pass;
+    glBeginQuery(GL_TIME_ELAPSED_EXT, set.queries[set.numIssued]);
+    mQueryActive = true;
+    return true;
+}
+
+
+void GLESGpuTimer::end()
+{
+    if (!mQueryActive)
+    {
+        return;
+    }
+
+    glEndQuery(GL_TIME_ELAPSED_EXT);
+    ++mQuerySets[mCurrentSet].numIssued;
+    mQueryActive = false;
+}
+
+
+void GLESGpuTimer::collect(QuerySet& set)
+{
+    int numIssued = set.numIssued;
+    set.numIssued = 0;
+    if (numIssued == 0)
+    {
+        return;
+    }
+
+    // Queries complete in order, if the last one is available all of them are
+    GLuint available = GL_FALSE;
+    glGetQueryObjectuiv(set.queries[numIssued - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+
+    // Reading the disjoint flag clears it, so it is read for every frame even if the results
+    // aren't used, a disjoint operation may have affected any of the queries in flight
+    GLint disjoint = 0;
+    glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint);
+    if (available == GL_FALSE || disjoint != 0)
+    {
+        return;
+    }
+
+    uint64_t passTimes[static_cast<int>(Pass::NUM_PASSES)] {};
+    bool passMeasured[static_cast<int>(Pass::NUM_PASSES)] {};
+    for (int i = 0; i < numIssued; ++i)
+    {
+        GLuint64 elapsed = 0;
+        mGetQueryObjectui64v(set.queries[i], GL_QUERY_RESULT, &elapsed);
+        int pass = static_cast<int>(set.passes[i]);
+        passTimes[pass] += elapsed;
+        passMeasured[pass] = true;
+    }
+
+    for (int pass = 0; pass < static_cast<int>(Pass::NUM_PASSES); ++pass)
+    {
+        if (passMeasured[pass])
+        {
+            Instrumentation::record(getStage(static_cast<Pass>(pass)), passTimes[pass]);
+        }
+    }
+}
+
+
+Instrumentation::Stage GLESGpuTimer::getStage(Pass pass)
+{
+    switch (pass)
+    {
+        case Pass::VIDEO_BACKGROUND:
+            return Instrumentation::Stage::GPU_VIDEO_BACKGROUND;
+        case Pass::AUGMENTATIONS:
+            return Instrumentation::Stage::GPU_AUGMENTATIONS;
+        case Pass::GUIDE_VIEW:
+        default:
+            return Instrumentation::Stage::GPU_GUIDE_VIEW;
+    }
+}
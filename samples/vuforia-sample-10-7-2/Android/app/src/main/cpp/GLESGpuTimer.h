@@ -0,0 +1,102 @@
+/*===============================================================================
+Copyright (c) 2022 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#ifndef _VUFORIA_GLESGPUTIMER_H_
+#define _VUFORIA_GLESGPUTIMER_H_
+
+#include <GLES3/gl31.h>
+#include <GLES2/gl2ext.h>
+
+#include <Instrumentation.h>
+
+
+/// GPU time of the renderer passes measured with GL_EXT_disjoint_timer_query
+/**
+ * Each pass is wrapped in a GL_TIME_ELAPSED_EXT query. The queries of a frame are read back
+ * NUM_QUERY_SETS frames later, when the GPU has normally finished with them, and only if
+ * their results are available so reading them never stalls the pipeline. The GPU time of a
+ * pass, summed over its queries in the frame, is recorded in Instrumentation under the
+ * pass's GPU stage. Frames for which the GPU reports a disjoint operation, e.g. a frequency
+ * change, are discarded.
+ *
+ * Without the extension all the methods do nothing.
+ */
+class GLESGpuTimer
+{
+public:
+    /// Measured passes, the augmentations pass covers all the drawing on targets and the origin
+    enum class Pass
+    {
+        VIDEO_BACKGROUND,
+        AUGMENTATIONS,
+        GUIDE_VIEW,
+        NUM_PASSES
+    };
+
+    /// Number of frames whose queries are in flight at once
+    static constexpr int NUM_QUERY_SETS = 2;
+    /// Maximum number of passes measured in a frame, further passes aren't measured
+    static constexpr int MAX_QUERIES_PER_FRAME = 16;
+
+    /// Measures a pass from its construction to its destruction
+    class ScopedPass
+    {
+    public:
+        ScopedPass(GLESGpuTimer& timer, Pass pass) : mTimer(timer), mStarted(timer.begin(pass)) {}
+        ~ScopedPass()
+        {
+            if (mStarted)
+            {
+                mTimer.end();
+            }
+        }
+
+        ScopedPass(const ScopedPass&) = delete;
+        ScopedPass& operator=(const ScopedPass&) = delete;
+
+    private:
+        GLESGpuTimer& mTimer;
+        bool mStarted;
+    };
+
+    /// Create the queries if the extension is supported, requires a current GL context
+    void init();
+    void deinit();
+
+    bool isSupported() const { return mSupported; }
+
+    /// Record the results of the oldest frame and start timing a new frame
+    void beginFrame();
+
+    /// Start timing pass, returns false if the pass isn't measured
+    /// No other pass may be started until end is called.
+    bool begin(Pass pass);
+    void end();
+
+private:
+    /// The queries issued in one frame
+    struct QuerySet
+    {
+        GLuint queries[MAX_QUERIES_PER_FRAME] {};
+        Pass passes[MAX_QUERIES_PER_FRAME] {};
+        int numIssued { 0 };
+    };
+
+    /// Record the results of set if they are available, then make it reusable
+    void collect(QuerySet& set);
+
+    static Instrumentation::Stage getStage(Pass pass);
+
+    bool mSupported { false };
+    PFNGLGETQUERYOBJECTUI64VEXTPROC mGetQueryObjectui64v { nullptr };
+
+    QuerySet mQuerySets[NUM_QUERY_SETS];
+    int mCurrentSet { 0 };
+    bool mQueryActive { false };
+};
+
+#endif // _VUFORIA_GLESGPUTIMER_H_
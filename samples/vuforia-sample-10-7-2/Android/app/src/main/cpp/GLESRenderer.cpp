@@ -7,14 +7,80 @@ countries.
 
 #include "GLESRenderer.h"
 
+#include "AndroidAssetReader.h"
 #include "GLESUtils.h"
 #include "Shaders.h"
 
-#include <MemoryStream.h>
+#include <Instrumentation.h>
+#include <MatrixMath.h>
 #include <Models.h>
 
 #include <android/asset_manager.h>
 
+#include <algorithm>
+#include <string>
+
+
+namespace
+{
+    /// Largest part of a model copied into a GPU buffer at once while uploading models,
+    /// so that the upload budget can be checked in between
+    constexpr size_t MODEL_UPLOAD_SLICE_SIZE = 256 * 1024;
+
+    /// Point a vertex attribute of the currently bound vertex array at a buffer
+    void setVertexAttribute(GLint handle, GLuint buffer, GLint size, GLsizei stride = 0, size_t offset = 0)
+    {
+        if (handle < 0)
+        {
+            return;
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, buffer);
+        glVertexAttribPointer(static_cast<GLuint>(handle), size, GL_FLOAT, GL_FALSE, stride,
+                              reinterpret_cast<const GLvoid*>(offset));
+        glEnableVertexAttribArray(static_cast<GLuint>(handle));
+    }
+
+    /// Point a mat4 vertex attribute of the currently bound vertex array at a buffer of matrices,
+    /// advancing one matrix per instance
+    void setInstanceMatrixAttribute(GLint handle, GLuint buffer)
+    {
+        if (handle < 0)
+        {
+            return;
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, buffer);
+        // A mat4 attribute occupies four consecutive locations, one per column
+        for (GLuint column = 0; column < 4; ++column)
+        {
+            GLuint location = static_cast<GLuint>(handle) + column;
+            glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, sizeof(VuMatrix44F),
+                                  reinterpret_cast<const GLvoid*>(column * 4 * sizeof(float)));
+            glEnableVertexAttribArray(location);
+            glVertexAttribDivisor(location, 1);
+        }
+    }
+
+    /// FNV-1a hash of a block of memory, chained through hash
+    uint64_t hashBytes(const void* data, size_t size, uint64_t hash = 14695981039346656037ULL)
+    {
+        const auto* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; ++i)
+        {
+            hash ^= bytes[i];
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    /// Count a draw call of numInstances instances in the frame statistics
+    void countDrawCall(int numInstances = 1)
+    {
+        Instrumentation::increment(Instrumentation::Counter::DRAW_CALLS);
+        Instrumentation::increment(Instrumentation::Counter::INSTANCES_DRAWN, static_cast<uint64_t>(numInstances));
+    }
+}
+
+
 bool GLESRenderer::init(AAssetManager* assetManager)
 {
     // Setup for Video Background rendering
@@ -35,7 +101,7 @@ bool GLESRenderer::init(AAssetManager* assetManager)
     mUniformColorVertexPositionHandle =
         glGetAttribLocation(mUniformColorShaderProgramID, "vertexPosition");
     mUniformColorMvpMatrixHandle =
-        glGetUniformLocation(mUniformColorShaderProgramID, "modelViewProjectionMatrix");
+        glGetAttribLocation(mUniformColorShaderProgramID, "modelViewProjectionMatrix");
     mUniformColorColorHandle =
         glGetUniformLocation(mUniformColorShaderProgramID, "uniformColor");
 
@@ -47,7 +113,7 @@ bool GLESRenderer::init(AAssetManager* assetManager)
     mTextureUniformColorTextureCoordHandle =
         glGetAttribLocation(mTextureUniformColorShaderProgramID, "vertexTextureCoord");
     mTextureUniformColorMvpMatrixHandle =
-        glGetUniformLocation(mTextureUniformColorShaderProgramID, "modelViewProjectionMatrix");
+        glGetAttribLocation(mTextureUniformColorShaderProgramID, "modelViewProjectionMatrix");
     mTextureUniformColorTexSampler2DHandle =
         glGetUniformLocation(mTextureUniformColorShaderProgramID, "texSampler2D");
     mTextureUniformColorColorHandle =
@@ -61,39 +127,14 @@ bool GLESRenderer::init(AAssetManager* assetManager)
     mVertexColorColorHandle
         = glGetAttribLocation(mVertexColorShaderProgramID, "vertexColor");
     mVertexColorMvpMatrixHandle
-        = glGetUniformLocation(mVertexColorShaderProgramID, "modelViewProjectionMatrix");
+        = glGetAttribLocation(mVertexColorShaderProgramID, "modelViewProjectionMatrix");
 
-    mModelTargetGuideViewTextureUnit = -1;
+    createStaticGeometry();
 
-    std::vector<char> data; // for reading model files
+    mGpuTimer.init();
 
-    // Load Astronaut model
-    {
-        if (!readAsset(assetManager, "Astronaut.obj", data))
-        {
-            return false;
-        }
-        if (!loadObjModel(data, mAstronautVertexCount, mAstronautVertices, mAstronautTexCoords))
-        {
-            return false;
-        }
-        data.clear();
-        mAstronautTextureUnit = -1;
-    }
-
-    // Load Lander model
-    {
-        if (!readAsset(assetManager, "VikingLander.obj", data))
-        {
-            return false;
-        }
-        if (!loadObjModel(data, mLanderVertexCount, mLanderVertices, mLanderTexCoords))
-        {
-            return false;
-        }
-        data.clear();
-        mLanderTextureUnit = -1;
-    }
+    // Models are loaded in the background, they are uploaded by beginFrame once they are loaded
+    mMeshLoader.start(std::make_unique<AndroidAssetReader>(assetManager));
 
     return true;
 }
@@ -101,210 +142,250 @@ bool GLESRenderer::init(AAssetManager* assetManager)
 
 void GLESRenderer::deinit()
 {
-    if (mModelTargetGuideViewTextureUnit != -1)
-    {
-        GLESUtils::destroyTexture(mModelTargetGuideViewTextureUnit);
-        mModelTargetGuideViewTextureUnit = -1;
-    }
-    if (mAstronautTextureUnit != -1)
+    mMeshLoader.stop();
+    mModelUpload = ModelUpload();
+
+    destroyStaticGeometry();
+    mGpuTimer.deinit();
+    mStateCache.reset();
+
+    for (const auto& guideViewTexture : mGuideViewTextures)
     {
-        GLESUtils::destroyTexture(mAstronautTextureUnit);
-        mAstronautTextureUnit = -1;
+        GLESUtils::destroyTexture(guideViewTexture.second);
     }
-    if (mLanderTextureUnit != -1)
+    mGuideViewTextures.clear();
+    mActiveGuideViewName.clear();
+    mActiveGuideViewTexture = -1;
+
+    for (auto& model : mModels)
     {
-        GLESUtils::destroyTexture(mLanderTextureUnit);
-        mLanderTextureUnit = -1;
+        destroyModel(model.second);
+        if (model.second.textureId != -1)
+        {
+            GLESUtils::destroyTexture(model.second.textureId);
+        }
     }
+    mModels.clear();
+}
+
+
+void GLESRenderer::beginFrame()
+{
+    mGpuTimer.beginFrame();
+    ++mFrameCount;
+    uploadModels();
 }
 
 
 void GLESRenderer::setAstronautTexture(int width, int height, unsigned char* bytes)
 {
-    createTexture(width, height, bytes, mAstronautTextureUnit);
+    createTexture(width, height, bytes, mModels[IMAGE_TARGET_MODEL].textureId);
 }
 
 
 void GLESRenderer::setLanderTexture(int width, int height, unsigned char* bytes)
 {
-    createTexture(width, height, bytes, mLanderTextureUnit);
+    createTexture(width, height, bytes, mModels[MODEL_TARGET_MODEL].textureId);
 }
 
 
-void GLESRenderer::renderVideoBackground(
-    const VuMatrix44F& projectionMatrix,
-    const float* vertices, const float* textureCoordinates,
-    const int numTriangles, const unsigned int* indices,
-    int textureUnit)
+void GLESRenderer::renderVideoBackground(const VuMatrix44F& projectionMatrix, const VuMesh& mesh,
+                                         const VuVector4I& viewport, int textureUnit)
 {
-    GLboolean depthTest = GL_FALSE;
-    GLboolean cullTest = GL_FALSE;
+    Instrumentation::ScopedTimer timer(Instrumentation::Stage::DRAW_VIDEO_BACKGROUND);
+    GLESGpuTimer::ScopedPass gpuPass(mGpuTimer, GLESGpuTimer::Pass::VIDEO_BACKGROUND);
 
-    glGetBooleanv(GL_DEPTH_TEST, &depthTest);
-    glGetBooleanv(GL_CULL_FACE, &cullTest);
+    // This is the first draw of the frame. Vuforia binds the camera texture while updating the
+    // video background, so the cached state can't be relied on from the previous frame.
+    mStateCache.reset();
 
-    glDisable(GL_DEPTH_TEST);
-    glDisable(GL_CULL_FACE);
+    mStateCache.disable(GL_DEPTH_TEST);
+    mStateCache.disable(GL_CULL_FACE);
+    mStateCache.disable(GL_BLEND);
 
-    // Load the shader and upload the vertex/texcoord/index data
-    glUseProgram(mVbShaderProgramID);
-    glVertexAttribPointer(static_cast<GLuint>(mVbVertexPositionHandle), 3, GL_FLOAT,
-                          GL_FALSE, 0, vertices);
-    glVertexAttribPointer(static_cast<GLuint>(mVbTextureCoordHandle), 2, GL_FLOAT,
-                          GL_FALSE, 0, textureCoordinates);
+    // Upload the vertex/texcoord/index data if it has changed since the last frame
+    if (!updateVideoBackgroundMesh(mesh, viewport))
+    {
+        return;
+    }
 
-    glUniform1i(mVbTexSampler2DHandle, textureUnit);
+    // Load the shader and bind the uploaded mesh
+    mStateCache.useProgram(mVbShaderProgramID);
+    mStateCache.bindVertexArray(mVbVertexArray);
 
-    // Render the video background with the custom shader
-    // First, we enable the vertex arrays
-    glEnableVertexAttribArray(static_cast<GLuint>(mVbVertexPositionHandle));
-    glEnableVertexAttribArray(static_cast<GLuint>(mVbTextureCoordHandle));
+    glUniform1i(mVbTexSampler2DHandle, textureUnit);
 
     // Pass the projection matrix to OpenGL
     glUniformMatrix4fv(mVbMvpMatrixHandle, 1, GL_FALSE, projectionMatrix.data);
 
     // Then, we issue the render call
-    glDrawElements(GL_TRIANGLES, numTriangles * 3, GL_UNSIGNED_INT,
-                   indices);
-
-    // Finally, we disable the vertex arrays
-    glDisableVertexAttribArray(static_cast<GLuint>(mVbVertexPositionHandle));
-    glDisableVertexAttribArray(static_cast<GLuint>(mVbTextureCoordHandle));
-
-    if(depthTest)
-        glEnable(GL_DEPTH_TEST);
-
-    if(cullTest)
-        glEnable(GL_CULL_FACE);
+    glDrawElements(GL_TRIANGLES, mVbNumIndices, GL_UNSIGNED_INT, (const GLvoid*) 0);
+    countDrawCall();
 
     GLESUtils::checkGlError("Render video background");
 }
 
 
-void GLESRenderer::renderWorldOrigin(VuMatrix44F& projectionMatrix, VuMatrix44F& modelViewMatrix)
+bool GLESRenderer::updateVideoBackgroundMesh(const VuMesh& mesh, const VuVector4I& viewport)
 {
-    VuVector3F axis10cmSize{ 0.1f, 0.1f, 0.1f };
-    renderAxis(projectionMatrix, modelViewMatrix, axis10cmSize, 4.0f);
-    VuVector4F cubeColor{ 0.8, 0.8, 0.8, 1.0 };
-    renderCube(projectionMatrix, modelViewMatrix, 0.015f, cubeColor);
-}
+    if (mesh.pos == nullptr || mesh.tex == nullptr || mesh.faceIndices == nullptr)
+    {
+        LOG("Video background mesh has no positions, texture coordinates or indices");
+        return false;
+    }
 
+    size_t positionsSize = mesh.numVertices * 3 * sizeof(float);
+    size_t texCoordsSize = mesh.numVertices * 2 * sizeof(float);
+    size_t indicesSize = mesh.numFaces * 3 * sizeof(uint32_t);
+
+    uint64_t hash = hashBytes(&viewport, sizeof(viewport));
+    hash = hashBytes(&mesh.numVertices, sizeof(mesh.numVertices), hash);
+    hash = hashBytes(&mesh.numFaces, sizeof(mesh.numFaces), hash);
+    hash = hashBytes(mesh.pos, positionsSize, hash);
+    hash = hashBytes(mesh.tex, texCoordsSize, hash);
+    hash = hashBytes(mesh.faceIndices, indicesSize, hash);
+    if (mVbNumIndices != 0 && hash == mVbMeshHash)
+    {
+        return true;
+    }
 
-void GLESRenderer::renderImageTarget(VuMatrix44F& projectionMatrix,
-                                     VuMatrix44F& modelViewMatrix,
-                                     VuMatrix44F& scaledModelViewMatrix)
-{
-    VuMatrix44F scaledModelViewProjectionMatrix = vuMatrix44FMultiplyMatrix(projectionMatrix, scaledModelViewMatrix);
+    // Bind the default vertex array so binding the index buffer doesn't change mVbVertexArray
+    mStateCache.bindVertexArray(0);
 
+    glBindBuffer(GL_ARRAY_BUFFER, mVbVertexBuffer);
+    glBufferData(GL_ARRAY_BUFFER, positionsSize, mesh.pos, GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, mVbTexCoordBuffer);
+    glBufferData(GL_ARRAY_BUFFER, texCoordsSize, mesh.tex, GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mVbIndexBuffer);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indicesSize, mesh.faceIndices, GL_STATIC_DRAW);
 
-    glEnable(GL_DEPTH_TEST);
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 
-    float stateLineWidth;
-    glGetFloatv(GL_LINE_WIDTH, &stateLineWidth);
+    mVbNumIndices = mesh.numFaces * 3;
+    mVbMeshHash = hash;
 
-    glUseProgram(mUniformColorShaderProgramID);
+    GLESUtils::checkGlError("Upload video background mesh");
+    return true;
+}
 
-    glVertexAttribPointer(mUniformColorVertexPositionHandle, 3, GL_FLOAT, GL_TRUE, 0,
-                          (const GLvoid *) &squareVertices[0]);
 
-    glEnableVertexAttribArray(mUniformColorVertexPositionHandle);
+void GLESRenderer::renderWorldOrigin(VuMatrix44F& projectionMatrix, VuMatrix44F& modelViewMatrix)
+{
+    Instrumentation::ScopedTimer timer(Instrumentation::Stage::DRAW_WORLD_ORIGIN);
+    GLESGpuTimer::ScopedPass gpuPass(mGpuTimer, GLESGpuTimer::Pass::AUGMENTATIONS);
 
-    glUniformMatrix4fv(mUniformColorMvpMatrixHandle, 1, GL_FALSE,
-                       &scaledModelViewProjectionMatrix.data[0]);
+    VuVector3F axis10cmSize{ 0.1f, 0.1f, 0.1f };
+    renderAxis(projectionMatrix, &modelViewMatrix, 1, axis10cmSize, 4.0f);
+    VuVector4F cubeColor{ 0.8, 0.8, 0.8, 1.0 };
+    renderCube(projectionMatrix, &modelViewMatrix, 1, 0.015f, cubeColor);
+}
 
-    // Draw translucent solid overlay
-    // Color RGBA
-    glUniform4f(mUniformColorColorHandle, 1.0, 0.0, 0.0, 0.1);
-    glDrawElements(GL_TRIANGLES, NUM_SQUARE_INDEX, GL_UNSIGNED_SHORT,
-                   (const GLvoid *) &squareIndices[0]);
 
-    // Draw solid outline
-    glUniform4f(mUniformColorColorHandle, 1.0, 0.0, 0.0, 1.0);
-    glLineWidth(4.0f);
-    glDrawElements(GL_LINES, NUM_SQUARE_WIREFRAME_INDEX, GL_UNSIGNED_SHORT,
-                   (const GLvoid *) &squareWireframeIndices[0]);
+void GLESRenderer::renderImageTargets(const VuMatrix44F& projectionMatrix,
+                                      const VuMatrix44F* modelViewMatrices,
+                                      const VuMatrix44F* scaledModelViewMatrices, int count)
+{
+    Instrumentation::ScopedTimer timer(Instrumentation::Stage::DRAW_IMAGE_TARGETS);
+    GLESGpuTimer::ScopedPass gpuPass(mGpuTimer, GLESGpuTimer::Pass::AUGMENTATIONS);
 
-    glDisableVertexAttribArray(mUniformColorVertexPositionHandle);
+    mStateCache.enable(GL_DEPTH_TEST);
+    mStateCache.disable(GL_CULL_FACE);
+    mStateCache.enable(GL_BLEND);
+    mStateCache.blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-    GLESUtils::checkGlError("Render Image Target");
+    mStateCache.useProgram(mUniformColorShaderProgramID);
+    mStateCache.bindVertexArray(mSquareVertexArray);
+    mStateCache.lineWidth(4.0f);
 
-    glLineWidth(stateLineWidth);
+    for (int first = 0; first < count; first += MAX_INSTANCES)
+    {
+        int numInstances = uploadInstances(projectionMatrix, scaledModelViewMatrices + first, count - first);
+
+        // Draw translucent solid overlay
+        // Color RGBA
+        glUniform4f(mUniformColorColorHandle, 1.0, 0.0, 0.0, 0.1);
+        glDrawElementsInstanced(GL_TRIANGLES, NUM_SQUARE_INDEX, GL_UNSIGNED_SHORT, (const GLvoid *) 0,
+                                numInstances);
+        countDrawCall(numInstances);
+
+        // Draw solid outline, the wireframe indices follow the triangle indices in the index buffer
+        glUniform4f(mUniformColorColorHandle, 1.0, 0.0, 0.0, 1.0);
+        glDrawElementsInstanced(GL_LINES, NUM_SQUARE_WIREFRAME_INDEX, GL_UNSIGNED_SHORT,
+                                (const GLvoid *) (NUM_SQUARE_INDEX * sizeof(unsigned short)), numInstances);
+        countDrawCall(numInstances);
+    }
 
-    glDisable(GL_BLEND);
-    glDisable(GL_DEPTH_TEST);
+    GLESUtils::checkGlError("Render Image Target");
 
     VuVector3F axis2cmSize{ 0.02f, 0.02f, 0.02f };
-    renderAxis(projectionMatrix, modelViewMatrix, axis2cmSize, 4.0f);
+    renderAxis(projectionMatrix, modelViewMatrices, count, axis2cmSize, 4.0f);
 
-    VuMatrix44F modelViewProjectionMatrix = vuMatrix44FMultiplyMatrix(projectionMatrix, modelViewMatrix);
-    renderModel(modelViewProjectionMatrix,
-        mAstronautVertexCount, mAstronautVertices.data(), mAstronautTexCoords.data(),
-        mAstronautTextureUnit);
+    renderModel(projectionMatrix, modelViewMatrices, count, useModel(IMAGE_TARGET_MODEL));
 }
 
 
-void GLESRenderer::renderModelTarget(VuMatrix44F& projectionMatrix,
-                                     VuMatrix44F& modelViewMatrix,
-                                     VuMatrix44F& /*scaledModelViewMatrix*/)
+void GLESRenderer::renderModelTargets(const VuMatrix44F& projectionMatrix,
+                                      const VuMatrix44F* modelViewMatrices,
+                                      const VuMatrix44F* /*scaledModelViewMatrices*/, int count)
 {
-    VuMatrix44F modelViewProjectionMatrix = vuMatrix44FMultiplyMatrix(projectionMatrix, modelViewMatrix);
+    Instrumentation::ScopedTimer timer(Instrumentation::Stage::DRAW_MODEL_TARGETS);
+    GLESGpuTimer::ScopedPass gpuPass(mGpuTimer, GLESGpuTimer::Pass::AUGMENTATIONS);
 
-    renderModel(modelViewProjectionMatrix,
-        mLanderVertexCount, mLanderVertices.data(), mLanderTexCoords.data(),
-        mLanderTextureUnit);
+    renderModel(projectionMatrix, modelViewMatrices, count, useModel(MODEL_TARGET_MODEL));
 
     VuVector3F axis10cmSize{ 0.1f, 0.1f, 0.1f };
-    renderAxis(projectionMatrix, modelViewMatrix, axis10cmSize, 4.0f);
+    renderAxis(projectionMatrix, modelViewMatrices, count, axis10cmSize, 4.0f);
 }
 
 
-void GLESRenderer::renderModelTargetGuideView(VuMatrix44F& projectionMatrix,
-                                              VuMatrix44F& modelViewMatrix,
-                                              const VuImageInfo& image)
+void GLESRenderer::prepareGuideViewTexture(const char* guideViewName, const VuImageInfo& image)
 {
-    VuMatrix44F modelViewProjectionMatrix = vuMatrix44FMultiplyMatrix(projectionMatrix, modelViewMatrix);
-
+    GLuint& textureId = mGuideViewTextures[guideViewName];
+    if (textureId == 0)
+    {
+        textureId = GLESUtils::createTexture(image);
+        // Creating the texture changed the texture binding behind the cache's back
+        mStateCache.reset();
+    }
+}
 
-    glDisable(GL_DEPTH_TEST);
 
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+void GLESRenderer::renderModelTargetGuideView(VuMatrix44F& projectionMatrix,
+                                              VuMatrix44F& modelViewMatrix,
+                                              const VuImageInfo& image,
+                                              const char* guideViewName)
+{
+    Instrumentation::ScopedTimer timer(Instrumentation::Stage::DRAW_GUIDE_VIEW);
+    GLESGpuTimer::ScopedPass gpuPass(mGpuTimer, GLESGpuTimer::Pass::GUIDE_VIEW);
 
-    glActiveTexture(GL_TEXTURE0);
+    mStateCache.disable(GL_DEPTH_TEST);
+    mStateCache.disable(GL_CULL_FACE);
+    mStateCache.enable(GL_BLEND);
+    mStateCache.blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-    if (mModelTargetGuideViewTextureUnit == -1)
+    // The texture is only looked up when the Guide View changes
+    if (mActiveGuideViewTexture == -1 || mActiveGuideViewName != guideViewName)
     {
-        mModelTargetGuideViewTextureUnit = GLESUtils::createTexture(image);
+        prepareGuideViewTexture(guideViewName, image);
+        mActiveGuideViewName = guideViewName;
+        mActiveGuideViewTexture = mGuideViewTextures[mActiveGuideViewName];
     }
-    glBindTexture(GL_TEXTURE_2D, mModelTargetGuideViewTextureUnit);
-
-    glEnableVertexAttribArray(mTextureUniformColorVertexPositionHandle);
-    glVertexAttribPointer(mTextureUniformColorVertexPositionHandle, 3, GL_FLOAT, GL_FALSE, 0, (const GLvoid*)&squareVertices[0]);
+    mStateCache.activeTexture(GL_TEXTURE0);
+    mStateCache.bindTexture(mActiveGuideViewTexture);
 
-    glEnableVertexAttribArray(mTextureUniformColorTextureCoordHandle);
-    glVertexAttribPointer(mTextureUniformColorTextureCoordHandle, 2, GL_FLOAT, GL_FALSE, 0, (const GLvoid*)&squareTexCoords[0]);
+    mStateCache.useProgram(mTextureUniformColorShaderProgramID);
+    mStateCache.bindVertexArray(mGuideViewVertexArray);
 
-    glUseProgram(mTextureUniformColorShaderProgramID);
-    glUniformMatrix4fv(mTextureUniformColorMvpMatrixHandle, 1, GL_FALSE, (GLfloat*)modelViewProjectionMatrix.data);
+    uploadInstances(projectionMatrix, &modelViewMatrix, 1);
     glUniform4f(mTextureUniformColorColorHandle, 1.0f, 1.0f, 1.0f, 0.7f);
     glUniform1i(mTextureUniformColorTexSampler2DHandle, 0); //texture unit, not handle
 
     // Draw
-    glDrawElements(GL_TRIANGLES, NUM_SQUARE_INDEX, GL_UNSIGNED_SHORT, (const GLvoid*)&squareIndices[0]);
-
-    //disable input data structures
-    glDisableVertexAttribArray(mTextureUniformColorTextureCoordHandle);
-    glDisableVertexAttribArray(mTextureUniformColorVertexPositionHandle);
-    glUseProgram(0);
-
-    glBindTexture(GL_TEXTURE_2D, 0);
+    glDrawElementsInstanced(GL_TRIANGLES, NUM_SQUARE_INDEX, GL_UNSIGNED_SHORT, (const GLvoid*) 0, 1);
+    countDrawCall();
 
     GLESUtils::checkGlError("Render guide view");
-
-    glDisable(GL_BLEND);
-    glEnable(GL_DEPTH_TEST);
 }
 
 
@@ -319,223 +400,420 @@ void GLESRenderer::createTexture(int width, int height, unsigned char* bytes, GL
 }
 
 
-void GLESRenderer::renderCube(const VuMatrix44F& projectionMatrix, const VuMatrix44F& modelViewMatrix,
-                              float scale, const VuVector4F& color)
+void GLESRenderer::renderCube(const VuMatrix44F& projectionMatrix, const VuMatrix44F* modelViewMatrices,
+                              int count, float scale, const VuVector4F& color)
 {
-    VuMatrix44F scaledModelViewMatrix;
-    VuMatrix44F modelViewProjectionMatrix;
     VuVector3F scaleVec{ scale, scale, scale };
 
-    scaledModelViewMatrix = vuMatrix44FScale(scaleVec, modelViewMatrix);
-    modelViewProjectionMatrix = vuMatrix44FMultiplyMatrix(projectionMatrix, scaledModelViewMatrix);
-
     ///////////////////////////////////////////////////////////////
     // Render with const ambient diffuse light uniform color shader
-    glEnable(GL_DEPTH_TEST);
-    glUseProgram(mUniformColorShaderProgramID);
+    mStateCache.enable(GL_DEPTH_TEST);
+    mStateCache.disable(GL_CULL_FACE);
+    mStateCache.disable(GL_BLEND);
+    mStateCache.useProgram(mUniformColorShaderProgramID);
+    mStateCache.bindVertexArray(mCubeVertexArray);
 
-    glEnableVertexAttribArray(mUniformColorVertexPositionHandle);
-
-    glVertexAttribPointer(mUniformColorVertexPositionHandle, 3, GL_FLOAT, GL_FALSE, 0, (const GLvoid*)&cubeVertices[0]);
-
-    glUniformMatrix4fv(mUniformColorMvpMatrixHandle, 1, GL_FALSE, (GLfloat*)modelViewProjectionMatrix.data);
     glUniform4f(mUniformColorColorHandle, color.data[0], color.data[1], color.data[2], color.data[3]);
 
     // Draw
-    glDrawElements(GL_TRIANGLES, NUM_CUBE_INDEX, GL_UNSIGNED_SHORT, (const GLvoid*)&cubeIndices[0]);
-
-    //disable input data structures
-    glDisableVertexAttribArray(mUniformColorVertexPositionHandle);
-    glUseProgram(0);
-    glDisable(GL_DEPTH_TEST);
+    for (int first = 0; first < count; first += MAX_INSTANCES)
+    {
+        int numInstances = uploadInstances(projectionMatrix, modelViewMatrices + first, count - first, &scaleVec);
+        glDrawElementsInstanced(GL_TRIANGLES, NUM_CUBE_INDEX, GL_UNSIGNED_SHORT, (const GLvoid*) 0, numInstances);
+        countDrawCall(numInstances);
+    }
 
     GLESUtils::checkGlError("Render cube");
     ///////////////////////////////////////////////////////
 }
 
 
-void GLESRenderer::renderAxis(const VuMatrix44F& projectionMatrix, const VuMatrix44F& modelViewMatrix,
-                              const VuVector3F& scale,
+void GLESRenderer::renderAxis(const VuMatrix44F& projectionMatrix, const VuMatrix44F* modelViewMatrices,
+                              int count, const VuVector3F& scale,
                               float lineWidth)
 {
-    VuMatrix44F scaledModelViewMatrix;
-    VuMatrix44F modelViewProjectionMatrix;
+    ///////////////////////////////////////////////////////
+    // Render with vertex color shader
+    mStateCache.enable(GL_DEPTH_TEST);
+    mStateCache.disable(GL_CULL_FACE);
+    mStateCache.disable(GL_BLEND);
+    mStateCache.useProgram(mVertexColorShaderProgramID);
+    mStateCache.bindVertexArray(mAxisVertexArray);
 
-    scaledModelViewMatrix = vuMatrix44FScale(scale, modelViewMatrix);
-    modelViewProjectionMatrix = vuMatrix44FMultiplyMatrix(projectionMatrix, scaledModelViewMatrix);
+    // Draw
+    mStateCache.lineWidth(lineWidth);
 
+    for (int first = 0; first < count; first += MAX_INSTANCES)
+    {
+        int numInstances = uploadInstances(projectionMatrix, modelViewMatrices + first, count - first, &scale);
+        glDrawElementsInstanced(GL_LINES, NUM_AXIS_INDEX, GL_UNSIGNED_SHORT, (const GLvoid*) 0, numInstances);
+        countDrawCall(numInstances);
+    }
+
+    GLESUtils::checkGlError("Render axis");
     ///////////////////////////////////////////////////////
-    // Render with vertex color shader
-    glEnable(GL_DEPTH_TEST);
-    glUseProgram(mVertexColorShaderProgramID);
+}
+
+
+void GLESRenderer::renderModel(const VuMatrix44F& projectionMatrix, const VuMatrix44F* modelViewMatrices,
+                               int count, const Model& model)
+{
+    if (model.vertexArray == 0)
+    {
+        return;
+    }
 
-    glEnableVertexAttribArray(mVertexColorVertexPositionHandle);
-    glVertexAttribPointer(mVertexColorVertexPositionHandle, 3, GL_FLOAT, GL_FALSE, 0, (const GLvoid*)&axisVertices[0]);
+    Instrumentation::ScopedTimer timer(Instrumentation::Stage::DRAW_MODEL);
 
-    glEnableVertexAttribArray(mVertexColorColorHandle);
-    glVertexAttribPointer(mVertexColorColorHandle, 4, GL_FLOAT, GL_FALSE, 0, (const GLvoid*)&axisColors[0]);
+    mStateCache.enable(GL_DEPTH_TEST);
+    mStateCache.enable(GL_CULL_FACE);
+    mStateCache.cullFace(GL_BACK);
+    mStateCache.frontFace(GL_CCW);
 
-    glUniformMatrix4fv(mVertexColorMvpMatrixHandle, 1, GL_FALSE, (GLfloat*)modelViewProjectionMatrix.data);
+    mStateCache.enable(GL_BLEND);
+    mStateCache.blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    mStateCache.useProgram(mTextureUniformColorShaderProgramID);
+    mStateCache.bindVertexArray(model.vertexArray);
+
+    mStateCache.activeTexture(GL_TEXTURE0);
+    mStateCache.bindTexture(model.textureId);
+
+    glUniform4f(mTextureUniformColorColorHandle, 1.0f, 1.0f, 1.0f, 1.0f);
+    glUniform1i(mTextureUniformColorTexSampler2DHandle, 0); //texture unit, not handle
 
     // Draw
-    float stateLineWidth;
-    glGetFloatv(GL_LINE_WIDTH, &stateLineWidth);
+    for (int first = 0; first < count; first += MAX_INSTANCES)
+    {
+        int numInstances = uploadInstances(projectionMatrix, modelViewMatrices + first, count - first);
+        if (model.numIndices > 0)
+        {
+            glDrawElementsInstanced(GL_TRIANGLES, model.numIndices, model.indexType, (const GLvoid *) 0,
+                                    numInstances);
+        }
+        else
+        {
+            glDrawArraysInstanced(GL_TRIANGLES, 0, model.numVertices, numInstances);
+        }
+        countDrawCall(numInstances);
+    }
 
-    glLineWidth(lineWidth);
+    GLESUtils::checkGlError("Render model");
+}
 
-    glDrawElements(GL_LINES, NUM_AXIS_INDEX, GL_UNSIGNED_SHORT, (const GLvoid*)&axisIndices[0]);
 
-    //disable input data structures
-    glDisableVertexAttribArray(mVertexColorVertexPositionHandle);
-    glDisableVertexAttribArray(mVertexColorColorHandle);
-    glUseProgram(0);
-    glDisable(GL_DEPTH_TEST);
+int GLESRenderer::uploadInstances(const VuMatrix44F& projectionMatrix, const VuMatrix44F* modelViewMatrices,
+                                  int count, const VuVector3F* scale)
+{
+    VuMatrix44F modelViewProjectionMatrices[MAX_INSTANCES];
+    int numInstances = std::min(count, MAX_INSTANCES);
+    for (int i = 0; i < numInstances; ++i)
+    {
+        if (scale != nullptr)
+        {
+            VuMatrix44F scaledModelViewMatrix;
+            MatrixMath::scale(*scale, modelViewMatrices[i], scaledModelViewMatrix);
+            MatrixMath::multiply(projectionMatrix, scaledModelViewMatrix, modelViewProjectionMatrices[i]);
+        }
+        else
+        {
+            MatrixMath::multiply(projectionMatrix, modelViewMatrices[i], modelViewProjectionMatrices[i]);
+        }
+    }
 
-    glLineWidth(stateLineWidth);
+    glBindBuffer(GL_ARRAY_BUFFER, mInstanceBuffer);
+    // Orphan the previous contents so the driver doesn't have to wait for draws still reading them
+    glBufferData(GL_ARRAY_BUFFER, sizeof(modelViewProjectionMatrices), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, numInstances * sizeof(VuMatrix44F), modelViewProjectionMatrices);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
 
-    GLESUtils::checkGlError("Render axis");
-    ///////////////////////////////////////////////////////
+    return numInstances;
 }
 
 
-void GLESRenderer::renderModel(VuMatrix44F modelViewProjectionMatrix,
-    const int numVertices, const float* vertices, const float* textureCoordinates,
-    GLuint textureId)
+void GLESRenderer::createStaticGeometry()
 {
-    glEnable(GL_DEPTH_TEST);
-    glEnable(GL_CULL_FACE);
-    glCullFace(GL_BACK);
-    glFrontFace(GL_CCW);
+    // Create all the buffers first, binding GL_ELEMENT_ARRAY_BUFFER while a vertex array
+    // is bound would change the vertex array
+    mSquareVertexBuffer = GLESUtils::createBuffer(GL_ARRAY_BUFFER, sizeof(squareVertices), squareVertices);
+    mSquareTexCoordBuffer = GLESUtils::createBuffer(GL_ARRAY_BUFFER, sizeof(squareTexCoords), squareTexCoords);
+    {
+        unsigned short squareAllIndices[NUM_SQUARE_INDEX + NUM_SQUARE_WIREFRAME_INDEX];
+        std::copy(squareIndices, squareIndices + NUM_SQUARE_INDEX, squareAllIndices);
+        std::copy(squareWireframeIndices, squareWireframeIndices + NUM_SQUARE_WIREFRAME_INDEX,
+                  squareAllIndices + NUM_SQUARE_INDEX);
+        mSquareIndexBuffer = GLESUtils::createBuffer(GL_ELEMENT_ARRAY_BUFFER, sizeof(squareAllIndices), squareAllIndices);
+    }
+    mCubeVertexBuffer = GLESUtils::createBuffer(GL_ARRAY_BUFFER, sizeof(cubeVertices), cubeVertices);
+    mCubeIndexBuffer = GLESUtils::createBuffer(GL_ELEMENT_ARRAY_BUFFER, sizeof(cubeIndices), cubeIndices);
+    mAxisVertexBuffer = GLESUtils::createBuffer(GL_ARRAY_BUFFER, sizeof(axisVertices), axisVertices);
+    mAxisColorBuffer = GLESUtils::createBuffer(GL_ARRAY_BUFFER, sizeof(axisColors), axisColors);
+    mAxisIndexBuffer = GLESUtils::createBuffer(GL_ELEMENT_ARRAY_BUFFER, sizeof(axisIndices), axisIndices);
+
+    // Per-instance model view projection matrices, filled by uploadInstances before each draw
+    mInstanceBuffer = GLESUtils::createBuffer(GL_ARRAY_BUFFER, MAX_INSTANCES * sizeof(VuMatrix44F), nullptr,
+                                              GL_STREAM_DRAW);
+
+    // The video background mesh is provided by Vuforia, its buffers are filled by updateVideoBackgroundMesh
+    mVbVertexBuffer = GLESUtils::createBuffer(GL_ARRAY_BUFFER, 0, nullptr);
+    mVbTexCoordBuffer = GLESUtils::createBuffer(GL_ARRAY_BUFFER, 0, nullptr);
+    mVbIndexBuffer = GLESUtils::createBuffer(GL_ELEMENT_ARRAY_BUFFER, 0, nullptr);
+    mVbNumIndices = 0;
+
+    // Video background, drawn with the video background shader
+    glGenVertexArrays(1, &mVbVertexArray);
+    glBindVertexArray(mVbVertexArray);
+    setVertexAttribute(mVbVertexPositionHandle, mVbVertexBuffer, 3);
+    setVertexAttribute(mVbTextureCoordHandle, mVbTexCoordBuffer, 2);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mVbIndexBuffer);
+
+    // Image Target square, drawn with the uniform color shader
+    glGenVertexArrays(1, &mSquareVertexArray);
+    glBindVertexArray(mSquareVertexArray);
+    setVertexAttribute(mUniformColorVertexPositionHandle, mSquareVertexBuffer, 3);
+    setInstanceMatrixAttribute(mUniformColorMvpMatrixHandle, mInstanceBuffer);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mSquareIndexBuffer);
+
+    // Guide View square, drawn with the texture uniform color shader
+    glGenVertexArrays(1, &mGuideViewVertexArray);
+    glBindVertexArray(mGuideViewVertexArray);
+    setVertexAttribute(mTextureUniformColorVertexPositionHandle, mSquareVertexBuffer, 3);
+    setVertexAttribute(mTextureUniformColorTextureCoordHandle, mSquareTexCoordBuffer, 2);
+    setInstanceMatrixAttribute(mTextureUniformColorMvpMatrixHandle, mInstanceBuffer);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mSquareIndexBuffer);
+
+    // Cube, drawn with the uniform color shader
+    glGenVertexArrays(1, &mCubeVertexArray);
+    glBindVertexArray(mCubeVertexArray);
+    setVertexAttribute(mUniformColorVertexPositionHandle, mCubeVertexBuffer, 3);
+    setInstanceMatrixAttribute(mUniformColorMvpMatrixHandle, mInstanceBuffer);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mCubeIndexBuffer);
+
+    // Axis, drawn with the vertex color shader
+    glGenVertexArrays(1, &mAxisVertexArray);
+    glBindVertexArray(mAxisVertexArray);
+    setVertexAttribute(mVertexColorVertexPositionHandle, mAxisVertexBuffer, 3);
+    setVertexAttribute(mVertexColorColorHandle, mAxisColorBuffer, 4);
+    setInstanceMatrixAttribute(mVertexColorMvpMatrixHandle, mInstanceBuffer);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mAxisIndexBuffer);
+
+    // Restore the default bindings
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    GLESUtils::checkGlError("Create static geometry");
+}
 
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-    glUseProgram(mTextureUniformColorShaderProgramID);
+void GLESRenderer::destroyStaticGeometry()
+{
+    GLuint vertexArrays[] = { mVbVertexArray, mSquareVertexArray, mGuideViewVertexArray, mCubeVertexArray, mAxisVertexArray };
+    glDeleteVertexArrays(sizeof(vertexArrays) / sizeof(vertexArrays[0]), vertexArrays);
+    mVbVertexArray = mSquareVertexArray = mGuideViewVertexArray = mCubeVertexArray = mAxisVertexArray = 0;
+    mVbNumIndices = 0;
+
+    for (GLuint* buffer : { &mInstanceBuffer, &mVbVertexBuffer, &mVbTexCoordBuffer, &mVbIndexBuffer,
+                            &mSquareVertexBuffer, &mSquareTexCoordBuffer, &mSquareIndexBuffer,
+                            &mCubeVertexBuffer, &mCubeIndexBuffer,
+                            &mAxisVertexBuffer, &mAxisColorBuffer, &mAxisIndexBuffer })
+    {
+        if (*buffer != 0)
+        {
+            GLESUtils::destroyBuffer(*buffer);
+            *buffer = 0;
+        }
+    }
+}
 
-    glEnableVertexAttribArray(mTextureUniformColorVertexPositionHandle);
-    glVertexAttribPointer(mTextureUniformColorVertexPositionHandle, 3, GL_FLOAT, GL_FALSE, 0,
-                          (const GLvoid *) vertices);
 
-    glEnableVertexAttribArray(mTextureUniformColorTextureCoordHandle);
-    glVertexAttribPointer(mTextureUniformColorTextureCoordHandle, 2, GL_FLOAT, GL_FALSE, 0,
-                          (const GLvoid *) textureCoordinates);
+void GLESRenderer::prefetchModel(const std::string& name)
+{
+    useModel(name);
+}
 
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, textureId);
 
-    glUniformMatrix4fv(mTextureUniformColorMvpMatrixHandle, 1, GL_FALSE,
-                       (GLfloat *) modelViewProjectionMatrix.data);
-    glUniform4f(mTextureUniformColorColorHandle, 1.0f, 1.0f, 1.0f, 1.0f);
-    glUniform1i(mTextureUniformColorTexSampler2DHandle, 0); //texture unit, not handle
+GLESRenderer::Model& GLESRenderer::useModel(const std::string& name)
+{
+    Model& model = mModels[name];
+    model.lastUsedFrame = mFrameCount;
+    if (model.state == Model::State::UNLOADED)
+    {
+        model.state = Model::State::LOADING;
+        mMeshLoader.request(name);
+    }
+    return model;
+}
 
-    // Draw
-    glDrawArrays(GL_TRIANGLES, 0, numVertices);
 
-    //disable input data structures
-    glDisableVertexAttribArray(mTextureUniformColorTextureCoordHandle);
-    glDisableVertexAttribArray(mTextureUniformColorVertexPositionHandle);
-    glUseProgram(0);
+void GLESRenderer::evictModels(size_t size)
+{
+    while (mModelMemoryUsed + size > mModelMemoryBudget)
+    {
+        // Models drawn in the previous frame are likely to be drawn again in this one
+        std::unordered_map<std::string, Model>::value_type* leastRecentlyUsed = nullptr;
+        for (auto& model : mModels)
+        {
+            if (model.second.state == Model::State::READY && model.second.lastUsedFrame + 1 < mFrameCount &&
+                (leastRecentlyUsed == nullptr || model.second.lastUsedFrame < leastRecentlyUsed->second.lastUsedFrame))
+            {
+                leastRecentlyUsed = &model;
+            }
+        }
+        if (leastRecentlyUsed == nullptr)
+        {
+            return;
+        }
 
-    glBindTexture(GL_TEXTURE_2D, 0);
+        LOG("Evicting model %s", leastRecentlyUsed->first.c_str());
+        destroyModel(leastRecentlyUsed->second);
+        leastRecentlyUsed->second.state = Model::State::UNLOADED;
+    }
+}
 
-    GLESUtils::checkGlError("Render model");
 
-    glDisable(GL_BLEND);
-    glDisable(GL_CULL_FACE);
-    glDisable(GL_DEPTH_TEST);
+void GLESRenderer::uploadModels()
+{
+    if (mModelUpload.mesh == nullptr && !beginModelUpload())
+    {
+        return;
+    }
+
+    Instrumentation::ScopedTimer timer(Instrumentation::Stage::UPLOAD_MODELS);
+    const uint64_t deadline = Instrumentation::now() +
+        std::chrono::duration_cast<std::chrono::nanoseconds>(mModelUploadBudget).count();
+
+    // At least one slice is uploaded, then the next model is started while there is time left
+    do
+    {
+        if (continueModelUpload() && !beginModelUpload())
+        {
+            break;
+        }
+    } while (Instrumentation::now() < deadline);
 }
 
 
-bool GLESRenderer::readAsset(AAssetManager* assetManager, const char* filename, std::vector<char>& data)
+bool GLESRenderer::beginModelUpload()
 {
-    LOG("Reading asset %s", filename);
-    AAsset* asset = AAssetManager_open(assetManager, filename, AASSET_MODE_STREAMING);
-    if (asset == nullptr)
+    mModelUpload = ModelUpload();
+    mModelUpload.mesh = mMeshLoader.takeLoaded();
+    if (mModelUpload.mesh == nullptr)
     {
-        LOG("Error opening asset file %s", filename);
         return false;
     }
-    auto assetSize = AAsset_getLength(asset);
-    data.reserve(assetSize);
-    char buf[BUFSIZ];
-    int nb_read = 0;
-    while ((nb_read = AAsset_read(asset, buf, BUFSIZ)) > 0)
+
+    const LoadedMesh& mesh = *mModelUpload.mesh;
+    Model* model = &mModels[mesh.name];
+    if (!mesh.succeeded)
     {
-        std::copy(&buf[0], &buf[BUFSIZ], std::back_inserter(data));
+        model->state = Model::State::FAILED;
+        mModelUpload = ModelUpload();
+        return false;
     }
-    AAsset_close(asset);
-    if (nb_read < 0)
+
+    // Binding the index buffer would change the bound vertex array's index buffer
+    mStateCache.bindVertexArray(0);
+
+    // The buffers are allocated now and filled in slices by continueModelUpload
+    destroyModel(*model);
+    bool indexed = mesh.indices != nullptr && mesh.numIndices > 0;
+    size_t memorySize = mesh.getVertexDataSize() + (indexed ? mesh.getIndexDataSize() : 0);
+    evictModels(memorySize);
+    model->memorySize = memorySize;
+    mModelMemoryUsed += memorySize;
+    model->vertexBuffer = GLESUtils::createBuffer(GL_ARRAY_BUFFER, mesh.getVertexDataSize(), nullptr);
+    model->numVertices = mesh.numVertices;
+    if (indexed)
     {
-        LOG("Error reading asset file %s", filename);
-        return false;
+        model->indexBuffer = GLESUtils::createBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.getIndexDataSize(), nullptr);
+        model->indexType = mesh.indexSize == sizeof(uint32_t) ? GL_UNSIGNED_INT : GL_UNSIGNED_SHORT;
+        model->numIndices = mesh.numIndices;
     }
+
+    mModelUpload.model = model;
     return true;
 }
 
 
-bool GLESRenderer::loadObjModel(const std::vector<char>& data, int& numVertices, std::vector<float>& vertices, std::vector<float>& texCoords)
+bool GLESRenderer::continueModelUpload()
 {
-    tinyobj::attrib_t attrib;
-    std::vector<tinyobj::shape_t> shapes;
-    std::vector<tinyobj::material_t> materials;
+    const LoadedMesh& mesh = *mModelUpload.mesh;
+    Model& model = *mModelUpload.model;
 
-    std::string warn;
-    std::string err;
-
-    MemoryInputStream aFileDataStream(data.data(), data.size());
-    bool ret = tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, &aFileDataStream);
-    if (!ret || !err.empty())
+    // Vertices first, then indices
+    size_t vertexDataSize = mesh.getVertexDataSize();
+    size_t indexDataSize = model.indexBuffer != 0 ? mesh.getIndexDataSize() : 0;
+    if (mModelUpload.vertexBytesUploaded < vertexDataSize)
     {
-        LOG("Error loading model (%s)", err.c_str());
-        return false;
+        size_t offset = mModelUpload.vertexBytesUploaded;
+        size_t size = std::min(vertexDataSize - offset, MODEL_UPLOAD_SLICE_SIZE);
+        glBindBuffer(GL_ARRAY_BUFFER, model.vertexBuffer);
+        glBufferSubData(GL_ARRAY_BUFFER, offset, size, reinterpret_cast<const char*>(mesh.vertices) + offset);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        mModelUpload.vertexBytesUploaded += size;
     }
-    if (!warn.empty())
+    else if (mModelUpload.indexBytesUploaded < indexDataSize)
     {
-        LOG("Warning loading model (%s)", warn.c_str());
+        size_t offset = mModelUpload.indexBytesUploaded;
+        size_t size = std::min(indexDataSize - offset, MODEL_UPLOAD_SLICE_SIZE);
+        mStateCache.bindVertexArray(0);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, model.indexBuffer);
+        glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, offset, size, static_cast<const char*>(mesh.indices) + offset);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+        mModelUpload.indexBytesUploaded += size;
     }
 
-    numVertices = 0;
-    vertices.clear();
-    texCoords.clear();
-    // Loop over shapes
-    // s is the index into the shapes vector
-    // f is the index of the current face
-    // v is the index of the current vertex
-    for (size_t s = 0; s < shapes.size(); ++s)
+    if (mModelUpload.vertexBytesUploaded < vertexDataSize || mModelUpload.indexBytesUploaded < indexDataSize)
     {
-        // Loop over faces(polygon)
-        size_t index_offset = 0;
-        for (size_t f = 0; f < shapes[s].mesh.num_face_vertices.size(); ++f)
-        {
-            int fv = shapes[s].mesh.num_face_vertices[f];
-            numVertices += fv;
+        return false;
+    }
 
-            // Loop over vertices in the face.
-            for (size_t v = 0; v < fv; ++v)
-            {
-                // access to vertex
-                tinyobj::index_t idx = shapes[s].mesh.indices[index_offset + v];
-
-                vertices.push_back(attrib.vertices[3 * idx.vertex_index + 0]);
-                vertices.push_back(attrib.vertices[3 * idx.vertex_index + 1]);
-                vertices.push_back(attrib.vertices[3 * idx.vertex_index + 2]);
-
-                // The model may not have texture coordinates for every vertex
-                // If a texture coordinate is missing we just set it to 0,0
-                // This may not be suitable for rendering some OBJ model files
-                if (idx.texcoord_index < 0)
-                {
-                    texCoords.push_back(0.f);
-                    texCoords.push_back(0.f);
-                }
-                else
-                {
-                    texCoords.push_back(attrib.texcoords[2 * idx.texcoord_index + 0]);
-                    texCoords.push_back(attrib.texcoords[2 * idx.texcoord_index + 1]);
-                }
-            }
-            index_offset += fv;
-        }
+    // All the data is uploaded, the vertex array makes the model ready to draw
+    const GLsizei stride = MeshData::VERTEX_STRIDE * sizeof(float);
+    glGenVertexArrays(1, &model.vertexArray);
+    mStateCache.bindVertexArray(model.vertexArray);
+    setVertexAttribute(mTextureUniformColorVertexPositionHandle, model.vertexBuffer, 3, stride,
+                       MeshData::POSITION_OFFSET * sizeof(float));
+    setVertexAttribute(mTextureUniformColorTextureCoordHandle, model.vertexBuffer, 2, stride,
+                       MeshData::TEXCOORD_OFFSET * sizeof(float));
+    setInstanceMatrixAttribute(mTextureUniformColorMvpMatrixHandle, mInstanceBuffer);
+    if (model.indexBuffer != 0)
+    {
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, model.indexBuffer);
     }
+
+    mStateCache.bindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    GLESUtils::checkGlError("Upload model");
+    model.state = Model::State::READY;
+    LOG("Uploaded model %s, %zu bytes of %zu used by models", mesh.name.c_str(), mModelMemoryUsed, mModelMemoryBudget);
+    mModelUpload = ModelUpload();
     return true;
 }
+
+
+void GLESRenderer::destroyModel(Model& model)
+{
+    if (model.vertexArray != 0)
+    {
+        glDeleteVertexArrays(1, &model.vertexArray);
+        model.vertexArray = 0;
+    }
+    if (model.vertexBuffer != 0)
+    {
+        GLESUtils::destroyBuffer(model.vertexBuffer);
+        model.vertexBuffer = 0;
+    }
+    if (model.indexBuffer != 0)
+    {
+        GLESUtils::destroyBuffer(model.indexBuffer);
+        model.indexBuffer = 0;
+    }
+    model.numVertices = 0;
+    model.numIndices = 0;
+    mModelMemoryUsed -= model.memorySize;
+    model.memorySize = 0;
+}
@@ -12,10 +12,17 @@ countries.
 #include <GLES3/gl31.h>
 #include <GLES2/gl2ext.h>
 
-#include <tiny_obj_loader.h>
+#include "GLESGpuTimer.h"
+#include "GLESStateCache.h"
+
+#include <MeshLoader.h>
 
 #include <VuforiaEngine/VuforiaEngine.h>
 
+#include <chrono>
+#include <memory>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 
@@ -23,38 +30,131 @@ countries.
 class GLESRenderer
 {
 public:
+    /// Maximum number of instances drawn by one instanced draw call, larger batches are split
+    static constexpr int MAX_INSTANCES = 16;
+
+    /// Default time spent uploading models to the GPU in each frame
+    static constexpr std::chrono::microseconds DEFAULT_MODEL_UPLOAD_BUDGET { 2000 };
+
+    /// Default GPU memory the geometry of the loaded models may use
+    static constexpr size_t DEFAULT_MODEL_MEMORY_BUDGET = 32 * 1024 * 1024;
+
+    /// Names of the models drawn on Image Targets and Model Targets
+    static constexpr const char* IMAGE_TARGET_MODEL = "Astronaut";
+    static constexpr const char* MODEL_TARGET_MODEL = "VikingLander";
+
     /// Initialize the renderer ready for use
+    /**
+     * Models are loaded from the assets the first time they are drawn or when they are
+     * prefetched. They are loaded on a background thread and uploaded to the GPU over the
+     * following frames, so the renderer can be used straight away. Augmentations are drawn
+     * without their model until it has been uploaded.
+     */
     bool init(AAssetManager* assetManager);
     /// Clean up objects created during rendering
     void deinit();
 
+    /// Start rendering a frame, before any of the render methods is called
+    /// Continues uploading the models that have been loaded, for up to the upload budget.
+    void beginFrame();
+
+    /// Set the time spent uploading models to the GPU in each frame
+    /// At least a part of a model is uploaded in each frame while models are waiting, however
+    /// small the budget.
+    void setModelUploadBudget(std::chrono::microseconds budget) { mModelUploadBudget = budget; }
+
+    /// Start loading a model ahead of it being drawn
+    void prefetchModel(const std::string& name);
+
+    /// Set the GPU memory the geometry of the loaded models may use
+    /**
+     * When uploading a model would exceed the budget the least recently drawn models are
+     * evicted, they are loaded again the next time they are drawn. Models drawn in the
+     * previous frame are kept even if they don't fit.
+     */
+    void setModelMemoryBudget(size_t bytes) { mModelMemoryBudget = bytes; }
+
     void setAstronautTexture(int width, int height, unsigned char* bytes);
     void setLanderTexture(int width, int height, unsigned char* bytes);
 
     /// Render the video background
-    void renderVideoBackground(const VuMatrix44F& projectionMatrix,
-                               const float* vertices, const float* textureCoordinates,
-                               const int numTriangles, const unsigned int* indices,
-                               int textureUnit);
+    /**
+     * The mesh is kept in GPU buffers and only uploaded again when its contents
+     * or the viewport change.
+     */
+    void renderVideoBackground(const VuMatrix44F& projectionMatrix, const VuMesh& mesh,
+                               const VuVector4I& viewport, int textureUnit);
 
     /// Render augmentation for the world origin
     void renderWorldOrigin(VuMatrix44F& projectionMatrix,
                            VuMatrix44F& modelViewMatrix);
 
-    /// Render a bounding box augmentation on an Image Target
-    void renderImageTarget(VuMatrix44F& projectionMatrix,
-                           VuMatrix44F& modelViewMatrix,
-                           VuMatrix44F& scaledModelViewMatrix);
+    /// Render bounding box augmentations on count Image Targets
+    /// Each mesh is drawn once for all the targets using instanced rendering.
+    void renderImageTargets(const VuMatrix44F& projectionMatrix,
+                            const VuMatrix44F* modelViewMatrices,
+                            const VuMatrix44F* scaledModelViewMatrices, int count);
 
-    /// Render a bounding cube augmentation on a Model Target
-    void renderModelTarget(VuMatrix44F& projectionMatrix,
-                           VuMatrix44F& modelViewMatrix,
-                           VuMatrix44F& scaledModelViewMatrix);
+    /// Render augmentations on count Model Targets
+    /// Each mesh is drawn once for all the targets using instanced rendering.
+    void renderModelTargets(const VuMatrix44F& projectionMatrix,
+                            const VuMatrix44F* modelViewMatrices,
+                            const VuMatrix44F* scaledModelViewMatrices, int count);
 
     /// Render the Guide View for a Model Target
+    /// The texture created for the image is cached by guideViewName.
     void renderModelTargetGuideView(VuMatrix44F& projectionMatrix,
                                     VuMatrix44F& modelViewMatrix,
-                                    const VuImageInfo& Image);
+                                    const VuImageInfo& image,
+                                    const char* guideViewName);
+
+    /// Create the texture for a Guide View image ahead of the Guide View being rendered
+    void prepareGuideViewTexture(const char* guideViewName, const VuImageInfo& image);
+
+    /// The state cache used by the draw helpers, e.g. to read its call counters
+    const GLESStateCache& getStateCache() const { return mStateCache; }
+
+    /// The timer measuring the GPU time of the render passes
+    const GLESGpuTimer& getGpuTimer() const { return mGpuTimer; }
+
+private: // types
+    /// GPU resident geometry and texture for a model loaded from the assets
+    struct Model
+    {
+        enum class State
+        {
+            UNLOADED,
+            LOADING,    ///< Requested from mMeshLoader or being uploaded
+            READY,
+            FAILED,     ///< The model couldn't be loaded, it isn't requested again
+        };
+        State state = State::UNLOADED;
+
+        /// Vertex array object binding the buffers to the texture uniform color shader,
+        /// 0 until the model has been uploaded
+        GLuint vertexArray = 0;
+        /// Interleaved vertices in the MeshData layout
+        GLuint vertexBuffer = 0;
+        /// Triangle indices, 0 if the model is drawn as a triangle list
+        GLuint indexBuffer = 0;
+        GLenum indexType = GL_UNSIGNED_SHORT;
+        GLsizei numVertices = 0;
+        GLsizei numIndices = 0;
+        GLuint textureId = -1;
+        /// Size of the vertex and index buffers in bytes
+        size_t memorySize = 0;
+        /// Value of mFrameCount when the model was last drawn or prefetched
+        uint64_t lastUsedFrame = 0;
+    };
+
+    /// A loaded mesh being copied into the GPU buffers of a model over several frames
+    struct ModelUpload
+    {
+        std::unique_ptr<LoadedMesh> mesh;
+        Model* model = nullptr;
+        size_t vertexBytesUploaded = 0;
+        size_t indexBytesUploaded = 0;
+    };
 
 private: // methods
     /// Attempt to create a texture from bytes
@@ -62,46 +162,80 @@ private: // methods
     /// that should be destroyed and replaced with a new one.
     void createTexture(int width, int height, unsigned char* bytes, GLuint& textureId);
 
-    /// Render a filled 3D cube
+    /// Render count filled 3D cubes
     /*
     * by default the cube is centered in 0.0 and has a unit size ([-0.5;0.5] on every axis)
-    * projection and modelViewMatrix define the transformation of the model
+    * projection and modelViewMatrices define the transformation of each instance
     * scale defines the size of the cube (implemented as pre-transformation)
     * color will be used for rendering the model
     */
     void renderCube(const VuMatrix44F& projectionMatrix,
-                    const VuMatrix44F& modelViewMatrix,
+                    const VuMatrix44F* modelViewMatrices, int count,
                     float scale, const VuVector4F &color);
 
-    /// Render 3D Axes
+    /// Render count sets of 3D Axes
     /*
     * red line is x unit vector, green line is y unit vector, blue line is z unit vector
-    * projection and modelViewMatrix define the transformation of the model
+    * projection and modelViewMatrices define the transformation of each instance
     * scale defines a 3D scale of the model (implemented as pre-transformation)
     * lineWidth defines the width of the rendering line style
     */
     void renderAxis(const VuMatrix44F& projectionMatrix,
-                    const VuMatrix44F& modelViewMatrix,
+                    const VuMatrix44F* modelViewMatrices, int count,
                     const VuVector3F& scale,
                     float lineWidth = 2.0f);
 
-    /// Render a 3D model
-    void renderModel(VuMatrix44F modelViewProjectionMatrix,
-                     const int numVertices, const float* vertices, const float* textureCoordinates,
-                     GLuint textureId);
+    /// Render count instances of a 3D model
+    void renderModel(const VuMatrix44F& projectionMatrix,
+                     const VuMatrix44F* modelViewMatrices, int count, const Model& model);
 
-    /// Read an asset file into a byte vector
-    bool readAsset(AAssetManager* assetManager, const char* filename, std::vector<char>& data);
+    /// Fill the instance buffer with the model view projection matrices of up to MAX_INSTANCES instances
+    /// If scale is not nullptr it is applied to each model view matrix first.
+    /// Returns the number of instances uploaded.
+    int uploadInstances(const VuMatrix44F& projectionMatrix, const VuMatrix44F* modelViewMatrices,
+                        int count, const VuVector3F* scale = nullptr);
 
-    /// Load a model from an OBJ file
-    /*
-    * The model is input as the data array, the vertex and texture coordinate
-    * vectors are populated by this method as it reads the input.
-    */
-    bool loadObjModel(const std::vector<char>& data, int& numVertices, std::vector<float>& vertices, std::vector<float>& texCoords);
+    /// Upload the video background mesh if it differs from the one last uploaded
+    /// Returns false if the mesh can't be rendered.
+    bool updateVideoBackgroundMesh(const VuMesh& mesh, const VuVector4I& viewport);
+
+    /// Create the buffers and vertex array objects for the shapes in Models.h
+    /// and the video background
+    void createStaticGeometry();
+
+    /// Clean up objects created by createStaticGeometry
+    void destroyStaticGeometry();
+
+    /// The model to draw for name, requesting it from mMeshLoader if it isn't loaded
+    /// The model has no vertex array until it is ready.
+    Model& useModel(const std::string& name);
+
+    /// Destroy the least recently used models until size more bytes fit in mModelMemoryBudget
+    void evictModels(size_t size);
+
+    /// Upload the meshes loaded by mMeshLoader for up to mModelUploadBudget
+    void uploadModels();
+
+    /// Take the next mesh loaded by mMeshLoader into mModelUpload and create its GPU buffers
+    /// Returns false if no mesh is waiting or it can't be uploaded.
+    bool beginModelUpload();
+
+    /// Copy the next slice of mModelUpload.mesh into the GPU buffers
+    /// Once all of it is copied the vertex array is created, making the model ready to draw,
+    /// and true is returned.
+    bool continueModelUpload();
+
+    /// Clean up the GPU buffers of a model
+    void destroyModel(Model& model);
 
 private: // data members
 
+    // Shadow of the GL state so the draw helpers only issue the state changes they need
+    GLESStateCache mStateCache;
+
+    // GPU timing of the video background, augmentation and Guide View passes
+    GLESGpuTimer mGpuTimer;
+
     // For video background rendering
     GLuint mVbShaderProgramID     = 0;
     GLint mVbVertexPositionHandle       = 0;
@@ -122,7 +256,10 @@ private: // data members
     GLint mTextureUniformColorMvpMatrixHandle           = 0;
     GLint mTextureUniformColorTexSampler2DHandle        = 0;
     GLint mTextureUniformColorColorHandle               = 0;
-    GLuint mModelTargetGuideViewTextureUnit = -1;
+    // Guide View textures by Guide View name and the one last rendered
+    std::unordered_map<std::string, GLuint> mGuideViewTextures;
+    std::string mActiveGuideViewName;
+    GLuint mActiveGuideViewTexture = -1;
 
     // For axis rendering
     GLuint mVertexColorShaderProgramID    = 0;
@@ -130,17 +267,47 @@ private: // data members
     GLint mVertexColorColorHandle               = 0;
     GLint mVertexColorMvpMatrixHandle           = 0;
 
-    // For rendering the Astronaut, loaded from the obj file
-    int mAstronautVertexCount;
-    std::vector<float> mAstronautVertices;
-    std::vector<float> mAstronautTexCoords;
-    GLuint mAstronautTextureUnit = -1;
-
-    // For rendering the Lander, loaded from the obj file
-    int mLanderVertexCount;
-    std::vector<float> mLanderVertices;
-    std::vector<float> mLanderTexCoords;
-    GLuint mLanderTextureUnit = -1;
+    // Per-instance model view projection matrices for the augmentation shaders
+    GLuint mInstanceBuffer          = 0;
+
+    // GPU copy of the video background mesh, see updateVideoBackgroundMesh
+    GLuint mVbVertexArray           = 0;
+    GLuint mVbVertexBuffer          = 0;
+    GLuint mVbTexCoordBuffer        = 0;
+    GLuint mVbIndexBuffer           = 0;
+    GLsizei mVbNumIndices           = 0;
+    uint64_t mVbMeshHash            = 0; // hash of the mesh contents and viewport
+
+    // GPU buffers for the shapes in Models.h
+    GLuint mSquareVertexBuffer      = 0;
+    GLuint mSquareTexCoordBuffer    = 0;
+    GLuint mSquareIndexBuffer       = 0; // squareIndices followed by squareWireframeIndices
+    GLuint mCubeVertexBuffer        = 0;
+    GLuint mCubeIndexBuffer         = 0;
+    GLuint mAxisVertexBuffer        = 0;
+    GLuint mAxisColorBuffer         = 0;
+    GLuint mAxisIndexBuffer         = 0;
+
+    // Vertex array objects binding the shapes to the shader that draws them
+    GLuint mSquareVertexArray       = 0; // uniform color shader
+    GLuint mGuideViewVertexArray    = 0; // texture uniform color shader
+    GLuint mCubeVertexArray         = 0; // uniform color shader
+    GLuint mAxisVertexArray         = 0; // vertex color shader
+
+    // Models by name, loaded from the model assets when they are first used
+    std::unordered_map<std::string, Model> mModels;
+    // Size of the GPU buffers of all the models and the limit it is kept to
+    size_t mModelMemoryUsed = 0;
+    size_t mModelMemoryBudget = DEFAULT_MODEL_MEMORY_BUDGET;
+    // Number of frames begun, for finding the least recently used models
+    uint64_t mFrameCount = 0;
+
+    // Loads the models from the assets in the background
+    MeshLoader mMeshLoader;
+
+    // The model being uploaded, its mesh is nullptr when no upload is in progress
+    ModelUpload mModelUpload;
+    std::chrono::microseconds mModelUploadBudget { DEFAULT_MODEL_UPLOAD_BUDGET };
 };
 
 #endif //_VUFORIA_GLESRENDERER_H_
@@ -0,0 +1,157 @@
+/*===============================================================================
+Copyright (c) 2022 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#include "GLESStateCache.h"
+
+
+void
+GLESStateCache::reset()
+{
+    mProgram.valid = false;
+    mVertexArray.valid = false;
+    mActiveTexture.valid = false;
+    for (auto& texture : mTextures)
+    {
+        texture.valid = false;
+    }
+    mDepthTest.valid = false;
+    mBlend.valid = false;
+    mCullFace.valid = false;
+    mBlendFunc.valid = false;
+    mCullFaceMode.valid = false;
+    mFrontFace.valid = false;
+    mLineWidth.valid = false;
+}
+
+
+void
+GLESStateCache::useProgram(GLuint program)
+{
+    if (update(mProgram, program))
+    {
+        glUseProgram(program);
+    }
+}
+
+
+void
+GLESStateCache::bindVertexArray(GLuint vertexArray)
+{
+    if (update(mVertexArray, vertexArray))
+    {
+        glBindVertexArray(vertexArray);
+    }
+}
+
+
+void
+GLESStateCache::activeTexture(GLenum textureUnit)
+{
+    if (update(mActiveTexture, textureUnit))
+    {
+        glActiveTexture(textureUnit);
+    }
+}
+
+
+void
+GLESStateCache::bindTexture(GLuint texture)
+{
+    int unit = mActiveTexture.valid ? static_cast<int>(mActiveTexture.value - GL_TEXTURE0) : -1;
+    if (unit < 0 || unit >= MAX_TEXTURE_UNITS)
+    {
+        // The active unit is unknown or not tracked
+        ++mIssuedCalls;
+        glBindTexture(GL_TEXTURE_2D, texture);
+        return;
+    }
+
+    if (update(mTextures[unit], texture))
+    {
+        glBindTexture(GL_TEXTURE_2D, texture);
+    }
+}
+
+
+void
+GLESStateCache::setCapability(GLenum capability, bool enabled)
+{
+    Cached<bool>* cached = nullptr;
+    switch (capability)
+    {
+        case GL_DEPTH_TEST:
+            cached = &mDepthTest;
+            break;
+        case GL_BLEND:
+            cached = &mBlend;
+            break;
+        case GL_CULL_FACE:
+            cached = &mCullFace;
+            break;
+        default:
+            break;
+    }
+
+    if (cached == nullptr)
+    {
+        ++mIssuedCalls;
+    }
+    else if (!update(*cached, enabled))
+    {
+        return;
+    }
+
+    if (enabled)
+    {
+        glEnable(capability);
+    }
+    else
+    {
+        glDisable(capability);
+    }
+}
+
+
+void
+GLESStateCache::blendFunc(GLenum sourceFactor, GLenum destinationFactor)
+{
+    uint64_t blendFunc = (static_cast<uint64_t>(sourceFactor) << 32) | destinationFactor;
+    if (update(mBlendFunc, blendFunc))
+    {
+        glBlendFunc(sourceFactor, destinationFactor);
+    }
+}
+
+
+void
+GLESStateCache::cullFace(GLenum mode)
+{
+    if (update(mCullFaceMode, mode))
+    {
+        glCullFace(mode);
+    }
+}
+
+
+void
+GLESStateCache::frontFace(GLenum mode)
+{
+    if (update(mFrontFace, mode))
+    {
+        glFrontFace(mode);
+    }
+}
+
+
+void
+GLESStateCache::lineWidth(GLfloat width)
+{
+    if (update(mLineWidth, width))
+    {
+        glLineWidth(width);
+    }
+}
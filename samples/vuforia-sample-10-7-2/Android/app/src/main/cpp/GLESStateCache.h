@@ -0,0 +1,98 @@
+/*===============================================================================
+Copyright (c) 2022 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#ifndef _VUFORIA_GLESSTATECACHE_H_
+#define _VUFORIA_GLESSTATECACHE_H_
+
+#include <GLES3/gl31.h>
+
+#include <cstdint>
+
+
+/// Shadow copy of the OpenGL ES state used by the renderer
+/**
+ * Each setter only issues the GL call if the value differs from the one last set
+ * through the cache, so draw helpers can simply request the state they need.
+ * State that has not been set since the last reset() is unknown and the next setter
+ * always issues its GL call. reset() must be called whenever GL state may have been
+ * changed without going through the cache.
+ */
+class GLESStateCache
+{
+public:
+    /// Number of texture units whose bindings are tracked
+    static constexpr int MAX_TEXTURE_UNITS = 8;
+
+    GLESStateCache() { reset(); }
+
+    /// Forget all cached state
+    void reset();
+
+    void useProgram(GLuint program);
+    void bindVertexArray(GLuint vertexArray);
+    void activeTexture(GLenum textureUnit);
+    /// Bind a GL_TEXTURE_2D texture on the active texture unit
+    void bindTexture(GLuint texture);
+
+    /// Enable or disable GL_DEPTH_TEST, GL_BLEND or GL_CULL_FACE
+    /// Other capabilities are passed straight through to GL.
+    void setCapability(GLenum capability, bool enabled);
+    void enable(GLenum capability) { setCapability(capability, true); }
+    void disable(GLenum capability) { setCapability(capability, false); }
+
+    void blendFunc(GLenum sourceFactor, GLenum destinationFactor);
+    void cullFace(GLenum mode);
+    void frontFace(GLenum mode);
+    void lineWidth(GLfloat width);
+
+    /// Number of GL calls skipped because the state was already set
+    uint64_t getSkippedCallCount() const { return mSkippedCalls; }
+    /// Number of GL calls issued through the cache
+    uint64_t getIssuedCallCount() const { return mIssuedCalls; }
+
+private:
+    /// A cached value, only meaningful while valid is true
+    template <typename T>
+    struct Cached
+    {
+        T value {};
+        bool valid { false };
+    };
+
+    /// Record a request to set a state to value
+    /// Returns true if the GL call must be issued.
+    template <typename T>
+    bool update(Cached<T>& cached, const T& value)
+    {
+        if (cached.valid && cached.value == value)
+        {
+            ++mSkippedCalls;
+            return false;
+        }
+        cached.value = value;
+        cached.valid = true;
+        ++mIssuedCalls;
+        return true;
+    }
+
+    Cached<GLuint> mProgram;
+    Cached<GLuint> mVertexArray;
+    Cached<GLenum> mActiveTexture;
+    Cached<GLuint> mTextures[MAX_TEXTURE_UNITS];
+    Cached<bool> mDepthTest;
+    Cached<bool> mBlend;
+    Cached<bool> mCullFace;
+    Cached<uint64_t> mBlendFunc; // source factor in the high 32 bits, destination factor in the low
+    Cached<GLenum> mCullFaceMode;
+    Cached<GLenum> mFrontFace;
+    Cached<GLfloat> mLineWidth;
+
+    uint64_t mSkippedCalls { 0 };
+    uint64_t mIssuedCalls { 0 };
+};
+
+#endif // _VUFORIA_GLESSTATECACHE_H_
@@ -200,3 +200,29 @@ GLESUtils::destroyTexture(GLuint textureId)
 
     return true;
 }
+
+
+GLuint
+GLESUtils::createBuffer(GLenum target, GLsizeiptr size, const void* data, GLenum usage)
+{
+    GLuint bufferId = 0;
+
+    glGenBuffers(1, &bufferId);
+    glBindBuffer(target, bufferId);
+    glBufferData(target, size, data, usage);
+    glBindBuffer(target, 0);
+
+    GLESUtils::checkGlError("Creating buffer");
+
+    return bufferId;
+}
+
+
+bool
+GLESUtils::destroyBuffer(GLuint bufferId)
+{
+    glDeleteBuffers(1, &bufferId);
+    GLESUtils::checkGlError("After glDeleteBuffers");
+
+    return true;
+}
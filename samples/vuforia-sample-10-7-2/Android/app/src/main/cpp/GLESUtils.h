@@ -44,6 +44,14 @@ public:
 
     /// Clean up texture
     static bool destroyTexture(GLuint textureId);
+
+    /// Create a buffer object and fill it with data
+    /// The buffer is left unbound.
+    static GLuint createBuffer(GLenum target, GLsizeiptr size, const void* data,
+        GLenum usage = GL_STATIC_DRAW);
+
+    /// Clean up buffer
+    static bool destroyBuffer(GLuint bufferId);
 };
 
 #endif // _VUFORIA_GLESUTILS_H_
@@ -48,7 +48,8 @@ static const char* textureColorVertexShaderSrc = R"(
     attribute vec4 vertexPosition;
     attribute vec2 vertexTextureCoord;
 
-    uniform mat4 modelViewProjectionMatrix;
+    // Per-instance model view projection matrix
+    attribute mat4 modelViewProjectionMatrix;
 
     varying vec2 texCoord;
 
@@ -83,7 +84,8 @@ static const char* textureColorFragmentShaderSrc = R"(
 static const char *uniformColorVertexShaderSrc = R"(
     attribute vec4 vertexPosition;
 
-    uniform mat4 modelViewProjectionMatrix;
+    // Per-instance model view projection matrix
+    attribute mat4 modelViewProjectionMatrix;
 
     void main()
     {
@@ -111,7 +113,8 @@ static const char *vertexColorVertexShaderSrc = R"(
     attribute vec4 vertexPosition;
     attribute vec4 vertexColor;
 
-    uniform mat4 modelViewProjectionMatrix;
+    // Per-instance model view projection matrix
+    attribute mat4 modelViewProjectionMatrix;
 
     // Color to use per vertex, linear interpolated down at fragment shader
     varying vec4 color;
@@ -8,6 +8,8 @@ countries.
 #include <jni.h>
 
 #include <AppController.h>
+#include <Instrumentation.h>
+#include <Trace.h>
 #include <Log.h>
 #include "GLESRenderer.h"
 
@@ -200,6 +202,8 @@ Java_com_vuforia_engine_native_1sample_VuforiaActivity_initRendering(
         JNIEnv * /* env */,
         jobject /* this */)
 {
+    Trace::setThreadName("GL");
+
     // Define clear color
     glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
 
@@ -243,7 +247,29 @@ Java_com_vuforia_engine_native_1sample_VuforiaActivity_configureRendering(
         jint orientation, jint rotation)
 {
     std::vector<int> androidOrientation { orientation, rotation };
-    return controller.configureRendering(width, height, androidOrientation.data()) ? JNI_TRUE : JNI_FALSE;
+    if (!controller.configureRendering(width, height, androidOrientation.data()))
+    {
+        return JNI_FALSE;
+    }
+
+    // Create the Guide View textures now so that switching Guide Views doesn't stall a frame
+    controller.enumerateGuideViewImages([](const char* guideViewName, const VuImageInfo& imageInfo)
+    {
+        gWrapperData.renderer.prepareGuideViewTexture(guideViewName, imageInfo);
+    });
+
+    // Start loading the models for the targets that can be observed, other models are only
+    // loaded if they are drawn
+    if (controller.hasObserverForTargetType(AppController::IMAGE_TARGET_ID))
+    {
+        gWrapperData.renderer.prefetchModel(GLESRenderer::IMAGE_TARGET_MODEL);
+    }
+    if (controller.hasObserverForTargetType(AppController::MODEL_TARGET_ID))
+    {
+        gWrapperData.renderer.prefetchModel(GLESRenderer::MODEL_TARGET_MODEL);
+    }
+
+    return JNI_TRUE;
 }
 
 
@@ -257,6 +283,10 @@ Java_com_vuforia_engine_native_1sample_VuforiaActivity_renderFrame(
         return JNI_FALSE;
     }
 
+    Instrumentation::ScopedTimer frameTimer(Instrumentation::Stage::FRAME);
+
+    gWrapperData.renderer.beginFrame();
+
     // Clear colour and depth buffers
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
@@ -273,10 +303,8 @@ Java_com_vuforia_engine_native_1sample_VuforiaActivity_renderFrame(
 
         auto renderState = controller.getRenderState();
         gWrapperData.renderer.renderVideoBackground(
-            renderState.vbProjectionMatrix,
-            renderState.vbMesh->pos, renderState.vbMesh->tex,
-            renderState.vbMesh->numFaces, renderState.vbMesh->faceIndices,
-            vbTextureUnit);
+            renderState.vbProjectionMatrix, *renderState.vbMesh,
+            renderState.viewport, vbTextureUnit);
 
         VuMatrix44F worldOriginProjection;
         VuMatrix44F worldOriginModelView;
@@ -285,21 +313,34 @@ Java_com_vuforia_engine_native_1sample_VuforiaActivity_renderFrame(
             gWrapperData.renderer.renderWorldOrigin(worldOriginProjection, worldOriginModelView);
         }
 
+        // All the tracked targets of each type are rendered together
         VuMatrix44F trackableProjection;
-        VuMatrix44F trackableModelView;
-        VuMatrix44F trackableModelViewScaled;
-        VuImageInfo modelTargetGuideViewImage;
-        if (controller.getImageTargetResult(trackableProjection, trackableModelView, trackableModelViewScaled))
+        VuMatrix44F trackableModelViews[AppController::MAX_FRAME_OBSERVATIONS];
+        VuMatrix44F trackableModelViewsScaled[AppController::MAX_FRAME_OBSERVATIONS];
+        int numImageTargets = controller.getTargetResults(AppController::IMAGE_TARGET_ID, trackableProjection,
+                                                          trackableModelViews, trackableModelViewsScaled,
+                                                          AppController::MAX_FRAME_OBSERVATIONS);
+        if (numImageTargets > 0)
         {
-            gWrapperData.renderer.renderImageTarget(trackableProjection, trackableModelView, trackableModelViewScaled);
+            gWrapperData.renderer.renderImageTargets(trackableProjection, trackableModelViews,
+                                                     trackableModelViewsScaled, numImageTargets);
         }
-        else if (controller.getModelTargetResult(trackableProjection, trackableModelView, trackableModelViewScaled))
+
+        int numModelTargets = controller.getTargetResults(AppController::MODEL_TARGET_ID, trackableProjection,
+                                                          trackableModelViews, trackableModelViewsScaled,
+                                                          AppController::MAX_FRAME_OBSERVATIONS);
+        VuImageInfo modelTargetGuideViewImage;
+        const char* modelTargetGuideViewName = nullptr;
+        if (numModelTargets > 0)
         {
-            gWrapperData.renderer.renderModelTarget(trackableProjection, trackableModelView, trackableModelViewScaled);
+            gWrapperData.renderer.renderModelTargets(trackableProjection, trackableModelViews,
+                                                     trackableModelViewsScaled, numModelTargets);
         }
-        else if (controller.getModelTargetGuideView(trackableProjection, trackableModelView, modelTargetGuideViewImage))
+        else if (controller.getModelTargetGuideView(trackableProjection, trackableModelViews[0],
+                                                    modelTargetGuideViewImage, modelTargetGuideViewName))
         {
-            gWrapperData.renderer.renderModelTargetGuideView(trackableProjection, trackableModelView, modelTargetGuideViewImage);
+            gWrapperData.renderer.renderModelTargetGuideView(trackableProjection, trackableModelViews[0],
+                                                             modelTargetGuideViewImage, modelTargetGuideViewName);
         }
 
         if (gWrapperData.usingARCore)
@@ -311,6 +352,10 @@ Java_com_vuforia_engine_native_1sample_VuforiaActivity_renderFrame(
 
     controller.finishRender();
 
+    frameTimer.stop();
+    // Periodically log the frame statistics so that regressions show up in the device log
+    Instrumentation::logStatsIfDue();
+
     return JNI_TRUE;
 }
 
@@ -7,7 +7,10 @@ countries.
 
 #include "AppController.h"
 
+#include "Instrumentation.h"
 #include "Log.h"
+#include "MatrixMath.h"
+#include "Trace.h"
 
 #include <algorithm>
 #include <cassert>
@@ -45,10 +48,18 @@ AppController public methods
 
 void AppController::initAR(const InitConfig& initConfig, int target)
 {
+    Trace::ScopedEvent event("initAR");
+
     mVbRenderBackend = initConfig.vbRenderBackend;
     mShowErrorCallback = initConfig.showErrorCallback;
     mInitDoneCallback = initConfig.initDoneCallback;
     mTarget = target;
+    mTargets = initConfig.targets;
+    mMaxSimultaneousImageTargets = initConfig.maxSimultaneousImageTargets;
+    mUseStateHandler = initConfig.useStateHandler;
+    mDriverName = initConfig.driverName;
+    mDriverUserData = initConfig.driverUserData;
+    mTraceFilePath = initConfig.traceFilePath != nullptr ? initConfig.traceFilePath : "";
 
     mGuideViewModelTarget = nullptr;
     
@@ -56,6 +67,10 @@ void AppController::initAR(const InitConfig& initConfig, int target)
     {
         return;
     }
+
+    // The list used to query observations is reused every frame so that rendering
+    // doesn't allocate, it is destroyed in deinitAR
+    REQUIRE_SUCCESS(vuObservationListCreate(&mObservationList));
     
     if (!createObservers())
     {
@@ -70,6 +85,14 @@ bool AppController::startAR()
 {
     LOG("AppController::startAR");
 
+    if (!mTraceFilePath.empty() && !Trace::isEnabled())
+    {
+        // Start a new file, the app and driver append to it when AR is stopped and restarted
+        Trace::createFile(mTraceFilePath.c_str());
+        Trace::setEnabled(true);
+    }
+    Trace::ScopedEvent event("startAR");
+
     // Bail out early if engine instance has not been created yet
     if (mEngine == nullptr)
     {
@@ -94,6 +117,14 @@ bool AppController::startAR()
         LOG("Failed to set active video mode %d for camera device", static_cast<int>(mCameraVideoMode));
     }
 
+    // The handler must be registered while the engine is stopped, it then receives every
+    // new state on the Vuforia Engine thread
+    if (mUseStateHandler && vuEngineRegisterStateHandler(mEngine, &AppController::stateHandler, this) != VU_SUCCESS)
+    {
+        LOG("Failed to register the state handler");
+        return false;
+    }
+
     // Start engine
     if (vuEngineStart(mEngine) != VU_SUCCESS)
     {
@@ -117,6 +148,7 @@ bool AppController::startAR()
 bool AppController::stopAR()
 {
     LOG("AppController::stopAR");
+    Trace::ScopedEvent event("stopAR");
 
     // Bail out early if engine instance has not been created yet
     if (mEngine == nullptr)
@@ -132,15 +164,41 @@ bool AppController::stopAR()
         return false;
     }
 
-    mARStarted = false;
+    {
+        // A frame that is already being rendered still uses its state, wait for it to finish
+        // before the states are released. No further frames are rendered once AR is stopped.
+        std::unique_lock<std::mutex> lock(mRenderMutex);
+        mARStarted = false;
+        mRenderCondition.wait(lock, [this] { return !mRendering; });
+    }
 
     // Stop engine
     if (vuEngineStop(mEngine) != VU_SUCCESS)
     {
         LOG("Failed to stop Vuforia");
+        // The engine is still running, resume rendering so that the app stays usable
+        std::lock_guard<std::mutex> lock(mRenderMutex);
+        mARStarted = true;
         return false;
     }
 
+    if (mUseStateHandler)
+    {
+        // No more states are delivered, release the ones still held by the frames
+        if (vuEngineRegisterStateHandler(mEngine, nullptr, nullptr) != VU_SUCCESS)
+        {
+            LOG("Failed to unregister the state handler");
+        }
+        releaseStateHandlerFrames();
+    }
+
+    if (Trace::isEnabled() && !mTraceFilePath.empty())
+    {
+        // The rendering has stopped, write the frames traced since AR was started
+        Trace::instant("stopped");
+        Trace::writeFile(mTraceFilePath.c_str());
+    }
+
     LOG("Successfully stopped Vuforia");
     return true;
 }
@@ -157,6 +215,15 @@ void AppController::deinitAR()
 
     stopAR();
 
+    // The list contents are bound to the lifetime of the state and observers
+    if (mObservationList != nullptr)
+    {
+        REQUIRE_SUCCESS(vuObservationListDestroy(mObservationList));
+        mObservationList = nullptr;
+    }
+    mGuideViewModelTarget = nullptr;
+    mGuideViewName.clear();
+
     destroyObservers();
 
     // Destroy engine instance
@@ -268,27 +335,58 @@ bool AppController::getVideoBackgroundTextureSize(VuVector2I& textureSize)
 
 bool AppController::prepareToRender(double* viewport, VuRenderVideoBackgroundData* renderData)
 {
-    if (vuEngineAcquireLatestState(mEngine, &mVuforiaState) != VU_SUCCESS)
     {
-        LOG("Error getting state");
-        return false;
+        std::lock_guard<std::mutex> lock(mRenderMutex);
+        if (!mARStarted)
+        {
+            return false;
+        }
+        mRendering = true;
+    }
+
+    Instrumentation::ScopedTimer acquireTimer(Instrumentation::Stage::ACQUIRE_STATE);
+    if (mUseStateHandler)
+    {
+        // Pick up the newest frame collected by the state handler, if none was collected since
+        // the last call the previous frame is rendered again. The frame holds a reference to its
+        // state until the state handler reuses the frame, which it can't do while we own it.
+        mStateHandlerFrames.acquireLatest();
+        mCurrentFrame = &mStateHandlerFrames.getReadBuffer();
+        mVuforiaState = mCurrentFrame->state;
+        if (mVuforiaState == nullptr)
+        {
+            return false;
+        }
+    }
+    else
+    {
+        if (vuEngineAcquireLatestState(mEngine, &mVuforiaState) != VU_SUCCESS)
+        {
+            LOG("Error getting state");
+            return false;
+        }
+        mCurrentFrame = &mPulledFrame;
     }
 
     if (vuStateHasCameraFrame(mVuforiaState) != VU_TRUE)
     {
+        Instrumentation::increment(Instrumentation::Counter::FRAMES_SKIPPED);
         return false;
     }
 
     if (vuStateGetRenderState(mVuforiaState, &mCurrentRenderState) != VU_SUCCESS)
     {
         LOG("Error getting render state");
+        Instrumentation::increment(Instrumentation::Counter::FRAMES_SKIPPED);
         return false;
     }
 
     if (!mCurrentRenderState.vbMesh)
     {
+        Instrumentation::increment(Instrumentation::Counter::FRAMES_SKIPPED);
         return false;
     }
+    acquireTimer.stop();
 
     viewport[0] = mCurrentRenderState.viewport.data[0];
     viewport[1] = mCurrentRenderState.viewport.data[1];
@@ -297,20 +395,38 @@ bool AppController::prepareToRender(double* viewport, VuRenderVideoBackgroundDat
     viewport[4] = 0.0f;
     viewport[5] = 1.0f;
 
-    if (vuRenderControllerUpdateVideoBackgroundTexture(mRenderController, mVuforiaState, renderData) != VU_SUCCESS)
     {
-        LOG("Error updating video background texture");
-        return false;
+        Instrumentation::ScopedTimer timer(Instrumentation::Stage::VIDEO_BACKGROUND_UPDATE);
+        if (vuRenderControllerUpdateVideoBackgroundTexture(mRenderController, mVuforiaState, renderData) != VU_SUCCESS)
+        {
+            LOG("Error updating video background texture");
+            Instrumentation::increment(Instrumentation::Counter::FRAMES_SKIPPED);
+            return false;
+        }
     }
     
+    if (!mUseStateHandler)
+    {
+        collectFrame(mVuforiaState, mPulledFrame);
+    }
     updateDevicePose();
+    updateGuideView();
 
+    Instrumentation::increment(Instrumentation::Counter::FRAMES_RENDERED);
     return true;
 }
 
 
 void AppController::finishRender()
 {
+    // Nothing to finish if prepareToRender was called after AR was stopped
+    if (!mRendering)
+    {
+        return;
+    }
+
+    Instrumentation::ScopedTimer timer(Instrumentation::Stage::FINISH_RENDER);
+
     // Check for device tracker relocalizing for too long and reset if needed
     if (mLatestDevicePoseData.poseStatus == VU_OBSERVATION_POSE_STATUS_LIMITED &&
         mLatestDevicePoseData.poseStatusInfo == VU_DEVICE_POSE_OBSERVATION_STATUS_INFO_RELOCALIZING)
@@ -329,6 +445,8 @@ void AppController::finishRender()
         {
             mTimingRelocalizingState = false;
             VuResult resetResult = vuEngineResetWorldTracking(mEngine);
+            Instrumentation::increment(Instrumentation::Counter::TRACKING_RESETS);
+            Trace::instant("reset world tracking");
             LOG("%s reset world tracking", resetResult == VU_SUCCESS ? "Successfully" : "Failed to");
         }
     }
@@ -337,12 +455,20 @@ void AppController::finishRender()
         mTimingRelocalizingState = false;
     }
 
-    // Clean up and release the Vuforia state
-    if (mVuforiaState != nullptr && vuStateRelease(mVuforiaState) != VU_SUCCESS)
+    // Clean up and release the Vuforia state, the states of the state handler frames are
+    // released when the frames are reused
+    if (!mUseStateHandler && mVuforiaState != nullptr && vuStateRelease(mVuforiaState) != VU_SUCCESS)
     {
         LOG("Error releasing the Vuforia state");
     }
     mVuforiaState = nullptr;
+    mCurrentFrame = nullptr;
+
+    {
+        std::lock_guard<std::mutex> lock(mRenderMutex);
+        mRendering = false;
+    }
+    mRenderCondition.notify_all();
 }
 
 
@@ -360,190 +486,181 @@ bool AppController::getOrigin(VuMatrix44F& projectionMatrix,
 }
 
 
-bool AppController::getImageTargetResult(VuMatrix44F& projectionMatrix,
-                                         VuMatrix44F& modelViewMatrix,
-                                         VuMatrix44F& scaledModelViewMatrix)
+void AppController::collectFrame(const VuState* state, FrameData& frame)
 {
-    bool result = false;
+    Instrumentation::ScopedTimer timer(Instrumentation::Stage::OBSERVATIONS);
 
-    if (mTarget != IMAGE_TARGET_ID)
+    frame.numObservations = 0;
+    frame.devicePoseObservation = -1;
+    for (int& numTargetObservations : frame.numTargetObservations)
     {
-        return false;
+        numTargetObservations = 0;
     }
 
-    VuObservationList* observationList = nullptr;
-    REQUIRE_SUCCESS(vuObservationListCreate(&observationList));
-
-    if (vuStateGetImageTargetObservations(mVuforiaState, observationList) != VU_SUCCESS)
+    if (vuStateGetObservations(state, mObservationList) != VU_SUCCESS)
     {
-        LOG("Error getting image target observations");
-        REQUIRE_SUCCESS(vuObservationListDestroy(observationList));
-        return false;
+        LOG("Error getting observations");
+        return;
     }
 
-    int numObservations = 0;
-    REQUIRE_SUCCESS(vuObservationListGetSize(observationList, &numObservations));
+    int32_t numObservations = 0;
+    REQUIRE_SUCCESS(vuObservationListGetSize(mObservationList, &numObservations));
 
-    if (numObservations > 0)
+    for (int32_t i = 0; i < numObservations && frame.numObservations < MAX_FRAME_OBSERVATIONS; ++i)
     {
         VuObservation* observation = nullptr;
-        if (vuObservationListGetElement(observationList, 0, &observation) == VU_SUCCESS)
+        if (vuObservationListGetElement(mObservationList, i, &observation) != VU_SUCCESS)
         {
-            assert(observation);
-            assert(vuObservationIsType(observation, VU_OBSERVATION_IMAGE_TARGET_TYPE) == VU_TRUE);
-            assert(vuObservationHasPoseInfo(observation) == VU_TRUE);
-
-            VuPoseInfo poseInfo;
-            REQUIRE_SUCCESS(vuObservationGetPoseInfo(observation, &poseInfo));
+            continue;
+        }
+        assert(observation);
 
-            VuImageTargetObservationTargetInfo imageTargetInfo;
-            REQUIRE_SUCCESS(vuImageTargetObservationGetTargetInfo(observation, &imageTargetInfo));
+        if (vuObservationHasPoseInfo(observation) != VU_TRUE)
+        {
+            continue;
+        }
 
-            if (poseInfo.poseStatus != VU_OBSERVATION_POSE_STATUS_NO_POSE)
+        // Find the Observer that reported the observation, only the first device pose
+        // observation is kept but all target observations are
+        const ObjectObserver* objectObserver = nullptr;
+        int targetType = -1;
+        int32_t observerId = vuObservationGetObserverId(observation);
+        if (mDevicePoseObserver != nullptr && observerId == mDevicePoseObserverId)
+        {
+            if (frame.devicePoseObservation != -1)
+            {
+                continue;
+            }
+        }
+        else
+        {
+            auto found = std::find_if(mObjectObservers.begin(), mObjectObservers.end(),
+                                      [observerId](const ObjectObserver& o) { return o.id == observerId; });
+            if (found == mObjectObservers.end())
             {
-                projectionMatrix = mCurrentRenderState.projectionMatrix;
+                continue;
+            }
+            objectObserver = &*found;
+            targetType = objectObserver->targetType;
+        }
 
-                // Compute model-view matrix
-                auto modelMatrix = poseInfo.pose;
-                modelViewMatrix = vuMatrix44FMultiplyMatrix(mCurrentRenderState.viewMatrix,
-                                                            modelMatrix);
+        ObservationData& data = frame.observations[frame.numObservations];
+        data = ObservationData{};
+        data.objectObserver = objectObserver;
+        REQUIRE_SUCCESS(vuObservationGetType(observation, &data.type));
+        REQUIRE_SUCCESS(vuObservationGetPoseInfo(observation, &data.poseInfo));
+
+        switch (data.type)
+        {
+            case VU_OBSERVATION_DEVICE_POSE_TYPE:
+                REQUIRE_SUCCESS(vuDevicePoseObservationGetStatusInfo(observation, &data.devicePoseStatusInfo));
+                break;
+
+            case VU_OBSERVATION_IMAGE_TARGET_TYPE:
+            {
+                VuImageTargetObservationTargetInfo imageTargetInfo;
+                REQUIRE_SUCCESS(vuImageTargetObservationGetTargetInfo(observation, &imageTargetInfo));
 
-                // Calculate a scaled modelViewMatrix for rendering a unit bounding box
                 // z-dimension will be zero for planar target
                 // set it here to the larger dimension so that
                 // a 3D augmentation can be shown
-                VuVector3F scale;
-                scale.data[0] = imageTargetInfo.size.data[0];
-                scale.data[1] = imageTargetInfo.size.data[1];
-                scale.data[2] = std::max(scale.data[0], scale.data[1]);
-                scaledModelViewMatrix = vuMatrix44FScale(scale, modelViewMatrix);
+                data.size.data[0] = imageTargetInfo.size.data[0];
+                data.size.data[1] = imageTargetInfo.size.data[1];
+                data.size.data[2] = std::max(data.size.data[0], data.size.data[1]);
+                break;
+            }
 
-                result = true;
+            case VU_OBSERVATION_MODEL_TARGET_TYPE:
+            {
+                VuModelTargetObservationTargetInfo modelTargetInfo;
+                REQUIRE_SUCCESS(vuModelTargetObservationGetTargetInfo(observation, &modelTargetInfo));
+
+                data.size = modelTargetInfo.size;
+                data.center = modelTargetInfo.bbox.center;
+                data.activeGuideViewName = modelTargetInfo.activeGuideViewName;
+                break;
             }
+
+            default:
+                break;
         }
-    }
 
-    REQUIRE_SUCCESS(vuObservationListDestroy(observationList));
+        if (targetType < 0)
+        {
+            frame.devicePoseObservation = frame.numObservations;
+        }
+        else
+        {
+            frame.targetObservations[targetType][frame.numTargetObservations[targetType]++] = frame.numObservations;
+        }
+        ++frame.numObservations;
+    }
 
-    return result;
+    Trace::counter("observations", frame.numObservations);
 }
 
 
-bool AppController::getModelTargetResult(VuMatrix44F& projectionMatrix,
-                                         VuMatrix44F& modelViewMatrix,
-                                         VuMatrix44F& scaledModelViewMatrix)
+int AppController::getTargetResults(int targetType, VuMatrix44F& projectionMatrix,
+                                    VuMatrix44F* modelViewMatrices, VuMatrix44F* scaledModelViewMatrices,
+                                    int maxResults)
 {
-    bool result = false;
-
-    if (mTarget != MODEL_TARGET_ID)
-    {
-        return false;
-    }
+    assert(targetType >= 0 && targetType < NUM_TARGET_TYPES);
 
-    VuObservationList* observationList = nullptr;
-    REQUIRE_SUCCESS(vuObservationListCreate(&observationList));
+    projectionMatrix = mCurrentRenderState.projectionMatrix;
 
-    if (vuStateGetModelTargetObservations(mVuforiaState, observationList) != VU_SUCCESS)
+    if (mCurrentFrame == nullptr)
     {
-        LOG("Error getting model target observations");
-        REQUIRE_SUCCESS(vuObservationListDestroy(observationList));
-        return false;
+        return 0;
     }
 
-    int numObservations = 0;
-    REQUIRE_SUCCESS(vuObservationListGetSize(observationList, &numObservations));
-
-    if (numObservations > 0)
+    const FrameData& frame = *mCurrentFrame;
+    int numResults = 0;
+    for (int i = 0; i < frame.numTargetObservations[targetType] && numResults < maxResults; ++i)
     {
-        VuObservation* observation = nullptr;
-        if (vuObservationListGetElement(observationList, 0, &observation) == VU_SUCCESS)
+        const ObservationData& observation = frame.observations[frame.targetObservations[targetType][i]];
+        if (observation.poseInfo.poseStatus == VU_OBSERVATION_POSE_STATUS_NO_POSE)
         {
-            assert(observation);
-            assert(vuObservationIsType(observation, VU_OBSERVATION_MODEL_TARGET_TYPE) == VU_TRUE);
-            assert(vuObservationHasPoseInfo(observation) == VU_TRUE);
-
-            VuPoseInfo poseInfo;
-            REQUIRE_SUCCESS(vuObservationGetPoseInfo(observation, &poseInfo));
-
-            VuModelTargetObservationTargetInfo modelTargetInfo;
-            REQUIRE_SUCCESS(vuModelTargetObservationGetTargetInfo(observation, &modelTargetInfo));
-            if (poseInfo.poseStatus == VU_OBSERVATION_POSE_STATUS_NO_POSE)
-            {
-                VuGuideViewList* guideViewList;
-                REQUIRE_SUCCESS(vuGuideViewListCreate(&guideViewList));
-
-                if (vuModelTargetObserverGetGuideViews(mObjectObserver, guideViewList) != VU_SUCCESS)
-                {
-                    LOG("Error getting list of guide views");
-                }
-                else
-                {
-                    int32_t size;
-                    REQUIRE_SUCCESS(vuGuideViewListGetSize(guideViewList, &size));
-                    mGuideViewModelTarget = [&]() -> VuGuideView*
-                    {
-                        for (int i = 0; i < size; ++i)
-                        {
-                            VuGuideView* guideView = nullptr;
-                            REQUIRE_SUCCESS(vuGuideViewListGetElement(guideViewList, i, &guideView));
-                            const char* guideViewName = nullptr;
-                            REQUIRE_SUCCESS(vuGuideViewGetName(guideView, &guideViewName));
-                            
-                            // Note: We use the activeGuideViewName as we know there is a guide view for our dataset.
-                            //       When using Advanced Model Targets there may not be a guide view and
-                            //       activeGuideViewName will be NULL.
-                            if (strcmp(guideViewName, modelTargetInfo.activeGuideViewName) == 0)
-                            {
-                               return guideView;
-                            }
-                        }
-                        return nullptr;
-                    }();
-                    if (!mGuideViewModelTarget)
-                    {
-                        LOG("Error getting guide view details");
-                    }
-                }
-
-                REQUIRE_SUCCESS(vuGuideViewListDestroy(guideViewList));
-            }
-            else
-            {
-                mGuideViewModelTarget = nullptr;
-
-                projectionMatrix = mCurrentRenderState.projectionMatrix;
-
-                // Compute model-view matrix
-                auto modelMatrix = poseInfo.pose;
-                modelViewMatrix = vuMatrix44FMultiplyMatrix(mCurrentRenderState.viewMatrix,
-                                                            modelMatrix);
+            continue;
+        }
 
-                // Calculate a scaled modelViewMatrix for rendering a unit bounding box
-                VuMatrix44F scaleMatrix = vuMatrix44FScalingMatrix(modelTargetInfo.size);
-                VuMatrix44F translateMatrix = vuMatrix44FTranslationMatrix(modelTargetInfo.bbox.center);
+        // Compute model-view matrix
+        VuMatrix44F& modelViewMatrix = modelViewMatrices[numResults];
+        MatrixMath::multiply(mCurrentRenderState.viewMatrix, observation.poseInfo.pose, modelViewMatrix);
 
-                scaledModelViewMatrix = vuMatrix44FMultiplyMatrix(translateMatrix, scaleMatrix);
-                scaledModelViewMatrix = vuMatrix44FMultiplyMatrix(modelViewMatrix, scaledModelViewMatrix);
+        // Calculate a scaled modelViewMatrix for rendering a unit bounding box
+        VuMatrix44F& scaledModelViewMatrix = scaledModelViewMatrices[numResults];
+        if (targetType == IMAGE_TARGET_ID)
+        {
+            assert(observation.type == VU_OBSERVATION_IMAGE_TARGET_TYPE);
+            MatrixMath::scale(observation.size, modelViewMatrix, scaledModelViewMatrix);
+        }
+        else
+        {
+            assert(observation.type == VU_OBSERVATION_MODEL_TARGET_TYPE);
+            VuMatrix44F scaleMatrix = MatrixMath::scalingMatrix(observation.size);
+            VuMatrix44F translateMatrix = MatrixMath::translationMatrix(observation.center);
 
-                result = true;
-            }
+            MatrixMath::multiply(translateMatrix, scaleMatrix, scaledModelViewMatrix);
+            MatrixMath::multiply(modelViewMatrix, scaledModelViewMatrix, scaledModelViewMatrix);
         }
-    }
 
-    REQUIRE_SUCCESS(vuObservationListDestroy(observationList));
+        ++numResults;
+    }
 
-    return result;
+    return numResults;
 }
 
 
 bool AppController::getModelTargetGuideView(VuMatrix44F& projectionMatrix,
                                             VuMatrix44F& modelViewMatrix,
-                                            VuImageInfo& guideViewImageInfo)
+                                            VuImageInfo& guideViewImageInfo,
+                                            const char*& guideViewName)
 {
     if (mGuideViewModelTarget == nullptr)
     {
         return false;
     }
+    guideViewName = mGuideViewName.c_str();
 
     VuCameraIntrinsics cameraIntrinsics;
     if (vuStateGetCameraIntrinsics(mVuforiaState, &cameraIntrinsics) != VU_SUCCESS)
@@ -568,7 +685,7 @@ bool AppController::getModelTargetGuideView(VuMatrix44F& projectionMatrix,
 
     float planeDistance = 0.01f;
     float fieldOfView = fov.data[1];
-    float nearPlaneHeight = 1.0f * planeDistance * std::tanf(fieldOfView * 0.5f);
+    float nearPlaneHeight = 1.0f * planeDistance * std::tan(fieldOfView * 0.5f);
     float nearPlaneWidth = nearPlaneHeight * mDisplayAspectRatio;
 
     float planeWidth;
@@ -609,12 +726,40 @@ bool AppController::getModelTargetGuideView(VuMatrix44F& projectionMatrix,
     projectionMatrix = vuIdentityMatrix44F();
     modelViewMatrix = vuIdentityMatrix44F();
 
-    modelViewMatrix = vuMatrix44FScale(VuVector3F{scale.data[0], scale.data[1], 1.0f}, modelViewMatrix);
+    MatrixMath::scale(VuVector3F{scale.data[0], scale.data[1], 1.0f}, modelViewMatrix, modelViewMatrix);
 
     return true;
 }
 
 
+void AppController::enumerateGuideViewImages(const GuideViewImageCallback& callback)
+{
+    for (const auto& objectObserver : mObjectObservers)
+    {
+        for (const auto& guideView : objectObserver.guideViews)
+        {
+            VuImage* guideViewImage = nullptr;
+            VuImageInfo guideViewImageInfo;
+            if (vuGuideViewGetImage(guideView.second, &guideViewImage) != VU_SUCCESS ||
+                vuImageGetImageInfo(guideViewImage, &guideViewImageInfo) != VU_SUCCESS)
+            {
+                LOG("Error getting image for guide view %s", guideView.first.c_str());
+                continue;
+            }
+            callback(guideView.first.c_str(), guideViewImageInfo);
+        }
+    }
+}
+
+
+bool AppController::hasObserverForTargetType(int targetType) const
+{
+    return std::any_of(mObjectObservers.begin(), mObjectObservers.end(),
+                       [targetType](const ObjectObserver& objectObserver)
+                       { return objectObserver.targetType == targetType; });
+}
+
+
 /*===============================================================================
 AppController private methods
 ===============================================================================*/
@@ -689,6 +834,23 @@ bool AppController::initVuforiaInternal(void* appData)
         return false;
     }
 
+    // Add the Vuforia Driver configuration if the camera is provided by a driver
+    if (mDriverName != nullptr)
+    {
+        auto driverConfig = vuDriverConfigDefault();
+        driverConfig.driverName = mDriverName;
+        driverConfig.userData = mDriverUserData;
+        if (vuEngineConfigSetAddDriverConfig(configSet, &driverConfig) != VU_SUCCESS)
+        {
+            // Clean up before exiting
+            REQUIRE_SUCCESS(vuEngineConfigSetDestroy(configSet));
+
+            LOG("Failed to init Vuforia, could not configure the Vuforia Driver %s", mDriverName);
+            mShowErrorCallback("Vuforia failed to initialize, could not configure the Vuforia Driver");
+            return false;
+        }
+    }
+
     // Create Engine instance
     VuErrorCode errorCode;
     auto engineCreateResult = vuEngineCreate(&mEngine, configSet, &errorCode);
@@ -780,6 +942,14 @@ std::string AppController::initErrorToString(VuErrorCode error)
             errorMessage = "Vuforia failed to initialize because the license check encountered an unknown error.";
             break;
 
+        case VU_ENGINE_CREATION_ERROR_DRIVER_CONFIG_LOAD_ERROR:
+            errorMessage = "Vuforia failed to initialize because the Vuforia Driver could not be loaded.";
+            break;
+
+        case VU_ENGINE_CREATION_ERROR_DRIVER_CONFIG_FEATURE_NOT_SUPPORTED:
+            errorMessage = "Vuforia failed to initialize because the Vuforia Driver is not supported by the license.";
+            break;
+
         case VU_ENGINE_CREATION_ERROR_RENDER_CONFIG_UNSUPPORTED_BACKEND:
             errorMessage = "Vuforia failed to initialize because the requested rendering backend is not supported on this platform or device.";
             break;
@@ -807,37 +977,76 @@ bool AppController::createObservers()
         LOG("Error creating device pose observer: 0x%02x", devicePoseCreationError);
         return false;
     }
+    mDevicePoseObserverId = vuObserverGetId(mDevicePoseObserver);
 
-    if (mTarget == IMAGE_TARGET_ID)
+    // Use the sample target if the app didn't configure any targets
+    std::vector<TargetConfig> targets = mTargets;
+    if (targets.empty())
     {
-        auto imageTargetConfig = vuImageTargetConfigDefault();
-        imageTargetConfig.databasePath = "StonesAndChips.xml";
-        imageTargetConfig.targetName = "stones";
-        imageTargetConfig.activate = VU_TRUE;
-
-        VuImageTargetCreationError imageTargetCreationError;
-        if (vuEngineCreateImageTargetObserver(mEngine, &mObjectObserver, &imageTargetConfig, &imageTargetCreationError) != VU_SUCCESS)
+        TargetConfig sampleTarget;
+        sampleTarget.targetType = mTarget;
+        if (mTarget == IMAGE_TARGET_ID)
         {
-            LOG("Error creating image target observer: 0x%02x", imageTargetCreationError);
-            mShowErrorCallback("Error creating image target observer");
-            return false;
+            sampleTarget.databasePath = "StonesAndChips.xml";
+            sampleTarget.targetName = "stones";
+        }
+        else
+        {
+            sampleTarget.databasePath = "VuforiaMars_ModelTarget.xml";
+            sampleTarget.targetName = "VuforiaMars_ModelTarget";
         }
+        targets.push_back(sampleTarget);
     }
-    else
+
+    if (mMaxSimultaneousImageTargets > 1 &&
+        vuEngineSetMaximumSimultaneousTrackedImages(mEngine, mMaxSimultaneousImageTargets) != VU_SUCCESS)
     {
-        auto modelTargetConfig = vuModelTargetConfigDefault();
+        LOG("Failed to set the maximum number of simultaneously tracked images to %d", mMaxSimultaneousImageTargets);
+    }
 
-        modelTargetConfig.databasePath = "VuforiaMars_ModelTarget.xml";
-        modelTargetConfig.targetName = "VuforiaMars_ModelTarget";
-        modelTargetConfig.activate = VU_TRUE;
+    mObjectObservers.reserve(targets.size());
+    for (const auto& target : targets)
+    {
+        ObjectObserver objectObserver;
+        objectObserver.targetType = target.targetType;
 
-        VuModelTargetCreationError modelTargetCreationError;
-        if (vuEngineCreateModelTargetObserver(mEngine, &mObjectObserver, &modelTargetConfig, &modelTargetCreationError) != VU_SUCCESS)
+        if (target.targetType == IMAGE_TARGET_ID)
         {
-            LOG("Error creating image target observer: 0x%02x", modelTargetCreationError);
-            mShowErrorCallback("Error creating model target observer");
-            return false;
+            auto imageTargetConfig = vuImageTargetConfigDefault();
+            imageTargetConfig.databasePath = target.databasePath.c_str();
+            imageTargetConfig.targetName = target.targetName.c_str();
+            imageTargetConfig.activate = VU_TRUE;
+
+            VuImageTargetCreationError imageTargetCreationError;
+            if (vuEngineCreateImageTargetObserver(mEngine, &objectObserver.observer, &imageTargetConfig, &imageTargetCreationError) != VU_SUCCESS)
+            {
+                LOG("Error creating image target observer for %s: 0x%02x", target.targetName.c_str(), imageTargetCreationError);
+                mShowErrorCallback("Error creating image target observer");
+                return false;
+            }
+        }
+        else
+        {
+            auto modelTargetConfig = vuModelTargetConfigDefault();
+            modelTargetConfig.databasePath = target.databasePath.c_str();
+            modelTargetConfig.targetName = target.targetName.c_str();
+            modelTargetConfig.activate = VU_TRUE;
+
+            VuModelTargetCreationError modelTargetCreationError;
+            if (vuEngineCreateModelTargetObserver(mEngine, &objectObserver.observer, &modelTargetConfig, &modelTargetCreationError) != VU_SUCCESS)
+            {
+                LOG("Error creating model target observer for %s: 0x%02x", target.targetName.c_str(), modelTargetCreationError);
+                mShowErrorCallback("Error creating model target observer");
+                return false;
+            }
         }
+
+        objectObserver.id = vuObserverGetId(objectObserver.observer);
+        if (objectObserver.targetType == MODEL_TARGET_ID && !cacheGuideViews(objectObserver))
+        {
+            LOG("Error getting guide views for %s", target.targetName.c_str());
+        }
+        mObjectObservers.push_back(std::move(objectObserver));
     }
 
     return true;
@@ -846,17 +1055,49 @@ bool AppController::createObservers()
 
 void AppController::destroyObservers()
 {
-    if (mObjectObserver != nullptr && vuObserverDestroy(mObjectObserver) != VU_SUCCESS)
+    for (const auto& objectObserver : mObjectObservers)
     {
-        LOG("Error destroying object observer");
+        if (vuObserverDestroy(objectObserver.observer) != VU_SUCCESS)
+        {
+            LOG("Error destroying object observer");
+        }
     }
-    mObjectObserver = nullptr;
+    mObjectObservers.clear();
 
     if (mDevicePoseObserver != nullptr && vuObserverDestroy(mDevicePoseObserver) != VU_SUCCESS)
     {
         LOG("Error destroying object observer");
     }
     mDevicePoseObserver = nullptr;
+    mDevicePoseObserverId = -1;
+}
+
+
+bool AppController::cacheGuideViews(ObjectObserver& objectObserver)
+{
+    VuGuideViewList* guideViewList = nullptr;
+    REQUIRE_SUCCESS(vuGuideViewListCreate(&guideViewList));
+
+    if (vuModelTargetObserverGetGuideViews(objectObserver.observer, guideViewList) != VU_SUCCESS)
+    {
+        REQUIRE_SUCCESS(vuGuideViewListDestroy(guideViewList));
+        return false;
+    }
+
+    int32_t size;
+    REQUIRE_SUCCESS(vuGuideViewListGetSize(guideViewList, &size));
+    objectObserver.guideViews.reserve(size);
+    for (int i = 0; i < size; ++i)
+    {
+        VuGuideView* guideView = nullptr;
+        REQUIRE_SUCCESS(vuGuideViewListGetElement(guideViewList, i, &guideView));
+        const char* guideViewName = nullptr;
+        REQUIRE_SUCCESS(vuGuideViewGetName(guideView, &guideViewName));
+        objectObserver.guideViews.emplace(guideViewName, guideView);
+    }
+
+    REQUIRE_SUCCESS(vuGuideViewListDestroy(guideViewList));
+    return true;
 }
 
 
@@ -866,42 +1107,116 @@ void AppController::updateDevicePose()
     mLatestDevicePoseData.poseStatus = VU_OBSERVATION_POSE_STATUS_NO_POSE;
     mLatestDevicePoseData.poseStatusInfo = VU_DEVICE_POSE_OBSERVATION_STATUS_INFO_NORMAL;
 
-    VuObservationList* observationList = nullptr;
-    REQUIRE_SUCCESS(vuObservationListCreate(&observationList));
+    const FrameData& frame = *mCurrentFrame;
+    if (frame.devicePoseObservation < 0)
+    {
+        return;
+    }
+
+    const ObservationData& observation = frame.observations[frame.devicePoseObservation];
+    assert(observation.type == VU_OBSERVATION_DEVICE_POSE_TYPE);
+
+    if (observation.poseInfo.poseStatus != VU_OBSERVATION_POSE_STATUS_NO_POSE)
+    {
+        // Store latest tracked device pose and pose status
+        mLatestDevicePoseData.pose = observation.poseInfo.pose;
+        mLatestDevicePoseData.poseStatus = observation.poseInfo.poseStatus;
+        mLatestDevicePoseData.poseStatusInfo = observation.devicePoseStatusInfo;
+    }
+}
+
 
-    if (vuStateGetDevicePoseObservations(mVuforiaState, observationList) == VU_SUCCESS)
+void AppController::updateGuideView()
+{
+    // Keep the current Guide View until there are Model Target observations
+    const FrameData& frame = *mCurrentFrame;
+    if (frame.numTargetObservations[MODEL_TARGET_ID] == 0)
     {
-        int numObservations = 0;
-        REQUIRE_SUCCESS(vuObservationListGetSize(observationList, &numObservations));
+        return;
+    }
 
-        if (numObservations > 0)
+    // The Guide View is only displayed while none of the Model Targets are tracked
+    const ObservationData* untrackedObservation = nullptr;
+    for (int i = 0; i < frame.numTargetObservations[MODEL_TARGET_ID]; ++i)
+    {
+        const ObservationData& observation = frame.observations[frame.targetObservations[MODEL_TARGET_ID][i]];
+        if (observation.poseInfo.poseStatus != VU_OBSERVATION_POSE_STATUS_NO_POSE)
         {
-            VuObservation* observation = nullptr;
-            if (vuObservationListGetElement(observationList, 0, &observation) == VU_SUCCESS)
-            {
-                assert(observation);
-                assert(vuObservationIsType(observation, VU_OBSERVATION_DEVICE_POSE_TYPE) == VU_TRUE);
-                assert(vuObservationHasPoseInfo(observation) == VU_TRUE);
-
-                VuPoseInfo poseInfo;
-                REQUIRE_SUCCESS(vuObservationGetPoseInfo(observation, &poseInfo));
-
-                if (poseInfo.poseStatus != VU_OBSERVATION_POSE_STATUS_NO_POSE)
-                {
-                    // Store latest tracked device pose and pose status
-                    mLatestDevicePoseData.pose = poseInfo.pose;
-                    mLatestDevicePoseData.poseStatus = poseInfo.poseStatus;
-
-                    // Retrieve device pose-specific status information
-                    REQUIRE_SUCCESS(vuDevicePoseObservationGetStatusInfo(observation, &mLatestDevicePoseData.poseStatusInfo));
-                }
-            }
+            mGuideViewModelTarget = nullptr;
+            return;
+        }
+        if (untrackedObservation == nullptr)
+        {
+            untrackedObservation = &observation;
         }
     }
-    else
+
+    // Note: We use the activeGuideViewName as we know there is a guide view for our dataset.
+    //       When using Advanced Model Targets there may not be a guide view and
+    //       activeGuideViewName will be NULL.
+    const char* activeGuideViewName = untrackedObservation->activeGuideViewName;
+    if (activeGuideViewName == nullptr)
+    {
+        mGuideViewModelTarget = nullptr;
+        mGuideViewName.clear();
+        return;
+    }
+
+    // Only look the Guide View up again when the active one changes
+    if (mGuideViewModelTarget != nullptr && mGuideViewName == activeGuideViewName)
+    {
+        return;
+    }
+
+    mGuideViewName = activeGuideViewName;
+    const auto& guideViews = untrackedObservation->objectObserver->guideViews;
+    auto guideView = guideViews.find(mGuideViewName);
+    mGuideViewModelTarget = guideView != guideViews.end() ? guideView->second : nullptr;
+    if (!mGuideViewModelTarget)
+    {
+        LOG("Error getting guide view details");
+    }
+}
+
+
+void VU_API_CALL AppController::stateHandler(const VuState* state, void* clientData)
+{
+    // Called on the Vuforia Engine thread, the state is only valid during the call so a
+    // reference is kept with the collected frame for the render thread
+    auto* controller = static_cast<AppController*>(clientData);
+    Trace::setThreadName("Vuforia Engine");
+    Trace::ScopedEvent event("stateHandler");
+    FrameData& frame = controller->mStateHandlerFrames.getWriteBuffer();
+
+    if (frame.state != nullptr && vuStateRelease(frame.state) != VU_SUCCESS)
     {
-        LOG("Error getting device pose observations");
+        LOG("Error releasing the Vuforia state");
     }
+    frame.state = nullptr;
+
+    if (vuStateAcquireReference(state, &frame.state) != VU_SUCCESS)
+    {
+        LOG("Error acquiring a reference to the Vuforia state");
+        return;
+    }
+
+    controller->collectFrame(frame.state, frame);
+    controller->mStateHandlerFrames.publish();
+    Instrumentation::increment(Instrumentation::Counter::STATES_COLLECTED);
+}
 
-    REQUIRE_SUCCESS(vuObservationListDestroy(observationList));
+
+void AppController::releaseStateHandlerFrames()
+{
+    for (int i = 0; i < TripleBuffer<FrameData>::NUM_BUFFERS; ++i)
+    {
+        FrameData& frame = mStateHandlerFrames.getBuffer(i);
+        if (frame.state != nullptr && vuStateRelease(frame.state) != VU_SUCCESS)
+        {
+            LOG("Error releasing the Vuforia state");
+        }
+        frame.state = nullptr;
+        frame.numObservations = 0;
+    }
+    mStateHandlerFrames.reset();
 }
@@ -8,13 +8,20 @@ countries.
 #ifndef __APPCONTROLLER_H__
 #define __APPCONTROLLER_H__
 
+#include "TripleBuffer.h"
+
 #include <VuforiaEngine/VuforiaEngine.h>
 
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
 #include <cstdio>
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 
 /// The AppController provides a platform-independent encapsulation of the Vuforia lifecycle
@@ -27,10 +34,26 @@ public:
     // Constants
     static constexpr int IMAGE_TARGET_ID = 0;
     static constexpr int MODEL_TARGET_ID = 1;
+    /// Number of target types, the target ids above are in the range [0, NUM_TARGET_TYPES)
+    static constexpr int NUM_TARGET_TYPES = 2;
+
+    /// Maximum number of observations collectFrame keeps for a frame
+    static constexpr int MAX_FRAME_OBSERVATIONS = 32;
 
     // Type definitions
     using ErrorCallback = std::function<void(const char* errorString)>;
     using InitDoneCallback = std::function<void()>;
+    using GuideViewImageCallback = std::function<void(const char* guideViewName, const VuImageInfo& imageInfo)>;
+
+    /// A target in a device database to create an Observer for
+    class TargetConfig
+    {
+    public:
+        /// Either IMAGE_TARGET_ID or MODEL_TARGET_ID
+        int targetType { IMAGE_TARGET_ID };
+        std::string databasePath;
+        std::string targetName;
+    };
 
     /// Struct to group initialization parameters passed to initAR
     class InitConfig
@@ -40,6 +63,23 @@ public:
         void* appData { nullptr };
         ErrorCallback showErrorCallback {};
         InitDoneCallback initDoneCallback {};
+        /// The targets to observe, the Observers run concurrently and may use different databases.
+        /// If empty the sample target selected by the target parameter of initAR is used.
+        std::vector<TargetConfig> targets {};
+        /// Maximum number of Image Targets tracked at the same time
+        int maxSimultaneousImageTargets { 1 };
+        /// If true the observations are collected on the Vuforia Engine thread as each state
+        /// becomes available and prepareToRender picks up the latest collected frame, otherwise
+        /// prepareToRender acquires the latest state and collects the observations itself.
+        bool useStateHandler { false };
+        /// Name of a Vuforia Driver library providing the camera instead of the device camera,
+        /// driverUserData is passed to the driver's vuforiaDriver_init
+        const char* driverName { nullptr };
+        void* driverUserData { nullptr };
+        /// If set the frame loop is traced while AR is started and the events are appended to
+        /// this file, in the Chrome Trace Event format, when AR is stopped. See Trace.h.
+        /// The file is replaced when AR is first started.
+        const char* traceFilePath { nullptr };
     };
 
 
@@ -81,6 +121,8 @@ public:
     /// Call this method at the start of Vuforia rendering.
     /// Gets the latest video background texture from Vuforia.
     /// Whatever the result of this call finishRender must be called before rendering completes.
+    /// Returns false once stopAR has been called, stopAR waits for a frame already being
+    /// rendered to reach finishRender.
     bool prepareToRender(double* viewport, VuRenderVideoBackgroundData* renderData);
 
     /// Call this method when Vuforia rendering is complete, this should be near the end of the
@@ -95,27 +137,93 @@ public:
     /// Returns false if the world origin position is not currently available.
     bool getOrigin(VuMatrix44F& projectionMatrix, VuMatrix44F& modelViewMatrix);
 
-    /// Get rendering information for the Image Target.
-    /// Returns false if Vuforia isn't currently tracking the Image Target.
-    bool getImageTargetResult(VuMatrix44F& projectionMatrix,
-                              VuMatrix44F& modelViewMatrix, VuMatrix44F& scaledModelViewMatrix);
-
-    /// Get rendering information for the Model Target.
-    /// Returns false if Vuforia isn't currently tracking the Model Target.
-    bool getModelTargetResult(VuMatrix44F& projectionMatrix,
-                              VuMatrix44F& modelViewMatrix, VuMatrix44F& scaledModelViewMatrix);
+    /// Get rendering information for all the tracked targets of one type.
+    /// targetType is either IMAGE_TARGET_ID or MODEL_TARGET_ID. The matrices of up to maxResults
+    /// targets are written to modelViewMatrices and scaledModelViewMatrices, the scaled matrices
+    /// are for rendering a unit bounding box. Returns the number of targets written.
+    int getTargetResults(int targetType, VuMatrix44F& projectionMatrix,
+                         VuMatrix44F* modelViewMatrices, VuMatrix44F* scaledModelViewMatrices,
+                         int maxResults);
 
     /// Get rendering information for the Model Target Guide View.
     /// Returns false if Guide View rendering isn't required for the current frame.
+    /// guideViewName identifies the image so that rendering resources created for it can be reused,
+    /// it remains valid until the Observers are destroyed.
     bool getModelTargetGuideView(VuMatrix44F& projectionMatrix,
                                  VuMatrix44F& modelViewMatrix,
-                                 VuImageInfo& guideViewImageInfo);
+                                 VuImageInfo& guideViewImageInfo,
+                                 const char*& guideViewName);
+
+    /// Invoke callback with the image of every Guide View of the Model Target Observers.
+    /// Use this after initAR to prepare rendering resources for the Guide Views before they are displayed.
+    void enumerateGuideViewImages(const GuideViewImageCallback& callback);
+
+    /// Check whether any Observer tracks targets of targetType, IMAGE_TARGET_ID or MODEL_TARGET_ID.
+    /// Use this after initAR to prepare rendering resources only for the targets that can be observed.
+    bool hasObserverForTargetType(int targetType) const;
 
     /// Get the PlatformController handle.
     /// The result is only valid after initAR is called and before deinitAR is called.
     VuController* getPlatformController() { return mPlatformController; }
 
 
+private: // types
+
+    /// An Observer for one of the configured targets
+    struct ObjectObserver
+    {
+        VuObserver* observer { nullptr };
+        /// Observer id used to bucket observations in collectFrame
+        int32_t id { -1 };
+        /// Either IMAGE_TARGET_ID or MODEL_TARGET_ID
+        int targetType { IMAGE_TARGET_ID };
+        /// The Guide Views of a Model Target by name, they are owned by the Observer
+        std::unordered_map<std::string, VuGuideView*> guideViews;
+    };
+
+
+    /// Pose data extracted from an observation by collectFrame
+    struct ObservationData
+    {
+        /// The observation type, one of the VU_OBSERVATION_*_TYPE values
+        VuObservationType type { 0 };
+
+        /// The Observer that reported a target observation, nullptr for the device pose
+        const ObjectObserver* objectObserver { nullptr };
+
+        /// Pose and pose status
+        VuPoseInfo poseInfo { VU_OBSERVATION_POSE_STATUS_NO_POSE, {} };
+
+        /// Target size, the z-dimension of an Image Target is set to its larger dimension
+        VuVector3F size {};
+
+        /// Center of the target bounding box
+        VuVector3F center {};
+
+        /// Name of the active Guide View of a Model Target, owned by the Vuforia state
+        const char* activeGuideViewName { nullptr };
+
+        /// Device pose status info
+        VuDevicePoseObservationStatusInfo devicePoseStatusInfo { VU_DEVICE_POSE_OBSERVATION_STATUS_INFO_UNKNOWN };
+    };
+
+    /// The observations collected from a Vuforia state by collectFrame
+    struct FrameData
+    {
+        /// Reference to the state, it keeps the data the observations point to valid
+        VuState* state { nullptr };
+
+        ObservationData observations[MAX_FRAME_OBSERVATIONS];
+        int numObservations { 0 };
+
+        /// Index in observations of the device pose observation, -1 if there is none
+        int devicePoseObservation { -1 };
+
+        /// Indices in observations of the target observations, bucketed by target type
+        int targetObservations[NUM_TARGET_TYPES][MAX_FRAME_OBSERVATIONS];
+        int numTargetObservations[NUM_TARGET_TYPES] {};
+    };
+
 private: // methods
     
     /// Used by initAR to prepare and invoke Vuforia initialization.
@@ -130,9 +238,28 @@ private: // methods
     /// Clean up Observers created by createObservers
     void destroyObservers();
 
+    /// Fill the guideViews of a Model Target Observer
+    bool cacheGuideViews(ObjectObserver& objectObserver);
+
     /// Called in prepareToRender to update the cached device pose information
     void updateDevicePose();
 
+    /// Called in prepareToRender to select the Guide View to display
+    void updateGuideView();
+
+    /// Collect the observations for a frame
+    /// The state is queried once for all observations and those reported by the Observers
+    /// created by the AppController are bucketed by type, getTargetResults then reads them
+    /// without querying the state again. frame.state isn't changed.
+    void collectFrame(const VuState* state, FrameData& frame);
+
+    /// Vuforia state handler, called on the Vuforia Engine thread when useStateHandler is set
+    static void VU_API_CALL stateHandler(const VuState* state, void* clientData);
+
+    /// Release the state references held by the state handler frames
+    /// Called by stopAR once neither the state handler nor the render thread uses the frames.
+    void releaseStateHandlerFrames();
+
 private: // data members
 
     /// Callback to inform the user of an error
@@ -151,14 +278,30 @@ private: // data members
 
     /// THe rendering backend to use for the Video Background
     VuRenderVBBackendType mVbRenderBackend = VuRenderVBBackendType::VU_RENDER_VB_BACKEND_DEFAULT;
-    /// The target to use, either IMAGE_TARGET_ID or MODEL_TARGET_ID
+    /// The sample target to use if no targets are configured, either IMAGE_TARGET_ID or MODEL_TARGET_ID
     int mTarget = IMAGE_TARGET_ID;
+    /// The targets to create Observers for, copied from InitConfig
+    std::vector<TargetConfig> mTargets;
+    /// Maximum number of Image Targets tracked at the same time
+    int mMaxSimultaneousImageTargets = 1;
+    /// Vuforia Driver configuration copied from InitConfig, the name is nullptr if no driver is used
+    const char* mDriverName = nullptr;
+    void* mDriverUserData = nullptr;
+    /// Trace file written when AR is stopped, empty if the frame loop isn't traced
+    std::string mTraceFilePath;
 
     /// The Vuforia camera video mode to use, either DEFAULT, SPEED or QUALITY.
     VuCameraVideoModePreset mCameraVideoMode = VuCameraVideoModePreset::VU_CAMERA_VIDEO_MODE_PRESET_DEFAULT;
 
     /// Flag that is true when Vuforia is running
-    bool mARStarted = false;
+    std::atomic<bool> mARStarted { false };
+
+    /// Guards mRendering and the changes of mARStarted in stopAR
+    std::mutex mRenderMutex;
+    std::condition_variable mRenderCondition;
+    /// True from prepareToRender to finishRender while AR is started, the render thread is then
+    /// using mVuforiaState and the frames of the state handler
+    bool mRendering = false;
 
     /// Local copy of current RenderState
     VuRenderState mCurrentRenderState;
@@ -189,15 +332,38 @@ private: // data members
     /// The maximum length of time in the RELOCALIZING state before tracking is reset
     static constexpr int MAX_RELOCALIZING_SECONDS { 15 };
 
-    /// The observer for either the Image or Model target depending on which target was specified
-    VuObserver* mObjectObserver = nullptr;
+    /// The Observers for the Image and Model Targets, created in createObservers
+    std::vector<ObjectObserver> mObjectObservers;
+
+    /// Observer id used to bucket observations in collectFrame
+    int32_t mDevicePoseObserverId = -1;
+
+
+    /// If true observations are collected on the Vuforia Engine thread by the state handler
+    bool mUseStateHandler = false;
+    /// Frames collected by the state handler, handed over to the render thread
+    TripleBuffer<FrameData> mStateHandlerFrames;
+    /// Frame collected by prepareToRender when the state handler isn't used
+    FrameData mPulledFrame;
+    /// Between calls to prepareToRender and finishRender this points to the frame being rendered
+    const FrameData* mCurrentFrame = nullptr;
 
     /// Between calls to prepareToRender and finishRender this holds a copy of the Vuforia state.
     VuState* mVuforiaState = nullptr;
 
+    /// Observation list filled by collectFrame, valid between initAR and deinitAR
+    /**
+     * The Vuforia query functions replace the previous contents of the list, so
+     * its contents are only meaningful within the method that filled it.
+     */
+    VuObservationList* mObservationList = nullptr;
+
     /// If a Model Target Guide View should be displayed this points to the object providing
     /// details of what the App should render.
     VuGuideView* mGuideViewModelTarget = nullptr;
+    /// Name of mGuideViewModelTarget, the Guide View is only looked up again when the active
+    /// Guide View reported by the Model Target observation changes
+    std::string mGuideViewName;
 };
 
 #endif /* __APPCONTROLLER_H__ */
@@ -0,0 +1,119 @@
+/*===============================================================================
+Copyright (c) 2022 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#ifndef __ASSET_READER_H__
+#define __ASSET_READER_H__
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+
+/// Read-only contents of an asset held in memory
+/**
+ * The contents are a memory mapping of the asset where the platform allows it, otherwise
+ * memory owned by the platform's asset manager or a copy owned by the AssetData. Either way
+ * they can be passed to MeshFile::read, ObjLoader::load or a MemoryInputStream without
+ * copying, and remain valid until the AssetData is reset or destroyed.
+ */
+class AssetData
+{
+public:
+    /// Releases contents that aren't owned by the AssetData, handle is the value passed to reset
+    using ReleaseFunction = void (*)(void* handle, const char* data, size_t size);
+
+    AssetData() = default;
+    ~AssetData() { reset(); }
+
+    AssetData(AssetData&& other) noexcept { *this = std::move(other); }
+    AssetData& operator=(AssetData&& other) noexcept
+    {
+        if (this != &other)
+        {
+            reset();
+            mData = std::exchange(other.mData, nullptr);
+            mSize = std::exchange(other.mSize, 0);
+            mRelease = std::exchange(other.mRelease, nullptr);
+            mHandle = std::exchange(other.mHandle, nullptr);
+            // Moving the vector keeps its buffer, so mData remains valid
+            mStorage = std::move(other.mStorage);
+            other.mStorage.clear();
+        }
+        return *this;
+    }
+
+    AssetData(const AssetData&) = delete;
+    AssetData& operator=(const AssetData&) = delete;
+
+    /// Hold contents released with release(handle, data, size) when they are no longer needed
+    void reset(const char* data, size_t size, ReleaseFunction release, void* handle)
+    {
+        reset();
+        mData = data;
+        mSize = size;
+        mRelease = release;
+        mHandle = handle;
+    }
+
+    /// Hold contents copied into storage
+    void reset(std::vector<char>&& storage)
+    {
+        reset();
+        mStorage = std::move(storage);
+        mData = mStorage.data();
+        mSize = mStorage.size();
+    }
+
+    /// Release the contents
+    void reset()
+    {
+        if (mRelease != nullptr)
+        {
+            mRelease(mHandle, mData, mSize);
+        }
+        mData = nullptr;
+        mSize = 0;
+        mRelease = nullptr;
+        mHandle = nullptr;
+        mStorage = std::vector<char>();
+    }
+
+    const char* data() const { return mData; }
+    size_t size() const { return mSize; }
+    bool empty() const { return mSize == 0; }
+
+    const char* begin() const { return mData; }
+    const char* end() const { return mData + mSize; }
+
+private:
+    const char* mData { nullptr };
+    size_t mSize { 0 };
+    ReleaseFunction mRelease { nullptr };
+    void* mHandle { nullptr };
+    std::vector<char> mStorage;
+};
+
+
+/// Source of the app's asset files
+/**
+ * Implemented by AndroidAssetReader for the assets packaged in the APK and by FileAssetReader
+ * for files on the file system.
+ */
+class AssetReader
+{
+public:
+    virtual ~AssetReader() = default;
+
+    /// Check whether an asset exists
+    virtual bool exists(const char* name) const = 0;
+
+    /// Map or read the whole asset into data
+    /// Returns false if the asset doesn't exist or can't be read.
+    virtual bool read(const char* name, AssetData& data) const = 0;
+};
+
+#endif // __ASSET_READER_H__
@@ -0,0 +1,131 @@
+/*===============================================================================
+Copyright (c) 2022 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#include "FileAssetReader.h"
+
+#include "Log.h"
+
+#include <cstdio>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define FILE_ASSET_READER_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+namespace
+{
+
+/// Read a whole file into memory
+bool readFile(const char* path, AssetData& data)
+{
+    FILE* file = fopen(path, "rb");
+    if (file == nullptr)
+    {
+        LOG("Error opening asset file %s", path);
+        return false;
+    }
+
+    std::vector<char> contents;
+    char buffer[BUFSIZ];
+    size_t numRead = 0;
+    while ((numRead = fread(buffer, 1, sizeof(buffer), file)) > 0)
+    {
+        // Only the bytes read, the last read is usually short
+        contents.insert(contents.end(), buffer, buffer + numRead);
+    }
+    bool failed = ferror(file) != 0;
+    fclose(file);
+    if (failed)
+    {
+        LOG("Error reading asset file %s", path);
+        return false;
+    }
+
+    data.reset(std::move(contents));
+    return true;
+}
+
+
+#if defined(FILE_ASSET_READER_MMAP)
+void unmap(void* handle, const char* data, size_t size)
+{
+    (void)handle;
+    munmap(const_cast<char*>(data), size);
+}
+#endif
+
+} // namespace
+
+
+bool FileAssetReader::exists(const char* name) const
+{
+    FILE* file = fopen(getPath(name).c_str(), "rb");
+    if (file == nullptr)
+    {
+        return false;
+    }
+    fclose(file);
+    return true;
+}
+
+
+bool FileAssetReader::read(const char* name, AssetData& data) const
+{
+    std::string path = getPath(name);
+    data.reset();
+
+#if defined(FILE_ASSET_READER_MMAP)
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        LOG("Error opening asset file %s", path.c_str());
+        return false;
+    }
+
+    struct stat status;
+    if (fstat(fd, &status) == 0 && S_ISREG(status.st_mode))
+    {
+        size_t size = static_cast<size_t>(status.st_size);
+        if (size == 0)
+        {
+            // Empty files can't be mapped
+            close(fd);
+            return true;
+        }
+
+        void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (mapping != MAP_FAILED)
+        {
+            // Models are parsed from start to end
+            madvise(mapping, size, MADV_SEQUENTIAL);
+            data.reset(static_cast<const char*>(mapping), size, unmap, nullptr);
+            return true;
+        }
+    }
+    else
+    {
+        close(fd);
+    }
+#endif
+
+    return readFile(path.c_str(), data);
+}
+
+
+std::string FileAssetReader::getPath(const char* name) const
+{
+    if (mDirectory.empty())
+    {
+        return name;
+    }
+    return mDirectory + "/" + name;
+}
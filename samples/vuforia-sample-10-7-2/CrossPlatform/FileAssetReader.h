@@ -0,0 +1,37 @@
+/*===============================================================================
+Copyright (c) 2022 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#ifndef __FILE_ASSET_READER_H__
+#define __FILE_ASSET_READER_H__
+
+#include "AssetReader.h"
+
+#include <string>
+
+
+/// Reads assets from files in a directory of the file system
+/**
+ * On POSIX systems the files are mapped into memory with mmap, so reading an asset doesn't
+ * copy it and its pages are loaded on demand. Elsewhere, or if the file can't be mapped, the
+ * file is read into memory.
+ */
+class FileAssetReader : public AssetReader
+{
+public:
+    /// Asset names are paths relative to directory, or used as they are if directory is empty
+    explicit FileAssetReader(std::string directory = std::string()) : mDirectory(std::move(directory)) {}
+
+    bool exists(const char* name) const override;
+    bool read(const char* name, AssetData& data) const override;
+
+private:
+    std::string getPath(const char* name) const;
+
+    std::string mDirectory;
+};
+
+#endif // __FILE_ASSET_READER_H__
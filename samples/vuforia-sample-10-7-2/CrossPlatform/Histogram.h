@@ -0,0 +1,176 @@
+/*===============================================================================
+Copyright (c) 2022 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#ifndef __HISTOGRAM_H__
+#define __HISTOGRAM_H__
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+
+/// Histogram of durations in nanoseconds with a fixed set of log-linear buckets
+/**
+ * As in an HDR histogram each power of two range is split into SUB_BUCKETS equal buckets,
+ * so every value up to MAX_VALUE is recorded with a relative error below 1 / SUB_BUCKETS
+ * without any allocation. Larger values are counted in the last bucket.
+ *
+ * One thread records into the histogram while any thread may read it, the buckets are atomics
+ * accessed with relaxed ordering so recording is a handful of plain loads and stores.
+ * Readers see a consistent enough view for statistics, not an exact snapshot.
+ */
+class Histogram
+{
+public:
+    static constexpr int SUB_BUCKET_BITS = 4;
+    static constexpr int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    /// Values below 2^MAX_EXPONENT ns, about 18 minutes, are recorded accurately
+    static constexpr int MAX_EXPONENT = 40;
+    static constexpr uint64_t MAX_VALUE = (uint64_t(1) << MAX_EXPONENT) - 1;
+    static constexpr int NUM_BUCKETS = (MAX_EXPONENT - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+    /// Bucket counts merged from one or more histograms
+    using Counts = std::array<uint64_t, NUM_BUCKETS>;
+
+    /// Record a value, only one thread may record into a histogram
+    void record(uint64_t value)
+    {
+        int bucket = getBucket(value);
+        mCounts[bucket].store(mCounts[bucket].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        mCount.store(mCount.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        mSum.store(mSum.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+        if (value > mMax.load(std::memory_order_relaxed))
+        {
+            mMax.store(value, std::memory_order_relaxed);
+        }
+        if (value < mMin.load(std::memory_order_relaxed))
+        {
+            mMin.store(value, std::memory_order_relaxed);
+        }
+    }
+
+    /// Remove all the values, only the recording thread may clear the histogram
+    void clear()
+    {
+        for (auto& count : mCounts)
+        {
+            count.store(0, std::memory_order_relaxed);
+        }
+        mCount.store(0, std::memory_order_relaxed);
+        mSum.store(0, std::memory_order_relaxed);
+        mMin.store(UINT64_MAX, std::memory_order_relaxed);
+        mMax.store(0, std::memory_order_relaxed);
+    }
+
+    /// Add the values recorded by other, only the recording thread may add to the histogram
+    void add(const Histogram& other)
+    {
+        for (int i = 0; i < NUM_BUCKETS; ++i)
+        {
+            mCounts[i].store(mCounts[i].load(std::memory_order_relaxed) + other.mCounts[i].load(std::memory_order_relaxed),
+                             std::memory_order_relaxed);
+        }
+        mCount.store(mCount.load(std::memory_order_relaxed) + other.getCount(), std::memory_order_relaxed);
+        mSum.store(mSum.load(std::memory_order_relaxed) + other.getSum(), std::memory_order_relaxed);
+        mMin.store(std::min(getMin(), other.getMin()), std::memory_order_relaxed);
+        mMax.store(std::max(getMax(), other.getMax()), std::memory_order_relaxed);
+    }
+
+    /// Add the bucket counts of this histogram to counts
+    void addTo(Counts& counts) const
+    {
+        for (int i = 0; i < NUM_BUCKETS; ++i)
+        {
+            counts[i] += mCounts[i].load(std::memory_order_relaxed);
+        }
+    }
+
+    uint64_t getCount() const { return mCount.load(std::memory_order_relaxed); }
+    uint64_t getSum() const { return mSum.load(std::memory_order_relaxed); }
+    /// Smallest value recorded, UINT64_MAX if there is none
+    uint64_t getMin() const { return mMin.load(std::memory_order_relaxed); }
+    uint64_t getMax() const { return mMax.load(std::memory_order_relaxed); }
+
+    /// Index of the bucket counting value
+    static int getBucket(uint64_t value)
+    {
+        value = std::min(value, MAX_VALUE);
+        if (value < SUB_BUCKETS)
+        {
+            return static_cast<int>(value);
+        }
+        int exponent = 63 - countLeadingZeros(value);
+        int subBucket = static_cast<int>(value >> (exponent - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1);
+        return (exponent - SUB_BUCKET_BITS + 1) * SUB_BUCKETS + subBucket;
+    }
+
+    /// Largest value counted in bucket
+    static uint64_t getBucketUpperBound(int bucket)
+    {
+        if (bucket < SUB_BUCKETS)
+        {
+            return static_cast<uint64_t>(bucket);
+        }
+        int exponent = bucket / SUB_BUCKETS + SUB_BUCKET_BITS - 1;
+        uint64_t subBucket = static_cast<uint64_t>(bucket % SUB_BUCKETS);
+        uint64_t lowerBound = (uint64_t(SUB_BUCKETS) + subBucket) << (exponent - SUB_BUCKET_BITS);
+        return lowerBound + (uint64_t(1) << (exponent - SUB_BUCKET_BITS)) - 1;
+    }
+
+    /// Value at or below which percentile (0 to 100) of the counted values lie
+    /// The result is the upper bound of the bucket holding the value, 0 if counts is empty.
+    static uint64_t getPercentile(const Counts& counts, double percentile)
+    {
+        uint64_t total = 0;
+        for (uint64_t count : counts)
+        {
+            total += count;
+        }
+        if (total == 0)
+        {
+            return 0;
+        }
+
+        uint64_t rank = static_cast<uint64_t>(percentile / 100.0 * static_cast<double>(total) + 0.5);
+        rank = std::min(std::max<uint64_t>(rank, 1), total);
+        uint64_t seen = 0;
+        for (int i = 0; i < NUM_BUCKETS; ++i)
+        {
+            seen += counts[i];
+            if (seen >= rank)
+            {
+                return getBucketUpperBound(i);
+            }
+        }
+        return MAX_VALUE;
+    }
+
+private:
+    static int countLeadingZeros(uint64_t value)
+    {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanReverse64(&index, value);
+        return 63 - static_cast<int>(index);
+#else
+        return __builtin_clzll(value);
+#endif
+    }
+
+    std::array<std::atomic<uint32_t>, NUM_BUCKETS> mCounts {};
+    std::atomic<uint64_t> mCount { 0 };
+    std::atomic<uint64_t> mSum { 0 };
+    std::atomic<uint64_t> mMin { UINT64_MAX };
+    std::atomic<uint64_t> mMax { 0 };
+};
+
+#endif // __HISTOGRAM_H__
@@ -0,0 +1,329 @@
+/*===============================================================================
+Copyright (c) 2022 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#include "Instrumentation.h"
+
+#include "Histogram.h"
+#include "Log.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+
+namespace
+{
+
+constexpr int NUM_STAGES = static_cast<int>(Instrumentation::Stage::NUM_STAGES);
+constexpr int NUM_COUNTERS = static_cast<int>(Instrumentation::Counter::NUM_COUNTERS);
+
+constexpr const char* STAGE_NAMES[NUM_STAGES] = {
+    "frame",
+    "acquire state",
+    "observations",
+    "video background update",
+    "draw video background",
+    "draw world origin",
+    "draw image targets",
+    "draw model targets",
+    "draw guide view",
+    "draw model",
+    "finish render",
+    "upload models",
+    "load model",
+    "gpu video background",
+    "gpu augmentations",
+    "gpu guide view",
+};
+
+constexpr const char* COUNTER_NAMES[NUM_COUNTERS] = {
+    "frames rendered",
+    "frames skipped",
+    "states collected",
+    "draw calls",
+    "instances drawn",
+    "tracking resets",
+};
+
+
+/// The statistics recorded by one thread
+struct alignas(64) ThreadData
+{
+    /// Value of gGeneration the statistics were last cleared for
+    std::atomic<uint32_t> generation { 0 };
+    Histogram histograms[NUM_STAGES];
+    std::atomic<uint64_t> counters[NUM_COUNTERS] {};
+};
+
+
+std::atomic<bool> gEnabled { true };
+/// Incremented by reset, the threads clear their data when they see a new generation
+std::atomic<uint32_t> gGeneration { 0 };
+
+/// The data of every running thread that recorded. The mutex is only taken when a thread
+/// records for the first time or exits and by readers.
+std::mutex gThreadDataMutex;
+std::vector<std::unique_ptr<ThreadData>> gThreadData;
+/// The statistics of the threads that exited, merged into a single block so that they aren't lost
+ThreadData gExitedThreadData;
+
+std::atomic<int64_t> gLogInterval { 5 };
+uint64_t gLastLogTime { 0 };
+
+
+/// Whether the data belongs to the current generation, data not cleared since a reset is ignored
+bool isCurrent(const ThreadData& data)
+{
+    return data.generation.load(std::memory_order_relaxed) == gGeneration.load(std::memory_order_relaxed);
+}
+
+
+/// Clear the statistics of data if they are from an earlier generation
+void clearIfStale(ThreadData& data)
+{
+    uint32_t generation = gGeneration.load(std::memory_order_relaxed);
+    if (data.generation.load(std::memory_order_relaxed) != generation)
+    {
+        data.generation.store(generation, std::memory_order_relaxed);
+        for (Histogram& histogram : data.histograms)
+        {
+            histogram.clear();
+        }
+        for (auto& counter : data.counters)
+        {
+            counter.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+
+/// Owns the data of a thread, merges it into gExitedThreadData and frees it when the thread exits
+struct ThreadDataOwner
+{
+    ThreadData* data { nullptr };
+
+    ~ThreadDataOwner()
+    {
+        if (data == nullptr)
+        {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(gThreadDataMutex);
+        if (isCurrent(*data))
+        {
+            clearIfStale(gExitedThreadData);
+            for (int i = 0; i < NUM_STAGES; ++i)
+            {
+                gExitedThreadData.histograms[i].add(data->histograms[i]);
+            }
+            for (int i = 0; i < NUM_COUNTERS; ++i)
+            {
+                auto& counter = gExitedThreadData.counters[i];
+                counter.store(counter.load(std::memory_order_relaxed) + data->counters[i].load(std::memory_order_relaxed),
+                              std::memory_order_relaxed);
+            }
+        }
+        gThreadData.erase(std::find_if(gThreadData.begin(), gThreadData.end(),
+                                       [this](const std::unique_ptr<ThreadData>& threadData) { return threadData.get() == data; }));
+    }
+};
+
+
+ThreadData& getThreadData()
+{
+    thread_local ThreadDataOwner owner;
+    if (owner.data == nullptr)
+    {
+        auto data = std::make_unique<ThreadData>();
+        data->generation.store(gGeneration.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        owner.data = data.get();
+
+        std::lock_guard<std::mutex> lock(gThreadDataMutex);
+        gThreadData.push_back(std::move(data));
+    }
+
+    clearIfStale(*owner.data);
+    return *owner.data;
+}
+
+
+/// Call function for the current data of every running thread and of the exited threads
+/// gThreadDataMutex must be held.
+template<typename Function>
+void forEachCurrent(Function function)
+{
+    for (const auto& data : gThreadData)
+    {
+        if (isCurrent(*data))
+        {
+            function(*data);
+        }
+    }
+    if (isCurrent(gExitedThreadData))
+    {
+        function(gExitedThreadData);
+    }
+}
+
+
+double toMilliseconds(uint64_t nanoseconds)
+{
+    return static_cast<double>(nanoseconds) / 1e6;
+}
+
+} // namespace
+
+
+void Instrumentation::setEnabled(bool enabled)
+{
+    gEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+
+bool Instrumentation::isEnabled()
+{
+    return gEnabled.load(std::memory_order_relaxed);
+}
+
+
+void Instrumentation::record(Stage stage, uint64_t duration)
+{
+    if (!isEnabled())
+    {
+        return;
+    }
+    getThreadData().histograms[static_cast<int>(stage)].record(duration);
+}
+
+
+void Instrumentation::increment(Counter counter, uint64_t value)
+{
+    if (!isEnabled())
+    {
+        return;
+    }
+    // Only this thread writes the counter, so a load and store is enough
+    auto& threadCounter = getThreadData().counters[static_cast<int>(counter)];
+    threadCounter.store(threadCounter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+
+Instrumentation::StageStats Instrumentation::getStageStats(Stage stage)
+{
+    StageStats stats;
+    Histogram::Counts counts {};
+    uint64_t min = UINT64_MAX;
+
+    {
+        std::lock_guard<std::mutex> lock(gThreadDataMutex);
+        forEachCurrent([&](const ThreadData& data) {
+            const Histogram& histogram = data.histograms[static_cast<int>(stage)];
+            histogram.addTo(counts);
+            stats.count += histogram.getCount();
+            stats.total += histogram.getSum();
+            min = std::min(min, histogram.getMin());
+            stats.max = std::max(stats.max, histogram.getMax());
+        });
+    }
+
+    if (stats.count > 0)
+    {
+        stats.min = min;
+        // The percentiles are bucket upper bounds, don't report them beyond the largest value
+        stats.p50 = std::min(Histogram::getPercentile(counts, 50.0), stats.max);
+        stats.p95 = std::min(Histogram::getPercentile(counts, 95.0), stats.max);
+        stats.p99 = std::min(Histogram::getPercentile(counts, 99.0), stats.max);
+    }
+    return stats;
+}
+
+
+uint64_t Instrumentation::getCounter(Counter counter)
+{
+    uint64_t value = 0;
+    std::lock_guard<std::mutex> lock(gThreadDataMutex);
+    forEachCurrent([&](const ThreadData& data) {
+        value += data.counters[static_cast<int>(counter)].load(std::memory_order_relaxed);
+    });
+    return value;
+}
+
+
+void Instrumentation::reset()
+{
+    gGeneration.fetch_add(1, std::memory_order_relaxed);
+}
+
+
+const char* Instrumentation::getStageName(Stage stage)
+{
+    int index = static_cast<int>(stage);
+    return index >= 0 && index < NUM_STAGES ? STAGE_NAMES[index] : "unknown";
+}
+
+
+const char* Instrumentation::getCounterName(Counter counter)
+{
+    int index = static_cast<int>(counter);
+    return index >= 0 && index < NUM_COUNTERS ? COUNTER_NAMES[index] : "unknown";
+}
+
+
+void Instrumentation::logStats()
+{
+    LOG("%-24s %8s %9s %9s %9s %9s %9s", "stage (ms)", "count", "mean", "p50", "p95", "p99", "max");
+    for (int i = 0; i < NUM_STAGES; ++i)
+    {
+        StageStats stats = getStageStats(static_cast<Stage>(i));
+        if (stats.count == 0)
+        {
+            continue;
+        }
+        LOG("%-24s %8llu %9.3f %9.3f %9.3f %9.3f %9.3f", STAGE_NAMES[i],
+            static_cast<unsigned long long>(stats.count), toMilliseconds(stats.total) / stats.count,
+            toMilliseconds(stats.p50), toMilliseconds(stats.p95), toMilliseconds(stats.p99),
+            toMilliseconds(stats.max));
+    }
+    for (int i = 0; i < NUM_COUNTERS; ++i)
+    {
+        LOG("%-24s %8llu", COUNTER_NAMES[i], static_cast<unsigned long long>(getCounter(static_cast<Counter>(i))));
+    }
+}
+
+
+void Instrumentation::setLogInterval(std::chrono::seconds interval)
+{
+    gLogInterval.store(interval.count(), std::memory_order_relaxed);
+}
+
+
+void Instrumentation::logStatsIfDue()
+{
+    int64_t interval = gLogInterval.load(std::memory_order_relaxed);
+    if (!isEnabled() || interval <= 0)
+    {
+        return;
+    }
+
+    uint64_t time = now();
+    if (gLastLogTime == 0)
+    {
+        gLastLogTime = time;
+        return;
+    }
+    if (time - gLastLogTime < static_cast<uint64_t>(interval) * 1000000000ull)
+    {
+        return;
+    }
+
+    gLastLogTime = time;
+    logStats();
+    reset();
+}
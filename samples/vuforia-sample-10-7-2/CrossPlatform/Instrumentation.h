@@ -0,0 +1,156 @@
+/*===============================================================================
+Copyright (c) 2022 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#ifndef __INSTRUMENTATION_H__
+#define __INSTRUMENTATION_H__
+
+#include "Trace.h"
+
+#include <chrono>
+#include <cstdint>
+
+
+/// Timing and counters for the stages of the frame pipeline
+/**
+ * Each thread records into its own block of Histograms and counters, created on the first
+ * record from the thread, so recording takes no locks and doesn't contend with other threads.
+ * The statistics of a stage or counter are merged from all the blocks when they are read.
+ * When a thread exits its block is merged into a single block for the exited threads and freed.
+ *
+ * Recording is enabled by default and can be switched off with setEnabled, the cost of a
+ * ScopedTimer is then a single relaxed load. While Trace is enabled each ScopedTimer is also
+ * recorded as a trace event named after its stage.
+ */
+class Instrumentation
+{
+public:
+    /// Timed stages of the frame pipeline
+    enum class Stage
+    {
+        FRAME,                      ///< Whole frame on the render thread
+        ACQUIRE_STATE,              ///< Acquiring the latest Vuforia state
+        OBSERVATIONS,               ///< Collecting the observations of a state
+        VIDEO_BACKGROUND_UPDATE,    ///< Updating the video background texture
+        DRAW_VIDEO_BACKGROUND,
+        DRAW_WORLD_ORIGIN,
+        DRAW_IMAGE_TARGETS,
+        DRAW_MODEL_TARGETS,
+        DRAW_GUIDE_VIEW,
+        DRAW_MODEL,                 ///< Each draw of a loaded model, within the target stages
+        FINISH_RENDER,
+        UPLOAD_MODELS,              ///< Uploading loaded models to the GPU, at the start of a frame
+        LOAD_MODEL,                 ///< Reading and parsing a model on the loading thread
+        GPU_VIDEO_BACKGROUND,       ///< GPU time of the renderer passes, where timer queries are supported
+        GPU_AUGMENTATIONS,
+        GPU_GUIDE_VIEW,
+        NUM_STAGES
+    };
+
+    /// Event counters
+    enum class Counter
+    {
+        FRAMES_RENDERED,            ///< Frames for which a camera frame was rendered
+        FRAMES_SKIPPED,             ///< Frames without a camera frame or render state
+        STATES_COLLECTED,           ///< States collected by the state handler
+        DRAW_CALLS,
+        INSTANCES_DRAWN,
+        TRACKING_RESETS,            ///< World tracking resets after relocalizing for too long
+        NUM_COUNTERS
+    };
+
+    /// Statistics of a stage in nanoseconds
+    /// The percentiles are accurate to the histogram bucket size, see Histogram.
+    struct StageStats
+    {
+        uint64_t count { 0 };
+        uint64_t total { 0 };
+        uint64_t min { 0 };
+        uint64_t max { 0 };
+        uint64_t p50 { 0 };
+        uint64_t p95 { 0 };
+        uint64_t p99 { 0 };
+    };
+
+    /// Records the time from its construction to its destruction for a stage
+    class ScopedTimer
+    {
+    public:
+        explicit ScopedTimer(Stage stage)
+            : mStage(stage), mStartTime(isEnabled() ? now() : 0), mTraced(Trace::isEnabled())
+        {
+            if (mTraced)
+            {
+                Trace::begin(getStageName(stage), "frame");
+            }
+        }
+        ~ScopedTimer() { stop(); }
+
+        /// Record the time now instead of at destruction
+        void stop()
+        {
+            if (mStartTime != 0)
+            {
+                record(mStage, now() - mStartTime);
+                mStartTime = 0;
+            }
+            if (mTraced)
+            {
+                Trace::end();
+                mTraced = false;
+            }
+        }
+
+        ScopedTimer(const ScopedTimer&) = delete;
+        ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    private:
+        Stage mStage;
+        uint64_t mStartTime;
+        bool mTraced;
+    };
+
+    /// Monotonic time in nanoseconds
+    static uint64_t now()
+    {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    static void setEnabled(bool enabled);
+    static bool isEnabled();
+
+    /// Record a duration in nanoseconds for stage
+    static void record(Stage stage, uint64_t duration);
+
+    /// Add value to counter
+    static void increment(Counter counter, uint64_t value = 1);
+
+    /// Statistics of a stage over all the threads since the last reset
+    static StageStats getStageStats(Stage stage);
+
+    /// Value of a counter over all the threads since the last reset
+    static uint64_t getCounter(Counter counter);
+
+    /// Clear all the statistics
+    /// Each thread clears its own block the next time it records.
+    static void reset();
+
+    static const char* getStageName(Stage stage);
+    static const char* getCounterName(Counter counter);
+
+    /// Log the statistics of all the stages and counters
+    static void logStats();
+
+    /// Set the interval at which logStatsIfDue logs the statistics, 0 disables logging
+    static void setLogInterval(std::chrono::seconds interval);
+
+    /// Log the statistics and reset them if the log interval passed since they were last logged
+    /// Intended to be called once per frame from the render thread.
+    static void logStatsIfDue();
+};
+
+#endif // __INSTRUMENTATION_H__
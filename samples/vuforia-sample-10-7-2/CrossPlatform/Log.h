@@ -25,6 +25,9 @@ void LOG(const char* message, ...);
 
 #elif defined(__APPLE__) // iOS
 #   define LOG(...) do { printf(__VA_ARGS__); printf("\n"); } while (0)
+
+#else // Desktop tools
+#   define LOG(...) do { fprintf(stderr, __VA_ARGS__); fprintf(stderr, "\n"); } while (0)
 #endif
 
 #endif // __LOG_H__
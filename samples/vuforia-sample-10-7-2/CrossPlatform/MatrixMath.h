@@ -0,0 +1,174 @@
+/*===============================================================================
+Copyright (c) 2022 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#ifndef __MATRIXMATH_H__
+#define __MATRIXMATH_H__
+
+#include <VuforiaEngine/VuforiaEngine.h>
+
+// ARMv7 NEON flushes denormals to zero, unlike the VFP instructions of scalar code, so NEON is
+// only used on AArch64
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#define MATRIXMATH_NEON 1
+#include <arm_neon.h>
+#elif defined(__SSE__) || defined(_M_X64)
+#define MATRIXMATH_SSE 1
+#include <xmmintrin.h>
+#endif
+
+
+/// Inline versions of the Vuforia MathUtils matrix functions used for every tracked target
+/**
+ * The MathUtils functions take and return VuMatrix44F, 64 bytes, by value and can't be
+ * inlined, which adds up with several products per target each frame. These functions take
+ * their arguments by reference, are inlined and use NEON (AArch64 only) or SSE where available.
+ *
+ * Each element of a product is computed as ((a0 * b0 + a1 * b1) + a2 * b2) + a3 * b3 with
+ * separate multiplies and adds, never fused multiply-adds, to match the MathUtils functions bit
+ * for bit. Tools/MathUtilsBenchmark checks the results and measures both. Built against the
+ * stub engine it only checks them against the stub's reference code and by value, so -0 and
+ * +0 compare equal. Only a build with VUFORIA_ENGINE_LIBRARY set to the Vuforia Engine library,
+ * run on the device, checks them bit for bit against MathUtils.
+ *
+ * The output of each function may be one of its inputs. The Scalar namespace holds the plain
+ * C++ versions, used where no SIMD instruction set is available.
+ */
+namespace MatrixMath
+{
+
+namespace Scalar
+{
+
+/// result = a * b, as vuMatrix44FMultiplyMatrix
+inline void multiply(const VuMatrix44F& a, const VuMatrix44F& b, VuMatrix44F& result)
+{
+#if defined(__clang__)
+    // Clang would otherwise fuse the multiplies and adds where FMA is available, e.g. on AArch64
+#pragma clang fp contract(off)
+#endif
+    VuMatrix44F product;
+    for (int column = 0; column < 4; ++column)
+    {
+        const float* bColumn = &b.data[column * 4];
+        for (int row = 0; row < 4; ++row)
+        {
+            float sum = a.data[row] * bColumn[0];
+            sum += a.data[4 + row] * bColumn[1];
+            sum += a.data[8 + row] * bColumn[2];
+            sum += a.data[12 + row] * bColumn[3];
+            product.data[column * 4 + row] = sum;
+        }
+    }
+    result = product;
+}
+
+
+/// result = m * S(scale), as vuMatrix44FScale
+inline void scale(const VuVector3F& scale, const VuMatrix44F& m, VuMatrix44F& result)
+{
+    for (int column = 0; column < 3; ++column)
+    {
+        float s = scale.data[column];
+        for (int row = 0; row < 4; ++row)
+        {
+            result.data[column * 4 + row] = m.data[column * 4 + row] * s;
+        }
+    }
+    for (int row = 0; row < 4; ++row)
+    {
+        result.data[12 + row] = m.data[12 + row];
+    }
+}
+
+} // namespace Scalar
+
+
+/// result = a * b, as vuMatrix44FMultiplyMatrix
+inline void multiply(const VuMatrix44F& a, const VuMatrix44F& b, VuMatrix44F& result)
+{
+#if defined(MATRIXMATH_NEON)
+    // vmulq/vaddq rather than vmlaq/vfmaq, which would round differently
+    float32x4_t a0 = vld1q_f32(&a.data[0]);
+    float32x4_t a1 = vld1q_f32(&a.data[4]);
+    float32x4_t a2 = vld1q_f32(&a.data[8]);
+    float32x4_t a3 = vld1q_f32(&a.data[12]);
+    for (int column = 0; column < 4; ++column)
+    {
+        // Column c of b is read before column c of the result is written, so b may be result
+        const float* bColumn = &b.data[column * 4];
+        float32x4_t sum = vmulq_n_f32(a0, bColumn[0]);
+        sum = vaddq_f32(sum, vmulq_n_f32(a1, bColumn[1]));
+        sum = vaddq_f32(sum, vmulq_n_f32(a2, bColumn[2]));
+        sum = vaddq_f32(sum, vmulq_n_f32(a3, bColumn[3]));
+        vst1q_f32(&result.data[column * 4], sum);
+    }
+#elif defined(MATRIXMATH_SSE)
+    __m128 a0 = _mm_loadu_ps(&a.data[0]);
+    __m128 a1 = _mm_loadu_ps(&a.data[4]);
+    __m128 a2 = _mm_loadu_ps(&a.data[8]);
+    __m128 a3 = _mm_loadu_ps(&a.data[12]);
+    for (int column = 0; column < 4; ++column)
+    {
+        // Column c of b is read before column c of the result is written, so b may be result
+        __m128 bColumn = _mm_loadu_ps(&b.data[column * 4]);
+        __m128 sum = _mm_mul_ps(a0, _mm_shuffle_ps(bColumn, bColumn, _MM_SHUFFLE(0, 0, 0, 0)));
+        sum = _mm_add_ps(sum, _mm_mul_ps(a1, _mm_shuffle_ps(bColumn, bColumn, _MM_SHUFFLE(1, 1, 1, 1))));
+        sum = _mm_add_ps(sum, _mm_mul_ps(a2, _mm_shuffle_ps(bColumn, bColumn, _MM_SHUFFLE(2, 2, 2, 2))));
+        sum = _mm_add_ps(sum, _mm_mul_ps(a3, _mm_shuffle_ps(bColumn, bColumn, _MM_SHUFFLE(3, 3, 3, 3))));
+        _mm_storeu_ps(&result.data[column * 4], sum);
+    }
+#else
+    Scalar::multiply(a, b, result);
+#endif
+}
+
+
+/// result = m * S(scale), as vuMatrix44FScale
+inline void scale(const VuVector3F& scale, const VuMatrix44F& m, VuMatrix44F& result)
+{
+#if defined(MATRIXMATH_NEON)
+    vst1q_f32(&result.data[0], vmulq_n_f32(vld1q_f32(&m.data[0]), scale.data[0]));
+    vst1q_f32(&result.data[4], vmulq_n_f32(vld1q_f32(&m.data[4]), scale.data[1]));
+    vst1q_f32(&result.data[8], vmulq_n_f32(vld1q_f32(&m.data[8]), scale.data[2]));
+    vst1q_f32(&result.data[12], vld1q_f32(&m.data[12]));
+#elif defined(MATRIXMATH_SSE)
+    _mm_storeu_ps(&result.data[0], _mm_mul_ps(_mm_loadu_ps(&m.data[0]), _mm_set1_ps(scale.data[0])));
+    _mm_storeu_ps(&result.data[4], _mm_mul_ps(_mm_loadu_ps(&m.data[4]), _mm_set1_ps(scale.data[1])));
+    _mm_storeu_ps(&result.data[8], _mm_mul_ps(_mm_loadu_ps(&m.data[8]), _mm_set1_ps(scale.data[2])));
+    _mm_storeu_ps(&result.data[12], _mm_loadu_ps(&m.data[12]));
+#else
+    Scalar::scale(scale, m, result);
+#endif
+}
+
+
+/// Scaling matrix, as vuMatrix44FScalingMatrix
+inline VuMatrix44F scalingMatrix(const VuVector3F& scale)
+{
+    return VuMatrix44F { {
+        scale.data[0], 0.0f, 0.0f, 0.0f,
+        0.0f, scale.data[1], 0.0f, 0.0f,
+        0.0f, 0.0f, scale.data[2], 0.0f,
+        0.0f, 0.0f, 0.0f, 1.0f
+    } };
+}
+
+
+/// Translation matrix, as vuMatrix44FTranslationMatrix
+inline VuMatrix44F translationMatrix(const VuVector3F& translation)
+{
+    return VuMatrix44F { {
+        1.0f, 0.0f, 0.0f, 0.0f,
+        0.0f, 1.0f, 0.0f, 0.0f,
+        0.0f, 0.0f, 1.0f, 0.0f,
+        translation.data[0], translation.data[1], translation.data[2], 1.0f
+    } };
+}
+
+} // namespace MatrixMath
+
+#endif // __MATRIXMATH_H__
@@ -0,0 +1,79 @@
+/*===============================================================================
+Copyright (c) 2022 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#ifndef __MESH_DATA_H__
+#define __MESH_DATA_H__
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+
+/// Platform-independent geometry for a textured model
+/**
+ * Vertices are interleaved, each vertex is a position (x, y, z) followed by a
+ * texture coordinate (u, v). If indices is empty the vertices are a triangle list,
+ * otherwise every 3 indices describe a triangle.
+ */
+struct MeshData
+{
+    /// Number of floats per vertex
+    static constexpr int VERTEX_STRIDE = 5;
+    /// Offset in floats of the position within a vertex
+    static constexpr int POSITION_OFFSET = 0;
+    /// Offset in floats of the texture coordinate within a vertex
+    static constexpr int TEXCOORD_OFFSET = 3;
+
+    /// Interleaved vertex data
+    std::vector<float> vertices;
+    /// Optional triangle indices into vertices
+    std::vector<uint32_t> indices;
+
+    /// Axis aligned bounding box of the vertex positions
+    float boundsMin[3] { 0.f, 0.f, 0.f };
+    float boundsMax[3] { 0.f, 0.f, 0.f };
+
+    /// Number of vertices in the vertices array
+    int numVertices() const { return static_cast<int>(vertices.size() / VERTEX_STRIDE); }
+
+    /// Number of indices, 0 if the mesh is not indexed
+    int numIndices() const { return static_cast<int>(indices.size()); }
+
+    /// Clear all geometry
+    void clear()
+    {
+        vertices.clear();
+        indices.clear();
+        std::fill(boundsMin, boundsMin + 3, 0.f);
+        std::fill(boundsMax, boundsMax + 3, 0.f);
+    }
+
+    /// Update boundsMin and boundsMax from the vertex positions
+    void computeBounds()
+    {
+        if (vertices.empty())
+        {
+            std::fill(boundsMin, boundsMin + 3, 0.f);
+            std::fill(boundsMax, boundsMax + 3, 0.f);
+            return;
+        }
+        for (int c = 0; c < 3; ++c)
+        {
+            boundsMin[c] = boundsMax[c] = vertices[POSITION_OFFSET + c];
+        }
+        for (size_t v = 0; v < vertices.size(); v += VERTEX_STRIDE)
+        {
+            for (int c = 0; c < 3; ++c)
+            {
+                boundsMin[c] = std::min(boundsMin[c], vertices[v + POSITION_OFFSET + c]);
+                boundsMax[c] = std::max(boundsMax[c], vertices[v + POSITION_OFFSET + c]);
+            }
+        }
+    }
+};
+
+#endif // __MESH_DATA_H__
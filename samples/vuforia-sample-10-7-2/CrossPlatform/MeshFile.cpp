@@ -0,0 +1,184 @@
+/*===============================================================================
+Copyright (c) 2022 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#include "MeshFile.h"
+
+#include "Log.h"
+
+#include <cstring>
+#include <limits>
+
+
+namespace
+{
+    constexpr uint32_t VERTEX_ALIGNMENT = 16;
+    constexpr uint32_t INDEX_ALIGNMENT = 4;
+
+    uint32_t alignUp(uint32_t value, uint32_t alignment)
+    {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+
+    /// Check that every index addresses one of vertexCount vertices
+    template<typename Index>
+    bool areIndicesValid(const void* data, uint32_t indexCount, uint32_t vertexCount)
+    {
+        auto indices = static_cast<const Index*>(data);
+        for (uint32_t i = 0; i < indexCount; ++i)
+        {
+            if (indices[i] >= vertexCount)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+
+bool MeshFile::read(const void* data, size_t size, MeshFileView& view)
+{
+    view = MeshFileView();
+
+    if (data == nullptr || size < sizeof(MeshFileHeader))
+    {
+        LOG("Baked mesh is too small");
+        return false;
+    }
+    if (reinterpret_cast<uintptr_t>(data) % INDEX_ALIGNMENT != 0)
+    {
+        LOG("Baked mesh buffer is not aligned");
+        return false;
+    }
+
+    auto header = static_cast<const MeshFileHeader*>(data);
+    if (memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0)
+    {
+        LOG("Baked mesh has an invalid file identifier");
+        return false;
+    }
+    if (header->version != VERSION)
+    {
+        LOG("Baked mesh version %u is not supported", header->version);
+        return false;
+    }
+    if (header->vertexStride != MeshData::VERTEX_STRIDE * sizeof(float))
+    {
+        LOG("Baked mesh has an unsupported vertex layout");
+        return false;
+    }
+    if (header->indexCount > 0 && header->indexSize != sizeof(uint16_t) && header->indexSize != sizeof(uint32_t))
+    {
+        LOG("Baked mesh has an unsupported index size");
+        return false;
+    }
+
+    // Check the data sections are aligned and lie within the buffer
+    uint64_t vertexEnd = uint64_t(header->vertexOffset) + uint64_t(header->vertexCount) * header->vertexStride;
+    uint64_t indexEnd = uint64_t(header->indexOffset) + uint64_t(header->indexCount) * header->indexSize;
+    if (header->vertexOffset % VERTEX_ALIGNMENT != 0 || header->indexOffset % INDEX_ALIGNMENT != 0 ||
+        header->vertexOffset < sizeof(MeshFileHeader) || vertexEnd > size ||
+        (header->indexCount > 0 && (header->indexOffset < vertexEnd || indexEnd > size)))
+    {
+        LOG("Baked mesh is truncated or corrupt");
+        return false;
+    }
+
+    // Out of range indices would make the draw calls read beyond the vertex buffer
+    auto bytes = static_cast<const char*>(data);
+    if (header->indexCount > 0)
+    {
+        bool valid = header->indexCount % 3 == 0 &&
+                     (header->indexSize == sizeof(uint16_t) ?
+                      areIndicesValid<uint16_t>(bytes + header->indexOffset, header->indexCount, header->vertexCount) :
+                      areIndicesValid<uint32_t>(bytes + header->indexOffset, header->indexCount, header->vertexCount));
+        if (!valid)
+        {
+            LOG("Baked mesh has invalid indices");
+            return false;
+        }
+    }
+
+    view.header = header;
+    view.vertices = reinterpret_cast<const float*>(bytes + header->vertexOffset);
+    view.indices = header->indexCount > 0 ? bytes + header->indexOffset : nullptr;
+    return true;
+}
+
+
+void MeshFile::copy(const MeshFileView& view, MeshData& mesh)
+{
+    mesh.clear();
+    if (view.header == nullptr)
+    {
+        return;
+    }
+
+    mesh.vertices.assign(view.vertices, view.vertices + view.header->vertexCount * MeshData::VERTEX_STRIDE);
+
+    if (view.header->indexSize == sizeof(uint16_t))
+    {
+        auto indices = static_cast<const uint16_t*>(view.indices);
+        mesh.indices.assign(indices, indices + view.header->indexCount);
+    }
+    else if (view.header->indexSize == sizeof(uint32_t))
+    {
+        auto indices = static_cast<const uint32_t*>(view.indices);
+        mesh.indices.assign(indices, indices + view.header->indexCount);
+    }
+
+    std::copy(view.header->boundsMin, view.header->boundsMin + 3, mesh.boundsMin);
+    std::copy(view.header->boundsMax, view.header->boundsMax + 3, mesh.boundsMax);
+}
+
+
+bool MeshFile::write(const MeshData& mesh, std::vector<char>& data)
+{
+    uint64_t vertexBytes = mesh.vertices.size() * sizeof(float);
+    if (vertexBytes > std::numeric_limits<uint32_t>::max() / 2 ||
+        mesh.indices.size() > std::numeric_limits<uint32_t>::max() / sizeof(uint32_t))
+    {
+        LOG("Mesh is too large to bake");
+        return false;
+    }
+
+    MeshFileHeader header {};
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.vertexCount = mesh.numVertices();
+    header.vertexStride = MeshData::VERTEX_STRIDE * sizeof(float);
+    header.indexCount = mesh.numIndices();
+    header.indexSize = 0;
+    if (header.indexCount > 0)
+    {
+        header.indexSize = mesh.numVertices() <= std::numeric_limits<uint16_t>::max() + 1 ?
+                           sizeof(uint16_t) : sizeof(uint32_t);
+    }
+    header.vertexOffset = alignUp(sizeof(MeshFileHeader), VERTEX_ALIGNMENT);
+    header.indexOffset = alignUp(header.vertexOffset + static_cast<uint32_t>(vertexBytes), INDEX_ALIGNMENT);
+    std::copy(mesh.boundsMin, mesh.boundsMin + 3, header.boundsMin);
+    std::copy(mesh.boundsMax, mesh.boundsMax + 3, header.boundsMax);
+
+    data.assign(header.indexOffset + header.indexCount * header.indexSize, 0);
+    memcpy(data.data(), &header, sizeof(header));
+    memcpy(data.data() + header.vertexOffset, mesh.vertices.data(), vertexBytes);
+
+    if (header.indexSize == sizeof(uint16_t))
+    {
+        auto indices = reinterpret_cast<uint16_t*>(data.data() + header.indexOffset);
+        for (size_t i = 0; i < mesh.indices.size(); ++i)
+        {
+            indices[i] = static_cast<uint16_t>(mesh.indices[i]);
+        }
+    }
+    else if (header.indexSize == sizeof(uint32_t))
+    {
+        memcpy(data.data() + header.indexOffset, mesh.indices.data(), mesh.indices.size() * sizeof(uint32_t));
+    }
+
+    return true;
+}
@@ -0,0 +1,98 @@
+/*===============================================================================
+Copyright (c) 2022 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#ifndef __MESH_FILE_H__
+#define __MESH_FILE_H__
+
+#include "MeshData.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+/// Header at the start of a baked mesh file
+/**
+ * A baked mesh file is laid out so that it can be used in place from a memory mapping:
+ *   MeshFileHeader
+ *   vertex data at vertexOffset (16 byte aligned), vertexCount * vertexStride bytes
+ *   index data at indexOffset (4 byte aligned), indexCount * indexSize bytes
+ * All values are little-endian.
+ */
+struct MeshFileHeader
+{
+    /// Identifies the file type, always MeshFile::MAGIC
+    char magic[4];
+    /// Format version, readers reject versions they don't know
+    uint32_t version;
+    /// Number of vertices
+    uint32_t vertexCount;
+    /// Size of a vertex in bytes
+    uint32_t vertexStride;
+    /// Number of indices, 0 if the mesh is a triangle list
+    uint32_t indexCount;
+    /// Size of an index in bytes, 2 or 4, 0 if the mesh is not indexed
+    uint32_t indexSize;
+    /// Byte offset of the vertex data from the start of the file
+    uint32_t vertexOffset;
+    /// Byte offset of the index data from the start of the file
+    uint32_t indexOffset;
+    /// Axis aligned bounding box of the vertex positions
+    float boundsMin[3];
+    float boundsMax[3];
+};
+
+
+/// Non-owning view of a baked mesh file held in memory
+/**
+ * The pointers refer into the buffer passed to MeshFile::read and are only valid as long
+ * as that buffer is.
+ */
+struct MeshFileView
+{
+    const MeshFileHeader* header { nullptr };
+    /// Interleaved vertices in the MeshData layout
+    const float* vertices { nullptr };
+    /// Indices, either uint16_t or uint32_t depending on header->indexSize
+    const void* indices { nullptr };
+};
+
+
+/// Reader and writer for the binary baked mesh format
+/**
+ * Baked meshes are produced offline from OBJ files with the MeshBaker tool,
+ * so that the app can skip text parsing when loading models.
+ */
+class MeshFile
+{
+public:
+    /// File type identifier
+    static constexpr char MAGIC[4] = { 'V', 'M', 'S', 'H' };
+    /// Current format version
+    static constexpr uint32_t VERSION = 1;
+    /// File name extension used for baked meshes
+    static constexpr const char* EXTENSION = ".mesh";
+
+    /// Validate a baked mesh held in memory and set up a view of it
+    /**
+     * The buffer must be at least 4 byte aligned.
+     * Returns false if the buffer doesn't contain a valid baked mesh, including when the
+     * indices don't form whole triangles or address vertices beyond vertexCount.
+     */
+    static bool read(const void* data, size_t size, MeshFileView& view);
+
+    /// Copy the contents of a view into a MeshData
+    static void copy(const MeshFileView& view, MeshData& mesh);
+
+    /// Serialize a mesh into the baked format
+    /**
+     * 16-bit indices are written if all vertices can be addressed with them.
+     */
+    static bool write(const MeshData& mesh, std::vector<char>& data);
+};
+
+#endif // __MESH_FILE_H__
@@ -0,0 +1,162 @@
+/*===============================================================================
+Copyright (c) 2022 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#include "MeshLoader.h"
+
+#include "Instrumentation.h"
+#include "Log.h"
+#include "MeshFile.h"
+#include "ObjLoader.h"
+#include "Trace.h"
+
+#include <limits>
+#include <utility>
+
+
+void MeshLoader::start(std::unique_ptr<AssetReader> assetReader)
+{
+    stop();
+
+    mAssetReader = std::move(assetReader);
+    mStopRequested = false;
+    mThread = std::thread(&MeshLoader::run, this);
+}
+
+
+void MeshLoader::stop()
+{
+    if (mThread.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mStopRequested = true;
+        }
+        mCondition.notify_all();
+        mThread.join();
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    mRequests.clear();
+    mLoaded.clear();
+    mAssetReader.reset();
+}
+
+
+void MeshLoader::request(const std::string& name)
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mRequests.push_back(name);
+    }
+    mCondition.notify_all();
+}
+
+
+std::unique_ptr<LoadedMesh> MeshLoader::takeLoaded()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (mLoaded.empty())
+    {
+        return nullptr;
+    }
+    std::unique_ptr<LoadedMesh> mesh = std::move(mLoaded.front());
+    mLoaded.pop_front();
+    return mesh;
+}
+
+
+void MeshLoader::run()
+{
+    Trace::setThreadName("MeshLoader");
+
+    std::unique_lock<std::mutex> lock(mMutex);
+    while (true)
+    {
+        mCondition.wait(lock, [this] { return mStopRequested || !mRequests.empty(); });
+        if (mStopRequested)
+        {
+            return;
+        }
+        std::string name = std::move(mRequests.front());
+        mRequests.pop_front();
+
+        // Load without holding the lock so that requests can be queued meanwhile
+        lock.unlock();
+        std::unique_ptr<LoadedMesh> mesh = load(*mAssetReader, name);
+        lock.lock();
+
+        mLoaded.push_back(std::move(mesh));
+    }
+}
+
+
+std::unique_ptr<LoadedMesh> MeshLoader::load(const AssetReader& assetReader, const std::string& name)
+{
+    Instrumentation::ScopedTimer timer(Instrumentation::Stage::LOAD_MODEL);
+
+    auto mesh = std::make_unique<LoadedMesh>();
+    mesh->name = name;
+
+    // Prefer the baked mesh as it can be used without parsing
+    std::string filename = name + MeshFile::EXTENSION;
+    if (assetReader.exists(filename.c_str()))
+    {
+        MeshFileView view;
+        if (assetReader.read(filename.c_str(), mesh->mFile) &&
+            MeshFile::read(mesh->mFile.data(), mesh->mFile.size(), view))
+        {
+            mesh->vertices = view.vertices;
+            mesh->numVertices = view.header->vertexCount;
+            mesh->indices = view.header->indexCount > 0 ? view.indices : nullptr;
+            mesh->indexSize = view.header->indexCount > 0 ? view.header->indexSize : 0;
+            mesh->numIndices = view.header->indexCount;
+            mesh->succeeded = true;
+            LOG("Loaded model %s with %u vertices and %u indices", name.c_str(), mesh->numVertices, mesh->numIndices);
+            return mesh;
+        }
+        LOG("Error loading baked model %s, falling back to OBJ", filename.c_str());
+        mesh->mFile.reset();
+    }
+
+    filename = name + ".obj";
+    bool loaded = assetReader.read(filename.c_str(), mesh->mFile) &&
+                  ObjLoader::load(mesh->mFile.data(), mesh->mFile.size(), mesh->mMesh);
+    // The OBJ text isn't needed once it is parsed
+    mesh->mFile.reset();
+    if (!loaded)
+    {
+        LOG("Error loading model %s", filename.c_str());
+        return mesh;
+    }
+
+    MeshData& data = mesh->mMesh;
+    mesh->vertices = data.vertices.data();
+    mesh->numVertices = static_cast<uint32_t>(data.numVertices());
+    mesh->numIndices = static_cast<uint32_t>(data.numIndices());
+    if (data.indices.empty())
+    {
+        mesh->indices = nullptr;
+        mesh->indexSize = 0;
+    }
+    else if (data.numVertices() <= std::numeric_limits<uint16_t>::max() + 1)
+    {
+        // Use 16-bit indices where possible, they halve the index memory and bandwidth
+        mesh->mShortIndices.assign(data.indices.begin(), data.indices.end());
+        data.indices = std::vector<uint32_t>();
+        mesh->indices = mesh->mShortIndices.data();
+        mesh->indexSize = sizeof(uint16_t);
+    }
+    else
+    {
+        mesh->indices = data.indices.data();
+        mesh->indexSize = sizeof(uint32_t);
+    }
+    mesh->succeeded = true;
+
+    LOG("Loaded model %s with %u vertices and %u indices", name.c_str(), mesh->numVertices, mesh->numIndices);
+    return mesh;
+}
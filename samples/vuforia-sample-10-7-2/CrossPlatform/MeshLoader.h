@@ -0,0 +1,109 @@
+/*===============================================================================
+Copyright (c) 2022 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#ifndef __MESH_LOADER_H__
+#define __MESH_LOADER_H__
+
+#include "AssetReader.h"
+#include "MeshData.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+/// A mesh loaded from the assets into memory, ready to be uploaded to the GPU
+/**
+ * The vertices and indices point either into the mapped baked mesh file or into meshes
+ * parsed from an OBJ file, both owned by the LoadedMesh.
+ */
+class LoadedMesh
+{
+public:
+    /// Name of the model, without the file name extension
+    std::string name;
+    /// False if the model couldn't be read or parsed, the other members are then empty
+    bool succeeded { false };
+
+    /// Interleaved vertices in the MeshData layout
+    const float* vertices { nullptr };
+    uint32_t numVertices { 0 };
+    /// Indices of size indexSize, 2 or 4, nullptr if the mesh is a triangle list
+    const void* indices { nullptr };
+    uint32_t indexSize { 0 };
+    uint32_t numIndices { 0 };
+
+    size_t getVertexDataSize() const { return numVertices * MeshData::VERTEX_STRIDE * sizeof(float); }
+    size_t getIndexDataSize() const { return numIndices * indexSize; }
+
+private:
+    friend class MeshLoader;
+
+    /// Contents of the baked mesh file
+    AssetData mFile;
+    /// Mesh parsed from the OBJ file
+    MeshData mMesh;
+    /// mMesh.indices converted to 16 bits where the vertices can be addressed with them
+    std::vector<uint16_t> mShortIndices;
+};
+
+
+/// Loads meshes from the assets on a background thread
+/**
+ * The baked mesh file (name + MeshFile::EXTENSION) is used if it is present, otherwise the
+ * model is parsed from the OBJ file (name + ".obj"). Loading reads, parses and deduplicates
+ * the mesh so that all the render thread has left to do is copy it into GPU buffers.
+ *
+ * Meshes are loaded in the order they are requested. The loaded meshes are collected with
+ * takeLoaded, typically once per frame from the render thread.
+ */
+class MeshLoader
+{
+public:
+    MeshLoader() = default;
+    ~MeshLoader() { stop(); }
+
+    MeshLoader(const MeshLoader&) = delete;
+    MeshLoader& operator=(const MeshLoader&) = delete;
+
+    /// Start the loading thread reading the assets from assetReader
+    void start(std::unique_ptr<AssetReader> assetReader);
+
+    /// Stop the loading thread
+    /// Waits for the mesh being loaded, if any, and drops the requested and loaded meshes.
+    void stop();
+
+    /// Queue a mesh to be loaded
+    void request(const std::string& name);
+
+    /// Remove and return the next loaded mesh, nullptr if none has finished loading
+    std::unique_ptr<LoadedMesh> takeLoaded();
+
+    /// Load a mesh on the calling thread
+    static std::unique_ptr<LoadedMesh> load(const AssetReader& assetReader, const std::string& name);
+
+private:
+    void run();
+
+    std::unique_ptr<AssetReader> mAssetReader;
+    std::thread mThread;
+
+    /// Guards mStopRequested, mRequests and mLoaded
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+    bool mStopRequested { false };
+    std::deque<std::string> mRequests;
+    std::deque<std::unique_ptr<LoadedMesh>> mLoaded;
+};
+
+#endif // __MESH_LOADER_H__
@@ -0,0 +1,112 @@
+/*===============================================================================
+Copyright (c) 2022 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#include "ObjLoader.h"
+
+#include "Log.h"
+#include "ObjParser.h"
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+
+bool ObjLoader::load(const char* data, size_t size, MeshData& mesh, bool indexed)
+{
+    tinyobj::attrib_t attrib;
+    std::vector<tinyobj::shape_t> shapes;
+
+    std::string warn;
+    std::string err;
+
+    bool ret = ObjParser::parse(data, size, attrib, shapes, warn, err);
+    if (!ret || !err.empty())
+    {
+        LOG("Error loading model (%s)", err.c_str());
+        return false;
+    }
+    if (!warn.empty())
+    {
+        LOG("Warning loading model (%s)", warn.c_str());
+    }
+
+    mesh.clear();
+
+    size_t numCorners = 0;
+    for (const auto& shape : shapes)
+    {
+        numCorners += shape.mesh.indices.size();
+    }
+
+    // Maps a (vertex_index, texcoord_index) pair to its position in mesh.vertices
+    std::unordered_map<uint64_t, uint32_t> uniqueVertices;
+    if (indexed)
+    {
+        uniqueVertices.reserve(numCorners);
+        mesh.indices.reserve(numCorners);
+    }
+    else
+    {
+        mesh.vertices.reserve(numCorners * MeshData::VERTEX_STRIDE);
+    }
+
+    // Loop over shapes
+    // s is the index into the shapes vector
+    // f is the index of the current face
+    // v is the index of the current vertex
+    for (size_t s = 0; s < shapes.size(); ++s)
+    {
+        // Loop over faces(polygon)
+        size_t index_offset = 0;
+        for (size_t f = 0; f < shapes[s].mesh.num_face_vertices.size(); ++f)
+        {
+            size_t fv = shapes[s].mesh.num_face_vertices[f];
+
+            // Loop over vertices in the face.
+            for (size_t v = 0; v < fv; ++v)
+            {
+                // access to vertex
+                tinyobj::index_t idx = shapes[s].mesh.indices[index_offset + v];
+
+                if (indexed)
+                {
+                    uint64_t key = (uint64_t(uint32_t(idx.vertex_index)) << 32) | uint32_t(idx.texcoord_index);
+                    auto inserted = uniqueVertices.emplace(key, static_cast<uint32_t>(mesh.numVertices()));
+                    mesh.indices.push_back(inserted.first->second);
+                    if (!inserted.second)
+                    {
+                        // Vertex already emitted
+                        continue;
+                    }
+                }
+
+                mesh.vertices.push_back(attrib.vertices[3 * idx.vertex_index + 0]);
+                mesh.vertices.push_back(attrib.vertices[3 * idx.vertex_index + 1]);
+                mesh.vertices.push_back(attrib.vertices[3 * idx.vertex_index + 2]);
+
+                // The model may not have texture coordinates for every vertex
+                // If a texture coordinate is missing we just set it to 0,0
+                // This may not be suitable for rendering some OBJ model files
+                if (idx.texcoord_index < 0)
+                {
+                    mesh.vertices.push_back(0.f);
+                    mesh.vertices.push_back(0.f);
+                }
+                else
+                {
+                    mesh.vertices.push_back(attrib.texcoords[2 * idx.texcoord_index + 0]);
+                    mesh.vertices.push_back(attrib.texcoords[2 * idx.texcoord_index + 1]);
+                }
+            }
+            index_offset += fv;
+        }
+    }
+
+    mesh.vertices.shrink_to_fit();
+    mesh.computeBounds();
+    return true;
+}
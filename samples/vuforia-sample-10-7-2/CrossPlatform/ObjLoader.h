@@ -0,0 +1,32 @@
+/*===============================================================================
+Copyright (c) 2022 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#ifndef __OBJ_LOADER_H__
+#define __OBJ_LOADER_H__
+
+#include "MeshData.h"
+
+#include <cstddef>
+
+
+/// Converts OBJ model files into MeshData
+class ObjLoader
+{
+public:
+    /// Load a model from OBJ file contents held in memory
+    /*
+    * All shapes in the file are merged into a single mesh. Large files are parsed on all
+    * CPU cores (see ObjParser).
+    * If indexed is true each unique (position, texture coordinate) pair is emitted as
+    * one vertex and the faces are described by mesh.indices, otherwise every face
+    * corner is emitted as its own vertex and mesh.indices is left empty.
+    * Returns false if the file could not be parsed.
+    */
+    static bool load(const char* data, size_t size, MeshData& mesh, bool indexed = true);
+};
+
+#endif // __OBJ_LOADER_H__
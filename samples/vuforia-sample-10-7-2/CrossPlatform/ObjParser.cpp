@@ -0,0 +1,1411 @@
+/*===============================================================================
+Copyright (c) 2022 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#include "ObjParser.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <thread>
+#include <utility>
+
+
+namespace
+{
+
+using tinyobj::real_t;
+
+// The parsing functions work on the contents of a single line, [p, end), which never includes
+// the line ending and stops at a NUL character like the C string tinyobj parses.
+// Where tinyobj skips or stops at '\r' this isn't needed, a line can't contain one.
+
+constexpr int MAX_TAG_VALUES = 8192;
+
+/// Chunks per thread, so that threads that finish early take over work from the others
+constexpr size_t CHUNKS_PER_THREAD = 4;
+
+/// Flags for the indices of a face corner that are relative to the elements before the face
+constexpr uint8_t RELATIVE_V = 1;
+constexpr uint8_t RELATIVE_VT = 2;
+constexpr uint8_t RELATIVE_VN = 4;
+
+
+/// Face corner, indices that are not given are -1
+struct VertexIndex
+{
+    int v { -1 };
+    int vt { -1 };
+    int vn { -1 };
+};
+
+
+/// Face as parsed, before triangulation
+struct Face
+{
+    /// Position of the first corner in Chunk::corners
+    size_t firstCorner;
+    size_t numCorners;
+    unsigned int smoothingGroupId;
+};
+
+
+/// Face corner with relative indices
+struct RelativeCorner
+{
+    /// Position in Chunk::corners
+    size_t corner;
+    /// RELATIVE_V, RELATIVE_VT and RELATIVE_VN flags
+    uint8_t flags;
+};
+
+
+/// Line that changes the shapes, applied in file order when the chunks are merged: g, o, t or l
+struct Statement
+{
+    /// Line contents
+    const char* begin;
+    const char* end;
+    /// Line number in the chunk, starting at 1
+    size_t line;
+    /// Number of faces, vertices and triangles in the chunk before the line
+    size_t numFaces;
+    size_t numVertices;
+    size_t numTriangles;
+
+    /// Whether the line adds the faces before it to a shape
+    bool exportsFaces() const { return *begin == 'g' || *begin == 'o'; }
+};
+
+
+/// Capacities to reserve for the parser output
+struct Counts
+{
+    size_t vertices { 0 };
+    size_t normals { 0 };
+    size_t texcoords { 0 };
+    size_t faces { 0 };
+    size_t corners { 0 };
+};
+
+
+/// Part of the file that is parsed by one thread, starting and ending at a line boundary
+/**
+ * Vertices, normals and texture coordinates are numbered from the start of the chunk
+ * until the numbers in the previous chunks are known, so faces with relative indices are
+ * fixed up before they are triangulated.
+ */
+struct Chunk
+{
+    const char* begin { nullptr };
+    const char* end { nullptr };
+
+    // Contents of the chunk
+    std::vector<real_t> v;
+    std::vector<real_t> vn;
+    std::vector<real_t> vt;
+    std::vector<real_t> vc;
+    std::vector<Face> faces;
+    std::vector<VertexIndex> corners;
+    std::vector<RelativeCorner> relativeCorners;
+    std::vector<Statement> statements;
+    size_t numLines { 0 };
+    /// Line number in the chunk of a face that can't be parsed, 0 if there is none
+    size_t errorLine { 0 };
+    /// Number of faces before the first s line, which are in the smoothing group of the previous chunks
+    size_t numInheritedSmoothingFaces { 0 };
+    /// Smoothing group at the end of the chunk if it is set in the chunk
+    bool setsSmoothingGroup { false };
+    unsigned int smoothingGroupId { 0 };
+
+    // Position of the chunk in the file
+    size_t firstLine { 0 };
+    size_t firstV { 0 };
+    size_t firstVn { 0 };
+    size_t firstVt { 0 };
+    unsigned int initialSmoothingGroupId { 0 };
+    /// Number of vertices when the faces after the last g or o line of the chunk are exported
+    size_t exportNumVertices { 0 };
+
+    // Triangulated faces, 3 indices and a smoothing group per triangle
+    size_t numFaces { 0 };
+    std::vector<tinyobj::index_t> triangles;
+    std::vector<unsigned int> smoothingGroupIds;
+    int greatestV { -1 };
+    int greatestVn { -1 };
+    int greatestVt { -1 };
+};
+
+
+inline bool isSpace(char c)
+{
+    return c == ' ' || c == '\t';
+}
+
+
+inline bool isDigit(char c)
+{
+    return static_cast<unsigned int>(c - '0') < 10u;
+}
+
+
+inline const char* skipSpace(const char* p, const char* end)
+{
+    while (p < end && isSpace(*p))
+    {
+        ++p;
+    }
+    return p;
+}
+
+
+/// End of the token starting at p
+inline const char* tokenEnd(const char* p, const char* end)
+{
+    while (p < end && !isSpace(*p))
+    {
+        ++p;
+    }
+    return p;
+}
+
+
+/// End of the index starting at p, which may be followed by a '/'
+inline const char* indexEnd(const char* p, const char* end)
+{
+    while (p < end && *p != '/' && !isSpace(*p))
+    {
+        ++p;
+    }
+    return p;
+}
+
+
+/// atoi of the number at p
+int toInt(const char* p, const char* end)
+{
+    while (p < end && (isSpace(*p) || *p == '\v' || *p == '\f'))
+    {
+        ++p;
+    }
+    bool negative = false;
+    if (p < end && (*p == '+' || *p == '-'))
+    {
+        negative = *p == '-';
+        ++p;
+    }
+    unsigned int value = 0;
+    while (p < end && isDigit(*p))
+    {
+        value = value * 10u + static_cast<unsigned int>(*p - '0');
+        ++p;
+    }
+    return static_cast<int>(negative ? 0u - value : value);
+}
+
+
+/// Parse the number in [s, end) the way tinyobj's tryParseDouble does
+/**
+ * The digits are accumulated in a double, so the result can differ from a correctly rounded
+ * conversion such as std::from_chars in the last bit. The same arithmetic is used here so that
+ * the parsed model is identical.
+ */
+bool parseDouble(const char* s, const char* end, double* result)
+{
+    if (s >= end)
+    {
+        return false;
+    }
+
+    double mantissa = 0.0;
+    int exponent = 0;
+    char sign = '+';
+    char expSign = '+';
+    const char* curr = s;
+
+    if (*curr == '+' || *curr == '-')
+    {
+        sign = *curr;
+        curr++;
+    }
+    else if (!isDigit(*curr))
+    {
+        return false;
+    }
+
+    // Integer part
+    int read = 0;
+    while (curr != end && isDigit(*curr))
+    {
+        mantissa *= 10;
+        mantissa += static_cast<int>(*curr - 0x30);
+        curr++;
+        read++;
+    }
+    if (read == 0)
+    {
+        return false;
+    }
+
+    if (curr != end)
+    {
+        bool hasExponent = false;
+        if (*curr == '.')
+        {
+            // Decimal part
+            curr++;
+            read = 1;
+            while (curr != end && isDigit(*curr))
+            {
+                static const double pow_lut[] = {
+                    1.0, 0.1, 0.01, 0.001, 0.0001, 0.00001, 0.000001, 0.0000001,
+                };
+                const int lut_entries = sizeof pow_lut / sizeof pow_lut[0];
+
+                mantissa += static_cast<int>(*curr - 0x30) *
+                            (read < lut_entries ? pow_lut[read] : std::pow(10.0, -read));
+                read++;
+                curr++;
+            }
+            hasExponent = curr != end && (*curr == 'e' || *curr == 'E');
+        }
+        else
+        {
+            hasExponent = *curr == 'e' || *curr == 'E';
+        }
+
+        if (hasExponent)
+        {
+            curr++;
+            if (curr != end && (*curr == '+' || *curr == '-'))
+            {
+                expSign = *curr;
+                curr++;
+            }
+            else if (curr == end || !isDigit(*curr))
+            {
+                // Empty exponent
+                return false;
+            }
+
+            read = 0;
+            while (curr != end && isDigit(*curr))
+            {
+                exponent *= 10;
+                exponent += static_cast<int>(*curr - 0x30);
+                curr++;
+                read++;
+            }
+            exponent *= (expSign == '+' ? 1 : -1);
+            if (read == 0)
+            {
+                return false;
+            }
+        }
+    }
+
+    *result = (sign == '+' ? 1 : -1) *
+              (exponent ? std::ldexp(mantissa * std::pow(5.0, exponent), exponent) : mantissa);
+    return true;
+}
+
+
+/// Parse the next token as a number, defaultValue is returned if it isn't one
+real_t parseReal(const char*& p, const char* end, double defaultValue = 0.0)
+{
+    p = skipSpace(p, end);
+    const char* e = tokenEnd(p, end);
+    double value = defaultValue;
+    parseDouble(p, e, &value);
+    p = e;
+    return static_cast<real_t>(value);
+}
+
+
+/// Parse the next token as a number, returns false and leaves out unchanged if it isn't one
+bool parseReal(const char*& p, const char* end, real_t* out)
+{
+    p = skipSpace(p, end);
+    const char* e = tokenEnd(p, end);
+    double value;
+    bool ret = parseDouble(p, e, &value);
+    if (ret)
+    {
+        *out = static_cast<real_t>(value);
+    }
+    p = e;
+    return ret;
+}
+
+
+int parseInt(const char*& p, const char* end)
+{
+    p = skipSpace(p, end);
+    int value = toInt(p, end);
+    p = tokenEnd(p, end);
+    return value;
+}
+
+
+std::string parseString(const char*& p, const char* end)
+{
+    p = skipSpace(p, end);
+    const char* e = tokenEnd(p, end);
+    std::string s(p, e);
+    p = e;
+    return s;
+}
+
+
+/// Make an OBJ index zero based, negative indices are relative to the n elements defined so far
+inline bool fixIndex(int index, int n, int* result)
+{
+    if (index > 0)
+    {
+        *result = index - 1;
+        return true;
+    }
+    if (index == 0)
+    {
+        // Not allowed by the specification
+        return false;
+    }
+    *result = n + index;
+    return true;
+}
+
+
+/// Parse a face corner: i, i/j, i//k or i/j/k
+/**
+ * Negative indices are made relative to vSize, vnSize and vtSize and flagged in relativeFlags.
+ */
+bool parseTriple(const char*& p, const char* end, int vSize, int vnSize, int vtSize, VertexIndex& result,
+                 uint8_t& relativeFlags)
+{
+    VertexIndex vi;
+    relativeFlags = 0;
+    auto fix = [&p, end, &relativeFlags](int n, uint8_t flag, int* index) {
+        int value = toInt(p, end);
+        if (value < 0)
+        {
+            relativeFlags |= flag;
+        }
+        return fixIndex(value, n, index);
+    };
+
+    if (!fix(vSize, RELATIVE_V, &vi.v))
+    {
+        return false;
+    }
+    p = indexEnd(p, end);
+    if (p == end || *p != '/')
+    {
+        result = vi;
+        return true;
+    }
+    p++;
+
+    // i//k
+    if (p != end && *p == '/')
+    {
+        p++;
+        if (!fix(vnSize, RELATIVE_VN, &vi.vn))
+        {
+            return false;
+        }
+        p = indexEnd(p, end);
+        result = vi;
+        return true;
+    }
+
+    // i/j/k or i/j
+    if (!fix(vtSize, RELATIVE_VT, &vi.vt))
+    {
+        return false;
+    }
+    p = indexEnd(p, end);
+    if (p == end || *p != '/')
+    {
+        result = vi;
+        return true;
+    }
+
+    // i/j/k
+    p++;
+    if (!fix(vnSize, RELATIVE_VN, &vi.vn))
+    {
+        return false;
+    }
+    p = indexEnd(p, end);
+    result = vi;
+    return true;
+}
+
+
+/// Parse the contents of an s line after the 's'
+/**
+ * Returns false if the line doesn't change the smoothing group.
+ */
+bool parseSmoothingGroup(const char* token, const char* end, unsigned int& smoothingGroupId)
+{
+    token = skipSpace(token, end);
+    if (token == end)
+    {
+        return false;
+    }
+
+    // As in tinyobj, values of 3 or more characters other than "off" are ignored
+    if (end - token >= 3)
+    {
+        if (token[0] == 'o' && token[1] == 'f' && token[2] == 'f')
+        {
+            smoothingGroupId = 0;
+            return true;
+        }
+        return false;
+    }
+
+    int id = parseInt(token, end);
+    smoothingGroupId = id < 0 ? 0 : static_cast<unsigned int>(id);
+    return true;
+}
+
+
+// Point in polygon test from https://wrf.ecse.rpi.edu//Research/Short_Notes/pnpoly.html
+int pnpoly(int nvert, const real_t* vertx, const real_t* verty, real_t testx, real_t testy)
+{
+    int c = 0;
+    for (int i = 0, j = nvert - 1; i < nvert; j = i++)
+    {
+        if (((verty[i] > testy) != (verty[j] > testy)) &&
+            (testx < (vertx[j] - vertx[i]) * (testy - verty[i]) / (verty[j] - verty[i]) + vertx[i]))
+        {
+            c = !c;
+        }
+    }
+    return c;
+}
+
+
+inline tinyobj::index_t toIndex(const VertexIndex& vi)
+{
+    tinyobj::index_t index;
+    index.vertex_index = vi.v;
+    index.normal_index = vi.vn;
+    index.texcoord_index = vi.vt;
+    return index;
+}
+
+
+/// Count the elements of the file to reserve the output for
+Counts countElements(const char* data, size_t size)
+{
+    Counts counts;
+    const char* p = data;
+    const char* end = data + size;
+    while (p < end)
+    {
+        const char* lineEnd = static_cast<const char*>(memchr(p, '\n', static_cast<size_t>(end - p)));
+        if (lineEnd == nullptr)
+        {
+            lineEnd = end;
+        }
+
+        p = skipSpace(p, lineEnd);
+        if (lineEnd - p > 2 && p[0] == 'v')
+        {
+            if (isSpace(p[1]))
+            {
+                counts.vertices++;
+            }
+            else if (p[1] == 'n' && isSpace(p[2]))
+            {
+                counts.normals++;
+            }
+            else if (p[1] == 't' && isSpace(p[2]))
+            {
+                counts.texcoords++;
+            }
+        }
+        else if (lineEnd - p > 2 && p[0] == 'f' && isSpace(p[1]))
+        {
+            counts.faces++;
+            for (p += 2; p < lineEnd;)
+            {
+                p = skipSpace(p, lineEnd);
+                if (p < lineEnd && *p != '\r')
+                {
+                    counts.corners++;
+                }
+                p = tokenEnd(p, lineEnd);
+            }
+        }
+
+        p = lineEnd < end ? lineEnd + 1 : end;
+    }
+    return counts;
+}
+
+
+/// Parse a line of a chunk, returns false if it is a face that can't be parsed
+bool parseLine(Chunk& chunk, const char* token, const char* end)
+{
+    token = skipSpace(token, end);
+    if (token == end || token[0] == '#')
+    {
+        return true;
+    }
+
+    const ptrdiff_t length = end - token;
+    const char c1 = length > 1 ? token[1] : '\0';
+    const char c2 = length > 2 ? token[2] : '\0';
+
+    switch (token[0])
+    {
+        case 'v':
+            if (isSpace(c1))
+            {
+                // Vertex with an optional color, white if it has none
+                token += 2;
+                real_t x = parseReal(token, end);
+                real_t y = parseReal(token, end);
+                real_t z = parseReal(token, end);
+                real_t r, g, b;
+                if (!(parseReal(token, end, &r) && parseReal(token, end, &g) && parseReal(token, end, &b)))
+                {
+                    r = g = b = 1.0;
+                }
+                chunk.v.push_back(x);
+                chunk.v.push_back(y);
+                chunk.v.push_back(z);
+                chunk.vc.push_back(r);
+                chunk.vc.push_back(g);
+                chunk.vc.push_back(b);
+            }
+            else if (c1 == 'n' && isSpace(c2))
+            {
+                token += 3;
+                real_t x = parseReal(token, end);
+                real_t y = parseReal(token, end);
+                real_t z = parseReal(token, end);
+                chunk.vn.push_back(x);
+                chunk.vn.push_back(y);
+                chunk.vn.push_back(z);
+            }
+            else if (c1 == 't' && isSpace(c2))
+            {
+                token += 3;
+                real_t u = parseReal(token, end);
+                real_t v = parseReal(token, end);
+                chunk.vt.push_back(u);
+                chunk.vt.push_back(v);
+            }
+            return true;
+
+        case 'f':
+            if (isSpace(c1))
+            {
+                token = skipSpace(token + 2, end);
+
+                Face face { chunk.corners.size(), 0, chunk.smoothingGroupId };
+                const int vSize = static_cast<int>(chunk.v.size() / 3);
+                const int vnSize = static_cast<int>(chunk.vn.size() / 3);
+                const int vtSize = static_cast<int>(chunk.vt.size() / 2);
+                while (token < end)
+                {
+                    VertexIndex vi;
+                    uint8_t relativeFlags;
+                    if (!parseTriple(token, end, vSize, vnSize, vtSize, vi, relativeFlags))
+                    {
+                        return false;
+                    }
+                    if (relativeFlags != 0)
+                    {
+                        chunk.relativeCorners.push_back({ chunk.corners.size(), relativeFlags });
+                    }
+                    chunk.corners.push_back(vi);
+                    token = skipSpace(token, end);
+                }
+                face.numCorners = chunk.corners.size() - face.firstCorner;
+                chunk.faces.push_back(face);
+                if (!chunk.setsSmoothingGroup)
+                {
+                    chunk.numInheritedSmoothingFaces++;
+                }
+            }
+            return true;
+
+        case 's':
+            if (isSpace(c1) && parseSmoothingGroup(token + 2, end, chunk.smoothingGroupId))
+            {
+                chunk.setsSmoothingGroup = true;
+            }
+            return true;
+
+        case 'g':
+        case 'o':
+        case 't':
+        case 'l':
+            if (isSpace(c1))
+            {
+                chunk.statements.push_back({ token, end, chunk.numLines, chunk.faces.size(), chunk.v.size() / 3, 0 });
+            }
+            return true;
+
+        default:
+            // mtllib, usemtl and unknown commands are ignored
+            return true;
+    }
+}
+
+
+/// Parse the lines of a chunk, up to a face that can't be parsed
+void parseChunk(Chunk& chunk)
+{
+    Counts counts = countElements(chunk.begin, static_cast<size_t>(chunk.end - chunk.begin));
+    chunk.v.reserve(3 * counts.vertices);
+    chunk.vc.reserve(3 * counts.vertices);
+    chunk.vn.reserve(3 * counts.normals);
+    chunk.vt.reserve(2 * counts.texcoords);
+    chunk.faces.reserve(counts.faces);
+    chunk.corners.reserve(counts.corners);
+
+    const char* p = chunk.begin;
+    const char* end = chunk.end;
+    while (p < end)
+    {
+        // Lines end with "\n", "\r\n" or "\r", the contents end at a NUL character
+        const char* lineEnd = p;
+        const char* contentsEnd = nullptr;
+        for (; lineEnd < end; ++lineEnd)
+        {
+            const char c = *lineEnd;
+            if (static_cast<unsigned char>(c) <= '\r')
+            {
+                if (c == '\n' || c == '\r')
+                {
+                    break;
+                }
+                if (c == '\0' && contentsEnd == nullptr)
+                {
+                    contentsEnd = lineEnd;
+                }
+            }
+        }
+
+        chunk.numLines++;
+        if (!parseLine(chunk, p, contentsEnd != nullptr ? contentsEnd : lineEnd))
+        {
+            chunk.errorLine = chunk.numLines;
+            return;
+        }
+
+        p = lineEnd;
+        if (p < end)
+        {
+            p += (*p == '\r' && p + 1 < end && p[1] == '\n') ? 2 : 1;
+        }
+    }
+}
+
+
+void addTriangle(Chunk& chunk, const VertexIndex& a, const VertexIndex& b, const VertexIndex& c,
+                 unsigned int smoothingGroupId)
+{
+    chunk.triangles.push_back(toIndex(a));
+    chunk.triangles.push_back(toIndex(b));
+    chunk.triangles.push_back(toIndex(c));
+    chunk.smoothingGroupIds.push_back(smoothingGroupId);
+}
+
+
+// Ear clipping as done by tinyobj's exportGroupsToShape, including its handling of invalid
+// vertex indices, so that the triangles are the same. vSize is the number of floats in v
+// when tinyobj exports the face.
+void triangulate(Chunk& chunk, const Face& face, const real_t* v, size_t vSize,
+                 std::vector<VertexIndex>& remaining)
+{
+    const VertexIndex* corners = &chunk.corners[face.firstCorner];
+    size_t npolys = face.numCorners;
+
+    // Find the two axes to work in
+    size_t axes[2] = { 1, 2 };
+    for (size_t k = 0; k < npolys; ++k)
+    {
+        size_t vi0 = size_t(corners[(k + 0) % npolys].v);
+        size_t vi1 = size_t(corners[(k + 1) % npolys].v);
+        size_t vi2 = size_t(corners[(k + 2) % npolys].v);
+
+        if (((3 * vi0 + 2) >= vSize) || ((3 * vi1 + 2) >= vSize) || ((3 * vi2 + 2) >= vSize))
+        {
+            // Invalid triangle
+            continue;
+        }
+        real_t v0x = v[vi0 * 3 + 0];
+        real_t v0y = v[vi0 * 3 + 1];
+        real_t v0z = v[vi0 * 3 + 2];
+        real_t v1x = v[vi1 * 3 + 0];
+        real_t v1y = v[vi1 * 3 + 1];
+        real_t v1z = v[vi1 * 3 + 2];
+        real_t v2x = v[vi2 * 3 + 0];
+        real_t v2y = v[vi2 * 3 + 1];
+        real_t v2z = v[vi2 * 3 + 2];
+        real_t e0x = v1x - v0x;
+        real_t e0y = v1y - v0y;
+        real_t e0z = v1z - v0z;
+        real_t e1x = v2x - v1x;
+        real_t e1y = v2y - v1y;
+        real_t e1z = v2z - v1z;
+        real_t cx = std::fabs(e0y * e1z - e0z * e1y);
+        real_t cy = std::fabs(e0z * e1x - e0x * e1z);
+        real_t cz = std::fabs(e0x * e1y - e0y * e1x);
+        const real_t epsilon = std::numeric_limits<real_t>::epsilon();
+        if (cx > epsilon || cy > epsilon || cz > epsilon)
+        {
+            // Found a corner
+            if (!(cx > cy && cx > cz))
+            {
+                axes[0] = 0;
+                if (cz > cx && cz > cy)
+                {
+                    axes[1] = 1;
+                }
+            }
+            break;
+        }
+    }
+
+    real_t area = 0;
+    for (size_t k = 0; k < npolys; ++k)
+    {
+        size_t vi0 = size_t(corners[(k + 0) % npolys].v);
+        size_t vi1 = size_t(corners[(k + 1) % npolys].v);
+        if (((vi0 * 3 + axes[0]) >= vSize) || ((vi0 * 3 + axes[1]) >= vSize) ||
+            ((vi1 * 3 + axes[0]) >= vSize) || ((vi1 * 3 + axes[1]) >= vSize))
+        {
+            // Invalid index
+            continue;
+        }
+        real_t v0x = v[vi0 * 3 + axes[0]];
+        real_t v0y = v[vi0 * 3 + axes[1]];
+        real_t v1x = v[vi1 * 3 + axes[0]];
+        real_t v1y = v[vi1 * 3 + axes[1]];
+        area += (v0x * v1y - v0y * v1x) * static_cast<real_t>(0.5);
+    }
+
+    remaining.assign(corners, corners + npolys);
+    size_t guessVert = 0;
+    VertexIndex ind[3];
+    real_t vx[3];
+    real_t vy[3];
+
+    // How many iterations can be done without decreasing the remaining vertices
+    size_t remainingIterations = npolys;
+    size_t previousRemainingVertices = npolys;
+
+    while (remaining.size() > 3 && remainingIterations > 0)
+    {
+        npolys = remaining.size();
+        if (guessVert >= npolys)
+        {
+            guessVert -= npolys;
+        }
+
+        if (previousRemainingVertices != npolys)
+        {
+            // The number of remaining vertices decreased, reset the counters
+            previousRemainingVertices = npolys;
+            remainingIterations = npolys;
+        }
+        else
+        {
+            // No vertex was consumed in the previous iteration
+            remainingIterations--;
+        }
+
+        for (size_t k = 0; k < 3; k++)
+        {
+            ind[k] = remaining[(guessVert + k) % npolys];
+            size_t vi = size_t(ind[k].v);
+            if (((vi * 3 + axes[0]) >= vSize) || ((vi * 3 + axes[1]) >= vSize))
+            {
+                vx[k] = static_cast<real_t>(0.0);
+                vy[k] = static_cast<real_t>(0.0);
+            }
+            else
+            {
+                vx[k] = v[vi * 3 + axes[0]];
+                vy[k] = v[vi * 3 + axes[1]];
+            }
+        }
+        real_t e0x = vx[1] - vx[0];
+        real_t e0y = vy[1] - vy[0];
+        real_t e1x = vx[2] - vx[1];
+        real_t e1y = vy[2] - vy[1];
+        real_t cross = e0x * e1y - e0y * e1x;
+        // Internal angle
+        if (cross * area < static_cast<real_t>(0.0))
+        {
+            guessVert += 1;
+            continue;
+        }
+
+        // Check whether any other vertex is inside this triangle
+        bool overlap = false;
+        for (size_t otherVert = 3; otherVert < npolys; ++otherVert)
+        {
+            size_t idx = (guessVert + otherVert) % npolys;
+            size_t ovi = size_t(remaining[idx].v);
+            if (((ovi * 3 + axes[0]) >= vSize) || ((ovi * 3 + axes[1]) >= vSize))
+            {
+                continue;
+            }
+            real_t tx = v[ovi * 3 + axes[0]];
+            real_t ty = v[ovi * 3 + axes[1]];
+            if (pnpoly(3, vx, vy, tx, ty))
+            {
+                overlap = true;
+                break;
+            }
+        }
+
+        if (overlap)
+        {
+            guessVert += 1;
+            continue;
+        }
+
+        // This triangle is an ear
+        addTriangle(chunk, ind[0], ind[1], ind[2], face.smoothingGroupId);
+
+        // Remove its middle vertex from the polygon
+        remaining.erase(remaining.begin() + static_cast<ptrdiff_t>((guessVert + 1) % npolys));
+    }
+
+    if (remaining.size() == 3)
+    {
+        addTriangle(chunk, remaining[0], remaining[1], remaining[2], face.smoothingGroupId);
+    }
+}
+
+
+/// Fix up the relative indices and smoothing groups of a placed chunk and triangulate its faces
+/**
+ * v holds the vertices of the whole file.
+ */
+void triangulateChunk(Chunk& chunk, const std::vector<real_t>& v)
+{
+    for (const RelativeCorner& relative : chunk.relativeCorners)
+    {
+        VertexIndex& corner = chunk.corners[relative.corner];
+        if (relative.flags & RELATIVE_V)
+        {
+            corner.v += static_cast<int>(chunk.firstV);
+        }
+        if (relative.flags & RELATIVE_VT)
+        {
+            corner.vt += static_cast<int>(chunk.firstVt);
+        }
+        if (relative.flags & RELATIVE_VN)
+        {
+            corner.vn += static_cast<int>(chunk.firstVn);
+        }
+    }
+    for (size_t f = 0; f < chunk.numInheritedSmoothingFaces; ++f)
+    {
+        chunk.faces[f].smoothingGroupId = chunk.initialSmoothingGroupId;
+    }
+    for (const VertexIndex& corner : chunk.corners)
+    {
+        chunk.greatestV = std::max(chunk.greatestV, corner.v);
+        chunk.greatestVn = std::max(chunk.greatestVn, corner.vn);
+        chunk.greatestVt = std::max(chunk.greatestVt, corner.vt);
+    }
+
+    size_t numTriangles = 0;
+    for (const Face& face : chunk.faces)
+    {
+        if (face.numCorners >= 3)
+        {
+            numTriangles += face.numCorners - 2;
+        }
+    }
+    chunk.triangles.reserve(3 * numTriangles);
+    chunk.smoothingGroupIds.reserve(numTriangles);
+
+    std::vector<VertexIndex> remaining;
+    auto statement = chunk.statements.begin();
+    auto exportStatement = chunk.statements.begin();
+    for (size_t f = 0; f < chunk.faces.size(); ++f)
+    {
+        for (; statement != chunk.statements.end() && statement->numFaces <= f; ++statement)
+        {
+            statement->numTriangles = chunk.smoothingGroupIds.size();
+        }
+
+        const Face& face = chunk.faces[f];
+        if (face.numCorners < 3)
+        {
+            // Face must have 3+ vertices
+            continue;
+        }
+        if (face.numCorners == 3)
+        {
+            const VertexIndex* corners = &chunk.corners[face.firstCorner];
+            addTriangle(chunk, corners[0], corners[1], corners[2], face.smoothingGroupId);
+            continue;
+        }
+
+        // Polygons are triangulated with the vertices defined when tinyobj exports them
+        while (exportStatement != chunk.statements.end() &&
+               (exportStatement->numFaces <= f || !exportStatement->exportsFaces()))
+        {
+            ++exportStatement;
+        }
+        size_t numVertices = exportStatement != chunk.statements.end()
+                                 ? chunk.firstV + exportStatement->numVertices
+                                 : chunk.exportNumVertices;
+        triangulate(chunk, face, v.data(), 3 * numVertices, remaining);
+    }
+    for (; statement != chunk.statements.end(); ++statement)
+    {
+        statement->numTriangles = chunk.smoothingGroupIds.size();
+    }
+
+    // Only the triangles are needed from here on
+    chunk.numFaces = chunk.faces.size();
+    std::vector<Face>().swap(chunk.faces);
+    std::vector<VertexIndex>().swap(chunk.corners);
+}
+
+
+/// Builds the shapes from the triangulated chunks in file order, as tinyobj::LoadObj does
+class ShapeBuilder
+{
+public:
+    ShapeBuilder(std::vector<tinyobj::shape_t>& shapes, std::string& warn) : mShapes(shapes), mWarn(warn) {}
+
+    void addChunk(Chunk& chunk);
+
+    /// Add the last shape
+    void finish();
+
+private:
+    void addFaces(Chunk& chunk, size_t numFaces, size_t firstTriangle, size_t lastTriangle);
+    void parseFaceGroupName(const char* token, const char* end, size_t lineNumber);
+    void parseObjectName(const char* token, const char* end);
+    void parseTag(const char* token, const char* end);
+    void parseLines(const char* token, const char* end);
+
+    /// Complete the shape with the faces and lines added since the last export
+    bool exportGroupsToShape();
+
+    std::vector<tinyobj::shape_t>& mShapes;
+    std::string& mWarn;
+
+    tinyobj::shape_t mShape;
+    std::string mName;
+    std::vector<tinyobj::tag_t> mTags;
+    std::vector<int> mLines;
+    /// Faces added since the last export
+    size_t mNumFaces { 0 };
+};
+
+
+void ShapeBuilder::addChunk(Chunk& chunk)
+{
+    size_t face = 0;
+    size_t triangle = 0;
+    for (const Statement& statement : chunk.statements)
+    {
+        addFaces(chunk, statement.numFaces - face, triangle, statement.numTriangles);
+        face = statement.numFaces;
+        triangle = statement.numTriangles;
+
+        const char* token = statement.begin;
+        switch (*token)
+        {
+            case 'g':
+                parseFaceGroupName(token, statement.end, chunk.firstLine + statement.line);
+                break;
+            case 'o':
+                parseObjectName(token, statement.end);
+                break;
+            case 't':
+                parseTag(token + 2, statement.end);
+                break;
+            case 'l':
+                parseLines(token + 2, statement.end);
+                break;
+        }
+    }
+    addFaces(chunk, chunk.numFaces - face, triangle, chunk.smoothingGroupIds.size());
+}
+
+
+void ShapeBuilder::finish()
+{
+    // Also add the shape if a usemtl line flushed its faces
+    bool exported = exportGroupsToShape();
+    if (exported || !mShape.mesh.indices.empty())
+    {
+        mShapes.push_back(std::move(mShape));
+    }
+}
+
+
+void ShapeBuilder::addFaces(Chunk& chunk, size_t numFaces, size_t firstTriangle, size_t lastTriangle)
+{
+    mNumFaces += numFaces;
+
+    size_t numTriangles = lastTriangle - firstTriangle;
+    if (numTriangles == 0)
+    {
+        return;
+    }
+
+    tinyobj::mesh_t& mesh = mShape.mesh;
+    if (mesh.indices.empty() && numTriangles == chunk.smoothingGroupIds.size())
+    {
+        // All triangles of the chunk start a shape
+        mesh.indices.swap(chunk.triangles);
+        mesh.smoothing_group_ids.swap(chunk.smoothingGroupIds);
+    }
+    else
+    {
+        mesh.indices.insert(mesh.indices.end(), chunk.triangles.begin() + 3 * firstTriangle,
+                            chunk.triangles.begin() + 3 * lastTriangle);
+        mesh.smoothing_group_ids.insert(mesh.smoothing_group_ids.end(),
+                                        chunk.smoothingGroupIds.begin() + firstTriangle,
+                                        chunk.smoothingGroupIds.begin() + lastTriangle);
+    }
+    mesh.num_face_vertices.insert(mesh.num_face_vertices.end(), numTriangles, 3);
+    mesh.material_ids.insert(mesh.material_ids.end(), numTriangles, -1);
+}
+
+
+void ShapeBuilder::parseFaceGroupName(const char* token, const char* end, size_t lineNumber)
+{
+    exportGroupsToShape();
+    if (!mShape.mesh.indices.empty())
+    {
+        mShapes.push_back(std::move(mShape));
+    }
+    mShape = tinyobj::shape_t();
+
+    // The group names follow the 'g', several names are joined with spaces
+    parseString(token, end);
+    token = skipSpace(token, end);
+    if (token == end)
+    {
+        mWarn += "Empty group name. line: " + std::to_string(lineNumber) + "\n";
+        mName.clear();
+        return;
+    }
+
+    mName = parseString(token, end);
+    token = skipSpace(token, end);
+    while (token < end)
+    {
+        mName += ' ';
+        mName += parseString(token, end);
+        token = skipSpace(token, end);
+    }
+}
+
+
+void ShapeBuilder::parseObjectName(const char* token, const char* end)
+{
+    if (exportGroupsToShape())
+    {
+        mShapes.push_back(std::move(mShape));
+    }
+    mShape = tinyobj::shape_t();
+
+    mName.assign(token + 2, end);
+}
+
+
+void ShapeBuilder::parseTag(const char* token, const char* end)
+{
+    tinyobj::tag_t tag;
+    tag.name = parseString(token, end);
+
+    // Number of values as ints/reals/strings
+    int numInts = 0;
+    int numReals = 0;
+    int numStrings = 0;
+    token = skipSpace(token, end);
+    numInts = toInt(token, end);
+    token = indexEnd(token, end);
+    if (token < end && *token == '/')
+    {
+        token = skipSpace(token + 1, end);
+        numReals = toInt(token, end);
+        token = indexEnd(token, end);
+        if (token < end && *token == '/')
+        {
+            token++;
+            numStrings = parseInt(token, end);
+        }
+    }
+    numInts = std::min(std::max(numInts, 0), MAX_TAG_VALUES);
+    numReals = std::min(std::max(numReals, 0), MAX_TAG_VALUES);
+    numStrings = std::min(std::max(numStrings, 0), MAX_TAG_VALUES);
+
+    tag.intValues.resize(static_cast<size_t>(numInts));
+    for (int& value : tag.intValues)
+    {
+        value = parseInt(token, end);
+    }
+    tag.floatValues.resize(static_cast<size_t>(numReals));
+    for (real_t& value : tag.floatValues)
+    {
+        value = parseReal(token, end);
+    }
+    tag.stringValues.resize(static_cast<size_t>(numStrings));
+    for (std::string& value : tag.stringValues)
+    {
+        value = parseString(token, end);
+    }
+
+    mTags.push_back(std::move(tag));
+}
+
+
+void ShapeBuilder::parseLines(const char* token, const char* end)
+{
+    int first = 0;
+    bool second = false;
+    while (token < end)
+    {
+        int index = 0;
+        fixIndex(parseInt(token, end), 0, &index);
+        token = skipSpace(token, end);
+        if (second)
+        {
+            mLines.push_back(first);
+            mLines.push_back(index);
+        }
+        else
+        {
+            first = index;
+        }
+        second = !second;
+    }
+}
+
+
+bool ShapeBuilder::exportGroupsToShape()
+{
+    if (mNumFaces == 0 && mLines.empty())
+    {
+        return false;
+    }
+
+    // The triangles were added to the shape already
+    if (mNumFaces != 0)
+    {
+        mShape.name = mName;
+        mShape.mesh.tags = mTags;
+        mNumFaces = 0;
+    }
+
+    if (!mLines.empty())
+    {
+        mShape.path.indices.swap(mLines);
+    }
+
+    return true;
+}
+
+
+/// Split the file at line boundaries into chunks for numThreads threads
+std::vector<Chunk> splitChunks(const char* data, size_t size, unsigned int numThreads, size_t chunkSize)
+{
+    size_t numChunks = 1;
+    if (numThreads > 1 && chunkSize > 0)
+    {
+        numChunks = std::max<size_t>(1, std::min<size_t>(size / chunkSize, numThreads * CHUNKS_PER_THREAD));
+    }
+
+    std::vector<Chunk> chunks(numChunks);
+    const char* begin = data;
+    const char* end = data + size;
+    size_t numUsed = 0;
+    for (size_t i = 1; i <= numChunks; ++i)
+    {
+        const char* chunkEnd = end;
+        if (i < numChunks)
+        {
+            // Chunks end after a '\n', which always ends a line
+            const char* split = std::max(begin, data + size / numChunks * i);
+            auto newline = static_cast<const char*>(memchr(split, '\n', static_cast<size_t>(end - split)));
+            chunkEnd = newline != nullptr ? newline + 1 : end;
+        }
+        chunks[numUsed].begin = begin;
+        chunks[numUsed].end = chunkEnd;
+        numUsed++;
+        begin = chunkEnd;
+        if (begin == end)
+        {
+            break;
+        }
+    }
+    chunks.resize(numUsed);
+    return chunks;
+}
+
+
+/// Call function(i) for i from 0 to count - 1 on up to numThreads threads including this one
+template <typename Function>
+void parallelFor(size_t count, unsigned int numThreads, const Function& function)
+{
+    std::atomic<size_t> next { 0 };
+    auto work = [&next, count, &function]() {
+        for (size_t i = next++; i < count; i = next++)
+        {
+            function(i);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t t = 1; t < std::min<size_t>(numThreads, count); ++t)
+    {
+        threads.emplace_back(work);
+    }
+    work();
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+}
+
+
+/// Concatenate the elements of the chunks into elements
+void concatenate(std::vector<Chunk>& chunks, std::vector<real_t> Chunk::*elements, size_t Chunk::*first,
+                 size_t size, std::vector<real_t>& result, unsigned int numThreads)
+{
+    if (chunks.size() == 1)
+    {
+        result.swap(chunks[0].*elements);
+        return;
+    }
+
+    result.resize(0);
+    result.resize(chunks.back().*first * size + (chunks.back().*elements).size());
+    parallelFor(chunks.size(), numThreads, [&chunks, elements, first, size, &result](size_t i) {
+        std::vector<real_t>& chunkElements = chunks[i].*elements;
+        std::copy(chunkElements.begin(), chunkElements.end(), result.begin() + static_cast<ptrdiff_t>(chunks[i].*first * size));
+        std::vector<real_t>().swap(chunkElements);
+    });
+}
+
+} // namespace
+
+
+bool ObjParser::parse(const char* data, size_t size, tinyobj::attrib_t& attrib,
+                      std::vector<tinyobj::shape_t>& shapes, std::string& warn, std::string& err,
+                      unsigned int numThreads, size_t chunkSize)
+{
+    shapes.clear();
+    if (numThreads == 0)
+    {
+        numThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    std::vector<Chunk> chunks = splitChunks(data, size, numThreads, chunkSize);
+    parallelFor(chunks.size(), numThreads, [&chunks](size_t i) { parseChunk(chunks[i]); });
+
+    // Place the chunks in the file now that the number of lines and elements in each is known
+    size_t numLines = 0;
+    size_t numV = 0;
+    size_t numVn = 0;
+    size_t numVt = 0;
+    unsigned int smoothingGroupId = 0;
+    for (Chunk& chunk : chunks)
+    {
+        chunk.firstLine = numLines;
+        chunk.firstV = numV;
+        chunk.firstVn = numVn;
+        chunk.firstVt = numVt;
+        chunk.initialSmoothingGroupId = smoothingGroupId;
+        if (chunk.errorLine != 0)
+        {
+            err += "Failed parse `f' line(e.g. zero value for face index. line " +
+                   std::to_string(chunk.firstLine + chunk.errorLine) + ".)\n";
+            return false;
+        }
+
+        numLines += chunk.numLines;
+        numV += chunk.v.size() / 3;
+        numVn += chunk.vn.size() / 3;
+        numVt += chunk.vt.size() / 2;
+        if (chunk.setsSmoothingGroup)
+        {
+            smoothingGroupId = chunk.smoothingGroupId;
+        }
+    }
+
+    // Faces are exported at the next g or o line or the end of the file
+    size_t exportNumVertices = numV;
+    for (auto chunk = chunks.rbegin(); chunk != chunks.rend(); ++chunk)
+    {
+        chunk->exportNumVertices = exportNumVertices;
+        for (const Statement& statement : chunk->statements)
+        {
+            if (statement.exportsFaces())
+            {
+                exportNumVertices = chunk->firstV + statement.numVertices;
+                break;
+            }
+        }
+    }
+
+    concatenate(chunks, &Chunk::v, &Chunk::firstV, 3, attrib.vertices, numThreads);
+    concatenate(chunks, &Chunk::vn, &Chunk::firstVn, 3, attrib.normals, numThreads);
+    concatenate(chunks, &Chunk::vt, &Chunk::firstVt, 2, attrib.texcoords, numThreads);
+    concatenate(chunks, &Chunk::vc, &Chunk::firstV, 3, attrib.colors, numThreads);
+
+    parallelFor(chunks.size(), numThreads, [&chunks, &attrib](size_t i) {
+        triangulateChunk(chunks[i], attrib.vertices);
+    });
+
+    ShapeBuilder builder(shapes, warn);
+    int greatestV = -1;
+    int greatestVn = -1;
+    int greatestVt = -1;
+    for (Chunk& chunk : chunks)
+    {
+        builder.addChunk(chunk);
+        greatestV = std::max(greatestV, chunk.greatestV);
+        greatestVn = std::max(greatestVn, chunk.greatestVn);
+        greatestVt = std::max(greatestVt, chunk.greatestVt);
+    }
+
+    auto outOfBounds = [&warn, numLines](const char* what) {
+        warn += what;
+        warn += " indices out of bounds (line " + std::to_string(numLines) + ".)\n\n";
+    };
+    if (greatestV >= static_cast<int>(numV))
+    {
+        outOfBounds("Vertex");
+    }
+    if (greatestVn >= static_cast<int>(numVn))
+    {
+        outOfBounds("Vertex normal");
+    }
+    if (greatestVt >= static_cast<int>(numVt))
+    {
+        outOfBounds("Vertex texcoord");
+    }
+
+    builder.finish();
+    return true;
+}
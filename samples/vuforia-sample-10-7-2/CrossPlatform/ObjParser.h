@@ -0,0 +1,51 @@
+/*===============================================================================
+Copyright (c) 2022 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#ifndef __OBJ_PARSER_H__
+#define __OBJ_PARSER_H__
+
+#include <tiny_obj_loader.h>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+
+/// Parser for OBJ file contents held in memory
+/**
+ * Produces the same attrib_t and shape_t data, warnings and errors as tinyobj::LoadObj with
+ * triangulation and without a material reader, but parses the buffer in place instead of
+ * copying it line by line out of a std::istream. The number of vertices and faces is counted
+ * first so that the output is allocated once.
+ *
+ * Large files are split at line boundaries into chunks that are parsed on several threads.
+ * Indices are made relative to the whole file and the shapes are built in file order
+ * afterwards, so the result doesn't depend on the number of threads.
+ *
+ * Numbers are converted with the same arithmetic as tinyobj, so the results are bit for bit
+ * identical; Tools/ObjParserBenchmark checks this. Materials aren't loaded, mtllib and usemtl
+ * are ignored and every face has material id -1.
+ */
+class ObjParser
+{
+public:
+    /// Default minimum size of the chunks parsed by each thread
+    static constexpr size_t DEFAULT_CHUNK_SIZE = 64 * 1024;
+
+    /// Parse the OBJ file in data, replacing the contents of attrib and shapes
+    /**
+     * Up to numThreads threads are used including the calling one, 0 uses a thread per CPU
+     * core. Files smaller than 2 chunks of chunkSize bytes are parsed on the calling thread.
+     * Warnings and errors are appended to warn and err.
+     * Returns false if a face can't be parsed.
+     */
+    static bool parse(const char* data, size_t size, tinyobj::attrib_t& attrib,
+                      std::vector<tinyobj::shape_t>& shapes, std::string& warn, std::string& err,
+                      unsigned int numThreads = 0, size_t chunkSize = DEFAULT_CHUNK_SIZE);
+};
+
+#endif // __OBJ_PARSER_H__
@@ -0,0 +1,358 @@
+/*===============================================================================
+Copyright (c) 2022 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#include "Trace.h"
+
+#include "Log.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(__ANDROID__) || defined(__linux__)
+#include <sys/syscall.h>
+#include <unistd.h>
+#elif defined(_WIN32)
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+
+namespace
+{
+
+/// A recorded event, the fields correspond to the Trace Event format fields
+struct Event
+{
+    uint64_t timestamp;     ///< Nanoseconds on the monotonic clock
+    const char* name;
+    const char* category;
+    int64_t value;          ///< Counter value
+    char phase;             ///< 'B'egin, 'E'nd, 'i'nstant or 'C'ounter
+};
+
+
+/// Single producer single consumer ring of the events of one thread
+/// The thread recording the events is the producer, writeFile the consumer.
+struct ThreadBuffer
+{
+    static constexpr uint32_t MASK = Trace::EVENTS_PER_THREAD - 1;
+    static_assert((Trace::EVENTS_PER_THREAD & MASK) == 0, "EVENTS_PER_THREAD must be a power of two");
+
+    uint64_t threadId { 0 };
+    std::atomic<const char*> threadName { nullptr };
+    std::atomic<uint32_t> head { 0 };
+    std::atomic<uint32_t> tail { 0 };
+    std::atomic<uint64_t> dropped { 0 };
+    /// Whether the thread exited, its buffer is freed once writeFile drained it
+    bool exited { false };
+    Event events[Trace::EVENTS_PER_THREAD];
+};
+
+
+std::atomic<bool> gEnabled { false };
+
+/// The buffers of every thread that recorded events. The buffer of a thread that exits is kept
+/// until writeFile has written its events. The mutex is taken when a thread records its first
+/// event or exits and by writeFile.
+std::mutex gBuffersMutex;
+std::vector<std::unique_ptr<ThreadBuffer>> gBuffers;
+/// Events dropped by the threads whose buffers were freed
+uint64_t gExitedDroppedEvents { 0 };
+
+
+uint64_t getCurrentThreadId()
+{
+#if defined(__ANDROID__) || defined(__linux__)
+    // The kernel thread id, shared with the other libraries in the process
+    return static_cast<uint64_t>(syscall(SYS_gettid));
+#elif defined(_WIN32)
+    return static_cast<uint64_t>(GetCurrentThreadId());
+#else
+    return static_cast<uint64_t>(std::hash<std::thread::id>()(std::this_thread::get_id()));
+#endif
+}
+
+
+uint64_t getProcessId()
+{
+#if defined(_WIN32)
+    return static_cast<uint64_t>(GetCurrentProcessId());
+#else
+    return static_cast<uint64_t>(getpid());
+#endif
+}
+
+
+/// Free the buffer at position in gBuffers, gBuffersMutex must be held
+std::vector<std::unique_ptr<ThreadBuffer>>::iterator freeBuffer(std::vector<std::unique_ptr<ThreadBuffer>>::iterator position)
+{
+    gExitedDroppedEvents += (*position)->dropped.load(std::memory_order_relaxed);
+    return gBuffers.erase(position);
+}
+
+
+/// Owns the buffer of a thread, frees it when the thread exits or leaves it to writeFile to
+/// free if it still holds events
+struct ThreadBufferOwner
+{
+    ThreadBuffer* buffer { nullptr };
+
+    ~ThreadBufferOwner()
+    {
+        if (buffer == nullptr)
+        {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(gBuffersMutex);
+        if (buffer->head.load(std::memory_order_relaxed) != buffer->tail.load(std::memory_order_relaxed))
+        {
+            buffer->exited = true;
+            return;
+        }
+        freeBuffer(std::find_if(gBuffers.begin(), gBuffers.end(),
+                                [this](const std::unique_ptr<ThreadBuffer>& threadBuffer) { return threadBuffer.get() == buffer; }));
+    }
+};
+
+
+/// Name set for the calling thread, kept so that it can be applied when the thread's buffer
+/// is created on its first event
+thread_local const char* tThreadName = nullptr;
+thread_local ThreadBufferOwner tThreadBuffer;
+
+
+ThreadBuffer& getThreadBuffer()
+{
+    if (tThreadBuffer.buffer == nullptr)
+    {
+        auto buffer = std::make_unique<ThreadBuffer>();
+        buffer->threadId = getCurrentThreadId();
+        buffer->threadName.store(tThreadName, std::memory_order_relaxed);
+        tThreadBuffer.buffer = buffer.get();
+
+        std::lock_guard<std::mutex> lock(gBuffersMutex);
+        gBuffers.push_back(std::move(buffer));
+    }
+    return *tThreadBuffer.buffer;
+}
+
+
+void record(char phase, const char* name, const char* category, int64_t value = 0)
+{
+    if (!gEnabled.load(std::memory_order_relaxed))
+    {
+        return;
+    }
+
+    uint64_t timestamp = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+
+    ThreadBuffer& buffer = getThreadBuffer();
+    uint32_t head = buffer.head.load(std::memory_order_relaxed);
+    if (head - buffer.tail.load(std::memory_order_acquire) == Trace::EVENTS_PER_THREAD)
+    {
+        buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    buffer.events[head & ThreadBuffer::MASK] = Event { timestamp, name, category, value, phase };
+    buffer.head.store(head + 1, std::memory_order_release);
+}
+
+
+/// Write a string as a JSON string literal
+void writeString(FILE* file, const char* string)
+{
+    fputc('"', file);
+    for (const char* c = string != nullptr ? string : ""; *c != '\0'; ++c)
+    {
+        if (*c == '"' || *c == '\\')
+        {
+            fputc('\\', file);
+            fputc(*c, file);
+        }
+        else if (static_cast<unsigned char>(*c) < 0x20)
+        {
+            fprintf(file, "\\u%04x", static_cast<unsigned>(*c));
+        }
+        else
+        {
+            fputc(*c, file);
+        }
+    }
+    fputc('"', file);
+}
+
+
+void writeEvent(FILE* file, const Event& event, uint64_t processId, uint64_t threadId)
+{
+    // Trace Event timestamps are in microseconds
+    fprintf(file, "{\"ph\":\"%c\",\"ts\":%llu.%03u,\"pid\":%llu,\"tid\":%llu", event.phase,
+            static_cast<unsigned long long>(event.timestamp / 1000), static_cast<unsigned>(event.timestamp % 1000),
+            static_cast<unsigned long long>(processId), static_cast<unsigned long long>(threadId));
+    if (event.phase != 'E')
+    {
+        fputs(",\"name\":", file);
+        writeString(file, event.name);
+        fputs(",\"cat\":", file);
+        writeString(file, event.category);
+    }
+    if (event.phase == 'i')
+    {
+        // Instant events are shown on their thread's track
+        fputs(",\"s\":\"t\"", file);
+    }
+    else if (event.phase == 'C')
+    {
+        fputs(",\"args\":{\"value\":", file);
+        fprintf(file, "%lld}", static_cast<long long>(event.value));
+    }
+    fputs("},\n", file);
+}
+
+} // namespace
+
+
+void Trace::setEnabled(bool enabled)
+{
+    gEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+
+bool Trace::isEnabled()
+{
+    return gEnabled.load(std::memory_order_relaxed);
+}
+
+
+void Trace::begin(const char* name, const char* category)
+{
+    record('B', name, category);
+}
+
+
+void Trace::end()
+{
+    record('E', nullptr, nullptr);
+}
+
+
+void Trace::instant(const char* name, const char* category)
+{
+    record('i', name, category);
+}
+
+
+void Trace::counter(const char* name, int64_t value, const char* category)
+{
+    record('C', name, category, value);
+}
+
+
+void Trace::setThreadName(const char* name)
+{
+    // The buffer is only created once the thread records an event
+    tThreadName = name;
+    if (tThreadBuffer.buffer != nullptr)
+    {
+        tThreadBuffer.buffer->threadName.store(name, std::memory_order_relaxed);
+    }
+}
+
+
+bool Trace::createFile(const char* path)
+{
+    FILE* file = fopen(path, "wb");
+    if (file == nullptr || fclose(file) != 0)
+    {
+        LOG("Failed to create trace file %s", path);
+        return false;
+    }
+    return true;
+}
+
+
+bool Trace::writeFile(const char* path)
+{
+    FILE* file = fopen(path, "ab");
+    if (file == nullptr)
+    {
+        LOG("Failed to open trace file %s", path);
+        return false;
+    }
+
+    // The JSON array format allows the closing bracket to be left out, so events can be
+    // appended to the file later
+    fseek(file, 0, SEEK_END);
+    if (ftell(file) == 0)
+    {
+        fputs("[\n", file);
+    }
+
+    const uint64_t processId = getProcessId();
+    uint64_t numEvents = 0;
+    {
+        std::lock_guard<std::mutex> lock(gBuffersMutex);
+        for (auto position = gBuffers.begin(); position != gBuffers.end();)
+        {
+            ThreadBuffer* buffer = position->get();
+            const char* threadName = buffer->threadName.load(std::memory_order_relaxed);
+            if (threadName != nullptr)
+            {
+                fprintf(file, "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":%llu,\"tid\":%llu,\"args\":{\"name\":",
+                        static_cast<unsigned long long>(processId), static_cast<unsigned long long>(buffer->threadId));
+                writeString(file, threadName);
+                fputs("}},\n", file);
+            }
+
+            uint32_t tail = buffer->tail.load(std::memory_order_relaxed);
+            uint32_t head = buffer->head.load(std::memory_order_acquire);
+            for (uint32_t i = tail; i != head; ++i)
+            {
+                writeEvent(file, buffer->events[i & ThreadBuffer::MASK], processId, buffer->threadId);
+            }
+            buffer->tail.store(head, std::memory_order_release);
+            numEvents += head - tail;
+
+            // The buffer of an exited thread isn't needed once its events are written
+            position = buffer->exited ? freeBuffer(position) : position + 1;
+        }
+    }
+
+    bool written = ferror(file) == 0;
+    written = fclose(file) == 0 && written;
+    if (!written)
+    {
+        LOG("Failed to write trace file %s", path);
+        return false;
+    }
+
+    LOG("Wrote %llu trace events to %s, %llu events were dropped", static_cast<unsigned long long>(numEvents),
+        path, static_cast<unsigned long long>(getNumDroppedEvents()));
+    return true;
+}
+
+
+uint64_t Trace::getNumDroppedEvents()
+{
+    std::lock_guard<std::mutex> lock(gBuffersMutex);
+    uint64_t dropped = gExitedDroppedEvents;
+    for (const auto& buffer : gBuffers)
+    {
+        dropped += buffer->dropped.load(std::memory_order_relaxed);
+    }
+    return dropped;
+}
@@ -0,0 +1,95 @@
+/*===============================================================================
+Copyright (c) 2022 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#ifndef __TRACE_H__
+#define __TRACE_H__
+
+#include <cstdint>
+
+
+/// Timeline of events that can be written as a Chrome Trace Event file
+/**
+ * Events are recorded into a fixed size ring buffer per thread without taking locks and are
+ * only formatted when writeFile is called, which drains the buffers. When a buffer is full
+ * further events from its thread are dropped until the next writeFile. Tracing is disabled
+ * by default, while it is disabled recording an event is a single relaxed load. The buffer of
+ * a thread is freed when the thread exits, or by writeFile if it still holds events then.
+ *
+ * The file uses the JSON array format, which chrome://tracing and https://ui.perfetto.dev load.
+ * Timestamps are taken from the monotonic clock, so the events written by several libraries
+ * appending to the same file, e.g. the app and a Vuforia Driver, line up.
+ *
+ * Event names and categories aren't copied, they must be string literals or otherwise remain
+ * valid until the events are written.
+ */
+class Trace
+{
+public:
+    /// Number of events each thread can hold between calls to writeFile
+    static constexpr uint32_t EVENTS_PER_THREAD = 8192;
+
+    /// Records a duration event from its construction to its destruction
+    class ScopedEvent
+    {
+    public:
+        explicit ScopedEvent(const char* name, const char* category = "app") : mStarted(isEnabled())
+        {
+            if (mStarted)
+            {
+                begin(name, category);
+            }
+        }
+        ~ScopedEvent()
+        {
+            if (mStarted)
+            {
+                end();
+            }
+        }
+
+        ScopedEvent(const ScopedEvent&) = delete;
+        ScopedEvent& operator=(const ScopedEvent&) = delete;
+
+    private:
+        bool mStarted;
+    };
+
+    static void setEnabled(bool enabled);
+    static bool isEnabled();
+
+    /// Start a duration event on the calling thread, ended by the next call to end
+    static void begin(const char* name, const char* category = "app");
+    /// End the duration event last started on the calling thread
+    static void end();
+
+    /// Record an event without duration
+    static void instant(const char* name, const char* category = "app");
+
+    /// Record the value of a counter, shown as a graph over time
+    static void counter(const char* name, int64_t value, const char* category = "app");
+
+    /// Name the calling thread in the trace, may be called before tracing is enabled
+    static void setThreadName(const char* name);
+
+    /// Create an empty file at path, replacing any existing file
+    /// Called when tracing starts so that a file written by earlier runs isn't appended to.
+    /// Returns false if the file can't be created.
+    static bool createFile(const char* path);
+
+    /// Append the recorded events to the file at path and remove them from the buffers
+    /**
+     * The file is created if it doesn't exist. Events of several calls, also from other
+     * libraries using this class, can be appended to the same file.
+     * Returns false if the file can't be written.
+     */
+    static bool writeFile(const char* path);
+
+    /// Number of events dropped because a thread's buffer was full
+    static uint64_t getNumDroppedEvents();
+};
+
+#endif // __TRACE_H__
@@ -0,0 +1,82 @@
+/*===============================================================================
+Copyright (c) 2022 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#ifndef __TRIPLE_BUFFER_H__
+#define __TRIPLE_BUFFER_H__
+
+#include <atomic>
+#include <cstdint>
+
+
+/// Lock-free handoff of the latest value from one producer thread to one consumer thread
+/**
+ * The producer fills getWriteBuffer() and calls publish(). The consumer calls acquireLatest()
+ * and reads getReadBuffer(). Neither side ever waits for the other: the consumer always
+ * picks up the most recently published value and values it didn't pick up in time are
+ * overwritten. Each thread owns one of the three buffers at any time, the third is held
+ * in a shared slot that the threads swap their buffer with.
+ */
+template <typename T>
+class TripleBuffer
+{
+public:
+    /// Number of buffers
+    static constexpr int NUM_BUFFERS = 3;
+
+    /// The buffer owned by the producer, valid until the next call to publish
+    T& getWriteBuffer() { return mBuffers[mWriteIndex]; }
+
+    /// Make the write buffer available to the consumer
+    void publish()
+    {
+        uint8_t previous = mShared.exchange(static_cast<uint8_t>(mWriteIndex | NEW_DATA), std::memory_order_acq_rel);
+        mWriteIndex = previous & INDEX_MASK;
+    }
+
+    /// Swap the read buffer for the most recently published one
+    /// Returns false, leaving the read buffer unchanged, if nothing was published since the last call.
+    bool acquireLatest()
+    {
+        // Only the consumer clears NEW_DATA, so it is still set when the exchange happens
+        if ((mShared.load(std::memory_order_relaxed) & NEW_DATA) == 0)
+        {
+            return false;
+        }
+        uint8_t previous = mShared.exchange(mReadIndex, std::memory_order_acq_rel);
+        mReadIndex = previous & INDEX_MASK;
+        return true;
+    }
+
+    /// The buffer owned by the consumer, valid until the next call to acquireLatest
+    const T& getReadBuffer() const { return mBuffers[mReadIndex]; }
+
+    /// Access any of the buffers
+    /// This must only be used while neither the producer nor the consumer is running.
+    T& getBuffer(int index) { return mBuffers[index]; }
+
+    /// Return to the initial state with no value published
+    /// This must only be used while neither the producer nor the consumer is running.
+    void reset()
+    {
+        mWriteIndex = 0;
+        mShared.store(1, std::memory_order_relaxed);
+        mReadIndex = 2;
+    }
+
+private:
+    static constexpr uint8_t INDEX_MASK = 0x3;
+    static constexpr uint8_t NEW_DATA = 0x4;
+
+    T mBuffers[NUM_BUFFERS];
+
+    // The producer and consumer indices are kept on separate cache lines to avoid false sharing
+    alignas(64) uint8_t mWriteIndex { 0 };
+    alignas(64) std::atomic<uint8_t> mShared { 1 };
+    alignas(64) uint8_t mReadIndex { 2 };
+};
+
+#endif // __TRIPLE_BUFFER_H__
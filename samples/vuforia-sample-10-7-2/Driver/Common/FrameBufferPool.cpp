@@ -0,0 +1,149 @@
+/*===============================================================================
+Copyright (c) 2022 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#include "FrameBufferPool.h"
+
+#include <Log.h>
+
+#include <cassert>
+#include <new>
+
+
+bool FrameBufferPool::init(size_t bufferSize, uint32_t numBuffers)
+{
+    deinit();
+
+    if (bufferSize == 0 || numBuffers == 0 || numBuffers == END_OF_LIST)
+    {
+        LOG("Invalid frame buffer pool size");
+        return false;
+    }
+
+    mBufferSize = bufferSize;
+    mBufferStride = (bufferSize + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    mNumBuffers = numBuffers;
+
+    mMemory = static_cast<uint8_t*>(::operator new(mBufferStride * numBuffers, std::align_val_t(ALIGNMENT), std::nothrow));
+    if (mMemory == nullptr)
+    {
+        LOG("Failed to allocate %u frame buffers of %zu bytes", numBuffers, bufferSize);
+        deinit();
+        return false;
+    }
+
+    // Initially every buffer is free, linked in order
+    mNext.reset(new std::atomic<uint32_t>[numBuffers]);
+    for (uint32_t i = 0; i < numBuffers; ++i)
+    {
+        mNext[i].store(i + 1 < numBuffers ? i + 1 : END_OF_LIST, std::memory_order_relaxed);
+    }
+    mFreeHead.store(packHead(0, 0), std::memory_order_release);
+    return true;
+}
+
+
+bool FrameBufferPool::init(const VuforiaDriver::CameraMode& cameraMode, uint32_t numBuffers, uint32_t stride)
+{
+    return init(PixelConverter::fromDriverFormat(cameraMode.format), cameraMode.width, cameraMode.height,
+                numBuffers, stride);
+}
+
+
+bool FrameBufferPool::init(PixelConverter::Format format, uint32_t width, uint32_t height, uint32_t numBuffers,
+                           uint32_t stride)
+{
+    return init(PixelConverter::getImageSize(format, width, height, stride), numBuffers);
+}
+
+
+void FrameBufferPool::deinit()
+{
+    assert(mInUse.load() == 0);
+
+    if (mMemory != nullptr)
+    {
+        ::operator delete(mMemory, std::align_val_t(ALIGNMENT));
+        mMemory = nullptr;
+    }
+    mNext.reset();
+    mFreeHead.store(packHead(END_OF_LIST, 0), std::memory_order_relaxed);
+    mBufferSize = 0;
+    mBufferStride = 0;
+    mNumBuffers = 0;
+
+    mAcquired.store(0, std::memory_order_relaxed);
+    mReleased.store(0, std::memory_order_relaxed);
+    mExhausted.store(0, std::memory_order_relaxed);
+    mDropped.store(0, std::memory_order_relaxed);
+    mInUse.store(0, std::memory_order_relaxed);
+    mPeakInUse.store(0, std::memory_order_relaxed);
+}
+
+
+uint8_t* FrameBufferPool::acquire()
+{
+    uint64_t head = mFreeHead.load(std::memory_order_acquire);
+    for (;;)
+    {
+        uint32_t index = headIndex(head);
+        if (index == END_OF_LIST)
+        {
+            mExhausted.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        // If another thread takes this buffer first the tag changes and the exchange fails,
+        // so a stale next index read here is never installed
+        uint32_t next = mNext[index].load(std::memory_order_relaxed);
+        if (mFreeHead.compare_exchange_weak(head, packHead(next, headTag(head) + 1),
+                                            std::memory_order_acquire, std::memory_order_acquire))
+        {
+            mAcquired.fetch_add(1, std::memory_order_relaxed);
+            uint32_t inUse = mInUse.fetch_add(1, std::memory_order_relaxed) + 1;
+            uint32_t peak = mPeakInUse.load(std::memory_order_relaxed);
+            while (inUse > peak && !mPeakInUse.compare_exchange_weak(peak, inUse, std::memory_order_relaxed))
+            {
+            }
+            return mMemory + index * mBufferStride;
+        }
+    }
+}
+
+
+void FrameBufferPool::release(uint8_t* buffer)
+{
+    if (buffer == nullptr)
+    {
+        return;
+    }
+    assert(buffer >= mMemory && buffer < mMemory + mBufferStride * mNumBuffers);
+    assert((buffer - mMemory) % mBufferStride == 0);
+
+    uint32_t index = static_cast<uint32_t>((buffer - mMemory) / mBufferStride);
+    uint64_t head = mFreeHead.load(std::memory_order_relaxed);
+    do
+    {
+        mNext[index].store(headIndex(head), std::memory_order_relaxed);
+    } while (!mFreeHead.compare_exchange_weak(head, packHead(index, headTag(head) + 1),
+                                              std::memory_order_release, std::memory_order_relaxed));
+
+    mReleased.fetch_add(1, std::memory_order_relaxed);
+    mInUse.fetch_sub(1, std::memory_order_relaxed);
+}
+
+
+FrameBufferPool::Stats FrameBufferPool::getStats() const
+{
+    Stats stats;
+    stats.acquired = mAcquired.load(std::memory_order_relaxed);
+    stats.released = mReleased.load(std::memory_order_relaxed);
+    stats.exhausted = mExhausted.load(std::memory_order_relaxed);
+    stats.dropped = mDropped.load(std::memory_order_relaxed);
+    stats.inUse = mInUse.load(std::memory_order_relaxed);
+    stats.peakInUse = mPeakInUse.load(std::memory_order_relaxed);
+    return stats;
+}
@@ -0,0 +1,109 @@
+/*===============================================================================
+Copyright (c) 2022 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#ifndef __FRAME_BUFFER_POOL_H__
+#define __FRAME_BUFFER_POOL_H__
+
+#include "PixelConverter.h"
+
+#include <VuforiaEngine/Driver/Driver.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+
+/// Fixed set of equally sized frame buffers for Vuforia Driver implementations
+/**
+ * All the buffers are allocated up front in a single allocation, each starting on a cache
+ * line, so that capturing frames doesn't allocate. acquire() and release() are lock-free and
+ * may be called from any thread, e.g. a capture thread acquiring buffers and the thread
+ * delivering them to the CameraCallback releasing them. When all the buffers are in use
+ * acquire() fails instead of allocating, the caller is expected to drop the frame.
+ */
+class FrameBufferPool
+{
+public:
+    /// Alignment of every buffer in bytes
+    static constexpr size_t ALIGNMENT = 64;
+
+    /// Backpressure statistics, all counts are since init
+    struct Stats
+    {
+        uint64_t acquired { 0 };
+        uint64_t released { 0 };
+        /// Number of times acquire failed because all the buffers were in use
+        uint64_t exhausted { 0 };
+        /// Number of frames the driver reported as dropped
+        uint64_t dropped { 0 };
+        uint32_t inUse { 0 };
+        uint32_t peakInUse { 0 };
+    };
+
+    FrameBufferPool() = default;
+    FrameBufferPool(const FrameBufferPool&) = delete;
+    FrameBufferPool& operator=(const FrameBufferPool&) = delete;
+    ~FrameBufferPool() { deinit(); }
+
+    /// Allocate numBuffers buffers of bufferSize bytes
+    /// Any previous buffers are freed, none of them may still be in use.
+    bool init(size_t bufferSize, uint32_t numBuffers);
+
+    /// Allocate numBuffers buffers sized for frames in cameraMode
+    bool init(const VuforiaDriver::CameraMode& cameraMode, uint32_t numBuffers, uint32_t stride = 0);
+
+    /// Allocate numBuffers buffers sized for frames of any format PixelConverter knows, e.g. UYVY
+    /// The frame size is PixelConverter::getImageSize, stride as described there.
+    bool init(PixelConverter::Format format, uint32_t width, uint32_t height, uint32_t numBuffers, uint32_t stride = 0);
+
+    /// Free the buffers, none of them may still be in use
+    void deinit();
+
+    /// Take a buffer from the pool, returns nullptr if all the buffers are in use
+    uint8_t* acquire();
+
+    /// Return a buffer obtained from acquire to the pool
+    void release(uint8_t* buffer);
+
+    /// Count a frame that the driver dropped, e.g. because acquire failed or it was late
+    void recordDroppedFrame() { mDropped.fetch_add(1, std::memory_order_relaxed); }
+
+    size_t getBufferSize() const { return mBufferSize; }
+    uint32_t getNumBuffers() const { return mNumBuffers; }
+
+    Stats getStats() const;
+
+private:
+    /// Index marking the end of the free list
+    static constexpr uint32_t END_OF_LIST = UINT32_MAX;
+
+    /// The free list head packs the index of the first free buffer in the low 32 bits with a
+    /// tag in the high 32 bits that changes on every update, which prevents the ABA problem
+    static uint64_t packHead(uint32_t index, uint32_t tag) { return (static_cast<uint64_t>(tag) << 32) | index; }
+    static uint32_t headIndex(uint64_t head) { return static_cast<uint32_t>(head); }
+    static uint32_t headTag(uint64_t head) { return static_cast<uint32_t>(head >> 32); }
+
+    uint8_t* mMemory { nullptr };
+    size_t mBufferSize { 0 };
+    /// Distance between consecutive buffers, mBufferSize rounded up to ALIGNMENT
+    size_t mBufferStride { 0 };
+    uint32_t mNumBuffers { 0 };
+
+    /// Index of the next free buffer for each free buffer
+    std::unique_ptr<std::atomic<uint32_t>[]> mNext;
+    alignas(ALIGNMENT) std::atomic<uint64_t> mFreeHead { packHead(END_OF_LIST, 0) };
+
+    alignas(ALIGNMENT) std::atomic<uint64_t> mAcquired { 0 };
+    std::atomic<uint64_t> mReleased { 0 };
+    std::atomic<uint64_t> mExhausted { 0 };
+    std::atomic<uint64_t> mDropped { 0 };
+    std::atomic<uint32_t> mInUse { 0 };
+    std::atomic<uint32_t> mPeakInUse { 0 };
+};
+
+#endif // __FRAME_BUFFER_POOL_H__
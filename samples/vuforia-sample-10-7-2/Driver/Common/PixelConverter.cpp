@@ -0,0 +1,460 @@
+/*===============================================================================
+Copyright (c) 2022 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#include "PixelConverter.h"
+
+#include "PixelConverterKernels.h"
+
+#include <atomic>
+#include <cstring>
+#include <initializer_list>
+
+
+using namespace PixelConverterKernels;
+
+namespace
+{
+
+/*===============================================================================
+Scalar kernels
+===============================================================================*/
+
+/// Packed 4:2:2 with the byte offsets of the components in each 4 byte macropixel
+template <int Y0, int U, int Y1, int V, bool SWAP_CHROMA>
+uint32_t packed422ToSemiPlanar(const uint8_t* src0, const uint8_t* src1,
+                               uint8_t* y0, uint8_t* y1, uint8_t* chroma, uint32_t width)
+{
+    for (uint32_t x = 0; x < width; x += 2)
+    {
+        const uint8_t* a = src0 + x * 2;
+        const uint8_t* b = src1 + x * 2;
+        y0[x] = a[Y0];
+        y0[x + 1] = a[Y1];
+        y1[x] = b[Y0];
+        y1[x + 1] = b[Y1];
+        uint8_t u = static_cast<uint8_t>((a[U] + b[U] + 1) >> 1);
+        uint8_t v = static_cast<uint8_t>((a[V] + b[V] + 1) >> 1);
+        chroma[x] = SWAP_CHROMA ? v : u;
+        chroma[x + 1] = SWAP_CHROMA ? u : v;
+    }
+    return width;
+}
+
+
+template <int BYTES_PER_PIXEL, bool SWAP_CHROMA>
+uint32_t rgbToSemiPlanar(const uint8_t* src0, const uint8_t* src1,
+                         uint8_t* y0, uint8_t* y1, uint8_t* chroma, uint32_t width)
+{
+    for (uint32_t x = 0; x < width; x += 2)
+    {
+        // The last column of an odd width is paired with itself
+        uint32_t x1 = x + 1 < width ? x + 1 : x;
+        const uint8_t* a0 = src0 + x * BYTES_PER_PIXEL;
+        const uint8_t* a1 = src0 + x1 * BYTES_PER_PIXEL;
+        const uint8_t* b0 = src1 + x * BYTES_PER_PIXEL;
+        const uint8_t* b1 = src1 + x1 * BYTES_PER_PIXEL;
+
+        y0[x] = rgbToY(a0[0], a0[1], a0[2]);
+        y1[x] = rgbToY(b0[0], b0[1], b0[2]);
+        if (x1 != x)
+        {
+            y0[x1] = rgbToY(a1[0], a1[1], a1[2]);
+            y1[x1] = rgbToY(b1[0], b1[1], b1[2]);
+        }
+
+        int r = average4(a0[0] + a1[0] + b0[0] + b1[0]);
+        int g = average4(a0[1] + a1[1] + b0[1] + b1[1]);
+        int b = average4(a0[2] + a1[2] + b0[2] + b1[2]);
+        uint8_t u = rgbToU(r, g, b);
+        uint8_t v = rgbToV(r, g, b);
+        chroma[x] = SWAP_CHROMA ? v : u;
+        chroma[x + 1] = SWAP_CHROMA ? u : v;
+    }
+    return width;
+}
+
+
+uint32_t interleave(const uint8_t* first, const uint8_t* second, uint8_t* out, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        out[2 * i] = first[i];
+        out[2 * i + 1] = second[i];
+    }
+    return count;
+}
+
+
+Kernels createScalarKernels()
+{
+    Kernels kernels;
+    kernels.yuyvToNv12 = packed422ToSemiPlanar<0, 1, 2, 3, false>;
+    kernels.yuyvToNv21 = packed422ToSemiPlanar<0, 1, 2, 3, true>;
+    kernels.uyvyToNv12 = packed422ToSemiPlanar<1, 0, 3, 2, false>;
+    kernels.uyvyToNv21 = packed422ToSemiPlanar<1, 0, 3, 2, true>;
+    kernels.rgbToNv12 = rgbToSemiPlanar<3, false>;
+    kernels.rgbToNv21 = rgbToSemiPlanar<3, true>;
+    kernels.rgbaToNv12 = rgbToSemiPlanar<4, false>;
+    kernels.rgbaToNv21 = rgbToSemiPlanar<4, true>;
+    kernels.interleave = interleave;
+    return kernels;
+}
+
+
+/*===============================================================================
+Dispatch
+===============================================================================*/
+
+bool cpuSupports(PixelConverter::Implementation implementation)
+{
+    switch (implementation)
+    {
+        case PixelConverter::Implementation::SCALAR:
+            return true;
+#if defined(__x86_64__) || defined(__i386__)
+        case PixelConverter::Implementation::SSE2:
+            return __builtin_cpu_supports("sse2");
+        case PixelConverter::Implementation::AVX2:
+            return __builtin_cpu_supports("avx2");
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+        case PixelConverter::Implementation::NEON:
+            return true;
+#endif
+        default:
+            return false;
+    }
+}
+
+
+const Kernels& getKernels(PixelConverter::Implementation implementation)
+{
+    switch (implementation)
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        case PixelConverter::Implementation::SSE2:
+            return getSse2Kernels();
+        case PixelConverter::Implementation::AVX2:
+            return getAvx2Kernels();
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+        case PixelConverter::Implementation::NEON:
+            return getNeonKernels();
+#endif
+        default:
+            return getScalarKernels();
+    }
+}
+
+
+PixelConverter::Implementation selectBestImplementation()
+{
+    using Implementation = PixelConverter::Implementation;
+    for (Implementation implementation : { Implementation::NEON, Implementation::AVX2, Implementation::SSE2 })
+    {
+        if (cpuSupports(implementation))
+        {
+            return implementation;
+        }
+    }
+    return Implementation::SCALAR;
+}
+
+
+std::atomic<PixelConverter::Implementation>& currentImplementation()
+{
+    static std::atomic<PixelConverter::Implementation> implementation { selectBestImplementation() };
+    return implementation;
+}
+
+
+/// Pick the kernel converting from srcFormat into NV12 (swapChroma false) or NV21
+RowPairKernel selectRowPairKernel(const Kernels& kernels, PixelConverter::Format srcFormat, bool swapChroma)
+{
+    using Format = PixelConverter::Format;
+    switch (srcFormat)
+    {
+        case Format::YUYV:
+            return swapChroma ? kernels.yuyvToNv21 : kernels.yuyvToNv12;
+        case Format::UYVY:
+            return swapChroma ? kernels.uyvyToNv21 : kernels.uyvyToNv12;
+        case Format::RGB888:
+            return swapChroma ? kernels.rgbToNv21 : kernels.rgbToNv12;
+        case Format::RGBA8888:
+            return swapChroma ? kernels.rgbaToNv21 : kernels.rgbaToNv12;
+        default:
+            return nullptr;
+    }
+}
+
+
+void copyRows(const uint8_t* src, uint32_t srcStride, uint8_t* dst, uint32_t dstStride, uint32_t rowSize, uint32_t numRows)
+{
+    for (uint32_t row = 0; row < numRows; ++row)
+    {
+        memcpy(dst + row * dstStride, src + row * srcStride, rowSize);
+    }
+}
+
+} // namespace
+
+
+const Kernels& PixelConverterKernels::getScalarKernels()
+{
+    static const Kernels kernels = createScalarKernels();
+    return kernels;
+}
+
+
+bool PixelConverter::convert(Format srcFormat, const uint8_t* src, uint32_t srcStride,
+                             Format dstFormat, uint8_t* dst, uint32_t dstStride,
+                             uint32_t width, uint32_t height)
+{
+    if (!isSupported(srcFormat, dstFormat) || src == nullptr || dst == nullptr || width == 0 || height == 0)
+    {
+        return false;
+    }
+    if ((srcFormat == Format::YUYV || srcFormat == Format::UYVY) && (width & 1) != 0)
+    {
+        return false;
+    }
+
+    srcStride = srcStride != 0 ? srcStride : getPackedStride(srcFormat, width);
+    dstStride = dstStride != 0 ? dstStride : getPackedStride(dstFormat, width);
+
+    const bool swapChroma = dstFormat == Format::NV21;
+    const uint32_t chromaWidth = (width + 1) / 2;
+    const uint32_t chromaHeight = (height + 1) / 2;
+    uint8_t* dstChroma = dst + static_cast<size_t>(dstStride) * height;
+    const Kernels& kernels = getKernels(getImplementation());
+    const Kernels& scalarKernels = getScalarKernels();
+
+    switch (srcFormat)
+    {
+        case Format::NV12:
+        case Format::NV21:
+        {
+            copyRows(src, srcStride, dst, dstStride, width, height);
+            const uint8_t* srcChroma = src + static_cast<size_t>(srcStride) * height;
+            if (srcFormat == dstFormat)
+            {
+                copyRows(srcChroma, srcStride, dstChroma, dstStride, chromaWidth * 2, chromaHeight);
+                return true;
+            }
+            for (uint32_t row = 0; row < chromaHeight; ++row)
+            {
+                const uint8_t* in = srcChroma + row * static_cast<size_t>(srcStride);
+                uint8_t* out = dstChroma + row * static_cast<size_t>(dstStride);
+                for (uint32_t x = 0; x < chromaWidth * 2; x += 2)
+                {
+                    out[x] = in[x + 1];
+                    out[x + 1] = in[x];
+                }
+            }
+            return true;
+        }
+
+        case Format::YUV420P:
+        case Format::YV12:
+        {
+            copyRows(src, srcStride, dst, dstStride, width, height);
+            const uint32_t srcChromaStride = srcStride / 2;
+            const uint8_t* firstPlane = src + static_cast<size_t>(srcStride) * height;
+            const uint8_t* secondPlane = firstPlane + static_cast<size_t>(srcChromaStride) * chromaHeight;
+            // YUV420P stores U then V, YV12 V then U
+            const uint8_t* uPlane = srcFormat == Format::YUV420P ? firstPlane : secondPlane;
+            const uint8_t* vPlane = srcFormat == Format::YUV420P ? secondPlane : firstPlane;
+            const uint8_t* first = swapChroma ? vPlane : uPlane;
+            const uint8_t* second = swapChroma ? uPlane : vPlane;
+            for (uint32_t row = 0; row < chromaHeight; ++row)
+            {
+                size_t offset = row * static_cast<size_t>(srcChromaStride);
+                uint8_t* out = dstChroma + row * static_cast<size_t>(dstStride);
+                uint32_t done = kernels.interleave(first + offset, second + offset, out, chromaWidth);
+                scalarKernels.interleave(first + offset + done, second + offset + done, out + 2 * done, chromaWidth - done);
+            }
+            return true;
+        }
+
+        default:
+        {
+            RowPairKernel kernel = selectRowPairKernel(kernels, srcFormat, swapChroma);
+            RowPairKernel scalarKernel = selectRowPairKernel(scalarKernels, srcFormat, swapChroma);
+            const uint32_t bytesPerPixel = getPackedStride(srcFormat, 1);
+            for (uint32_t row = 0; row < height; row += 2)
+            {
+                // The last row of an odd height is paired with itself
+                uint32_t row1 = row + 1 < height ? row + 1 : row;
+                const uint8_t* src0 = src + row * static_cast<size_t>(srcStride);
+                const uint8_t* src1 = src + row1 * static_cast<size_t>(srcStride);
+                uint8_t* y0 = dst + row * static_cast<size_t>(dstStride);
+                uint8_t* y1 = dst + row1 * static_cast<size_t>(dstStride);
+                uint8_t* chroma = dstChroma + (row / 2) * static_cast<size_t>(dstStride);
+
+                uint32_t done = kernel != nullptr ? kernel(src0, src1, y0, y1, chroma, width) : 0;
+                if (done < width)
+                {
+                    size_t srcOffset = done * bytesPerPixel;
+                    scalarKernel(src0 + srcOffset, src1 + srcOffset, y0 + done, y1 + done, chroma + done, width - done);
+                }
+            }
+            return true;
+        }
+    }
+}
+
+
+bool PixelConverter::isSupported(Format srcFormat, Format dstFormat)
+{
+    if (dstFormat != Format::NV12 && dstFormat != Format::NV21)
+    {
+        return false;
+    }
+    return srcFormat != Format::UNKNOWN;
+}
+
+
+size_t PixelConverter::getImageSize(Format format, uint32_t width, uint32_t height, uint32_t stride)
+{
+    stride = stride != 0 ? stride : getPackedStride(format, width);
+    switch (format)
+    {
+        case Format::NV12:
+        case Format::NV21:
+        case Format::YUV420P:
+        case Format::YV12:
+            // Full resolution Y plane followed by the chroma planes at a quarter of its size
+            return static_cast<size_t>(stride) * (height + (height + 1) / 2);
+        case Format::UNKNOWN:
+            return 0;
+        default:
+            return static_cast<size_t>(stride) * height;
+    }
+}
+
+
+uint32_t PixelConverter::getPackedStride(Format format, uint32_t width)
+{
+    switch (format)
+    {
+        case Format::NV12:
+        case Format::NV21:
+            // The interleaved chroma rows of an odd width are a byte longer than the Y rows
+            return width + (width & 1);
+        case Format::YUV420P:
+        case Format::YV12:
+            // The chroma planes have half the stride
+            return width + (width & 1);
+        case Format::YUYV:
+        case Format::UYVY:
+            return width * 2;
+        case Format::RGB888:
+            return width * 3;
+        case Format::RGBA8888:
+            return width * 4;
+        default:
+            return 0;
+    }
+}
+
+
+VuforiaDriver::PixelFormat PixelConverter::toDriverFormat(Format format)
+{
+    using VuforiaDriver::PixelFormat;
+    switch (format)
+    {
+        case Format::NV12: return PixelFormat::NV12;
+        case Format::NV21: return PixelFormat::NV21;
+        case Format::YUV420P: return PixelFormat::YUV420P;
+        case Format::YV12: return PixelFormat::YV12;
+        case Format::YUYV: return PixelFormat::YUYV;
+        case Format::RGB888: return PixelFormat::RGB888;
+        case Format::RGBA8888: return PixelFormat::RGBA8888;
+        default: return PixelFormat::UNKNOWN;
+    }
+}
+
+
+PixelConverter::Format PixelConverter::fromDriverFormat(VuforiaDriver::PixelFormat format)
+{
+    using VuforiaDriver::PixelFormat;
+    switch (format)
+    {
+        case PixelFormat::NV12: return Format::NV12;
+        case PixelFormat::NV21: return Format::NV21;
+        case PixelFormat::YUV420P: return Format::YUV420P;
+        case PixelFormat::YV12: return Format::YV12;
+        case PixelFormat::YUYV: return Format::YUYV;
+        case PixelFormat::RGB888: return Format::RGB888;
+        case PixelFormat::RGBA8888: return Format::RGBA8888;
+        default: return Format::UNKNOWN;
+    }
+}
+
+
+PixelConverter::Format PixelConverter::parseFormat(const char* name)
+{
+    static const struct
+    {
+        const char* name;
+        Format format;
+    } formats[] = {
+        { "NV12", Format::NV12 },
+        { "NV21", Format::NV21 },
+        { "YUV420P", Format::YUV420P },
+        { "YV12", Format::YV12 },
+        { "YUYV", Format::YUYV },
+        { "UYVY", Format::UYVY },
+        { "RGB888", Format::RGB888 },
+        { "RGBA8888", Format::RGBA8888 },
+    };
+
+    for (const auto& entry : formats)
+    {
+        if (strcmp(entry.name, name) == 0)
+        {
+            return entry.format;
+        }
+    }
+    return Format::UNKNOWN;
+}
+
+
+PixelConverter::Implementation PixelConverter::getImplementation()
+{
+    return currentImplementation().load(std::memory_order_relaxed);
+}
+
+
+bool PixelConverter::setImplementation(Implementation implementation)
+{
+    if (!cpuSupports(implementation))
+    {
+        return false;
+    }
+    currentImplementation().store(implementation, std::memory_order_relaxed);
+    return true;
+}
+
+
+bool PixelConverter::isImplementationSupported(Implementation implementation)
+{
+    return cpuSupports(implementation);
+}
+
+
+const char* PixelConverter::getImplementationName(Implementation implementation)
+{
+    switch (implementation)
+    {
+        case Implementation::SCALAR: return "scalar";
+        case Implementation::SSE2: return "SSE2";
+        case Implementation::AVX2: return "AVX2";
+        case Implementation::NEON: return "NEON";
+        default: return "unknown";
+    }
+}
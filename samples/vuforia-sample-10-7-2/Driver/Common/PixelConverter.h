@@ -0,0 +1,92 @@
+/*===============================================================================
+Copyright (c) 2022 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#ifndef __PIXEL_CONVERTER_H__
+#define __PIXEL_CONVERTER_H__
+
+#include <VuforiaEngine/Driver/Driver.h>
+
+#include <cstddef>
+#include <cstdint>
+
+
+/// Converts camera frames into the semi-planar YUV formats Vuforia tracks best on
+/**
+ * Packed 4:2:2 YUV, RGB and planar 4:2:0 YUV frames are converted into NV12 or NV21.
+ * The conversion uses NEON on ARM and SSE2 or AVX2 on x86 where the CPU supports them,
+ * the implementation is selected at runtime. RGB is converted with the BT.601 limited
+ * range coefficients, chroma is averaged over each 2x2 block of pixels.
+ *
+ * Strides follow the VuforiaDriver::CameraFrame conventions: the stride of a packed format
+ * is the bytes per row, for the YUV 4:2:0 formats it is the stride of the Y plane, the
+ * interleaved chroma plane of NV12 and NV21 has the same stride and the U and V planes of
+ * YUV420P and YV12 have half of it. A stride of 0 means the rows are tightly packed.
+ */
+class PixelConverter
+{
+public:
+    /// Pixel formats, a superset of VuforiaDriver::PixelFormat
+    enum class Format : int32_t
+    {
+        UNKNOWN,
+        NV12,
+        NV21,
+        YUV420P,
+        YV12,
+        YUYV,
+        UYVY,       ///< YUV 4:2:2, single 16-bit interleaved plane ordered U Y0 V Y1
+        RGB888,
+        RGBA8888,
+    };
+
+    /// The conversion kernels, in order of preference
+    enum class Implementation : int32_t
+    {
+        SCALAR,
+        SSE2,       ///< 128-bit SSE2, RGB888 uses SSSE3 if the CPU has it and is scalar otherwise
+        AVX2,       ///< 256-bit AVX2 for every format
+        NEON,
+    };
+
+    /// Convert width x height pixels from src to dst
+    /// dstFormat must be NV12 or NV21. Returns false if the conversion isn't supported,
+    /// the packed 4:2:2 formats require an even width.
+    static bool convert(Format srcFormat, const uint8_t* src, uint32_t srcStride,
+                        Format dstFormat, uint8_t* dst, uint32_t dstStride,
+                        uint32_t width, uint32_t height);
+
+    /// Check whether convert supports a pair of formats
+    static bool isSupported(Format srcFormat, Format dstFormat);
+
+    /// Size in bytes of an image, stride as described above
+    static size_t getImageSize(Format format, uint32_t width, uint32_t height, uint32_t stride = 0);
+
+    /// Stride of a tightly packed image
+    static uint32_t getPackedStride(Format format, uint32_t width);
+
+    /// Map to and from the formats Vuforia accepts
+    /// toDriverFormat returns VuforiaDriver::PixelFormat::UNKNOWN for formats Vuforia doesn't accept.
+    static VuforiaDriver::PixelFormat toDriverFormat(Format format);
+    static Format fromDriverFormat(VuforiaDriver::PixelFormat format);
+
+    /// Parse a format name, e.g. "NV21", returns Format::UNKNOWN if the name isn't known
+    static Format parseFormat(const char* name);
+
+    /// The implementation used by convert
+    static Implementation getImplementation();
+
+    /// Select the implementation used by convert, e.g. to compare them
+    /// Returns false, leaving the implementation unchanged, if the CPU doesn't support it.
+    static bool setImplementation(Implementation implementation);
+
+    /// Check whether the CPU supports an implementation
+    static bool isImplementationSupported(Implementation implementation);
+
+    static const char* getImplementationName(Implementation implementation);
+};
+
+#endif // __PIXEL_CONVERTER_H__
@@ -0,0 +1,77 @@
+/*===============================================================================
+Copyright (c) 2022 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#ifndef __PIXEL_CONVERTER_KERNELS_H__
+#define __PIXEL_CONVERTER_KERNELS_H__
+
+#include <cstdint>
+
+
+/// Row kernels used by PixelConverter, one set per instruction set
+/**
+ * A row pair kernel converts two source rows into two Y rows and the interleaved chroma row
+ * they share. The kernels may stop short of width, they return the number of pixels
+ * converted, which is always even, and PixelConverter converts the rest with the scalar
+ * kernels. The two source rows may be the same row, as may the two Y rows.
+ */
+namespace PixelConverterKernels
+{
+
+using RowPairKernel = uint32_t (*)(const uint8_t* src0, const uint8_t* src1,
+                                   uint8_t* y0, uint8_t* y1, uint8_t* chroma, uint32_t width);
+
+/// Interleave count bytes of first and second into out, returns the number of bytes interleaved
+using InterleaveKernel = uint32_t (*)(const uint8_t* first, const uint8_t* second, uint8_t* out, uint32_t count);
+
+/// Kernels for one instruction set, entries are nullptr where the scalar kernel is used
+struct Kernels
+{
+    RowPairKernel yuyvToNv12 { nullptr };
+    RowPairKernel yuyvToNv21 { nullptr };
+    RowPairKernel uyvyToNv12 { nullptr };
+    RowPairKernel uyvyToNv21 { nullptr };
+    RowPairKernel rgbToNv12 { nullptr };
+    RowPairKernel rgbToNv21 { nullptr };
+    RowPairKernel rgbaToNv12 { nullptr };
+    RowPairKernel rgbaToNv21 { nullptr };
+    InterleaveKernel interleave { nullptr };
+};
+
+// BT.601 limited range conversion, all kernels must produce identical results
+inline uint8_t rgbToY(int r, int g, int b)
+{
+    return static_cast<uint8_t>(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+}
+
+inline uint8_t rgbToU(int r, int g, int b)
+{
+    return static_cast<uint8_t>(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+}
+
+inline uint8_t rgbToV(int r, int g, int b)
+{
+    return static_cast<uint8_t>(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+}
+
+/// Rounded average of the 2x2 block sum of a channel
+inline int average4(int sum)
+{
+    return (sum + 2) >> 2;
+}
+
+const Kernels& getScalarKernels();
+#if defined(__x86_64__) || defined(__i386__)
+const Kernels& getSse2Kernels();
+const Kernels& getAvx2Kernels();
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+const Kernels& getNeonKernels();
+#endif
+
+} // namespace PixelConverterKernels
+
+#endif // __PIXEL_CONVERTER_KERNELS_H__
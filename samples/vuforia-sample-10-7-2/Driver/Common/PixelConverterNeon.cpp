@@ -0,0 +1,164 @@
+/*===============================================================================
+Copyright (c) 2022 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+// NEON kernels for PixelConverter
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+
+#include "PixelConverterKernels.h"
+
+#include <arm_neon.h>
+
+
+using namespace PixelConverterKernels;
+
+namespace
+{
+
+/// Packed 4:2:2 with the index of the components in each 4 byte macropixel
+template <int Y0, int U, int Y1, int V, bool SWAP_CHROMA>
+uint32_t packed422Neon(const uint8_t* src0, const uint8_t* src1,
+                       uint8_t* y0, uint8_t* y1, uint8_t* chroma, uint32_t width)
+{
+    uint32_t x = 0;
+    for (; x + 32 <= width; x += 32)
+    {
+        // Deinterleave 16 macropixels per row
+        uint8x16x4_t a = vld4q_u8(src0 + x * 2);
+        uint8x16x4_t b = vld4q_u8(src1 + x * 2);
+
+        uint8x16x2_t rowY0 = { { a.val[Y0], a.val[Y1] } };
+        uint8x16x2_t rowY1 = { { b.val[Y0], b.val[Y1] } };
+        vst2q_u8(y0 + x, rowY0);
+        vst2q_u8(y1 + x, rowY1);
+
+        uint8x16_t u = vrhaddq_u8(a.val[U], b.val[U]);
+        uint8x16_t v = vrhaddq_u8(a.val[V], b.val[V]);
+        uint8x16x2_t uv = { { SWAP_CHROMA ? v : u, SWAP_CHROMA ? u : v } };
+        vst2q_u8(chroma + x, uv);
+    }
+    return x;
+}
+
+
+/// Y of 8 pixels, see rgbToY
+inline uint8x8_t computeY(uint8x8_t r, uint8x8_t g, uint8x8_t b)
+{
+    uint16x8_t sum = vmull_u8(r, vdup_n_u8(66));
+    sum = vmlal_u8(sum, g, vdup_n_u8(129));
+    sum = vmlal_u8(sum, b, vdup_n_u8(25));
+    sum = vaddq_u16(sum, vdupq_n_u16(128));
+    return vadd_u8(vshrn_n_u16(sum, 8), vdup_n_u8(16));
+}
+
+
+/// Average each 2x2 block of a channel over two rows of 16 pixels, see average4
+inline int16x8_t averageBlocks(uint8x16_t row0, uint8x16_t row1)
+{
+    uint16x8_t sum = vaddq_u16(vpaddlq_u8(row0), vpaddlq_u8(row1));
+    return vreinterpretq_s16_u16(vrshrq_n_u16(sum, 2));
+}
+
+
+/// One chroma component of 8 blocks, see rgbToU and rgbToV
+inline uint8x8_t computeChroma(int16x8_t r, int16x8_t g, int16x8_t b, int16_t rc, int16_t gc, int16_t bc)
+{
+    int16x8_t sum = vmulq_n_s16(r, rc);
+    sum = vmlaq_n_s16(sum, g, gc);
+    sum = vmlaq_n_s16(sum, b, bc);
+    sum = vaddq_s16(sum, vdupq_n_s16(128));
+    return vqmovun_s16(vaddq_s16(vshrq_n_s16(sum, 8), vdupq_n_s16(128)));
+}
+
+
+/// Convert 16 pixels of two rows given as deinterleaved channels
+template <bool SWAP_CHROMA>
+inline void convertRgbBlock(uint8x16_t r0, uint8x16_t g0, uint8x16_t b0,
+                            uint8x16_t r1, uint8x16_t g1, uint8x16_t b1,
+                            uint8_t* y0, uint8_t* y1, uint8_t* chroma)
+{
+    vst1q_u8(y0, vcombine_u8(computeY(vget_low_u8(r0), vget_low_u8(g0), vget_low_u8(b0)),
+                             computeY(vget_high_u8(r0), vget_high_u8(g0), vget_high_u8(b0))));
+    vst1q_u8(y1, vcombine_u8(computeY(vget_low_u8(r1), vget_low_u8(g1), vget_low_u8(b1)),
+                             computeY(vget_high_u8(r1), vget_high_u8(g1), vget_high_u8(b1))));
+
+    int16x8_t r = averageBlocks(r0, r1);
+    int16x8_t g = averageBlocks(g0, g1);
+    int16x8_t b = averageBlocks(b0, b1);
+    uint8x8_t u = computeChroma(r, g, b, -38, -74, 112);
+    uint8x8_t v = computeChroma(r, g, b, 112, -94, -18);
+    uint8x8x2_t uv = { { SWAP_CHROMA ? v : u, SWAP_CHROMA ? u : v } };
+    vst2_u8(chroma, uv);
+}
+
+
+template <bool SWAP_CHROMA>
+uint32_t rgbNeon(const uint8_t* src0, const uint8_t* src1,
+                 uint8_t* y0, uint8_t* y1, uint8_t* chroma, uint32_t width)
+{
+    uint32_t x = 0;
+    for (; x + 16 <= width; x += 16)
+    {
+        uint8x16x3_t a = vld3q_u8(src0 + x * 3);
+        uint8x16x3_t b = vld3q_u8(src1 + x * 3);
+        convertRgbBlock<SWAP_CHROMA>(a.val[0], a.val[1], a.val[2], b.val[0], b.val[1], b.val[2],
+                                     y0 + x, y1 + x, chroma + x);
+    }
+    return x;
+}
+
+
+template <bool SWAP_CHROMA>
+uint32_t rgbaNeon(const uint8_t* src0, const uint8_t* src1,
+                  uint8_t* y0, uint8_t* y1, uint8_t* chroma, uint32_t width)
+{
+    uint32_t x = 0;
+    for (; x + 16 <= width; x += 16)
+    {
+        uint8x16x4_t a = vld4q_u8(src0 + x * 4);
+        uint8x16x4_t b = vld4q_u8(src1 + x * 4);
+        convertRgbBlock<SWAP_CHROMA>(a.val[0], a.val[1], a.val[2], b.val[0], b.val[1], b.val[2],
+                                     y0 + x, y1 + x, chroma + x);
+    }
+    return x;
+}
+
+
+uint32_t interleaveNeon(const uint8_t* first, const uint8_t* second, uint8_t* out, uint32_t count)
+{
+    uint32_t i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        uint8x16x2_t pairs = { { vld1q_u8(first + i), vld1q_u8(second + i) } };
+        vst2q_u8(out + 2 * i, pairs);
+    }
+    return i;
+}
+
+} // namespace
+
+
+const Kernels& PixelConverterKernels::getNeonKernels()
+{
+    static const Kernels kernels = []()
+    {
+        Kernels k;
+        k.yuyvToNv12 = packed422Neon<0, 1, 2, 3, false>;
+        k.yuyvToNv21 = packed422Neon<0, 1, 2, 3, true>;
+        k.uyvyToNv12 = packed422Neon<1, 0, 3, 2, false>;
+        k.uyvyToNv21 = packed422Neon<1, 0, 3, 2, true>;
+        k.rgbToNv12 = rgbNeon<false>;
+        k.rgbToNv21 = rgbNeon<true>;
+        k.rgbaToNv12 = rgbaNeon<false>;
+        k.rgbaToNv21 = rgbaNeon<true>;
+        k.interleave = interleaveNeon;
+        return k;
+    }();
+    return kernels;
+}
+
+#endif // defined(__ARM_NEON) || defined(__ARM_NEON__)
@@ -0,0 +1,465 @@
+/*===============================================================================
+Copyright (c) 2022 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+// SSE2, SSSE3 and AVX2 kernels for PixelConverter
+// The kernels are compiled with target attributes so the rest of the library doesn't
+// require AVX2, PixelConverter only selects them when the CPU supports them. SSE2 has no
+// byte shuffle to expand RGB888 pixels, so the SSE2 set converts RGB888 with an SSSE3
+// kernel where the CPU supports SSSE3 and with the scalar kernel otherwise.
+
+#if defined(__x86_64__) || defined(__i386__)
+
+#include "PixelConverterKernels.h"
+
+#include <immintrin.h>
+
+
+using namespace PixelConverterKernels;
+
+namespace
+{
+
+#define SSE2_TARGET __attribute__((target("sse2")))
+#define SSSE3_TARGET __attribute__((target("ssse3")))
+#define AVX2_TARGET __attribute__((target("avx2")))
+
+
+/*===============================================================================
+Packed 4:2:2
+===============================================================================*/
+
+/// Swap the bytes of each 16-bit lane, turning UV pairs into VU pairs
+SSE2_TARGET inline __m128i swapBytes(__m128i value)
+{
+    return _mm_or_si128(_mm_slli_epi16(value, 8), _mm_srli_epi16(value, 8));
+}
+
+
+/// Split 8 macropixels (16 pixels) into their Y and interleaved chroma bytes
+template <bool Y_FIRST>
+SSE2_TARGET inline void splitPacked422(const uint8_t* src, __m128i& y, __m128i& chroma)
+{
+    const __m128i lowBytes = _mm_set1_epi16(0x00FF);
+    __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+    __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 16));
+    __m128i even = _mm_packus_epi16(_mm_and_si128(a, lowBytes), _mm_and_si128(b, lowBytes));
+    __m128i odd = _mm_packus_epi16(_mm_srli_epi16(a, 8), _mm_srli_epi16(b, 8));
+    y = Y_FIRST ? even : odd;
+    chroma = Y_FIRST ? odd : even;
+}
+
+
+template <bool Y_FIRST, bool SWAP_CHROMA>
+SSE2_TARGET uint32_t packed422Sse2(const uint8_t* src0, const uint8_t* src1,
+                                   uint8_t* y0, uint8_t* y1, uint8_t* chroma, uint32_t width)
+{
+    uint32_t x = 0;
+    for (; x + 16 <= width; x += 16)
+    {
+        __m128i rowY0, rowY1, chroma0, chroma1;
+        splitPacked422<Y_FIRST>(src0 + x * 2, rowY0, chroma0);
+        splitPacked422<Y_FIRST>(src1 + x * 2, rowY1, chroma1);
+        __m128i uv = _mm_avg_epu8(chroma0, chroma1);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(y0 + x), rowY0);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(y1 + x), rowY1);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(chroma + x), SWAP_CHROMA ? swapBytes(uv) : uv);
+    }
+    return x;
+}
+
+
+/// Split 16 macropixels (32 pixels) into their Y and interleaved chroma bytes
+template <bool Y_FIRST>
+AVX2_TARGET inline void splitPacked422(const uint8_t* src, __m256i& y, __m256i& chroma)
+{
+    const __m256i lowBytes = _mm256_set1_epi16(0x00FF);
+    __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+    __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 32));
+    // The packs work within each 128-bit lane, the permute restores the pixel order
+    __m256i even = _mm256_permute4x64_epi64(_mm256_packus_epi16(_mm256_and_si256(a, lowBytes), _mm256_and_si256(b, lowBytes)), 0xD8);
+    __m256i odd = _mm256_permute4x64_epi64(_mm256_packus_epi16(_mm256_srli_epi16(a, 8), _mm256_srli_epi16(b, 8)), 0xD8);
+    y = Y_FIRST ? even : odd;
+    chroma = Y_FIRST ? odd : even;
+}
+
+
+template <bool Y_FIRST, bool SWAP_CHROMA>
+AVX2_TARGET uint32_t packed422Avx2(const uint8_t* src0, const uint8_t* src1,
+                                   uint8_t* y0, uint8_t* y1, uint8_t* chroma, uint32_t width)
+{
+    uint32_t x = 0;
+    for (; x + 32 <= width; x += 32)
+    {
+        __m256i rowY0, rowY1, chroma0, chroma1;
+        splitPacked422<Y_FIRST>(src0 + x * 2, rowY0, chroma0);
+        splitPacked422<Y_FIRST>(src1 + x * 2, rowY1, chroma1);
+        __m256i uv = _mm256_avg_epu8(chroma0, chroma1);
+        if (SWAP_CHROMA)
+        {
+            uv = _mm256_or_si256(_mm256_slli_epi16(uv, 8), _mm256_srli_epi16(uv, 8));
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(y0 + x), rowY0);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(y1 + x), rowY1);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(chroma + x), uv);
+    }
+    return x;
+}
+
+
+/*===============================================================================
+RGB
+===============================================================================*/
+
+/// The R, G and B channels of 8 pixels as 16-bit values
+struct Channels
+{
+    __m128i r;
+    __m128i g;
+    __m128i b;
+};
+
+
+/// Split 8 RGBA pixels, given as two vectors of 4 pixels, into channels
+SSE2_TARGET inline Channels splitRgba(__m128i a, __m128i b)
+{
+    const __m128i lowByte = _mm_set1_epi32(0xFF);
+    Channels channels;
+    channels.r = _mm_packs_epi32(_mm_and_si128(a, lowByte), _mm_and_si128(b, lowByte));
+    channels.g = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(a, 8), lowByte), _mm_and_si128(_mm_srli_epi32(b, 8), lowByte));
+    channels.b = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(a, 16), lowByte), _mm_and_si128(_mm_srli_epi32(b, 16), lowByte));
+    return channels;
+}
+
+
+/// Y of 8 pixels as 16-bit values, see rgbToY
+SSE2_TARGET inline __m128i computeY(const Channels& c)
+{
+    // The products exceed the signed 16-bit range but the unsigned sum fits
+    __m128i sum = _mm_add_epi16(_mm_mullo_epi16(c.r, _mm_set1_epi16(66)), _mm_mullo_epi16(c.g, _mm_set1_epi16(129)));
+    sum = _mm_add_epi16(sum, _mm_mullo_epi16(c.b, _mm_set1_epi16(25)));
+    sum = _mm_add_epi16(sum, _mm_set1_epi16(128));
+    return _mm_add_epi16(_mm_srli_epi16(sum, 8), _mm_set1_epi16(16));
+}
+
+
+/// Sum horizontally adjacent pairs of a channel over two rows, then average, see average4
+/// The 4 averages are in the low 16 bits of each 32-bit lane.
+SSE2_TARGET inline __m128i averageBlocks(__m128i row0, __m128i row1)
+{
+    __m128i sum = _mm_add_epi16(row0, row1);
+    sum = _mm_add_epi16(_mm_and_si128(sum, _mm_set1_epi32(0xFFFF)), _mm_srli_epi32(sum, 16));
+    return _mm_srli_epi32(_mm_add_epi32(sum, _mm_set1_epi32(2)), 2);
+}
+
+
+/// One chroma component of 4 blocks, see rgbToU and rgbToV
+SSE2_TARGET inline __m128i computeChroma(const Channels& c, int16_t rc, int16_t gc, int16_t bc)
+{
+    __m128i sum = _mm_add_epi16(_mm_mullo_epi16(c.r, _mm_set1_epi16(rc)), _mm_mullo_epi16(c.g, _mm_set1_epi16(gc)));
+    sum = _mm_add_epi16(sum, _mm_mullo_epi16(c.b, _mm_set1_epi16(bc)));
+    sum = _mm_add_epi16(sum, _mm_set1_epi16(128));
+    return _mm_add_epi16(_mm_srai_epi16(sum, 8), _mm_set1_epi16(128));
+}
+
+
+/// Convert 8 pixels of two rows given as RGBA, 4 pixels per vector
+template <bool SWAP_CHROMA>
+SSE2_TARGET inline void convertRgbaBlock(__m128i a0, __m128i a1, __m128i b0, __m128i b1,
+                                         uint8_t* y0, uint8_t* y1, uint8_t* chroma)
+{
+    Channels row0 = splitRgba(a0, a1);
+    Channels row1 = splitRgba(b0, b1);
+
+    __m128i rowY0 = computeY(row0);
+    __m128i rowY1 = computeY(row1);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(y0), _mm_packus_epi16(rowY0, rowY0));
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(y1), _mm_packus_epi16(rowY1, rowY1));
+
+    // The block averages are in the even 16-bit lanes, the odd lanes are zero
+    Channels blocks;
+    blocks.r = averageBlocks(row0.r, row1.r);
+    blocks.g = averageBlocks(row0.g, row1.g);
+    blocks.b = averageBlocks(row0.b, row1.b);
+    __m128i u = computeChroma(blocks, -38, -74, 112);
+    __m128i v = computeChroma(blocks, 112, -94, -18);
+
+    // Move the second component into the odd lanes to interleave the pairs
+    __m128i evenLanes = _mm_set1_epi32(0xFFFF);
+    __m128i uv = SWAP_CHROMA ? _mm_or_si128(_mm_and_si128(v, evenLanes), _mm_slli_epi32(u, 16))
+                             : _mm_or_si128(_mm_and_si128(u, evenLanes), _mm_slli_epi32(v, 16));
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(chroma), _mm_packus_epi16(uv, uv));
+}
+
+
+template <bool SWAP_CHROMA>
+SSE2_TARGET uint32_t rgbaSse2(const uint8_t* src0, const uint8_t* src1,
+                              uint8_t* y0, uint8_t* y1, uint8_t* chroma, uint32_t width)
+{
+    uint32_t x = 0;
+    for (; x + 8 <= width; x += 8)
+    {
+        const uint8_t* a = src0 + x * 4;
+        const uint8_t* b = src1 + x * 4;
+        convertRgbaBlock<SWAP_CHROMA>(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a)),
+                                      _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + 16)),
+                                      _mm_loadu_si128(reinterpret_cast<const __m128i*>(b)),
+                                      _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + 16)),
+                                      y0 + x, y1 + x, chroma + x);
+    }
+    return x;
+}
+
+
+/// Expand 4 RGB pixels in the low 12 bytes to RGBA, the alpha bytes are zero
+SSSE3_TARGET inline __m128i expandRgb(const uint8_t* src)
+{
+    const __m128i shuffle = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    return _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src)), shuffle);
+}
+
+
+template <bool SWAP_CHROMA>
+SSSE3_TARGET uint32_t rgbSsse3(const uint8_t* src0, const uint8_t* src1,
+                               uint8_t* y0, uint8_t* y1, uint8_t* chroma, uint32_t width)
+{
+    // Each 16 byte load covers 5 1/3 pixels of which 4 are used, so stop before the last
+    // block to avoid reading past the end of the row
+    uint32_t x = 0;
+    for (; x + 8 <= width && (x + 8) * 3 + 4 <= width * 3; x += 8)
+    {
+        const uint8_t* a = src0 + x * 3;
+        const uint8_t* b = src1 + x * 3;
+        convertRgbaBlock<SWAP_CHROMA>(expandRgb(a), expandRgb(a + 12), expandRgb(b), expandRgb(b + 12),
+                                      y0 + x, y1 + x, chroma + x);
+    }
+    return x;
+}
+
+
+/// The R, G and B channels of 16 pixels as 16-bit values
+struct Channels256
+{
+    __m256i r;
+    __m256i g;
+    __m256i b;
+};
+
+
+/// One channel of 16 RGBA pixels, given as two vectors of 8 pixels, as 16-bit values
+template <int SHIFT>
+AVX2_TARGET inline __m256i extractChannel(__m256i a, __m256i b)
+{
+    // The pack works within each 128-bit lane, the permute restores the pixel order
+    const __m256i lowByte = _mm256_set1_epi32(0xFF);
+    __m256i first = _mm256_and_si256(_mm256_srli_epi32(a, SHIFT), lowByte);
+    __m256i second = _mm256_and_si256(_mm256_srli_epi32(b, SHIFT), lowByte);
+    return _mm256_permute4x64_epi64(_mm256_packs_epi32(first, second), 0xD8);
+}
+
+
+/// Split 16 RGBA pixels, given as two vectors of 8 pixels, into channels
+AVX2_TARGET inline Channels256 splitRgba(__m256i a, __m256i b)
+{
+    Channels256 channels;
+    channels.r = extractChannel<0>(a, b);
+    channels.g = extractChannel<8>(a, b);
+    channels.b = extractChannel<16>(a, b);
+    return channels;
+}
+
+
+/// Y of 16 pixels as 16-bit values, see rgbToY
+AVX2_TARGET inline __m256i computeY(const Channels256& c)
+{
+    // The products exceed the signed 16-bit range but the unsigned sum fits
+    __m256i sum = _mm256_add_epi16(_mm256_mullo_epi16(c.r, _mm256_set1_epi16(66)),
+                                   _mm256_mullo_epi16(c.g, _mm256_set1_epi16(129)));
+    sum = _mm256_add_epi16(sum, _mm256_mullo_epi16(c.b, _mm256_set1_epi16(25)));
+    sum = _mm256_add_epi16(sum, _mm256_set1_epi16(128));
+    return _mm256_add_epi16(_mm256_srli_epi16(sum, 8), _mm256_set1_epi16(16));
+}
+
+
+/// 8 block averages of a channel in the low 16 bits of each 32-bit lane, see averageBlocks
+AVX2_TARGET inline __m256i averageBlocks(__m256i row0, __m256i row1)
+{
+    __m256i sum = _mm256_add_epi16(row0, row1);
+    sum = _mm256_add_epi16(_mm256_and_si256(sum, _mm256_set1_epi32(0xFFFF)), _mm256_srli_epi32(sum, 16));
+    return _mm256_srli_epi32(_mm256_add_epi32(sum, _mm256_set1_epi32(2)), 2);
+}
+
+
+/// One chroma component of 8 blocks, see rgbToU and rgbToV
+AVX2_TARGET inline __m256i computeChroma(const Channels256& c, int16_t rc, int16_t gc, int16_t bc)
+{
+    __m256i sum = _mm256_add_epi16(_mm256_mullo_epi16(c.r, _mm256_set1_epi16(rc)),
+                                   _mm256_mullo_epi16(c.g, _mm256_set1_epi16(gc)));
+    sum = _mm256_add_epi16(sum, _mm256_mullo_epi16(c.b, _mm256_set1_epi16(bc)));
+    sum = _mm256_add_epi16(sum, _mm256_set1_epi16(128));
+    return _mm256_add_epi16(_mm256_srai_epi16(sum, 8), _mm256_set1_epi16(128));
+}
+
+
+/// Convert 16 pixels of two rows given as RGBA, 8 pixels per vector
+template <bool SWAP_CHROMA>
+AVX2_TARGET inline void convertRgbaBlock(__m256i a0, __m256i a1, __m256i b0, __m256i b1,
+                                         uint8_t* y0, uint8_t* y1, uint8_t* chroma)
+{
+    Channels256 row0 = splitRgba(a0, a1);
+    Channels256 row1 = splitRgba(b0, b1);
+
+    // Packing the two rows interleaves their halves, the permute puts each row in one lane
+    __m256i rowsY = _mm256_permute4x64_epi64(_mm256_packus_epi16(computeY(row0), computeY(row1)), 0xD8);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(y0), _mm256_castsi256_si128(rowsY));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(y1), _mm256_extracti128_si256(rowsY, 1));
+
+    // The block averages are in the even 16-bit lanes, the odd lanes are zero
+    Channels256 blocks;
+    blocks.r = averageBlocks(row0.r, row1.r);
+    blocks.g = averageBlocks(row0.g, row1.g);
+    blocks.b = averageBlocks(row0.b, row1.b);
+    __m256i u = computeChroma(blocks, -38, -74, 112);
+    __m256i v = computeChroma(blocks, 112, -94, -18);
+
+    // Move the second component into the odd lanes to interleave the pairs, then gather the
+    // 8 bytes packed in each 128-bit lane
+    __m256i evenLanes = _mm256_set1_epi32(0xFFFF);
+    __m256i uv = SWAP_CHROMA ? _mm256_or_si256(_mm256_and_si256(v, evenLanes), _mm256_slli_epi32(u, 16))
+                             : _mm256_or_si256(_mm256_and_si256(u, evenLanes), _mm256_slli_epi32(v, 16));
+    uv = _mm256_permute4x64_epi64(_mm256_packus_epi16(uv, uv), 0x08);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(chroma), _mm256_castsi256_si128(uv));
+}
+
+
+template <bool SWAP_CHROMA>
+AVX2_TARGET uint32_t rgbaAvx2(const uint8_t* src0, const uint8_t* src1,
+                              uint8_t* y0, uint8_t* y1, uint8_t* chroma, uint32_t width)
+{
+    uint32_t x = 0;
+    for (; x + 16 <= width; x += 16)
+    {
+        const uint8_t* a = src0 + x * 4;
+        const uint8_t* b = src1 + x * 4;
+        convertRgbaBlock<SWAP_CHROMA>(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a)),
+                                      _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + 32)),
+                                      _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b)),
+                                      _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + 32)),
+                                      y0 + x, y1 + x, chroma + x);
+    }
+    return x;
+}
+
+
+/// Expand 8 RGB pixels to RGBA, 4 per 128-bit lane, the alpha bytes are zero
+AVX2_TARGET inline __m256i expandRgb8(const uint8_t* src)
+{
+    const __m256i shuffle = _mm256_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,
+                                             0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    __m256i pixels = _mm256_inserti128_si256(
+        _mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src))),
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 12)), 1);
+    return _mm256_shuffle_epi8(pixels, shuffle);
+}
+
+
+template <bool SWAP_CHROMA>
+AVX2_TARGET uint32_t rgbAvx2(const uint8_t* src0, const uint8_t* src1,
+                             uint8_t* y0, uint8_t* y1, uint8_t* chroma, uint32_t width)
+{
+    // As in rgbSsse3 the last 16 byte load reads 4 bytes past the block
+    uint32_t x = 0;
+    for (; x + 16 <= width && (x + 16) * 3 + 4 <= width * 3; x += 16)
+    {
+        const uint8_t* a = src0 + x * 3;
+        const uint8_t* b = src1 + x * 3;
+        convertRgbaBlock<SWAP_CHROMA>(expandRgb8(a), expandRgb8(a + 24), expandRgb8(b), expandRgb8(b + 24),
+                                      y0 + x, y1 + x, chroma + x);
+    }
+    return x;
+}
+
+
+/*===============================================================================
+Planar chroma
+===============================================================================*/
+
+SSE2_TARGET uint32_t interleaveSse2(const uint8_t* first, const uint8_t* second, uint8_t* out, uint32_t count)
+{
+    uint32_t i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(second + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 2 * i), _mm_unpacklo_epi8(a, b));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 2 * i + 16), _mm_unpackhi_epi8(a, b));
+    }
+    return i;
+}
+
+
+AVX2_TARGET uint32_t interleaveAvx2(const uint8_t* first, const uint8_t* second, uint8_t* out, uint32_t count)
+{
+    uint32_t i = 0;
+    for (; i + 32 <= count; i += 32)
+    {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first + i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(second + i));
+        // The unpacks work within each 128-bit lane, recombine the lanes in order
+        __m256i low = _mm256_unpacklo_epi8(a, b);
+        __m256i high = _mm256_unpackhi_epi8(a, b);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 2 * i), _mm256_permute2x128_si256(low, high, 0x20));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 2 * i + 32), _mm256_permute2x128_si256(low, high, 0x31));
+    }
+    return i;
+}
+
+} // namespace
+
+
+const Kernels& PixelConverterKernels::getSse2Kernels()
+{
+    static const Kernels kernels = []()
+    {
+        Kernels k;
+        k.yuyvToNv12 = packed422Sse2<true, false>;
+        k.yuyvToNv21 = packed422Sse2<true, true>;
+        k.uyvyToNv12 = packed422Sse2<false, false>;
+        k.uyvyToNv21 = packed422Sse2<false, true>;
+        if (__builtin_cpu_supports("ssse3"))
+        {
+            k.rgbToNv12 = rgbSsse3<false>;
+            k.rgbToNv21 = rgbSsse3<true>;
+        }
+        k.rgbaToNv12 = rgbaSse2<false>;
+        k.rgbaToNv21 = rgbaSse2<true>;
+        k.interleave = interleaveSse2;
+        return k;
+    }();
+    return kernels;
+}
+
+
+const Kernels& PixelConverterKernels::getAvx2Kernels()
+{
+    static const Kernels kernels = []()
+    {
+        Kernels k;
+        k.yuyvToNv12 = packed422Avx2<true, false>;
+        k.yuyvToNv21 = packed422Avx2<true, true>;
+        k.uyvyToNv12 = packed422Avx2<false, false>;
+        k.uyvyToNv21 = packed422Avx2<false, true>;
+        k.rgbToNv12 = rgbAvx2<false>;
+        k.rgbToNv21 = rgbAvx2<true>;
+        k.rgbaToNv12 = rgbaAvx2<false>;
+        k.rgbaToNv21 = rgbaAvx2<true>;
+        k.interleave = interleaveAvx2;
+        return k;
+    }();
+    return kernels;
+}
+
+#endif // defined(__x86_64__) || defined(__i386__)
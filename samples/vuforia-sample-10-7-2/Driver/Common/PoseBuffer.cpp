@@ -0,0 +1,268 @@
+/*===============================================================================
+Copyright (c) 2022 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#include "PoseBuffer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <initializer_list>
+
+
+namespace
+{
+
+/// Below this angle between quaternions slerp is replaced by normalized lerp,
+/// which is accurate there and avoids dividing by sin(angle)
+constexpr float SLERP_LINEAR_THRESHOLD = 1e-3f;
+
+} // namespace
+
+
+PoseBuffer::PoseBuffer(size_t capacity)
+{
+    size_t roundedCapacity = 2;
+    while (roundedCapacity < capacity)
+    {
+        roundedCapacity *= 2;
+    }
+    mMask = roundedCapacity - 1;
+
+    mTimestamps.resize(roundedCapacity);
+    for (std::vector<float>* values : { &mTx, &mTy, &mTz, &mQx, &mQy, &mQz, &mQw })
+    {
+        values->resize(roundedCapacity);
+    }
+}
+
+
+bool PoseBuffer::add(uint64_t timestamp, const float translation[3], const float rotation[9])
+{
+    if (mCount > 0 && timestamp <= getNewestTimestamp())
+    {
+        return false;
+    }
+
+    size_t index;
+    if (mCount == capacity())
+    {
+        index = mFirst;
+        mFirst = slot(1);
+    }
+    else
+    {
+        index = slot(mCount++);
+    }
+
+    float quaternion[4];
+    matrixToQuaternion(rotation, quaternion);
+    // Keep consecutive quaternions in the same hemisphere so that blending takes the shorter arc
+    if (mCount > 1)
+    {
+        size_t previous = (index - 1) & mMask;
+        float dot = mQx[previous] * quaternion[0] + mQy[previous] * quaternion[1] +
+                    mQz[previous] * quaternion[2] + mQw[previous] * quaternion[3];
+        if (dot < 0.f)
+        {
+            for (float& component : quaternion)
+            {
+                component = -component;
+            }
+        }
+    }
+
+    mTimestamps[index] = timestamp;
+    mTx[index] = translation[0];
+    mTy[index] = translation[1];
+    mTz[index] = translation[2];
+    mQx[index] = quaternion[0];
+    mQy[index] = quaternion[1];
+    mQz[index] = quaternion[2];
+    mQw[index] = quaternion[3];
+    return true;
+}
+
+
+PoseBuffer::Result PoseBuffer::sample(uint64_t timestamp, float translation[3], float rotation[9],
+                                      uint64_t maxExtrapolation) const
+{
+    if (mCount == 0 || timestamp < getOldestTimestamp())
+    {
+        return Result::NONE;
+    }
+
+    size_t next = upperBound(timestamp);
+    size_t previous = next - 1;
+    uint64_t previousTimestamp = mTimestamps[slot(previous)];
+    if (previousTimestamp == timestamp)
+    {
+        blend(slot(previous), slot(previous), 0.f, translation, rotation);
+        return Result::EXACT;
+    }
+
+    if (next < mCount)
+    {
+        uint64_t nextTimestamp = mTimestamps[slot(next)];
+        float t = static_cast<float>(static_cast<double>(timestamp - previousTimestamp) /
+                                     static_cast<double>(nextTimestamp - previousTimestamp));
+        blend(slot(previous), slot(next), t, translation, rotation);
+        return Result::INTERPOLATED;
+    }
+
+    // timestamp is after the newest pose
+    if (timestamp - previousTimestamp > maxExtrapolation)
+    {
+        return Result::NONE;
+    }
+    if (mCount == 1)
+    {
+        // Without a second pose there is no motion to extrapolate, hold the only pose
+        blend(slot(previous), slot(previous), 0.f, translation, rotation);
+        return Result::EXTRAPOLATED;
+    }
+
+    uint64_t olderTimestamp = mTimestamps[slot(previous - 1)];
+    float t = static_cast<float>(static_cast<double>(timestamp - olderTimestamp) /
+                                 static_cast<double>(previousTimestamp - olderTimestamp));
+    blend(slot(previous - 1), slot(previous), t, translation, rotation);
+    return Result::EXTRAPOLATED;
+}
+
+
+void PoseBuffer::matrixToQuaternion(const float rotation[9], float quaternion[4])
+{
+    const float m00 = rotation[0], m01 = rotation[1], m02 = rotation[2];
+    const float m10 = rotation[3], m11 = rotation[4], m12 = rotation[5];
+    const float m20 = rotation[6], m21 = rotation[7], m22 = rotation[8];
+
+    // Derive the quaternion from the largest of its components for numerical stability
+    float trace = m00 + m11 + m22;
+    if (trace > 0.f)
+    {
+        float s = 2.f * std::sqrt(trace + 1.f);
+        quaternion[0] = (m21 - m12) / s;
+        quaternion[1] = (m02 - m20) / s;
+        quaternion[2] = (m10 - m01) / s;
+        quaternion[3] = 0.25f * s;
+    }
+    else if (m00 > m11 && m00 > m22)
+    {
+        float s = 2.f * std::sqrt(1.f + m00 - m11 - m22);
+        quaternion[0] = 0.25f * s;
+        quaternion[1] = (m01 + m10) / s;
+        quaternion[2] = (m02 + m20) / s;
+        quaternion[3] = (m21 - m12) / s;
+    }
+    else if (m11 > m22)
+    {
+        float s = 2.f * std::sqrt(1.f + m11 - m00 - m22);
+        quaternion[0] = (m01 + m10) / s;
+        quaternion[1] = 0.25f * s;
+        quaternion[2] = (m12 + m21) / s;
+        quaternion[3] = (m02 - m20) / s;
+    }
+    else
+    {
+        float s = 2.f * std::sqrt(1.f + m22 - m00 - m11);
+        quaternion[0] = (m02 + m20) / s;
+        quaternion[1] = (m12 + m21) / s;
+        quaternion[2] = 0.25f * s;
+        quaternion[3] = (m10 - m01) / s;
+    }
+
+    float length = std::sqrt(quaternion[0] * quaternion[0] + quaternion[1] * quaternion[1] +
+                             quaternion[2] * quaternion[2] + quaternion[3] * quaternion[3]);
+    for (int i = 0; i < 4; ++i)
+    {
+        quaternion[i] /= length;
+    }
+}
+
+
+void PoseBuffer::quaternionToMatrix(const float quaternion[4], float rotation[9])
+{
+    const float x = quaternion[0], y = quaternion[1], z = quaternion[2], w = quaternion[3];
+
+    rotation[0] = 1.f - 2.f * (y * y + z * z);
+    rotation[1] = 2.f * (x * y - z * w);
+    rotation[2] = 2.f * (x * z + y * w);
+    rotation[3] = 2.f * (x * y + z * w);
+    rotation[4] = 1.f - 2.f * (x * x + z * z);
+    rotation[5] = 2.f * (y * z - x * w);
+    rotation[6] = 2.f * (x * z - y * w);
+    rotation[7] = 2.f * (y * z + x * w);
+    rotation[8] = 1.f - 2.f * (x * x + y * y);
+}
+
+
+void PoseBuffer::slerp(const float q0[4], const float q1[4], float t, float result[4])
+{
+    float dot = q0[0] * q1[0] + q0[1] * q1[1] + q0[2] * q1[2] + q0[3] * q1[3];
+    float sign = 1.f;
+    if (dot < 0.f)
+    {
+        dot = -dot;
+        sign = -1.f;
+    }
+
+    float w0 = 1.f - t;
+    float w1 = t;
+    float angle = std::acos(std::min(dot, 1.f));
+    if (angle > SLERP_LINEAR_THRESHOLD)
+    {
+        float sinAngle = std::sin(angle);
+        w0 = std::sin(w0 * angle) / sinAngle;
+        w1 = std::sin(w1 * angle) / sinAngle;
+    }
+    w1 *= sign;
+
+    float length = 0.f;
+    for (int i = 0; i < 4; ++i)
+    {
+        result[i] = w0 * q0[i] + w1 * q1[i];
+        length += result[i] * result[i];
+    }
+    length = std::sqrt(length);
+    for (int i = 0; i < 4; ++i)
+    {
+        result[i] /= length;
+    }
+}
+
+
+size_t PoseBuffer::upperBound(uint64_t timestamp) const
+{
+    size_t first = 0;
+    size_t count = mCount;
+    while (count > 0)
+    {
+        size_t half = count / 2;
+        if (mTimestamps[slot(first + half)] <= timestamp)
+        {
+            first += half + 1;
+            count -= half + 1;
+        }
+        else
+        {
+            count = half;
+        }
+    }
+    return first;
+}
+
+
+void PoseBuffer::blend(size_t i0, size_t i1, float t, float translation[3], float rotation[9]) const
+{
+    translation[0] = mTx[i0] + (mTx[i1] - mTx[i0]) * t;
+    translation[1] = mTy[i0] + (mTy[i1] - mTy[i0]) * t;
+    translation[2] = mTz[i0] + (mTz[i1] - mTz[i0]) * t;
+
+    const float q0[4] = { mQx[i0], mQy[i0], mQz[i0], mQw[i0] };
+    const float q1[4] = { mQx[i1], mQy[i1], mQz[i1], mQw[i1] };
+    float quaternion[4];
+    slerp(q0, q1, t, quaternion);
+    quaternionToMatrix(quaternion, rotation);
+}
@@ -0,0 +1,93 @@
+/*===============================================================================
+Copyright (c) 2022 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#ifndef __POSE_BUFFER_H__
+#define __POSE_BUFFER_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+/// Short history of timestamped poses that can be sampled at any time
+/**
+ * Poses usually arrive at a different rate and on a different clock than the camera frames,
+ * e.g. from an IMU at 200 Hz against 30 fps video. The buffer keeps the most recent poses in a
+ * ring and provides the pose at a frame timestamp by interpolating between the two poses around
+ * it, translation linearly and rotation with quaternion slerp, or by extrapolating the motion
+ * of the last two poses a short time into the future.
+ *
+ * The ring is stored as a structure of arrays so that the binary search over the timestamps
+ * only touches the timestamps. Rotations are 3x3 row-major matrices like VuforiaDriver::Pose,
+ * they are stored as quaternions. The buffer isn't thread-safe.
+ */
+class PoseBuffer
+{
+public:
+    /// How a sampled pose was obtained
+    enum class Result
+    {
+        NONE,           ///< No pose is available at the requested time
+        EXACT,          ///< A pose was recorded at the requested time
+        INTERPOLATED,   ///< Interpolated between the recorded poses around the requested time
+        EXTRAPOLATED    ///< Predicted from the last recorded poses
+    };
+
+    /// Keep up to capacity poses, rounded up to a power of two
+    explicit PoseBuffer(size_t capacity = 64);
+
+    /// Add a pose, it must be newer than the poses already added
+    /// Returns false if it isn't, the pose is then ignored. The oldest pose is dropped when
+    /// the buffer is full.
+    bool add(uint64_t timestamp, const float translation[3], const float rotation[9]);
+
+    /// Get the pose at timestamp
+    /**
+     * Poses after the newest one are extrapolated up to maxExtrapolation nanoseconds ahead,
+     * NONE is returned for timestamps further ahead or before the oldest pose.
+     * O(log n) in the number of poses held.
+     */
+    Result sample(uint64_t timestamp, float translation[3], float rotation[9], uint64_t maxExtrapolation) const;
+
+    void clear() { mCount = 0; }
+
+    size_t size() const { return mCount; }
+    size_t capacity() const { return mTimestamps.size(); }
+    bool empty() const { return mCount == 0; }
+
+    /// Timestamps of the oldest and newest pose, the buffer must not be empty
+    uint64_t getOldestTimestamp() const { return mTimestamps[slot(0)]; }
+    uint64_t getNewestTimestamp() const { return mTimestamps[slot(mCount - 1)]; }
+
+    /// Conversions between 3x3 row-major rotation matrices and unit quaternions (x, y, z, w)
+    static void matrixToQuaternion(const float rotation[9], float quaternion[4]);
+    static void quaternionToMatrix(const float quaternion[4], float rotation[9]);
+
+    /// Spherical interpolation between unit quaternions along the shorter arc
+    /// t outside [0, 1] extrapolates along the same arc.
+    static void slerp(const float q0[4], const float q1[4], float t, float result[4]);
+
+private:
+    /// Index into the arrays of the index-th oldest pose
+    size_t slot(size_t index) const { return (mFirst + index) & mMask; }
+
+    /// Index of the oldest pose newer than timestamp, mCount if there is none
+    size_t upperBound(uint64_t timestamp) const;
+
+    /// Write the pose interpolated from the poses at indices i0 and i1 with factor t
+    void blend(size_t i0, size_t i1, float t, float translation[3], float rotation[9]) const;
+
+    std::vector<uint64_t> mTimestamps;
+    std::vector<float> mTx, mTy, mTz;
+    std::vector<float> mQx, mQy, mQz, mQw;
+
+    size_t mMask { 0 };
+    size_t mFirst { 0 };
+    size_t mCount { 0 };
+};
+
+#endif // __POSE_BUFFER_H__
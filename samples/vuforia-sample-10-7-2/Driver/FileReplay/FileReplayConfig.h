@@ -0,0 +1,125 @@
+/*===============================================================================
+Copyright (c) 2022 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#ifndef __FILE_REPLAY_CONFIG_H__
+#define __FILE_REPLAY_CONFIG_H__
+
+#include <VuforiaEngine/Driver/Driver.h>
+
+#include <cstdint>
+
+
+namespace FileReplay
+{
+
+/// How the recorded frames are paced
+enum class ReplayMode : int32_t
+{
+    REAL_TIME,              ///< Deliver the frames at their recorded rate, scaled by Config::speed
+    AS_FAST_AS_POSSIBLE,    ///< Deliver the next frame as soon as the previous one was consumed
+    STEPPED                 ///< Deliver frames only when requested with fileReplayDriver_step()
+};
+
+
+/// Driver configuration, pass a pointer to it as the userData of the VuDriverConfig
+/// The object must remain valid until the Vuforia Engine instance is destroyed.
+struct Config
+{
+    /// Recording directory containing sequence.txt, or the path of a sequence file
+    const char* recordingPath { nullptr };
+
+    /// Optional PoseTrace file, if set the driver also provides an external positional device
+    /// tracker reporting the recorded device poses and anchor events along with the frames
+    const char* poseTracePath { nullptr };
+
+    /// Deliver one pose per frame, sampled from the trace at the frame timestamp, instead of
+    /// every recorded pose. The pose is interpolated between the recorded poses around the
+    /// frame, or extrapolated from the last ones for up to maxPoseExtrapolation nanoseconds.
+    bool alignPosesToFrames { false };
+    uint64_t maxPoseExtrapolation { 50000000 };
+
+    ReplayMode mode { ReplayMode::REAL_TIME };
+
+    /// Playback rate for REAL_TIME, 2 plays the recording twice as fast
+    float speed { 1.0f };
+
+    /// Number of times the recording is played, 0 repeats it until the camera is stopped
+    uint32_t loopCount { 1 };
+
+    /// Read all the frames into memory when the camera is opened so that file access
+    /// doesn't affect the timing of the replay
+    bool preload { true };
+
+    /// Format the frames are delivered in, NV12 or NV21 to convert the recorded frames
+    /// UNKNOWN delivers them as recorded, unless Vuforia doesn't accept the recorded format,
+    /// e.g. UYVY, in which case they are converted to NV21.
+    VuforiaDriver::PixelFormat outputFormat { VuforiaDriver::PixelFormat::UNKNOWN };
+
+    /// Number of frame buffers used when the recording isn't preloaded, and for converted frames
+    uint32_t numStreamingBuffers { 2 };
+
+    /// In REAL_TIME drop the frames whose delivery time passed more than a frame interval ago,
+    /// as a camera would when the frames aren't consumed fast enough
+    bool dropLateFrames { false };
+
+    /// Value returned by ExternalCamera::processFramesOnThread()
+    bool processFramesOnThread { false };
+
+    /// If set the replay is traced while the camera is running and the events are appended to
+    /// this file, in the Chrome Trace Event format, when it is stopped. Using the same file as
+    /// AppController::InitConfig::traceFilePath shows the driver and app events on one timeline.
+    const char* traceFilePath { nullptr };
+};
+
+
+/// Replay statistics, reset when the camera is started
+struct Stats
+{
+    /// Number of frames passed to the camera callback
+    uint64_t framesDelivered { 0 };
+
+    /// Total and maximum time spent in the camera callback in nanoseconds
+    uint64_t totalCallbackTime { 0 };
+    uint64_t maxCallbackTime { 0 };
+
+    /// Total time spent converting frames to the output format in nanoseconds
+    uint64_t totalConversionTime { 0 };
+
+    /// Number of frames dropped because they were late or couldn't be read
+    uint64_t framesDropped { 0 };
+
+    /// Number of times no frame buffer was available
+    uint64_t bufferPoolExhausted { 0 };
+
+    /// Number of device poses and anchor events passed to the tracker callbacks
+    uint64_t posesDelivered { 0 };
+    uint64_t anchorEventsDelivered { 0 };
+
+    /// Number of poses delivered with alignPosesToFrames that had to be extrapolated
+    uint64_t posesExtrapolated { 0 };
+
+    /// Time from the first frame being delivered to the last callback returning in nanoseconds
+    uint64_t elapsedTime { 0 };
+
+    /// True once all the frames of all the loops have been delivered
+    bool finished { false };
+};
+
+} // namespace FileReplay
+
+
+extern "C"
+{
+    /// Allow numFrames more frames to be delivered in ReplayMode::STEPPED
+    VUFORIA_DRIVER_API_EXPORT void VUFORIA_DRIVER_CALLING_CONVENTION fileReplayDriver_step(uint32_t numFrames);
+
+    /// Get the statistics of the current or last replay
+    /// Returns false if no camera has been created.
+    VUFORIA_DRIVER_API_EXPORT bool VUFORIA_DRIVER_CALLING_CONVENTION fileReplayDriver_getStats(FileReplay::Stats* stats);
+}
+
+#endif // __FILE_REPLAY_CONFIG_H__
@@ -0,0 +1,634 @@
+/*===============================================================================
+Copyright (c) 2022 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#include "FileReplayDriver.h"
+
+#include <Log.h>
+#include <Trace.h>
+
+#include <algorithm>
+#include <cstring>
+
+
+namespace
+{
+
+constexpr const char* LIBRARY_VERSION = "FileReplayDriver-1.0";
+
+/// The driver instance, Vuforia creates at most one
+FileReplayDriver* gDriver = nullptr;
+/// Guards the camera and tracker of gDriver against being destroyed during the exported calls
+std::mutex gDriverMutex;
+
+
+uint64_t toNanoseconds(std::chrono::steady_clock::duration duration)
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count());
+}
+
+} // namespace
+
+
+/*===============================================================================
+ReplayCamera
+===============================================================================*/
+
+ReplayCamera::ReplayCamera(const FileReplay::Config& config) : mConfig(config)
+{
+    if (mConfig.speed <= 0.f)
+    {
+        mConfig.speed = 1.f;
+    }
+}
+
+
+ReplayCamera::~ReplayCamera()
+{
+    stop();
+}
+
+
+bool ReplayCamera::open()
+{
+    if (mOpen)
+    {
+        return true;
+    }
+
+    if (!mRecording.load(mConfig.recordingPath))
+    {
+        return false;
+    }
+
+    // Frames in formats Vuforia doesn't accept are converted to NV21 unless another
+    // output format is configured
+    PixelConverter::Format recordedFormat = mRecording.getFormat();
+    mOutputFormat = PixelConverter::fromDriverFormat(mConfig.outputFormat);
+    if (mOutputFormat == PixelConverter::Format::UNKNOWN)
+    {
+        mOutputFormat = mRecording.getCameraMode().format != VuforiaDriver::PixelFormat::UNKNOWN
+                            ? recordedFormat : PixelConverter::Format::NV21;
+    }
+    if (mOutputFormat != recordedFormat && !PixelConverter::isSupported(recordedFormat, mOutputFormat))
+    {
+        LOG("Conversion of the recorded frames to format %d isn't supported", static_cast<int>(mOutputFormat));
+        return false;
+    }
+
+    mCameraMode = mRecording.getCameraMode();
+    mCameraMode.format = PixelConverter::toDriverFormat(mOutputFormat);
+
+    if (mOutputFormat != recordedFormat)
+    {
+        // The converted frames are only held while they are delivered
+        size_t outputSize = PixelConverter::getImageSize(mOutputFormat, mCameraMode.width, mCameraMode.height);
+        if (!mOutputPool.init(outputSize, std::max<uint32_t>(mConfig.numStreamingBuffers, 1)))
+        {
+            return false;
+        }
+    }
+
+    uint32_t numBuffers = mConfig.preload ? static_cast<uint32_t>(mRecording.getNumFrames())
+                                          : std::max<uint32_t>(mConfig.numStreamingBuffers, 1);
+    if (!mFramePool.init(mRecording.getFrameSize(), numBuffers))
+    {
+        mOutputPool.deinit();
+        return false;
+    }
+
+    if (mConfig.preload)
+    {
+        mPreloadedFrames.resize(mRecording.getNumFrames());
+        for (size_t i = 0; i < mPreloadedFrames.size(); ++i)
+        {
+            mPreloadedFrames[i] = mFramePool.acquire();
+            if (!mRecording.readFrame(i, mPreloadedFrames[i]))
+            {
+                releasePreloadedFrames();
+                mFramePool.deinit();
+                mOutputPool.deinit();
+                return false;
+            }
+        }
+        mRecording.closeFile();
+    }
+
+    mOpen = true;
+    return true;
+}
+
+
+bool ReplayCamera::close()
+{
+    stop();
+    mRecording.closeFile();
+    releasePreloadedFrames();
+    mFramePool.deinit();
+    mOutputPool.deinit();
+    mOpen = false;
+    return true;
+}
+
+
+bool ReplayCamera::start(VuforiaDriver::CameraMode cameraMode, VuforiaDriver::CameraCallback* cb)
+{
+    if (!mOpen || cb == nullptr || mThread.joinable())
+    {
+        return false;
+    }
+
+    if (cameraMode.width != mCameraMode.width || cameraMode.height != mCameraMode.height ||
+        cameraMode.format != mCameraMode.format)
+    {
+        LOG("Camera mode %ux%u doesn't match the recording", cameraMode.width, cameraMode.height);
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStopRequested = false;
+        mPendingSteps = 0;
+        mStats = FileReplay::Stats();
+    }
+
+    if (mConfig.traceFilePath != nullptr)
+    {
+        Trace::setEnabled(true);
+    }
+
+    mCallback = cb;
+    mThread = std::thread(&ReplayCamera::replayFrames, this);
+    return true;
+}
+
+
+bool ReplayCamera::stop()
+{
+    if (!mThread.joinable())
+    {
+        return true;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStopRequested = true;
+    }
+    mCondition.notify_all();
+    mThread.join();
+    mCallback = nullptr;
+
+    if (mConfig.traceFilePath != nullptr)
+    {
+        Trace::writeFile(mConfig.traceFilePath);
+    }
+    return true;
+}
+
+
+uint32_t ReplayCamera::getNumSupportedCameraModes()
+{
+    return mOpen ? 1 : 0;
+}
+
+
+bool ReplayCamera::getSupportedCameraMode(uint32_t index, VuforiaDriver::CameraMode* cameraMode)
+{
+    if (!mOpen || index != 0 || cameraMode == nullptr)
+    {
+        return false;
+    }
+    *cameraMode = mCameraMode;
+    return true;
+}
+
+
+bool ReplayCamera::supportsExposureMode(VuforiaDriver::ExposureMode exposureMode)
+{
+    return exposureMode == getExposureMode();
+}
+
+
+VuforiaDriver::ExposureMode ReplayCamera::getExposureMode()
+{
+    return VuforiaDriver::ExposureMode::CONTINUOUS_AUTO;
+}
+
+
+bool ReplayCamera::setExposureMode(VuforiaDriver::ExposureMode exposureMode)
+{
+    return supportsExposureMode(exposureMode);
+}
+
+
+bool ReplayCamera::supportsFocusMode(VuforiaDriver::FocusMode focusMode)
+{
+    return focusMode == getFocusMode();
+}
+
+
+VuforiaDriver::FocusMode ReplayCamera::getFocusMode()
+{
+    return VuforiaDriver::FocusMode::FIXED;
+}
+
+
+bool ReplayCamera::setFocusMode(VuforiaDriver::FocusMode focusMode)
+{
+    return supportsFocusMode(focusMode);
+}
+
+
+void ReplayCamera::step(uint32_t numFrames)
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mPendingSteps += numFrames;
+    }
+    mCondition.notify_all();
+}
+
+
+FileReplay::Stats ReplayCamera::getStats()
+{
+    FrameBufferPool::Stats poolStats = mFramePool.getStats();
+    FrameBufferPool::Stats outputPoolStats = mOutputPool.getStats();
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    FileReplay::Stats stats = mStats;
+    stats.framesDropped = poolStats.dropped;
+    stats.bufferPoolExhausted = poolStats.exhausted + outputPoolStats.exhausted;
+    return stats;
+}
+
+
+void ReplayCamera::setPoseTracker(ReplayPoseTracker* tracker)
+{
+    std::lock_guard<std::mutex> lock(mPoseTrackerMutex);
+    mPoseTracker = tracker;
+}
+
+
+void ReplayCamera::replayFrames()
+{
+    using namespace std::chrono;
+
+    Trace::setThreadName("FileReplay camera");
+
+    const size_t numFrames = mRecording.getNumFrames();
+    const uint64_t firstTimestamp = mRecording.getFrame(0).timestamp;
+    // Leave one nominal frame interval between the last frame of a loop and the first of the next
+    const uint64_t frameInterval = 1000000000ull / std::max<uint32_t>(mRecording.getCameraMode().fps, 1);
+    const uint64_t loopDuration = mRecording.getDuration() + frameInterval;
+
+    const steady_clock::time_point startTime = steady_clock::now();
+    const uint64_t startTimestamp = toNanoseconds(startTime.time_since_epoch());
+
+    // Pose trace timestamps are rebased like the frame timestamps, poses recorded before the
+    // first frame are reported at the start of the loop
+    uint32_t loop = 0;
+    const ReplayPoseTracker::TimestampMapping toDeviceTimestamp = [&](uint64_t recordedTimestamp)
+    {
+        uint64_t recordedOffset = loop * loopDuration +
+                                  (recordedTimestamp > firstTimestamp ? recordedTimestamp - firstTimestamp : 0);
+        if (mConfig.mode == FileReplay::ReplayMode::REAL_TIME)
+        {
+            recordedOffset = static_cast<uint64_t>(recordedOffset / static_cast<double>(mConfig.speed));
+        }
+        return startTimestamp + recordedOffset;
+    };
+
+    VuforiaDriver::CameraFrame frame;
+    const bool convert = mOutputFormat != mRecording.getFormat();
+    frame.width = mCameraMode.width;
+    frame.height = mCameraMode.height;
+    frame.format = mCameraMode.format;
+    frame.intrinsics = mRecording.getIntrinsics();
+    if (convert)
+    {
+        frame.stride = PixelConverter::getPackedStride(mOutputFormat, frame.width);
+        frame.bufferSize = static_cast<uint32_t>(mOutputPool.getBufferSize());
+    }
+    else
+    {
+        frame.stride = mRecording.getStride();
+        frame.bufferSize = mRecording.getFrameSize();
+    }
+
+    uint32_t frameIndex = 0;
+    for (; mConfig.loopCount == 0 || loop < mConfig.loopCount; ++loop)
+    {
+        for (size_t i = 0; i < numFrames; ++i)
+        {
+            const Recording::Frame& recordedFrame = mRecording.getFrame(i);
+            uint64_t recordedOffset = loop * loopDuration + (recordedFrame.timestamp - firstTimestamp);
+            if (mConfig.mode == FileReplay::ReplayMode::REAL_TIME)
+            {
+                recordedOffset = static_cast<uint64_t>(recordedOffset / static_cast<double>(mConfig.speed));
+            }
+
+            if (!waitForFrame(recordedOffset, startTime))
+            {
+                return;
+            }
+
+            {
+                // The poses are delivered even if the frame is dropped so that none are skipped
+                std::lock_guard<std::mutex> lock(mPoseTrackerMutex);
+                if (mPoseTracker != nullptr)
+                {
+                    Trace::ScopedEvent event("deliver poses", "driver");
+                    mPoseTracker->deliverUntil(loop, recordedFrame.timestamp, toDeviceTimestamp);
+                }
+            }
+
+            if (mConfig.mode == FileReplay::ReplayMode::REAL_TIME && mConfig.dropLateFrames &&
+                toNanoseconds(steady_clock::now() - startTime) > recordedOffset + frameInterval)
+            {
+                mFramePool.recordDroppedFrame();
+                Trace::instant("frame dropped", "driver");
+                continue;
+            }
+
+            uint8_t* pixels = acquireFramePixels(i);
+            if (pixels == nullptr)
+            {
+                // Unreadable frames are dropped like a camera would
+                mFramePool.recordDroppedFrame();
+                Trace::instant("frame dropped", "driver");
+                continue;
+            }
+
+            uint64_t conversionTime = 0;
+            frame.buffer = pixels;
+            if (convert)
+            {
+                frame.buffer = mOutputPool.acquire();
+                if (frame.buffer == nullptr)
+                {
+                    releaseFramePixels(pixels);
+                    mFramePool.recordDroppedFrame();
+                    Trace::instant("frame dropped", "driver");
+                    continue;
+                }
+                Trace::ScopedEvent event("convert frame", "driver");
+                steady_clock::time_point conversionStart = steady_clock::now();
+                PixelConverter::convert(mRecording.getFormat(), pixels, mRecording.getStride(),
+                                        mOutputFormat, frame.buffer, frame.stride, frame.width, frame.height);
+                conversionTime = toNanoseconds(steady_clock::now() - conversionStart);
+            }
+            frame.timestamp = startTimestamp + recordedOffset;
+            frame.exposureTime = recordedFrame.exposureTime;
+            frame.index = frameIndex++;
+
+            Trace::begin("onNewCameraFrame", "driver");
+            steady_clock::time_point callbackStart = steady_clock::now();
+            mCallback->onNewCameraFrame(&frame);
+            steady_clock::time_point callbackEnd = steady_clock::now();
+            Trace::end();
+            if (convert)
+            {
+                mOutputPool.release(frame.buffer);
+            }
+            releaseFramePixels(pixels);
+
+            uint64_t callbackTime = toNanoseconds(callbackEnd - callbackStart);
+            std::lock_guard<std::mutex> lock(mMutex);
+            ++mStats.framesDelivered;
+            mStats.totalCallbackTime += callbackTime;
+            mStats.totalConversionTime += conversionTime;
+            mStats.maxCallbackTime = std::max(mStats.maxCallbackTime, callbackTime);
+            mStats.elapsedTime = toNanoseconds(callbackEnd - startTime);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    mStats.finished = true;
+}
+
+
+bool ReplayCamera::waitForFrame(uint64_t recordedOffset, std::chrono::steady_clock::time_point startTime)
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    switch (mConfig.mode)
+    {
+        case FileReplay::ReplayMode::REAL_TIME:
+        {
+            auto deliveryTime = startTime + std::chrono::nanoseconds(recordedOffset);
+            mCondition.wait_until(lock, deliveryTime, [this, deliveryTime]()
+            {
+                return mStopRequested || std::chrono::steady_clock::now() >= deliveryTime;
+            });
+            break;
+        }
+
+        case FileReplay::ReplayMode::STEPPED:
+            mCondition.wait(lock, [this]() { return mStopRequested || mPendingSteps > 0; });
+            if (!mStopRequested)
+            {
+                --mPendingSteps;
+            }
+            break;
+
+        case FileReplay::ReplayMode::AS_FAST_AS_POSSIBLE:
+            break;
+    }
+    return !mStopRequested;
+}
+
+
+uint8_t* ReplayCamera::acquireFramePixels(size_t index)
+{
+    if (mConfig.preload)
+    {
+        return mPreloadedFrames[index];
+    }
+
+    uint8_t* pixels = mFramePool.acquire();
+    if (pixels != nullptr && !mRecording.readFrame(index, pixels))
+    {
+        mFramePool.release(pixels);
+        return nullptr;
+    }
+    return pixels;
+}
+
+
+void ReplayCamera::releaseFramePixels(uint8_t* pixels)
+{
+    // Preloaded frames stay in their buffers until the camera is closed
+    if (!mConfig.preload)
+    {
+        mFramePool.release(pixels);
+    }
+}
+
+
+void ReplayCamera::releasePreloadedFrames()
+{
+    for (uint8_t* pixels : mPreloadedFrames)
+    {
+        mFramePool.release(pixels);
+    }
+    mPreloadedFrames.clear();
+}
+
+
+/*===============================================================================
+FileReplayDriver
+===============================================================================*/
+
+VuforiaDriver::ExternalCamera* FileReplayDriver::createExternalCamera()
+{
+    std::lock_guard<std::mutex> lock(gDriverMutex);
+    if (mCamera)
+    {
+        return nullptr;
+    }
+    mCamera = std::make_unique<ReplayCamera>(mConfig);
+    mCamera->setPoseTracker(mPoseTracker.get());
+    return mCamera.get();
+}
+
+
+void FileReplayDriver::destroyExternalCamera(VuforiaDriver::ExternalCamera* instance)
+{
+    std::lock_guard<std::mutex> lock(gDriverMutex);
+    if (instance == mCamera.get())
+    {
+        mCamera.reset();
+    }
+}
+
+
+VuforiaDriver::ExternalPositionalDeviceTracker* FileReplayDriver::createExternalPositionalDeviceTracker()
+{
+    std::lock_guard<std::mutex> lock(gDriverMutex);
+    if (mConfig.poseTracePath == nullptr || mPoseTracker)
+    {
+        return nullptr;
+    }
+    mPoseTracker = std::make_unique<ReplayPoseTracker>(mConfig);
+    if (mCamera)
+    {
+        mCamera->setPoseTracker(mPoseTracker.get());
+    }
+    return mPoseTracker.get();
+}
+
+
+void FileReplayDriver::destroyExternalPositionalDeviceTracker(VuforiaDriver::ExternalPositionalDeviceTracker* instance)
+{
+    std::lock_guard<std::mutex> lock(gDriverMutex);
+    if (instance == mPoseTracker.get())
+    {
+        if (mCamera)
+        {
+            mCamera->setPoseTracker(nullptr);
+        }
+        mPoseTracker.reset();
+    }
+}
+
+
+uint32_t FileReplayDriver::getCapabilities()
+{
+    uint32_t capabilities = static_cast<uint32_t>(VuforiaDriver::Capability::CAMERA_IMAGE);
+    if (mConfig.poseTracePath != nullptr)
+    {
+        capabilities |= static_cast<uint32_t>(VuforiaDriver::Capability::CAMERA_POSE);
+    }
+    return capabilities;
+}
+
+
+/*===============================================================================
+Exported functions
+===============================================================================*/
+
+extern "C"
+{
+
+uint32_t VUFORIA_DRIVER_CALLING_CONVENTION vuforiaDriver_getAPIVersion()
+{
+    return VuforiaDriver::VUFORIA_DRIVER_API_VERSION;
+}
+
+
+uint32_t VUFORIA_DRIVER_CALLING_CONVENTION vuforiaDriver_getLibraryVersion(char* versionString, const uint32_t maxLen)
+{
+    if (versionString == nullptr || maxLen == 0)
+    {
+        return 0;
+    }
+    uint32_t length = std::min(static_cast<uint32_t>(strlen(LIBRARY_VERSION)), maxLen - 1);
+    memcpy(versionString, LIBRARY_VERSION, length);
+    versionString[length] = '\0';
+    return length;
+}
+
+
+VuforiaDriver::Driver* VUFORIA_DRIVER_CALLING_CONVENTION vuforiaDriver_init(VuforiaDriver::PlatformData* platformData, void* userData)
+{
+    (void)platformData;
+
+    std::lock_guard<std::mutex> lock(gDriverMutex);
+    if (gDriver != nullptr)
+    {
+        return nullptr;
+    }
+
+    auto* config = static_cast<const FileReplay::Config*>(userData);
+    if (config == nullptr || config->recordingPath == nullptr)
+    {
+        LOG("The file replay driver requires a FileReplay::Config with a recording path as user data");
+        return nullptr;
+    }
+
+    gDriver = new FileReplayDriver(*config);
+    return gDriver;
+}
+
+
+void VUFORIA_DRIVER_CALLING_CONVENTION vuforiaDriver_deinit(VuforiaDriver::Driver* instance)
+{
+    std::lock_guard<std::mutex> lock(gDriverMutex);
+    if (instance != nullptr && instance == gDriver)
+    {
+        delete gDriver;
+        gDriver = nullptr;
+    }
+}
+
+
+void VUFORIA_DRIVER_CALLING_CONVENTION fileReplayDriver_step(uint32_t numFrames)
+{
+    std::lock_guard<std::mutex> lock(gDriverMutex);
+    if (gDriver != nullptr && gDriver->getCamera() != nullptr)
+    {
+        gDriver->getCamera()->step(numFrames);
+    }
+}
+
+
+bool VUFORIA_DRIVER_CALLING_CONVENTION fileReplayDriver_getStats(FileReplay::Stats* stats)
+{
+    std::lock_guard<std::mutex> lock(gDriverMutex);
+    if (stats == nullptr || gDriver == nullptr || gDriver->getCamera() == nullptr)
+    {
+        return false;
+    }
+    *stats = gDriver->getCamera()->getStats();
+    if (gDriver->getPoseTracker() != nullptr)
+    {
+        stats->posesDelivered = gDriver->getPoseTracker()->getNumPosesDelivered();
+        stats->anchorEventsDelivered = gDriver->getPoseTracker()->getNumAnchorEventsDelivered();
+        stats->posesExtrapolated = gDriver->getPoseTracker()->getNumPosesExtrapolated();
+    }
+    return true;
+}
+
+} // extern "C"
@@ -0,0 +1,155 @@
+/*===============================================================================
+Copyright (c) 2022 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#ifndef __FILE_REPLAY_DRIVER_H__
+#define __FILE_REPLAY_DRIVER_H__
+
+#include "FileReplayConfig.h"
+#include "Recording.h"
+#include "ReplayPoseTracker.h"
+
+#include <FrameBufferPool.h>
+#include <PixelConverter.h>
+
+#include <VuforiaEngine/Driver/Driver.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+/// ExternalCamera that replays the frames of a Recording
+/**
+ * The frames are delivered to the CameraCallback on a thread owned by the camera, paced
+ * according to the ReplayMode. Frame timestamps are rebased onto the steady clock
+ * (CLOCK_MONOTONIC) at the time the camera is started, keeping the recorded intervals.
+ * Frames are converted with PixelConverter if the output format differs from the recording.
+ * If a ReplayPoseTracker is set the trace records up to each frame are delivered before it.
+ */
+class ReplayCamera final : public VuforiaDriver::ExternalCamera
+{
+public:
+    explicit ReplayCamera(const FileReplay::Config& config);
+    ~ReplayCamera();
+
+    bool VUFORIA_DRIVER_CALLING_CONVENTION open() override;
+    bool VUFORIA_DRIVER_CALLING_CONVENTION close() override;
+    bool VUFORIA_DRIVER_CALLING_CONVENTION start(VuforiaDriver::CameraMode cameraMode, VuforiaDriver::CameraCallback* cb) override;
+    bool VUFORIA_DRIVER_CALLING_CONVENTION stop() override;
+
+    uint32_t VUFORIA_DRIVER_CALLING_CONVENTION getNumSupportedCameraModes() override;
+    bool VUFORIA_DRIVER_CALLING_CONVENTION getSupportedCameraMode(uint32_t index, VuforiaDriver::CameraMode* cameraMode) override;
+
+    // The recording has a fixed exposure and focus, only the modes reported as current are supported
+    bool VUFORIA_DRIVER_CALLING_CONVENTION supportsExposureMode(VuforiaDriver::ExposureMode exposureMode) override;
+    VuforiaDriver::ExposureMode VUFORIA_DRIVER_CALLING_CONVENTION getExposureMode() override;
+    bool VUFORIA_DRIVER_CALLING_CONVENTION setExposureMode(VuforiaDriver::ExposureMode exposureMode) override;
+    bool VUFORIA_DRIVER_CALLING_CONVENTION supportsExposureValue() override { return false; }
+    uint64_t VUFORIA_DRIVER_CALLING_CONVENTION getExposureValueMin() override { return 0; }
+    uint64_t VUFORIA_DRIVER_CALLING_CONVENTION getExposureValueMax() override { return 0; }
+    uint64_t VUFORIA_DRIVER_CALLING_CONVENTION getExposureValue() override { return 0; }
+    bool VUFORIA_DRIVER_CALLING_CONVENTION setExposureValue(uint64_t) override { return false; }
+
+    bool VUFORIA_DRIVER_CALLING_CONVENTION supportsFocusMode(VuforiaDriver::FocusMode focusMode) override;
+    VuforiaDriver::FocusMode VUFORIA_DRIVER_CALLING_CONVENTION getFocusMode() override;
+    bool VUFORIA_DRIVER_CALLING_CONVENTION setFocusMode(VuforiaDriver::FocusMode focusMode) override;
+    bool VUFORIA_DRIVER_CALLING_CONVENTION supportsFocusValue() override { return false; }
+    float VUFORIA_DRIVER_CALLING_CONVENTION getFocusValueMin() override { return 0.f; }
+    float VUFORIA_DRIVER_CALLING_CONVENTION getFocusValueMax() override { return 0.f; }
+    float VUFORIA_DRIVER_CALLING_CONVENTION getFocusValue() override { return 0.f; }
+    bool VUFORIA_DRIVER_CALLING_CONVENTION setFocusValue(float) override { return false; }
+
+    bool VUFORIA_DRIVER_CALLING_CONVENTION processFramesOnThread() override { return mConfig.processFramesOnThread; }
+
+    /// Allow numFrames more frames to be delivered in ReplayMode::STEPPED
+    void step(uint32_t numFrames);
+
+    /// Get the statistics of the current or last replay
+    FileReplay::Stats getStats();
+
+    /// Set the tracker whose poses are delivered along with the frames, nullptr to remove it
+    void setPoseTracker(ReplayPoseTracker* tracker);
+
+private:
+    /// Body of the replay thread
+    void replayFrames();
+
+    /// Wait until frame may be delivered, returns false if the camera was stopped
+    bool waitForFrame(uint64_t recordedOffset, std::chrono::steady_clock::time_point startTime);
+
+    /// Get the pixels of a frame, nullptr if they can't be read
+    /// The pixels must be passed to releaseFramePixels once the frame was delivered.
+    uint8_t* acquireFramePixels(size_t index);
+    void releaseFramePixels(uint8_t* pixels);
+
+    /// Return the buffers of a preloaded recording to the pool
+    void releasePreloadedFrames();
+
+    FileReplay::Config mConfig;
+    Recording mRecording;
+    bool mOpen { false };
+
+    /// The mode reported to Vuforia, the recorded mode with the output format
+    VuforiaDriver::CameraMode mCameraMode;
+    /// Format of the delivered frames, if it differs from the recorded format each frame is
+    /// converted into a buffer from mOutputPool before it is delivered
+    PixelConverter::Format mOutputFormat { PixelConverter::Format::UNKNOWN };
+    FrameBufferPool mOutputPool;
+
+    /// Frame buffers, holding every frame if the recording is preloaded, otherwise the
+    /// frames are read into a buffer taken from the pool while they are being delivered
+    FrameBufferPool mFramePool;
+    /// The buffer of each frame if the recording is preloaded
+    std::vector<uint8_t*> mPreloadedFrames;
+
+    VuforiaDriver::CameraCallback* mCallback { nullptr };
+    std::thread mThread;
+
+    /// Guards mPoseTracker, which may be set or removed while the camera is running
+    std::mutex mPoseTrackerMutex;
+    ReplayPoseTracker* mPoseTracker { nullptr };
+
+    /// Guards mStopRequested, mPendingSteps and mStats
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+    bool mStopRequested { false };
+    uint64_t mPendingSteps { 0 };
+    FileReplay::Stats mStats;
+};
+
+
+/// Driver creating a ReplayCamera and, if a pose trace is configured, a ReplayPoseTracker
+class FileReplayDriver final : public VuforiaDriver::Driver
+{
+public:
+    explicit FileReplayDriver(const FileReplay::Config& config) : mConfig(config) {}
+
+    VuforiaDriver::ExternalCamera* VUFORIA_DRIVER_CALLING_CONVENTION createExternalCamera() override;
+    void VUFORIA_DRIVER_CALLING_CONVENTION destroyExternalCamera(VuforiaDriver::ExternalCamera* instance) override;
+
+    VuforiaDriver::ExternalPositionalDeviceTracker* VUFORIA_DRIVER_CALLING_CONVENTION createExternalPositionalDeviceTracker() override;
+    void VUFORIA_DRIVER_CALLING_CONVENTION destroyExternalPositionalDeviceTracker(VuforiaDriver::ExternalPositionalDeviceTracker* instance) override;
+
+    uint32_t VUFORIA_DRIVER_CALLING_CONVENTION getCapabilities() override;
+
+    /// The camera created by createExternalCamera, nullptr if there is none
+    ReplayCamera* getCamera() { return mCamera.get(); }
+
+    /// The tracker created by createExternalPositionalDeviceTracker, nullptr if there is none
+    ReplayPoseTracker* getPoseTracker() { return mPoseTracker.get(); }
+
+private:
+    FileReplay::Config mConfig;
+    std::unique_ptr<ReplayCamera> mCamera;
+    std::unique_ptr<ReplayPoseTracker> mPoseTracker;
+};
+
+#endif // __FILE_REPLAY_DRIVER_H__
@@ -0,0 +1,122 @@
+/*===============================================================================
+Copyright (c) 2022 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#include "PoseTrace.h"
+
+#include <Log.h>
+
+#include <sys/stat.h>
+
+#include <cstdio>
+
+
+namespace
+{
+
+/// Whether the type, status and validity of a record are values the driver API defines
+bool isValid(const PoseTrace::Record& record)
+{
+    using namespace VuforiaDriver;
+    switch (record.type)
+    {
+        case PoseTrace::RecordType::POSE:
+            return record.status >= static_cast<int32_t>(PoseReason::INITIALIZING) &&
+                   record.status <= static_cast<int32_t>(PoseReason::RELOCALIZING) &&
+                   record.validity >= static_cast<int32_t>(PoseValidity::VALID) &&
+                   record.validity <= static_cast<int32_t>(PoseValidity::UNRELIABLE);
+        case PoseTrace::RecordType::ANCHOR:
+            return record.status >= static_cast<int32_t>(AnchorStatus::ADDED) &&
+                   record.status <= static_cast<int32_t>(AnchorStatus::PAUSED);
+        default:
+            return false;
+    }
+}
+
+} // namespace
+
+bool PoseTrace::load(const std::string& path)
+{
+    mRecords.clear();
+
+    FILE* file = fopen(path.c_str(), "rb");
+    if (file == nullptr)
+    {
+        LOG("Failed to open pose trace %s", path.c_str());
+        return false;
+    }
+
+    Header header;
+    bool success = fread(&header, sizeof(header), 1, file) == 1;
+    if (!success || header.magic != MAGIC || header.version != VERSION)
+    {
+        LOG("%s is not a pose trace of version %u", path.c_str(), VERSION);
+        fclose(file);
+        return false;
+    }
+
+    // Check the record count against the file size before allocating for it
+    struct stat info;
+    success = fstat(fileno(file), &info) == 0 &&
+              static_cast<uint64_t>(header.numRecords) * sizeof(Record) <= static_cast<uint64_t>(info.st_size) - sizeof(Header);
+    if (success)
+    {
+        mRecords.resize(header.numRecords);
+        success = fread(mRecords.data(), sizeof(Record), mRecords.size(), file) == mRecords.size();
+    }
+    fclose(file);
+    if (!success)
+    {
+        LOG("Pose trace %s is truncated", path.c_str());
+        mRecords.clear();
+        return false;
+    }
+
+    for (size_t i = 0; i < mRecords.size(); ++i)
+    {
+        Record& record = mRecords[i];
+        record.uuid[MAX_UUID_LENGTH] = '\0';
+        // The values are passed on to Vuforia as driver enums, reject any they don't define
+        if (!isValid(record))
+        {
+            LOG("Pose trace %s has a record of unknown type %u, status %d or validity %d at record %zu", path.c_str(),
+                static_cast<uint32_t>(record.type), static_cast<int>(record.status), static_cast<int>(record.validity), i);
+            mRecords.clear();
+            return false;
+        }
+        if (i > 0 && record.timestamp < mRecords[i - 1].timestamp)
+        {
+            LOG("Pose trace %s is not in timestamp order at record %zu", path.c_str(), i);
+            mRecords.clear();
+            return false;
+        }
+    }
+
+    LOG("Loaded pose trace %s with %zu records", path.c_str(), mRecords.size());
+    return true;
+}
+
+
+bool PoseTrace::save(const std::string& path) const
+{
+    FILE* file = fopen(path.c_str(), "wb");
+    if (file == nullptr)
+    {
+        LOG("Failed to create pose trace %s", path.c_str());
+        return false;
+    }
+
+    Header header;
+    header.numRecords = static_cast<uint32_t>(mRecords.size());
+    bool success = fwrite(&header, sizeof(header), 1, file) == 1 &&
+                   fwrite(mRecords.data(), sizeof(Record), mRecords.size(), file) == mRecords.size();
+    success = fclose(file) == 0 && success;
+    if (!success)
+    {
+        LOG("Failed to write pose trace %s", path.c_str());
+    }
+    return success;
+}
@@ -0,0 +1,77 @@
+/*===============================================================================
+Copyright (c) 2022 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#ifndef __POSE_TRACE_H__
+#define __POSE_TRACE_H__
+
+#include <VuforiaEngine/Driver/Driver.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+/// A recorded sequence of device poses and anchor events
+/**
+ * The trace is a binary file in little endian byte order: a Header followed by
+ * Header::numRecords Records in ascending timestamp order. The timestamps use the same
+ * time base as the frames of the Recording the trace is replayed with.
+ */
+class PoseTrace
+{
+public:
+    static constexpr uint32_t MAGIC = 0x52545056; // "VPTR"
+    static constexpr uint32_t VERSION = 1;
+
+    /// Maximum length of an anchor UUID, excluding the terminating null
+    static constexpr size_t MAX_UUID_LENGTH = 39;
+
+    enum class RecordType : uint32_t
+    {
+        POSE,
+        ANCHOR,
+    };
+
+    VUFORIA_DRIVER_PACKED_STRUCT(Header
+    {
+        uint32_t magic { MAGIC };
+        uint32_t version { VERSION };
+        uint32_t numRecords { 0 };
+        uint32_t reserved { 0 };
+    });
+
+    VUFORIA_DRIVER_PACKED_STRUCT(Record
+    {
+        uint64_t timestamp { 0 };
+        RecordType type { RecordType::POSE };
+        /// VuforiaDriver::PoseReason of a pose, VuforiaDriver::AnchorStatus of an anchor event
+        int32_t status { 0 };
+        /// VuforiaDriver::PoseValidity of a pose
+        int32_t validity { 0 };
+        /// Pose of the device or the anchor, the rotation matrix is in row major order
+        float translation[3] { 0.f, 0.f, 0.f };
+        float rotation[9] { 1.f, 0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 0.f, 1.f };
+        /// Null terminated UUID of an anchor
+        char uuid[MAX_UUID_LENGTH + 1] {};
+    });
+
+    /// Read a trace file
+    /// Returns false if it is truncated, out of timestamp order or has a type, status or
+    /// validity the driver API doesn't define.
+    bool load(const std::string& path);
+
+    /// Write a trace file, e.g. from a tool capturing poses
+    bool save(const std::string& path) const;
+
+    const std::vector<Record>& getRecords() const { return mRecords; }
+    std::vector<Record>& getRecords() { return mRecords; }
+
+private:
+    std::vector<Record> mRecords;
+};
+
+#endif // __POSE_TRACE_H__
@@ -0,0 +1,240 @@
+/*===============================================================================
+Copyright (c) 2022 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#include "Recording.h"
+
+#include <PixelConverter.h>
+
+#include <Log.h>
+
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+
+namespace
+{
+
+bool isDirectory(const std::string& path)
+{
+    struct stat info;
+    return stat(path.c_str(), &info) == 0 && S_ISDIR(info.st_mode);
+}
+
+} // namespace
+
+
+bool Recording::load(const std::string& path)
+{
+    closeFile();
+    mFormat = PixelConverter::Format::UNKNOWN;
+    mCameraMode = VuforiaDriver::CameraMode();
+    mCameraMode.format = VuforiaDriver::PixelFormat::UNKNOWN;
+    mIntrinsics = VuforiaDriver::CameraIntrinsics();
+    mStride = 0;
+    mFrameSize = 0;
+    mFileNames.clear();
+    mFrames.clear();
+
+    std::string sequencePath = path;
+    if (isDirectory(path))
+    {
+        sequencePath = path + "/" + SEQUENCE_FILE_NAME;
+    }
+    std::string directory = ".";
+    size_t separator = sequencePath.find_last_of('/');
+    if (separator != std::string::npos)
+    {
+        directory = sequencePath.substr(0, separator);
+    }
+
+    std::ifstream sequence(sequencePath);
+    if (!sequence)
+    {
+        LOG("Failed to open recording %s", sequencePath.c_str());
+        return false;
+    }
+
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(sequence, line))
+    {
+        ++lineNumber;
+        if (!parseLine(line, directory))
+        {
+            LOG("Error in recording %s line %d: %s", sequencePath.c_str(), lineNumber, line.c_str());
+            return false;
+        }
+    }
+
+    if (mFormat == PixelConverter::Format::UNKNOWN || mCameraMode.width == 0 || mCameraMode.height == 0)
+    {
+        LOG("Recording %s doesn't specify the frame format and size", sequencePath.c_str());
+        return false;
+    }
+    if (mFrames.empty())
+    {
+        LOG("Recording %s doesn't contain any frames", sequencePath.c_str());
+        return false;
+    }
+
+    if (mStride == 0)
+    {
+        mStride = PixelConverter::getPackedStride(mFormat, mCameraMode.width);
+    }
+    mFrameSize = static_cast<uint32_t>(PixelConverter::getImageSize(mFormat, mCameraMode.width, mCameraMode.height, mStride));
+
+    if (mCameraMode.fps == 0 && mFrames.size() > 1)
+    {
+        // Derive the nominal frame rate from the timestamps
+        mCameraMode.fps = static_cast<uint32_t>((mFrames.size() - 1) * 1000000000ull / std::max<uint64_t>(getDuration(), 1));
+    }
+
+    LOG("Loaded recording %s with %zu frames", sequencePath.c_str(), mFrames.size());
+    return true;
+}
+
+
+uint64_t Recording::getDuration() const
+{
+    return mFrames.empty() ? 0 : mFrames.back().timestamp - mFrames.front().timestamp;
+}
+
+
+bool Recording::readFrame(size_t index, uint8_t* buffer)
+{
+    const Frame& frame = mFrames[index];
+    if (mFile == nullptr || mOpenFileIndex != frame.file)
+    {
+        closeFile();
+        mFile = fopen(mFileNames[frame.file].c_str(), "rb");
+        if (mFile == nullptr)
+        {
+            LOG("Failed to open frame file %s", mFileNames[frame.file].c_str());
+            return false;
+        }
+        mOpenFileIndex = frame.file;
+    }
+
+    if (fseeko(mFile, static_cast<off_t>(frame.offset), SEEK_SET) != 0 ||
+        fread(buffer, 1, mFrameSize, mFile) != mFrameSize)
+    {
+        LOG("Failed to read frame %zu from %s", index, mFileNames[frame.file].c_str());
+        return false;
+    }
+    return true;
+}
+
+
+void Recording::closeFile()
+{
+    if (mFile != nullptr)
+    {
+        fclose(mFile);
+        mFile = nullptr;
+    }
+}
+
+
+bool Recording::parseLine(const std::string& line, const std::string& directory)
+{
+    std::istringstream stream(line.substr(0, line.find('#')));
+    std::string key;
+    if (!(stream >> key))
+    {
+        // Empty line or comment
+        return true;
+    }
+
+    if (key == "format")
+    {
+        std::string name;
+        if (!(stream >> name))
+        {
+            return false;
+        }
+        mFormat = PixelConverter::parseFormat(name.c_str());
+        mCameraMode.format = PixelConverter::toDriverFormat(mFormat);
+        return mFormat != PixelConverter::Format::UNKNOWN;
+    }
+    if (key == "size")
+    {
+        // The driver structs are packed, so their fields are parsed through locals
+        uint32_t width = 0;
+        uint32_t height = 0;
+        if (!(stream >> width >> height))
+        {
+            return false;
+        }
+        mCameraMode.width = width;
+        mCameraMode.height = height;
+        return true;
+    }
+    if (key == "stride")
+    {
+        return static_cast<bool>(stream >> mStride);
+    }
+    if (key == "fps")
+    {
+        uint32_t fps = 0;
+        if (!(stream >> fps))
+        {
+            return false;
+        }
+        mCameraMode.fps = fps;
+        return true;
+    }
+    if (key == "intrinsics")
+    {
+        float values[4];
+        if (!(stream >> values[0] >> values[1] >> values[2] >> values[3]))
+        {
+            return false;
+        }
+        mIntrinsics = VuforiaDriver::CameraIntrinsics();
+        mIntrinsics.focalLengthX = values[0];
+        mIntrinsics.focalLengthY = values[1];
+        mIntrinsics.principalPointX = values[2];
+        mIntrinsics.principalPointY = values[3];
+
+        // The distortion coefficients are optional
+        float coefficient = 0.f;
+        for (int i = 0; i < 8 && (stream >> coefficient); ++i)
+        {
+            mIntrinsics.distortionCoefficients[i] = coefficient;
+        }
+        return true;
+    }
+    if (key == "frame")
+    {
+        Frame frame;
+        std::string fileName;
+        if (!(stream >> frame.timestamp >> fileName))
+        {
+            return false;
+        }
+        stream >> frame.offset >> frame.exposureTime;
+
+        if (!mFrames.empty() && frame.timestamp < mFrames.back().timestamp)
+        {
+            return false;
+        }
+
+        std::string filePath = fileName[0] == '/' ? fileName : directory + "/" + fileName;
+        if (mFileNames.empty() || mFileNames.back() != filePath)
+        {
+            mFileNames.push_back(filePath);
+        }
+        frame.file = static_cast<uint32_t>(mFileNames.size() - 1);
+        mFrames.push_back(frame);
+        return true;
+    }
+
+    return false;
+}
@@ -0,0 +1,95 @@
+/*===============================================================================
+Copyright (c) 2022 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#ifndef __RECORDING_H__
+#define __RECORDING_H__
+
+#include <PixelConverter.h>
+
+#include <VuforiaEngine/Driver/Driver.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+
+/// A sequence of recorded raw camera frames
+/**
+ * The sequence file is a text file with one entry per line, '#' starts a comment:
+ *
+ *     format NV21                  NV12, NV21, YUV420P, YV12, YUYV, UYVY, RGB888 or RGBA8888
+ *     size 640 480                 frame width and height in pixels
+ *     stride 640                   optional, bytes per row of the first plane
+ *     fps 30                       nominal frame rate reported as the camera mode
+ *     intrinsics fx fy cx cy [k0 .. k7]
+ *     frame <timestamp ns> <file> [offset] [exposure ns]
+ *
+ * Each frame line names the file holding the pixels, relative to the sequence file.
+ * The frames may each be in their own file or concatenated in a single container file
+ * with offset giving the position of each frame in bytes. Frame timestamps must be
+ * ascending, only the differences between them are used.
+ */
+class Recording
+{
+public:
+    /// File name looked up when the path passed to load is a directory
+    static constexpr const char* SEQUENCE_FILE_NAME = "sequence.txt";
+
+    struct Frame
+    {
+        uint64_t timestamp { 0 };
+        uint64_t exposureTime { 0 };
+        /// Index into the file names
+        uint32_t file { 0 };
+        uint64_t offset { 0 };
+    };
+
+    ~Recording() { closeFile(); }
+
+    /// Parse a sequence file, or the sequence file in a directory
+    bool load(const std::string& path);
+
+    /// The camera mode of the recorded frames, the format is UNKNOWN for formats Vuforia
+    /// doesn't accept, use getFormat to get the recorded format
+    const VuforiaDriver::CameraMode& getCameraMode() const { return mCameraMode; }
+    PixelConverter::Format getFormat() const { return mFormat; }
+    const VuforiaDriver::CameraIntrinsics& getIntrinsics() const { return mIntrinsics; }
+    uint32_t getStride() const { return mStride; }
+    /// Size in bytes of each frame
+    uint32_t getFrameSize() const { return mFrameSize; }
+
+    size_t getNumFrames() const { return mFrames.size(); }
+    const Frame& getFrame(size_t index) const { return mFrames[index]; }
+
+    /// Time from the first to the last frame in nanoseconds
+    uint64_t getDuration() const;
+
+    /// Read the pixels of a frame into buffer, which must hold getFrameSize() bytes
+    bool readFrame(size_t index, uint8_t* buffer);
+
+    /// Close the file kept open by readFrame
+    void closeFile();
+
+private:
+    bool parseLine(const std::string& line, const std::string& directory);
+
+    PixelConverter::Format mFormat { PixelConverter::Format::UNKNOWN };
+    VuforiaDriver::CameraMode mCameraMode;
+    VuforiaDriver::CameraIntrinsics mIntrinsics;
+    uint32_t mStride { 0 };
+    uint32_t mFrameSize { 0 };
+
+    std::vector<std::string> mFileNames;
+    std::vector<Frame> mFrames;
+
+    /// The file last read by readFrame, consecutive frames are usually in the same file
+    FILE* mFile { nullptr };
+    uint32_t mOpenFileIndex { 0 };
+};
+
+#endif // __RECORDING_H__
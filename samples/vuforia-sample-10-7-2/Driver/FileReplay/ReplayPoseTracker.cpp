@@ -0,0 +1,282 @@
+/*===============================================================================
+Copyright (c) 2022 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#include "ReplayPoseTracker.h"
+
+#include <Log.h>
+
+#include <cstring>
+#include <iterator>
+
+
+namespace
+{
+
+VuforiaDriver::AnchorPose toAnchorPose(const PoseTrace::Record& record)
+{
+    VuforiaDriver::AnchorPose pose;
+    memcpy(pose.translationData, record.translation, sizeof(pose.translationData));
+    memcpy(pose.rotationData, record.rotation, sizeof(pose.rotationData));
+    return pose;
+}
+
+} // namespace
+
+
+ReplayPoseTracker::ReplayPoseTracker(const FileReplay::Config& config)
+    : mTraceFilePath(config.poseTracePath),
+      mAlignPosesToFrames(config.alignPosesToFrames),
+      mMaxPoseExtrapolation(config.maxPoseExtrapolation)
+{
+}
+
+
+bool ReplayPoseTracker::open()
+{
+    if (!mOpen)
+    {
+        mOpen = mTrace.load(mTraceFilePath);
+    }
+    return mOpen;
+}
+
+
+bool ReplayPoseTracker::close()
+{
+    stop();
+    mTrace.getRecords().clear();
+    mOpen = false;
+    return true;
+}
+
+
+bool ReplayPoseTracker::start(VuforiaDriver::PoseCallback* cb, VuforiaDriver::AnchorCallback* anchorCb)
+{
+    if (!mOpen || cb == nullptr)
+    {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    mPoseCallback = cb;
+    mAnchorCallback = anchorCb;
+    mLoop = 0;
+    mNextRecord = 0;
+    mPosesDelivered = 0;
+    mAnchorEventsDelivered = 0;
+    mPosesExtrapolated = 0;
+    mPoseBuffer.clear();
+    return true;
+}
+
+
+bool ReplayPoseTracker::stop()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mPoseCallback = nullptr;
+    mAnchorCallback = nullptr;
+    return true;
+}
+
+
+bool ReplayPoseTracker::resetTracking()
+{
+    // The trace can't react to a reset, the anchors it reports are forgotten until they are
+    // added again
+    std::lock_guard<std::mutex> lock(mMutex);
+    for (auto it = mAnchors.begin(); it != mAnchors.end();)
+    {
+        it = it->first.compare(0, 7, "replay-") == 0 ? std::next(it) : mAnchors.erase(it);
+    }
+    return true;
+}
+
+
+const char* ReplayPoseTracker::createAnchor(VuforiaDriver::AnchorPose* anchorPose)
+{
+    if (anchorPose == nullptr)
+    {
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto inserted = mAnchors.emplace("replay-" + std::to_string(mNextAnchorId++), *anchorPose);
+    return inserted.first->first.c_str();
+}
+
+
+bool ReplayPoseTracker::removeAnchor(const char* uuid)
+{
+    if (uuid == nullptr)
+    {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mAnchors.erase(uuid) > 0;
+}
+
+
+void ReplayPoseTracker::deliverUntil(uint32_t loop, uint64_t recordedTimestamp, const TimestampMapping& toDeviceTimestamp)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (mPoseCallback == nullptr)
+    {
+        return;
+    }
+
+    if (loop != mLoop)
+    {
+        mLoop = loop;
+        mNextRecord = 0;
+        mPoseBuffer.clear();
+    }
+
+    const std::vector<PoseTrace::Record>& records = mTrace.getRecords();
+    while (mNextRecord < records.size() && records[mNextRecord].timestamp <= recordedTimestamp)
+    {
+        const PoseTrace::Record& record = records[mNextRecord];
+        if (record.type != PoseTrace::RecordType::POSE)
+        {
+            mNextRecord = deliverAnchorEvents(mNextRecord, records.size());
+            continue;
+        }
+
+        if (mAlignPosesToFrames)
+        {
+            // The record is packed, copy the pose out before passing it on
+            float translation[3];
+            float rotation[9];
+            memcpy(translation, record.translation, sizeof(translation));
+            memcpy(rotation, record.rotation, sizeof(rotation));
+            mPoseBuffer.add(record.timestamp, translation, rotation);
+            mLatestReason = static_cast<VuforiaDriver::PoseReason>(record.status);
+            mLatestValidity = static_cast<VuforiaDriver::PoseValidity>(record.validity);
+            ++mNextRecord;
+            continue;
+        }
+
+        VuforiaDriver::Pose pose;
+        pose.timestamp = toDeviceTimestamp(record.timestamp);
+        memcpy(pose.translationData, record.translation, sizeof(pose.translationData));
+        memcpy(pose.rotationData, record.rotation, sizeof(pose.rotationData));
+        pose.reason = static_cast<VuforiaDriver::PoseReason>(record.status);
+        pose.coordinateSystem = VuforiaDriver::PoseCoordSystem::CAMERA;
+        pose.validity = static_cast<VuforiaDriver::PoseValidity>(record.validity);
+        mPoseCallback->onNewPose(&pose);
+        ++mPosesDelivered;
+        ++mNextRecord;
+    }
+
+    if (mAlignPosesToFrames)
+    {
+        deliverFramePose(recordedTimestamp, toDeviceTimestamp);
+    }
+}
+
+
+uint64_t ReplayPoseTracker::getNumPosesDelivered()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mPosesDelivered;
+}
+
+
+uint64_t ReplayPoseTracker::getNumAnchorEventsDelivered()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mAnchorEventsDelivered;
+}
+
+
+uint64_t ReplayPoseTracker::getNumPosesExtrapolated()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mPosesExtrapolated;
+}
+
+
+void ReplayPoseTracker::deliverFramePose(uint64_t recordedTimestamp, const TimestampMapping& toDeviceTimestamp)
+{
+    VuforiaDriver::Pose pose;
+    float translation[3];
+    float rotation[9];
+    PoseBuffer::Result result = mPoseBuffer.sample(recordedTimestamp, translation, rotation, mMaxPoseExtrapolation);
+    if (result == PoseBuffer::Result::NONE)
+    {
+        // No pose was recorded close enough before the frame
+        return;
+    }
+
+    pose.timestamp = toDeviceTimestamp(recordedTimestamp);
+    memcpy(pose.translationData, translation, sizeof(pose.translationData));
+    memcpy(pose.rotationData, rotation, sizeof(pose.rotationData));
+    pose.reason = mLatestReason;
+    pose.coordinateSystem = VuforiaDriver::PoseCoordSystem::CAMERA;
+    pose.validity = mLatestValidity;
+    mPoseCallback->onNewPose(&pose);
+    ++mPosesDelivered;
+    if (result == PoseBuffer::Result::EXTRAPOLATED)
+    {
+        ++mPosesExtrapolated;
+    }
+}
+
+
+size_t ReplayPoseTracker::deliverAnchorEvents(size_t first, size_t end)
+{
+    const std::vector<PoseTrace::Record>& records = mTrace.getRecords();
+    const PoseTrace::Record& firstRecord = records[first];
+    const auto status = static_cast<VuforiaDriver::AnchorStatus>(firstRecord.status);
+
+    // Update the anchors first so that the UUID strings passed to the callback remain
+    // valid for its duration, removed anchors are erased afterwards
+    mAnchorEvents.clear();
+    size_t next = first;
+    for (; next < end; ++next)
+    {
+        const PoseTrace::Record& record = records[next];
+        if (record.type != PoseTrace::RecordType::ANCHOR || record.timestamp != firstRecord.timestamp ||
+            record.status != firstRecord.status)
+        {
+            break;
+        }
+
+        auto anchor = mAnchors.find(record.uuid);
+        if (status == VuforiaDriver::AnchorStatus::ADDED || status == VuforiaDriver::AnchorStatus::UPDATED)
+        {
+            VuforiaDriver::AnchorPose pose = toAnchorPose(record);
+            anchor = mAnchors.insert_or_assign(record.uuid, pose).first;
+        }
+        if (anchor == mAnchors.end())
+        {
+            // The anchor wasn't added or was forgotten by resetTracking
+            continue;
+        }
+
+        VuforiaDriver::Anchor event;
+        event.uuid = anchor->first.c_str();
+        event.pose = anchor->second;
+        mAnchorEvents.push_back(event);
+    }
+
+    if (!mAnchorEvents.empty() && mAnchorCallback != nullptr)
+    {
+        mAnchorCallback->onAnchorUpdate(mAnchorEvents.data(), static_cast<int>(mAnchorEvents.size()), status);
+        mAnchorEventsDelivered += mAnchorEvents.size();
+    }
+
+    if (status == VuforiaDriver::AnchorStatus::REMOVED)
+    {
+        for (const VuforiaDriver::Anchor& event : mAnchorEvents)
+        {
+            mAnchors.erase(event.uuid);
+        }
+    }
+    mAnchorEvents.clear();
+    return next;
+}
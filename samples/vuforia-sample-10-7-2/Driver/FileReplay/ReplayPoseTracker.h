@@ -0,0 +1,101 @@
+/*===============================================================================
+Copyright (c) 2022 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#ifndef __REPLAY_POSE_TRACKER_H__
+#define __REPLAY_POSE_TRACKER_H__
+
+#include "FileReplayConfig.h"
+#include "PoseTrace.h"
+
+#include <PoseBuffer.h>
+
+#include <VuforiaEngine/Driver/Driver.h>
+
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+
+/// ExternalPositionalDeviceTracker that replays the poses and anchor events of a PoseTrace
+/**
+ * The tracker has no thread of its own, the ReplayCamera delivers the trace records up to
+ * each frame's recorded timestamp just before delivering the frame, so the poses stay aligned
+ * with the frames in every replay mode. Anchors created by Vuforia with createAnchor are kept
+ * at their initial pose.
+ *
+ * With Config::alignPosesToFrames the recorded poses are collected in a PoseBuffer instead and
+ * a single pose is delivered per frame, sampled at the frame timestamp. Only the poses recorded
+ * up to the frame are used, as a device tracker delivering the pose with the frame would.
+ */
+class ReplayPoseTracker final : public VuforiaDriver::ExternalPositionalDeviceTracker
+{
+public:
+    /// Maps a recorded timestamp to the timestamp reported to Vuforia
+    using TimestampMapping = std::function<uint64_t(uint64_t recordedTimestamp)>;
+
+    explicit ReplayPoseTracker(const FileReplay::Config& config);
+
+    bool VUFORIA_DRIVER_CALLING_CONVENTION open() override;
+    bool VUFORIA_DRIVER_CALLING_CONVENTION close() override;
+    bool VUFORIA_DRIVER_CALLING_CONVENTION start(VuforiaDriver::PoseCallback* cb, VuforiaDriver::AnchorCallback* anchorCb) override;
+    bool VUFORIA_DRIVER_CALLING_CONVENTION stop() override;
+    bool VUFORIA_DRIVER_CALLING_CONVENTION resetTracking() override;
+
+    bool VUFORIA_DRIVER_CALLING_CONVENTION isAnchorSupported() override { return true; }
+    const char* VUFORIA_DRIVER_CALLING_CONVENTION createAnchor(VuforiaDriver::AnchorPose* anchorPose) override;
+    bool VUFORIA_DRIVER_CALLING_CONVENTION removeAnchor(const char* uuid) override;
+
+    /// Deliver the records of one pass over the trace with timestamps up to recordedTimestamp
+    /// Called by the ReplayCamera before each frame. The trace is restarted when loop changes.
+    void deliverUntil(uint32_t loop, uint64_t recordedTimestamp, const TimestampMapping& toDeviceTimestamp);
+
+    /// Number of poses and anchor events delivered since the tracker was started
+    uint64_t getNumPosesDelivered();
+    uint64_t getNumAnchorEventsDelivered();
+    uint64_t getNumPosesExtrapolated();
+
+private:
+    /// Deliver consecutive anchor records with the same timestamp and status in one callback
+    /// Returns the index of the first record not delivered.
+    size_t deliverAnchorEvents(size_t first, size_t end);
+
+    /// Deliver the pose of the frame at recordedTimestamp sampled from mPoseBuffer
+    void deliverFramePose(uint64_t recordedTimestamp, const TimestampMapping& toDeviceTimestamp);
+
+    std::string mTraceFilePath;
+    bool mAlignPosesToFrames;
+    uint64_t mMaxPoseExtrapolation;
+    PoseTrace mTrace;
+    bool mOpen { false };
+
+    /// Guards the members below, the callbacks are invoked with it held so that stop()
+    /// doesn't return while a callback is in progress
+    std::mutex mMutex;
+    VuforiaDriver::PoseCallback* mPoseCallback { nullptr };
+    VuforiaDriver::AnchorCallback* mAnchorCallback { nullptr };
+    uint32_t mLoop { 0 };
+    size_t mNextRecord { 0 };
+    uint64_t mPosesDelivered { 0 };
+    uint64_t mAnchorEventsDelivered { 0 };
+    uint64_t mPosesExtrapolated { 0 };
+
+    /// Recent poses when aligning the poses to the frames, with the reason and validity of the newest
+    PoseBuffer mPoseBuffer;
+    VuforiaDriver::PoseReason mLatestReason { VuforiaDriver::PoseReason::VALID };
+    VuforiaDriver::PoseValidity mLatestValidity { VuforiaDriver::PoseValidity::VALID };
+
+    /// The current anchors by UUID, the keys provide the UUID strings passed to Vuforia
+    std::unordered_map<std::string, VuforiaDriver::AnchorPose> mAnchors;
+    uint32_t mNextAnchorId { 0 };
+    /// Anchors passed to the anchor callback, reused between calls
+    std::vector<VuforiaDriver::Anchor> mAnchorEvents;
+};
+
+#endif // __REPLAY_POSE_TRACKER_H__
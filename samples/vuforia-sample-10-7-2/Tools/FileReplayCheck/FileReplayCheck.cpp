@@ -0,0 +1,796 @@
+/*===============================================================================
+Copyright (c) 2022 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+// Replays small generated recordings through the file replay driver, calling it the way the
+// Vuforia Engine does, and checks the delivered frames and the replay statistics in each replay
+// mode, with looping, dropping of late frames and conversion of the recorded format. A generated
+// pose trace checks the poses and anchor events of the replayed device tracker.
+//
+// Usage: FileReplayCheck [directory]
+// The recordings are written to directory, by default FileReplayCheck in the temp directory.
+
+#include <FileReplayConfig.h>
+#include <PixelConverter.h>
+#include <PoseTrace.h>
+
+#include <VuforiaEngine/Driver/Driver.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+
+namespace
+{
+
+using namespace std::chrono_literals;
+
+constexpr uint32_t WIDTH = 8;
+constexpr uint32_t HEIGHT = 4;
+constexpr uint32_t NUM_FRAMES = 10;
+constexpr uint32_t FPS = 100;
+constexpr uint64_t FRAME_INTERVAL = 1000000000ull / FPS;
+constexpr uint64_t FIRST_TIMESTAMP = 5000000000ull;
+constexpr uint64_t EXPOSURE_TIME = 1000000;
+
+/// Longest time any replay is waited for
+constexpr auto TIMEOUT = 10s;
+
+int gNumFailures = 0;
+
+
+void expect(bool condition, const char* format, ...)
+{
+    if (condition)
+    {
+        return;
+    }
+    ++gNumFailures;
+    va_list arguments;
+    va_start(arguments, format);
+    vprintf(format, arguments);
+    va_end(arguments);
+    printf("\n");
+}
+
+
+uint64_t now()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+
+/// Pixels of a recorded frame, every byte identifies the frame and its position
+std::vector<uint8_t> getRecordedPixels(PixelConverter::Format format, uint32_t frame)
+{
+    std::vector<uint8_t> pixels(PixelConverter::getImageSize(format, WIDTH, HEIGHT));
+    for (size_t i = 0; i < pixels.size(); ++i)
+    {
+        pixels[i] = static_cast<uint8_t>(frame * 16 + i);
+    }
+    return pixels;
+}
+
+
+/// Write a recording of NUM_FRAMES frames in a single container file
+bool writeRecording(const std::filesystem::path& directory, PixelConverter::Format format, const char* formatName)
+{
+    std::filesystem::create_directories(directory);
+    std::ofstream sequence(directory / "sequence.txt");
+    std::ofstream frames(directory / "frames.bin", std::ios::binary);
+
+    sequence << "format " << formatName << "\n"
+             << "size " << WIDTH << " " << HEIGHT << "\n"
+             << "fps " << FPS << "\n"
+             << "intrinsics 10 10 4 2\n";
+    size_t offset = 0;
+    for (uint32_t i = 0; i < NUM_FRAMES; ++i)
+    {
+        std::vector<uint8_t> pixels = getRecordedPixels(format, i);
+        frames.write(reinterpret_cast<const char*>(pixels.data()), static_cast<std::streamsize>(pixels.size()));
+        sequence << "frame " << FIRST_TIMESTAMP + i * FRAME_INTERVAL << " frames.bin " << offset << " "
+                 << EXPOSURE_TIME + i << "\n";
+        offset += pixels.size();
+    }
+    return static_cast<bool>(sequence) && static_cast<bool>(frames);
+}
+
+
+/// A frame as the callback received it
+struct DeliveredFrame
+{
+    uint64_t arrivalTime;
+    uint64_t timestamp;
+    uint64_t exposureTime;
+    uint32_t index;
+    VuforiaDriver::PixelFormat format;
+    uint32_t stride;
+    std::vector<uint8_t> pixels;
+};
+
+
+/// Keeps a copy of every frame delivered, optionally blocking the replay in the first callback
+class CountingCallback : public VuforiaDriver::CameraCallback
+{
+public:
+    explicit CountingCallback(std::chrono::milliseconds firstFrameDelay = 0ms) : mFirstFrameDelay(firstFrameDelay) {}
+
+    void VUFORIA_DRIVER_CALLING_CONVENTION onNewCameraFrame(VuforiaDriver::CameraFrame* frame) override
+    {
+        DeliveredFrame delivered { now(), frame->timestamp, frame->exposureTime, frame->index, frame->format,
+                                   frame->stride, std::vector<uint8_t>(frame->buffer, frame->buffer + frame->bufferSize) };
+        bool first;
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            first = mFrames.empty();
+            mFrames.push_back(std::move(delivered));
+        }
+        mCondition.notify_all();
+        if (first)
+        {
+            std::this_thread::sleep_for(mFirstFrameDelay);
+        }
+    }
+
+    /// Wait until at least numFrames frames were delivered, returns false on timeout
+    bool waitForFrames(size_t numFrames)
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        return mCondition.wait_for(lock, TIMEOUT, [&] { return mFrames.size() >= numFrames; });
+    }
+
+    std::vector<DeliveredFrame> getFrames()
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mFrames;
+    }
+
+private:
+    std::chrono::milliseconds mFirstFrameDelay;
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+    std::vector<DeliveredFrame> mFrames;
+};
+
+
+/// Log of the frames, poses and anchor events delivered by a replay with a pose trace
+/**
+ * Pose timestamps are logged in microseconds from the first frame, anchor events with the
+ * x translation of each anchor.
+ */
+class EventLog : public VuforiaDriver::CameraCallback, public VuforiaDriver::PoseCallback,
+                 public VuforiaDriver::AnchorCallback
+{
+public:
+    void VUFORIA_DRIVER_CALLING_CONVENTION onNewCameraFrame(VuforiaDriver::CameraFrame* frame) override
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            if (mNumFrames++ == 0)
+            {
+                mFirstFrameTimestamp = frame->timestamp;
+            }
+            mEvents.push_back({ 0, "frame " + std::to_string(frame->index) });
+        }
+        mCondition.notify_all();
+    }
+
+    void VUFORIA_DRIVER_CALLING_CONVENTION onNewPose(VuforiaDriver::Pose* pose) override
+    {
+        char text[64];
+        snprintf(text, sizeof(text), " %.3f %d %d", pose->translationData[0], static_cast<int>(pose->reason),
+                 static_cast<int>(pose->validity));
+        std::lock_guard<std::mutex> lock(mMutex);
+        mEvents.push_back({ pose->timestamp, text });
+    }
+
+    void VUFORIA_DRIVER_CALLING_CONVENTION onAnchorUpdate(VuforiaDriver::Anchor* anchors, int numAnchors,
+                                                          VuforiaDriver::AnchorStatus status) override
+    {
+        static const char* const STATUS_NAMES[] = { "ADDED", "UPDATED", "REMOVED", "PAUSED" };
+        std::string text = STATUS_NAMES[static_cast<int>(status)];
+        for (int i = 0; i < numAnchors; ++i)
+        {
+            char pose[32];
+            snprintf(pose, sizeof(pose), " %.3f", anchors[i].pose.translationData[0]);
+            text += std::string(" ") + anchors[i].uuid + pose;
+        }
+        std::lock_guard<std::mutex> lock(mMutex);
+        mEvents.push_back({ 0, text });
+    }
+
+    bool waitForFrames(size_t numFrames)
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        return mCondition.wait_for(lock, TIMEOUT, [&] { return mNumFrames >= numFrames; });
+    }
+
+    std::vector<std::string> getLog()
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        std::vector<std::string> log;
+        for (const Event& event : mEvents)
+        {
+            log.push_back(event.timestamp == 0 ? event.text :
+                          "pose " + std::to_string((event.timestamp - mFirstFrameTimestamp) / 1000) + event.text);
+        }
+        return log;
+    }
+
+private:
+    struct Event
+    {
+        /// Timestamp of a pose, 0 for the other events
+        uint64_t timestamp;
+        std::string text;
+    };
+
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+    std::vector<Event> mEvents;
+    size_t mNumFrames { 0 };
+    uint64_t mFirstFrameTimestamp { 0 };
+};
+
+
+/// A driver and its camera, created, opened and started as the Vuforia Engine does
+/// If the configuration has a pose trace the tracker is started with eventLog as its callbacks.
+class Replay
+{
+public:
+    Replay(const FileReplay::Config& config, VuforiaDriver::CameraCallback& callback, EventLog* eventLog = nullptr)
+        : mConfig(config)
+    {
+        mDriver = vuforiaDriver_init(nullptr, &mConfig);
+        mCamera = mDriver != nullptr ? mDriver->createExternalCamera() : nullptr;
+        if (mConfig.poseTracePath != nullptr && mDriver != nullptr)
+        {
+            mTracker = mDriver->createExternalPositionalDeviceTracker();
+            if (mTracker == nullptr || !mTracker->open() || !mTracker->start(eventLog, eventLog))
+            {
+                expect(false, "Failed to start the replay of %s", config.poseTracePath);
+                mStarted = false;
+                return;
+            }
+        }
+        if (mCamera == nullptr || !mCamera->open() || mCamera->getNumSupportedCameraModes() != 1 ||
+            !mCamera->getSupportedCameraMode(0, &mCameraMode) || !mCamera->start(mCameraMode, &callback))
+        {
+            expect(false, "Failed to start the replay of %s", config.recordingPath);
+            mStarted = false;
+        }
+    }
+
+    ~Replay()
+    {
+        if (mCamera != nullptr)
+        {
+            mCamera->stop();
+            mCamera->close();
+            mDriver->destroyExternalCamera(mCamera);
+        }
+        if (mTracker != nullptr)
+        {
+            mTracker->stop();
+            mTracker->close();
+            mDriver->destroyExternalPositionalDeviceTracker(mTracker);
+        }
+        if (mDriver != nullptr)
+        {
+            vuforiaDriver_deinit(mDriver);
+        }
+    }
+
+    bool isStarted() const { return mStarted; }
+    const VuforiaDriver::CameraMode& getCameraMode() const { return mCameraMode; }
+
+    FileReplay::Stats getStats()
+    {
+        FileReplay::Stats stats;
+        expect(fileReplayDriver_getStats(&stats), "fileReplayDriver_getStats failed");
+        return stats;
+    }
+
+    /// Wait until the replay finished and return its statistics
+    FileReplay::Stats waitUntilFinished()
+    {
+        auto deadline = std::chrono::steady_clock::now() + TIMEOUT;
+        FileReplay::Stats stats = getStats();
+        while (!stats.finished && std::chrono::steady_clock::now() < deadline)
+        {
+            std::this_thread::sleep_for(1ms);
+            stats = getStats();
+        }
+        expect(stats.finished, "The replay didn't finish");
+        return stats;
+    }
+
+    void stop() { mCamera->stop(); }
+
+    VuforiaDriver::ExternalPositionalDeviceTracker* getTracker() { return mTracker; }
+
+private:
+    FileReplay::Config mConfig;
+    VuforiaDriver::Driver* mDriver { nullptr };
+    VuforiaDriver::ExternalCamera* mCamera { nullptr };
+    VuforiaDriver::ExternalPositionalDeviceTracker* mTracker { nullptr };
+    VuforiaDriver::CameraMode mCameraMode;
+    bool mStarted { true };
+};
+
+
+/// Check the frames delivered by numLoops passes over the NV21 recording
+void checkFrames(const char* name, const std::vector<DeliveredFrame>& frames, uint32_t numLoops, double speed)
+{
+    expect(frames.size() == NUM_FRAMES * numLoops, "%s: %zu frames delivered, expected %u", name, frames.size(),
+           NUM_FRAMES * numLoops);
+    for (size_t i = 0; i < frames.size(); ++i)
+    {
+        const DeliveredFrame& frame = frames[i];
+        uint32_t recordedIndex = static_cast<uint32_t>(i % NUM_FRAMES);
+        // A loop lasts one frame interval longer than the recording, so the timestamps stay evenly spaced
+        uint64_t expectedOffset = static_cast<uint64_t>(i * FRAME_INTERVAL / speed);
+        uint64_t offset = frame.timestamp - frames[0].timestamp;
+        expect(frame.index == i, "%s: frame %zu has index %u", name, i, frame.index);
+        expect(offset + 1 >= expectedOffset && offset <= expectedOffset + 1,
+               "%s: frame %zu is at %llu ns, expected %llu ns", name, i, static_cast<unsigned long long>(offset),
+               static_cast<unsigned long long>(expectedOffset));
+        expect(frame.exposureTime == EXPOSURE_TIME + recordedIndex, "%s: frame %zu has the wrong exposure time", name, i);
+        expect(frame.format == VuforiaDriver::PixelFormat::NV21 && frame.stride == WIDTH,
+               "%s: frame %zu has format %d and stride %u", name, i, static_cast<int>(frame.format), frame.stride);
+        expect(frame.pixels == getRecordedPixels(PixelConverter::Format::NV21, recordedIndex),
+               "%s: frame %zu doesn't have the pixels of recorded frame %u", name, i, recordedIndex);
+    }
+}
+
+
+void checkStats(const char* name, const FileReplay::Stats& stats, uint64_t delivered, uint64_t dropped)
+{
+    expect(stats.framesDelivered == delivered, "%s: stats report %llu frames delivered, expected %llu", name,
+           static_cast<unsigned long long>(stats.framesDelivered), static_cast<unsigned long long>(delivered));
+    expect(stats.framesDropped == dropped, "%s: stats report %llu frames dropped, expected %llu", name,
+           static_cast<unsigned long long>(stats.framesDropped), static_cast<unsigned long long>(dropped));
+    expect(stats.bufferPoolExhausted == 0, "%s: the frame buffers were exhausted", name);
+    expect(stats.maxCallbackTime <= stats.totalCallbackTime && stats.totalCallbackTime <= stats.elapsedTime,
+           "%s: inconsistent callback times", name);
+    expect(stats.posesDelivered == 0 && stats.anchorEventsDelivered == 0, "%s: poses delivered without a trace", name);
+}
+
+
+void checkAsFastAsPossible(const std::string& recording)
+{
+    FileReplay::Config config;
+    config.recordingPath = recording.c_str();
+    config.mode = FileReplay::ReplayMode::AS_FAST_AS_POSSIBLE;
+    config.loopCount = 3;
+
+    for (bool preload : { true, false })
+    {
+        const char* name = preload ? "AS_FAST_AS_POSSIBLE" : "AS_FAST_AS_POSSIBLE streamed";
+        config.preload = preload;
+        CountingCallback callback;
+        Replay replay(config, callback);
+        if (!replay.isStarted())
+        {
+            return;
+        }
+        FileReplay::Stats stats = replay.waitUntilFinished();
+        checkFrames(name, callback.getFrames(), config.loopCount, 1.0);
+        checkStats(name, stats, NUM_FRAMES * config.loopCount, 0);
+    }
+}
+
+
+void checkRealTime(const std::string& recording)
+{
+    const char* name = "REAL_TIME";
+    FileReplay::Config config;
+    config.recordingPath = recording.c_str();
+    config.speed = 2.0f;
+
+    CountingCallback callback;
+    uint64_t startTime = now();
+    Replay replay(config, callback);
+    if (!replay.isStarted())
+    {
+        return;
+    }
+    FileReplay::Stats stats = replay.waitUntilFinished();
+    std::vector<DeliveredFrame> frames = callback.getFrames();
+    checkFrames(name, frames, 1, config.speed);
+    checkStats(name, stats, NUM_FRAMES, 0);
+
+    // The timestamps are on the steady clock, no frame may arrive before its timestamp
+    for (size_t i = 0; i < frames.size(); ++i)
+    {
+        expect(frames[i].timestamp >= startTime && frames[i].arrivalTime >= frames[i].timestamp,
+               "%s: frame %zu arrived before its timestamp", name, i);
+    }
+    uint64_t duration = static_cast<uint64_t>((NUM_FRAMES - 1) * FRAME_INTERVAL / config.speed);
+    expect(stats.elapsedTime >= duration, "%s: the replay took %llu ns, expected at least %llu ns", name,
+           static_cast<unsigned long long>(stats.elapsedTime), static_cast<unsigned long long>(duration));
+}
+
+
+void checkStepped(const std::string& recording)
+{
+    const char* name = "STEPPED";
+    FileReplay::Config config;
+    config.recordingPath = recording.c_str();
+    config.mode = FileReplay::ReplayMode::STEPPED;
+
+    CountingCallback callback;
+    Replay replay(config, callback);
+    if (!replay.isStarted())
+    {
+        return;
+    }
+
+    std::this_thread::sleep_for(50ms);
+    expect(callback.getFrames().empty(), "%s: frames delivered without a step", name);
+
+    fileReplayDriver_step(3);
+    expect(callback.waitForFrames(3), "%s: the first 3 steps weren't delivered", name);
+    std::this_thread::sleep_for(50ms);
+    expect(callback.getFrames().size() == 3, "%s: %zu frames delivered after 3 steps", name, callback.getFrames().size());
+    expect(!replay.getStats().finished, "%s: finished after 3 steps", name);
+
+    fileReplayDriver_step(NUM_FRAMES - 3);
+    FileReplay::Stats stats = replay.waitUntilFinished();
+    checkFrames(name, callback.getFrames(), 1, 1.0);
+    checkStats(name, stats, NUM_FRAMES, 0);
+}
+
+
+void checkDropLateFrames(const std::string& recording)
+{
+    FileReplay::Config config;
+    config.recordingPath = recording.c_str();
+
+    for (bool dropLateFrames : { true, false })
+    {
+        const char* name = dropLateFrames ? "dropLateFrames" : "without dropLateFrames";
+        config.dropLateFrames = dropLateFrames;
+
+        // Holding the first frame for several frame intervals makes the following frames late
+        CountingCallback callback(std::chrono::milliseconds(4 * FRAME_INTERVAL / 1000000));
+        Replay replay(config, callback);
+        if (!replay.isStarted())
+        {
+            return;
+        }
+        FileReplay::Stats stats = replay.waitUntilFinished();
+        std::vector<DeliveredFrame> frames = callback.getFrames();
+        expect(stats.framesDelivered == frames.size(), "%s: stats report %llu frames delivered, %zu were", name,
+               static_cast<unsigned long long>(stats.framesDelivered), frames.size());
+        expect(stats.framesDelivered + stats.framesDropped == NUM_FRAMES, "%s: %llu frames delivered and %llu dropped",
+               name, static_cast<unsigned long long>(stats.framesDelivered),
+               static_cast<unsigned long long>(stats.framesDropped));
+        if (dropLateFrames)
+        {
+            expect(stats.framesDropped > 0, "%s: no late frame was dropped", name);
+        }
+        else
+        {
+            expect(stats.framesDropped == 0, "%s: late frames were dropped", name);
+        }
+
+        // The indices count the delivered frames, the timestamps keep the recorded spacing
+        for (size_t i = 1; i < frames.size(); ++i)
+        {
+            expect(frames[i].index == i, "%s: frame %zu has index %u", name, i, frames[i].index);
+            expect((frames[i].timestamp - frames[0].timestamp) % FRAME_INTERVAL <= 1,
+                   "%s: frame %zu isn't at a recorded timestamp", name, i);
+        }
+    }
+}
+
+
+void checkConversion(const std::string& recording)
+{
+    const char* name = "UYVY to NV21";
+    FileReplay::Config config;
+    config.recordingPath = recording.c_str();
+    config.mode = FileReplay::ReplayMode::AS_FAST_AS_POSSIBLE;
+
+    CountingCallback callback;
+    Replay replay(config, callback);
+    if (!replay.isStarted())
+    {
+        return;
+    }
+    expect(replay.getCameraMode().format == VuforiaDriver::PixelFormat::NV21,
+           "%s: the camera mode has format %d", name, static_cast<int>(replay.getCameraMode().format));
+
+    FileReplay::Stats stats = replay.waitUntilFinished();
+    checkStats(name, stats, NUM_FRAMES, 0);
+    expect(stats.totalConversionTime > 0, "%s: no conversion time reported", name);
+
+    std::vector<DeliveredFrame> frames = callback.getFrames();
+    expect(frames.size() == NUM_FRAMES, "%s: %zu frames delivered", name, frames.size());
+    for (size_t i = 0; i < frames.size(); ++i)
+    {
+        std::vector<uint8_t> recorded = getRecordedPixels(PixelConverter::Format::UYVY, static_cast<uint32_t>(i));
+        std::vector<uint8_t> expected(PixelConverter::getImageSize(PixelConverter::Format::NV21, WIDTH, HEIGHT));
+        PixelConverter::convert(PixelConverter::Format::UYVY, recorded.data(), 0, PixelConverter::Format::NV21,
+                                expected.data(), 0, WIDTH, HEIGHT);
+
+        const DeliveredFrame& frame = frames[i];
+        expect(frame.format == VuforiaDriver::PixelFormat::NV21 && frame.stride == WIDTH,
+               "%s: frame %zu has format %d and stride %u", name, i, static_cast<int>(frame.format), frame.stride);
+        expect(frame.pixels == expected, "%s: frame %zu isn't the converted recorded frame", name, i);
+
+        // The luma is copied unchanged from the odd bytes of UYVY
+        bool lumaCopied = frame.pixels.size() == expected.size();
+        for (uint32_t j = 0; lumaCopied && j < WIDTH * HEIGHT; ++j)
+        {
+            lumaCopied = frame.pixels[j] == recorded[j * 2 + 1];
+        }
+        expect(lumaCopied, "%s: frame %zu doesn't have the recorded luma", name, i);
+    }
+}
+
+
+PoseTrace::Record makePose(int64_t time, float x, VuforiaDriver::PoseReason reason,
+                           VuforiaDriver::PoseValidity validity = VuforiaDriver::PoseValidity::VALID)
+{
+    PoseTrace::Record record;
+    record.timestamp = static_cast<uint64_t>(static_cast<int64_t>(FIRST_TIMESTAMP) + time * 1000000);
+    record.type = PoseTrace::RecordType::POSE;
+    record.status = static_cast<int32_t>(reason);
+    record.validity = static_cast<int32_t>(validity);
+    record.translation[0] = x;
+    return record;
+}
+
+
+PoseTrace::Record makeAnchor(int64_t time, VuforiaDriver::AnchorStatus status, const char* uuid, float x)
+{
+    PoseTrace::Record record = makePose(time, x, VuforiaDriver::PoseReason::VALID);
+    record.type = PoseTrace::RecordType::ANCHOR;
+    record.status = static_cast<int32_t>(status);
+    snprintf(record.uuid, sizeof(record.uuid), "%s", uuid);
+    return record;
+}
+
+
+/// Write the pose trace replayed with the NV21 recording, times are in milliseconds from its first frame
+bool writePoseTrace(const std::string& path)
+{
+    using VuforiaDriver::AnchorStatus;
+    using VuforiaDriver::PoseReason;
+
+    PoseTrace trace;
+    trace.getRecords() = {
+        makePose(-1, 0.f, PoseReason::VALID),
+        makeAnchor(0, AnchorStatus::ADDED, "a", 1.f),
+        makeAnchor(0, AnchorStatus::ADDED, "b", 2.f),
+        makePose(5, 5.f, PoseReason::RELOCALIZING, VuforiaDriver::PoseValidity::UNRELIABLE),
+        makeAnchor(10, AnchorStatus::UPDATED, "a", 3.f),
+        // Removing an unknown anchor isn't reported
+        makeAnchor(20, AnchorStatus::REMOVED, "b", 0.f),
+        makeAnchor(20, AnchorStatus::REMOVED, "c", 0.f),
+        makeAnchor(20, AnchorStatus::UPDATED, "a", 4.f),
+        makePose(25, 25.f, PoseReason::VALID),
+        makePose(40, 40.f, PoseReason::VALID),
+        // After the last frame, never delivered
+        makePose(95, 95.f, PoseReason::VALID),
+    };
+    return trace.save(path);
+}
+
+
+/// The events of one pass over the pose trace and the NV21 recording, delivering every pose
+/// Without removeB the tracking was reset before anchor b was removed, so its removal isn't reported.
+void addTraceEvents(std::vector<std::string>& log, uint32_t loop, bool removeB)
+{
+    auto pose = [&](uint64_t time, const char* rest) {
+        uint64_t offset = loop * NUM_FRAMES * FRAME_INTERVAL + time * 1000000;
+        log.push_back("pose " + std::to_string(offset / 1000) + rest);
+    };
+    auto frame = [&](uint32_t index) { log.push_back("frame " + std::to_string(loop * NUM_FRAMES + index)); };
+
+    // The pose recorded before the first frame is reported at the start of the loop
+    pose(0, " 0.000 1 0");
+    log.push_back("ADDED a 1.000 b 2.000");
+    frame(0);
+    pose(5, " 5.000 5 1");
+    log.push_back("UPDATED a 3.000");
+    frame(1);
+    if (removeB)
+    {
+        log.push_back("REMOVED b 2.000");
+    }
+    log.push_back("UPDATED a 4.000");
+    frame(2);
+    pose(25, " 25.000 1 0");
+    frame(3);
+    pose(40, " 40.000 1 0");
+    for (uint32_t i = 4; i < NUM_FRAMES; ++i)
+    {
+        frame(i);
+    }
+}
+
+
+void checkLog(const char* name, const std::vector<std::string>& log, const std::vector<std::string>& expected)
+{
+    if (log == expected)
+    {
+        return;
+    }
+    expect(false, "%s: expected the events on the left, got those on the right", name);
+    for (size_t i = 0; i < std::max(log.size(), expected.size()); ++i)
+    {
+        printf("    %-32s %s\n", i < expected.size() ? expected[i].c_str() : "", i < log.size() ? log[i].c_str() : "");
+    }
+}
+
+
+void checkPoseTrace(const std::string& recording, const std::string& poseTrace)
+{
+    FileReplay::Config config;
+    config.recordingPath = recording.c_str();
+    config.poseTracePath = poseTrace.c_str();
+    config.mode = FileReplay::ReplayMode::AS_FAST_AS_POSSIBLE;
+    config.loopCount = 2;
+
+    {
+        // Every loop restarts the trace and reports its anchors again
+        const char* name = "pose trace";
+        EventLog eventLog;
+        Replay replay(config, eventLog, &eventLog);
+        if (!replay.isStarted())
+        {
+            return;
+        }
+        FileReplay::Stats stats = replay.waitUntilFinished();
+        std::vector<std::string> expected;
+        addTraceEvents(expected, 0, true);
+        addTraceEvents(expected, 1, true);
+        checkLog(name, eventLog.getLog(), expected);
+        expect(stats.posesDelivered == 8 && stats.anchorEventsDelivered == 10 && stats.posesExtrapolated == 0,
+               "%s: stats report %llu poses, %llu anchor events and %llu extrapolated poses", name,
+               static_cast<unsigned long long>(stats.posesDelivered),
+               static_cast<unsigned long long>(stats.anchorEventsDelivered),
+               static_cast<unsigned long long>(stats.posesExtrapolated));
+    }
+
+    {
+        // resetTracking forgets the anchors of the trace but keeps those created by Vuforia
+        const char* name = "pose trace resetTracking";
+        config.mode = FileReplay::ReplayMode::STEPPED;
+        config.loopCount = 1;
+        EventLog eventLog;
+        Replay replay(config, eventLog, &eventLog);
+        if (!replay.isStarted())
+        {
+            return;
+        }
+        VuforiaDriver::AnchorPose anchorPose;
+        std::string created = replay.getTracker()->createAnchor(&anchorPose);
+
+        fileReplayDriver_step(2);
+        expect(eventLog.waitForFrames(2), "%s: the first 2 steps weren't delivered", name);
+        replay.getTracker()->resetTracking();
+        fileReplayDriver_step(NUM_FRAMES - 2);
+        replay.waitUntilFinished();
+
+        std::vector<std::string> expected;
+        addTraceEvents(expected, 0, false);
+        checkLog(name, eventLog.getLog(), expected);
+        expect(replay.getTracker()->removeAnchor(created.c_str()), "%s: the anchor created by Vuforia was forgotten",
+               name);
+        expect(!replay.getTracker()->removeAnchor(created.c_str()), "%s: a removed anchor was removed again", name);
+    }
+
+    {
+        // One pose per frame at the frame timestamp, extrapolated up to 50 ms past the last recorded pose
+        const char* name = "pose trace alignPosesToFrames";
+        config.mode = FileReplay::ReplayMode::AS_FAST_AS_POSSIBLE;
+        config.alignPosesToFrames = true;
+        config.maxPoseExtrapolation = 50000000;
+        EventLog eventLog;
+        Replay replay(config, eventLog, &eventLog);
+        if (!replay.isStarted())
+        {
+            return;
+        }
+        FileReplay::Stats stats = replay.waitUntilFinished();
+        std::vector<std::string> expected = {
+            "ADDED a 1.000 b 2.000", "pose 0 0.000 1 0", "frame 0",
+            "UPDATED a 3.000", "pose 10000 9.167 5 1", "frame 1",
+            "REMOVED b 2.000", "UPDATED a 4.000", "pose 20000 17.500 5 1", "frame 2",
+            "pose 30000 30.000 1 0", "frame 3",
+        };
+        for (uint32_t i = 4; i < NUM_FRAMES; ++i)
+        {
+            expected.push_back("pose " + std::to_string(i * 10000) + " " + std::to_string(i * 10) + ".000 1 0");
+            expected.push_back("frame " + std::to_string(i));
+        }
+        checkLog(name, eventLog.getLog(), expected);
+        // Only the pose of frame 4 was recorded at the frame timestamp
+        expect(stats.posesDelivered == NUM_FRAMES && stats.posesExtrapolated == NUM_FRAMES - 1,
+               "%s: stats report %llu poses of which %llu extrapolated", name,
+               static_cast<unsigned long long>(stats.posesDelivered),
+               static_cast<unsigned long long>(stats.posesExtrapolated));
+    }
+}
+
+
+void checkPoseTraceValidation(const std::filesystem::path& directory)
+{
+    std::string path = (directory / "invalid.vptr").string();
+    PoseTrace trace;
+    PoseTrace loaded;
+
+    trace.getRecords() = { makeAnchor(0, VuforiaDriver::AnchorStatus::PAUSED, "a", 0.f) };
+    expect(trace.save(path) && loaded.load(path) && loaded.getRecords().size() == 1,
+           "A valid pose trace failed to load");
+
+    PoseTrace::Record pose = makePose(0, 0.f, VuforiaDriver::PoseReason::VALID);
+    PoseTrace::Record anchor = makeAnchor(0, VuforiaDriver::AnchorStatus::ADDED, "a", 0.f);
+    std::vector<std::pair<const char*, PoseTrace::Record>> invalidRecords(4, { "type", pose });
+    invalidRecords[0].second.type = static_cast<PoseTrace::RecordType>(2);
+    invalidRecords[1] = { "pose reason", pose };
+    invalidRecords[1].second.status = static_cast<int32_t>(VuforiaDriver::PoseReason::RELOCALIZING) + 1;
+    invalidRecords[2] = { "pose validity", pose };
+    invalidRecords[2].second.validity = -1;
+    invalidRecords[3] = { "anchor status", anchor };
+    invalidRecords[3].second.status = static_cast<int32_t>(VuforiaDriver::AnchorStatus::PAUSED) + 1;
+
+    for (const auto& invalid : invalidRecords)
+    {
+        trace.getRecords() = { makePose(-1, 0.f, VuforiaDriver::PoseReason::VALID), invalid.second };
+        expect(trace.save(path) && !loaded.load(path), "A pose trace with an invalid %s was loaded", invalid.first);
+    }
+}
+
+} // namespace
+
+
+int main(int argc, char* argv[])
+{
+    std::filesystem::path directory = argc > 1 ? std::filesystem::path(argv[1])
+                                               : std::filesystem::temp_directory_path() / "FileReplayCheck";
+    std::string nv21Recording = (directory / "NV21").string();
+    std::string uyvyRecording = (directory / "UYVY").string();
+    std::string poseTrace = (directory / "trace.vptr").string();
+    if (!writeRecording(nv21Recording, PixelConverter::Format::NV21, "NV21") ||
+        !writeRecording(uyvyRecording, PixelConverter::Format::UYVY, "UYVY") || !writePoseTrace(poseTrace))
+    {
+        printf("Failed to write the recordings to %s\n", directory.string().c_str());
+        return 1;
+    }
+
+    checkAsFastAsPossible(nv21Recording);
+    checkRealTime(nv21Recording);
+    checkStepped(nv21Recording);
+    checkDropLateFrames(nv21Recording);
+    checkConversion(uyvyRecording);
+    checkPoseTrace(nv21Recording, poseTrace);
+    checkPoseTraceValidation(directory);
+
+    if (gNumFailures != 0)
+    {
+        printf("%d checks failed\n", gNumFailures);
+        return 1;
+    }
+    printf("All file replay checks passed\n");
+    return 0;
+}
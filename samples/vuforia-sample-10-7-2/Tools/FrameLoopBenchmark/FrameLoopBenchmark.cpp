@@ -0,0 +1,293 @@
+/*===============================================================================
+Copyright (c) 2022 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+// Runs the AppController frame loop against the stub Vuforia Engine and reports the CPU time
+// and the number of heap allocations per frame. Each frame makes the same AppController calls
+// as the renderer: prepareToRender, getOrigin, getTargetResults for both target types,
+// getModelTargetGuideView and finishRender. The time includes the stub's work to create the
+// states, which doesn't change with the app code.
+//
+// The observation and Guide View lists are reused across frames so that the frame path doesn't
+// allocate, the benchmark fails if any frame does.
+//
+// Afterwards AR is stopped while the frame loop keeps running on another thread, as the app
+// does from its UI thread, to check that stopping waits for the frame being rendered.
+//
+// Usage: FrameLoopBenchmark [frames [imageTargets [modelTargets]]] [--state-handler] [--no-instrumentation]
+
+#include "VuforiaEngineStub.h"
+
+#include <AppController.h>
+#include <Instrumentation.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <string>
+#include <thread>
+
+
+namespace
+{
+
+std::atomic<uint64_t> gNumAllocations { 0 };
+std::atomic<uint64_t> gNumAllocatedBytes { 0 };
+
+
+void* allocate(size_t size)
+{
+    gNumAllocations.fetch_add(1, std::memory_order_relaxed);
+    gNumAllocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    return malloc(size != 0 ? size : 1);
+}
+
+
+/// Maximum number of targets of a type read per frame, as in the renderer
+constexpr int MAX_RESULTS = 32;
+
+struct FrameStats
+{
+    uint64_t framesRendered { 0 };
+    /// Sum of values of the results, so that computing them can't be optimized out
+    double checksum { 0.0 };
+};
+
+
+void runFrames(AppController& controller, uint64_t numFrames, FrameStats& stats)
+{
+    double viewport[6];
+    VuRenderVideoBackgroundData renderData {};
+    VuMatrix44F projectionMatrix;
+    VuMatrix44F modelViewMatrix;
+    VuMatrix44F modelViewMatrices[MAX_RESULTS];
+    VuMatrix44F scaledModelViewMatrices[MAX_RESULTS];
+
+    for (uint64_t frame = 0; frame < numFrames; ++frame)
+    {
+        Instrumentation::ScopedTimer frameTimer(Instrumentation::Stage::FRAME);
+        if (controller.prepareToRender(viewport, &renderData))
+        {
+            ++stats.framesRendered;
+            if (controller.getOrigin(projectionMatrix, modelViewMatrix))
+            {
+                stats.checksum += modelViewMatrix.data[12];
+            }
+
+            for (int targetType = 0; targetType < AppController::NUM_TARGET_TYPES; ++targetType)
+            {
+                int numResults = controller.getTargetResults(targetType, projectionMatrix, modelViewMatrices,
+                                                             scaledModelViewMatrices, MAX_RESULTS);
+                for (int i = 0; i < numResults; ++i)
+                {
+                    stats.checksum += scaledModelViewMatrices[i].data[0] + modelViewMatrices[i].data[14];
+                }
+            }
+
+            VuImageInfo guideViewImageInfo;
+            const char* guideViewName = nullptr;
+            if (controller.getModelTargetGuideView(projectionMatrix, modelViewMatrix, guideViewImageInfo, guideViewName))
+            {
+                stats.checksum += modelViewMatrix.data[0];
+            }
+        }
+        controller.finishRender();
+    }
+}
+
+} // namespace
+
+
+/*=== Allocation counting ===*/
+
+void* operator new(size_t size)
+{
+    void* pointer = allocate(size);
+    if (pointer == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return pointer;
+}
+
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+    return allocate(size);
+}
+
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+    return allocate(size);
+}
+
+
+void operator delete(void* pointer) noexcept
+{
+    free(pointer);
+}
+
+
+void operator delete[](void* pointer) noexcept
+{
+    free(pointer);
+}
+
+
+void operator delete(void* pointer, size_t) noexcept
+{
+    free(pointer);
+}
+
+
+void operator delete[](void* pointer, size_t) noexcept
+{
+    free(pointer);
+}
+
+
+int main(int argc, char* argv[])
+{
+    uint64_t numFrames = 2000000;
+    int numImageTargets = 1;
+    int numModelTargets = 1;
+    bool useStateHandler = false;
+    bool instrumentation = true;
+
+    int position = 0;
+    bool validArguments = true;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--state-handler") == 0)
+        {
+            useStateHandler = true;
+        }
+        else if (strcmp(argv[i], "--no-instrumentation") == 0)
+        {
+            instrumentation = false;
+        }
+        else if (position == 0)
+        {
+            numFrames = strtoull(argv[i], nullptr, 10);
+            validArguments = validArguments && numFrames > 0;
+            ++position;
+        }
+        else if (position == 1)
+        {
+            numImageTargets = atoi(argv[i]);
+            ++position;
+        }
+        else if (position == 2)
+        {
+            numModelTargets = atoi(argv[i]);
+            ++position;
+        }
+        else
+        {
+            validArguments = false;
+        }
+    }
+    if (!validArguments || numImageTargets < 0 || numModelTargets < 0 ||
+        numImageTargets + numModelTargets == 0 || numImageTargets + numModelTargets > MAX_RESULTS)
+    {
+        fprintf(stderr, "Usage: %s [frames [imageTargets [modelTargets]]] [--state-handler] [--no-instrumentation]\n", argv[0]);
+        return 1;
+    }
+
+    AppController::InitConfig initConfig;
+    bool initialized = false;
+    initConfig.showErrorCallback = [](const char* errorString) { fprintf(stderr, "Error: %s\n", errorString); };
+    initConfig.initDoneCallback = [&initialized]() { initialized = true; };
+    initConfig.maxSimultaneousImageTargets = std::max(numImageTargets, 1);
+    initConfig.useStateHandler = useStateHandler;
+    for (int i = 0; i < numImageTargets + numModelTargets; ++i)
+    {
+        AppController::TargetConfig target;
+        target.targetType = i < numImageTargets ? AppController::IMAGE_TARGET_ID : AppController::MODEL_TARGET_ID;
+        target.databasePath = "Stub.xml";
+        target.targetName = "target" + std::to_string(i);
+        initConfig.targets.push_back(target);
+    }
+
+    // The controller holds the frames of the state handler and is too large for the stack
+    auto controller = std::make_unique<AppController>();
+    controller->initAR(initConfig, AppController::IMAGE_TARGET_ID);
+    int orientation = 0;
+    if (!initialized || !controller->startAR() || !controller->configureRendering(1080, 1920, &orientation))
+    {
+        fprintf(stderr, "Failed to start the frame loop\n");
+        return 1;
+    }
+
+    Instrumentation::setEnabled(instrumentation);
+    Instrumentation::setLogInterval(std::chrono::seconds(0));
+
+    // Let the caches and the state handler settle before measuring
+    FrameStats stats;
+    runFrames(*controller, 10000, stats);
+    Instrumentation::reset();
+    stats = FrameStats {};
+
+    uint64_t allocationsBefore = gNumAllocations.load(std::memory_order_relaxed);
+    uint64_t bytesBefore = gNumAllocatedBytes.load(std::memory_order_relaxed);
+    auto start = std::chrono::steady_clock::now();
+
+    runFrames(*controller, numFrames, stats);
+
+    auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start);
+    uint64_t allocations = gNumAllocations.load(std::memory_order_relaxed) - allocationsBefore;
+    uint64_t bytes = gNumAllocatedBytes.load(std::memory_order_relaxed) - bytesBefore;
+
+    printf("%llu frames, %llu rendered, %d Image Targets, %d Model Targets, %s, instrumentation %s\n",
+           static_cast<unsigned long long>(numFrames), static_cast<unsigned long long>(stats.framesRendered),
+           numImageTargets, numModelTargets, useStateHandler ? "state handler" : "acquire latest state",
+           instrumentation ? "on" : "off");
+    printf("%10.1f ns/frame %10.3f allocations/frame %10.1f bytes/frame   (checksum %g)\n",
+           elapsed.count() / numFrames, static_cast<double>(allocations) / numFrames,
+           static_cast<double>(bytes) / numFrames, stats.checksum);
+
+    if (instrumentation)
+    {
+        Instrumentation::logStats();
+    }
+
+    // Once stopAR returns no frame may be using the released states
+    std::atomic<bool> stopped { false };
+    std::thread renderThread([&controller, &stopped]()
+    {
+        FrameStats renderStats;
+        while (!stopped.load())
+        {
+            runFrames(*controller, 1, renderStats);
+        }
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    controller->stopAR();
+    stopped.store(true);
+    renderThread.join();
+
+    controller->deinitAR();
+
+    if (allocations != 0)
+    {
+        fprintf(stderr, "Error: the frame loop made %llu heap allocations, it should make none\n",
+                static_cast<unsigned long long>(allocations));
+        return 1;
+    }
+    return 0;
+}
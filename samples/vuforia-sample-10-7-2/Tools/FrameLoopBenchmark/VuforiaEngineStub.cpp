@@ -0,0 +1,1169 @@
+/*===============================================================================
+Copyright (c) 2022 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+// Stub of the part of the Vuforia Engine C API used by the AppController, see VuforiaEngineStub.h.
+
+#include "VuforiaEngineStub.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+namespace
+{
+
+/// Maximum number of observations in a state
+constexpr int MAX_OBSERVATIONS = 64;
+/// Number of states in the engine's pool, enough for the references held by the state handler frames
+constexpr int NUM_STATES = 8;
+
+constexpr int32_t CAMERA_WIDTH = 640;
+constexpr int32_t CAMERA_HEIGHT = 480;
+constexpr float CAMERA_FOCAL_LENGTH = 500.0f;
+
+constexpr int32_t GUIDE_VIEW_SIZE = 512;
+
+} // namespace
+
+
+struct VuEngineConfigSet_
+{
+    bool hasLicenseConfig { false };
+    bool hasDriverConfig { false };
+};
+
+
+struct VuController_
+{
+    VuEngine* engine { nullptr };
+};
+
+
+struct VuImage_
+{
+    VuImageInfo info {};
+};
+
+
+struct VuGuideView_
+{
+    std::string name;
+    VuImage_ image;
+};
+
+
+struct VuGuideViewList_
+{
+    std::vector<VuGuideView*> elements;
+};
+
+
+struct VuObserver_
+{
+    VuEngine* engine { nullptr };
+    int32_t id { -1 };
+    /// The type of the observations reported by the Observer
+    VuObservationType observationType { 0 };
+    /// Index among the Observers of the same type, used to place the targets apart
+    int32_t index { 0 };
+    std::string targetName;
+    VuGuideView_ guideView;
+};
+
+
+struct VuObservation_
+{
+    int32_t observerId { -1 };
+    VuObservationType type { 0 };
+    VuPoseInfo poseInfo {};
+    VuDevicePoseObservationStatusInfo devicePoseStatusInfo { VU_DEVICE_POSE_OBSERVATION_STATUS_INFO_NORMAL };
+    VuImageTargetObservationTargetInfo imageTargetInfo {};
+    VuModelTargetObservationTargetInfo modelTargetInfo {};
+};
+
+
+struct VuObservationList_
+{
+    std::vector<VuObservation*> elements;
+};
+
+
+struct VuState_
+{
+    /// References held by the engine and the app, the state is free when this is 0
+    mutable std::atomic<int32_t> refCount { 0 };
+    VuRenderState renderState {};
+    VuCameraIntrinsics cameraIntrinsics {};
+    VuObservation_ observations[MAX_OBSERVATIONS];
+    int32_t numObservations { 0 };
+};
+
+
+struct VuEngine_
+{
+    VuController_ cameraController;
+    VuController_ renderController;
+    VuController_ platformController;
+
+    /// Guards the Observers, the render configuration and the state handler
+    mutable std::mutex mutex;
+    std::vector<std::unique_ptr<VuObserver_>> observers;
+    int32_t nextObserverId { 0 };
+    float nearPlane { 0.01f };
+    float farPlane { 5.0f };
+    VuVector2I viewSize { { 1080, 1920 } };
+
+    VuStateHandler* stateHandler { nullptr };
+    void* stateHandlerClientData { nullptr };
+    int32_t cameraFrameRate { 60 };
+
+    bool running { false };
+    std::thread stateHandlerThread;
+    std::condition_variable stopCondition;
+
+    VuState_ states[NUM_STATES];
+    std::atomic<int64_t> numStatesCreated { 0 };
+};
+
+
+namespace
+{
+
+VuMatrix44F multiply(const VuMatrix44F& a, const VuMatrix44F& b)
+{
+    VuMatrix44F result;
+    for (int column = 0; column < 4; ++column)
+    {
+        for (int row = 0; row < 4; ++row)
+        {
+            float sum = 0.0f;
+            for (int k = 0; k < 4; ++k)
+            {
+                sum += a.data[k * 4 + row] * b.data[column * 4 + k];
+            }
+            result.data[column * 4 + row] = sum;
+        }
+    }
+    return result;
+}
+
+
+VuMatrix44F identity()
+{
+    VuMatrix44F result {};
+    result.data[0] = result.data[5] = result.data[10] = result.data[15] = 1.0f;
+    return result;
+}
+
+
+/// Rigid transformation rotating by angle around axis and then translating
+VuMatrix44F makePose(float angle, const float axis[3], float x, float y, float z)
+{
+    float c = std::cos(angle);
+    float s = std::sin(angle);
+    float t = 1.0f - c;
+    VuMatrix44F pose = identity();
+    pose.data[0] = t * axis[0] * axis[0] + c;
+    pose.data[1] = t * axis[0] * axis[1] + s * axis[2];
+    pose.data[2] = t * axis[0] * axis[2] - s * axis[1];
+    pose.data[4] = t * axis[0] * axis[1] - s * axis[2];
+    pose.data[5] = t * axis[1] * axis[1] + c;
+    pose.data[6] = t * axis[1] * axis[2] + s * axis[0];
+    pose.data[8] = t * axis[0] * axis[2] + s * axis[1];
+    pose.data[9] = t * axis[1] * axis[2] - s * axis[0];
+    pose.data[10] = t * axis[2] * axis[2] + c;
+    pose.data[12] = x;
+    pose.data[13] = y;
+    pose.data[14] = z;
+    return pose;
+}
+
+
+/// Inverse of a rigid transformation
+VuMatrix44F invertPose(const VuMatrix44F& pose)
+{
+    VuMatrix44F inverse = identity();
+    for (int row = 0; row < 3; ++row)
+    {
+        for (int column = 0; column < 3; ++column)
+        {
+            inverse.data[column * 4 + row] = pose.data[row * 4 + column];
+        }
+        inverse.data[12 + row] = -(pose.data[row * 4] * pose.data[12] +
+                                   pose.data[row * 4 + 1] * pose.data[13] +
+                                   pose.data[row * 4 + 2] * pose.data[14]);
+    }
+    return inverse;
+}
+
+
+VuMatrix44F makeProjection(float verticalFov, float aspectRatio, float nearPlane, float farPlane)
+{
+    float f = 1.0f / std::tan(verticalFov * 0.5f);
+    VuMatrix44F projection {};
+    projection.data[0] = f / aspectRatio;
+    projection.data[5] = f;
+    projection.data[10] = (farPlane + nearPlane) / (nearPlane - farPlane);
+    projection.data[11] = -1.0f;
+    projection.data[14] = 2.0f * farPlane * nearPlane / (nearPlane - farPlane);
+    return projection;
+}
+
+
+/// Take a free state from the pool, returns nullptr if all the states are referenced
+VuState_* takeFreeState(VuEngine_* engine)
+{
+    for (VuState_& state : engine->states)
+    {
+        int32_t expected = 0;
+        if (state.refCount.compare_exchange_strong(expected, 1, std::memory_order_acquire))
+        {
+            return &state;
+        }
+    }
+    return nullptr;
+}
+
+
+/// Fill a state with the synthetic poses of the next camera frame
+void fillState(VuEngine_* engine, VuState_& state)
+{
+    static const VuMesh videoBackgroundMesh {};
+    static const float Y_AXIS[3] = { 0.0f, 1.0f, 0.0f };
+    static const float X_AXIS[3] = { 1.0f, 0.0f, 0.0f };
+
+    int64_t frameIndex = engine->numStatesCreated.fetch_add(1, std::memory_order_relaxed);
+    float time = static_cast<float>(frameIndex % 36000) / 60.0f;
+
+    std::lock_guard<std::mutex> lock(engine->mutex);
+
+    // The device moves on a circle around the targets while looking at them
+    VuMatrix44F devicePose = makePose(0.3f * std::sin(time), Y_AXIS, 0.05f * std::sin(time),
+                                      0.02f * std::cos(2.0f * time), 0.05f * std::cos(time));
+
+    VuRenderState& renderState = state.renderState;
+    renderState.viewport = VuVector4I { { 0, 0, engine->viewSize.data[0], engine->viewSize.data[1] } };
+    renderState.vbProjectionMatrix = identity();
+    renderState.vbMesh = const_cast<VuMesh*>(&videoBackgroundMesh);
+    renderState.viewMatrix = invertPose(devicePose);
+    renderState.projectionMatrix = makeProjection(1.0f, static_cast<float>(engine->viewSize.data[0]) / engine->viewSize.data[1],
+                                                  engine->nearPlane, engine->farPlane);
+
+    VuCameraIntrinsics& intrinsics = state.cameraIntrinsics;
+    intrinsics.size = VuVector2F { { static_cast<float>(CAMERA_WIDTH), static_cast<float>(CAMERA_HEIGHT) } };
+    intrinsics.focalLength = VuVector2F { { CAMERA_FOCAL_LENGTH, CAMERA_FOCAL_LENGTH } };
+    intrinsics.principalPoint = VuVector2F { { CAMERA_WIDTH * 0.5f, CAMERA_HEIGHT * 0.5f } };
+    intrinsics.distortionMode = VU_CAMERA_DISTORTION_MODE_LINEAR;
+
+    // Model Targets are tracked for two of every three seconds
+    bool modelTargetsTracked = (frameIndex / 60) % 3 != 2;
+
+    state.numObservations = 0;
+    for (const auto& observer : engine->observers)
+    {
+        if (state.numObservations == MAX_OBSERVATIONS)
+        {
+            break;
+        }
+
+        VuObservation_& observation = state.observations[state.numObservations++];
+        observation.observerId = observer->id;
+        observation.type = observer->observationType;
+        observation.poseInfo.poseStatus = VU_OBSERVATION_POSE_STATUS_TRACKED;
+
+        float offset = 0.15f * observer->index;
+        switch (observer->observationType)
+        {
+            case VU_OBSERVATION_DEVICE_POSE_TYPE:
+                observation.poseInfo.pose = devicePose;
+                observation.devicePoseStatusInfo = VU_DEVICE_POSE_OBSERVATION_STATUS_INFO_NORMAL;
+                break;
+
+            case VU_OBSERVATION_IMAGE_TARGET_TYPE:
+                observation.poseInfo.pose = makePose(0.1f * std::sin(time + offset), X_AXIS, offset, 0.0f, -0.4f);
+                observation.imageTargetInfo.name = observer->targetName.c_str();
+                observation.imageTargetInfo.uniqueId = observer->targetName.c_str();
+                observation.imageTargetInfo.size = VuVector2F { { 0.2f, 0.15f } };
+                break;
+
+            case VU_OBSERVATION_MODEL_TARGET_TYPE:
+                if (!modelTargetsTracked)
+                {
+                    observation.poseInfo.poseStatus = VU_OBSERVATION_POSE_STATUS_NO_POSE;
+                }
+                observation.poseInfo.pose = makePose(0.1f * std::cos(time + offset), Y_AXIS, -offset, -0.1f, -0.6f);
+                observation.modelTargetInfo.name = observer->targetName.c_str();
+                observation.modelTargetInfo.uniqueId = observer->targetName.c_str();
+                observation.modelTargetInfo.size = VuVector3F { { 0.3f, 0.2f, 0.25f } };
+                observation.modelTargetInfo.bbox.center = VuVector3F { { 0.0f, 0.1f, 0.0f } };
+                observation.modelTargetInfo.bbox.extent = VuVector3F { { 0.15f, 0.1f, 0.125f } };
+                observation.modelTargetInfo.activeGuideViewName = observer->guideView.name.c_str();
+                break;
+
+            default:
+                break;
+        }
+    }
+}
+
+
+/// Create the state of the next camera frame with a reference for the caller
+VuState_* createState(VuEngine_* engine)
+{
+    VuState_* state = takeFreeState(engine);
+    if (state != nullptr)
+    {
+        fillState(engine, *state);
+    }
+    return state;
+}
+
+
+void releaseState(VuState_* state)
+{
+    state->refCount.fetch_sub(1, std::memory_order_release);
+}
+
+
+/// Deliver states to the registered state handler at the camera frame rate until the engine is stopped
+void runStateHandler(VuEngine_* engine)
+{
+    auto nextFrameTime = std::chrono::steady_clock::now();
+    std::unique_lock<std::mutex> lock(engine->mutex);
+    while (engine->running)
+    {
+        VuStateHandler* handler = engine->stateHandler;
+        void* clientData = engine->stateHandlerClientData;
+        nextFrameTime += std::chrono::microseconds(1000000 / std::max(engine->cameraFrameRate, 1));
+
+        lock.unlock();
+        VuState_* state = createState(engine);
+        if (state != nullptr)
+        {
+            handler(state, clientData);
+            releaseState(state);
+        }
+        lock.lock();
+
+        engine->stopCondition.wait_until(lock, nextFrameTime, [engine] { return !engine->running; });
+    }
+}
+
+
+template <typename T>
+VuResult getElement(const std::vector<T*>& elements, int32_t element, T** result)
+{
+    if (result == nullptr || element < 0 || element >= static_cast<int32_t>(elements.size()))
+    {
+        return VU_FAILED;
+    }
+    *result = elements[element];
+    return VU_SUCCESS;
+}
+
+
+VuResult createObserver(VuEngine* engine, VuObserver** observer, VuObservationType observationType, const char* targetName)
+{
+    if (engine == nullptr || observer == nullptr)
+    {
+        return VU_FAILED;
+    }
+
+    auto newObserver = std::make_unique<VuObserver_>();
+    newObserver->engine = engine;
+    newObserver->observationType = observationType;
+    newObserver->targetName = targetName != nullptr ? targetName : "";
+
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    newObserver->id = engine->nextObserverId++;
+    for (const auto& other : engine->observers)
+    {
+        if (other->observationType == observationType)
+        {
+            ++newObserver->index;
+        }
+    }
+    if (observationType == VU_OBSERVATION_MODEL_TARGET_TYPE)
+    {
+        newObserver->guideView.name = newObserver->targetName + "_GuideView";
+        VuImageInfo& info = newObserver->guideView.image.info;
+        info.width = info.bufferWidth = GUIDE_VIEW_SIZE;
+        info.height = info.bufferHeight = GUIDE_VIEW_SIZE;
+        info.stride = GUIDE_VIEW_SIZE * 4;
+        info.bufferSize = info.stride * GUIDE_VIEW_SIZE;
+        info.format = VU_IMAGE_PIXEL_FORMAT_RGBA8888;
+    }
+
+    *observer = newObserver.get();
+    engine->observers.push_back(std::move(newObserver));
+    return VU_SUCCESS;
+}
+
+} // namespace
+
+
+/*=== Stub controls ===*/
+
+void VU_API_CALL vuStubSetCameraFrameRate(VuEngine* engine, int32_t framesPerSecond)
+{
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    engine->cameraFrameRate = framesPerSecond;
+}
+
+
+int64_t VU_API_CALL vuStubGetNumStatesCreated(const VuEngine* engine)
+{
+    return engine->numStatesCreated.load(std::memory_order_relaxed);
+}
+
+
+/*=== Configuration ===*/
+
+VuResult VU_API_CALL vuEngineConfigSetCreate(VuEngineConfigSet** configSet)
+{
+    if (configSet == nullptr)
+    {
+        return VU_FAILED;
+    }
+    *configSet = new VuEngineConfigSet_;
+    return VU_SUCCESS;
+}
+
+
+VuResult VU_API_CALL vuEngineConfigSetDestroy(VuEngineConfigSet* configSet)
+{
+    delete configSet;
+    return configSet != nullptr ? VU_SUCCESS : VU_FAILED;
+}
+
+
+VuResult VU_API_CALL vuEngineConfigSetAddRenderConfig(VuEngineConfigSet* configSet, const VuRenderConfig* config)
+{
+    return configSet != nullptr && config != nullptr ? VU_SUCCESS : VU_FAILED;
+}
+
+
+VuResult VU_API_CALL vuEngineConfigSetAddLicenseConfig(VuEngineConfigSet* configSet, const VuLicenseConfig* config)
+{
+    if (configSet == nullptr || config == nullptr || config->key == nullptr)
+    {
+        return VU_FAILED;
+    }
+    configSet->hasLicenseConfig = true;
+    return VU_SUCCESS;
+}
+
+
+VuResult VU_API_CALL vuEngineConfigSetAddDriverConfig(VuEngineConfigSet* configSet, const VuDriverConfig* config)
+{
+    if (configSet == nullptr || config == nullptr)
+    {
+        return VU_FAILED;
+    }
+    configSet->hasDriverConfig = true;
+    return VU_SUCCESS;
+}
+
+
+VuRenderConfig VU_API_CALL vuRenderConfigDefault()
+{
+    VuRenderConfig config {};
+    config.vbRenderBackend = VU_RENDER_VB_BACKEND_DEFAULT;
+    return config;
+}
+
+
+VuLicenseConfig VU_API_CALL vuLicenseConfigDefault()
+{
+    return VuLicenseConfig {};
+}
+
+
+VuDriverConfig VU_API_CALL vuDriverConfigDefault()
+{
+    return VuDriverConfig {};
+}
+
+
+VuDevicePoseConfig VU_API_CALL vuDevicePoseConfigDefault()
+{
+    VuDevicePoseConfig config {};
+    config.activate = VU_TRUE;
+    return config;
+}
+
+
+VuImageTargetConfig VU_API_CALL vuImageTargetConfigDefault()
+{
+    VuImageTargetConfig config {};
+    config.activate = VU_TRUE;
+    config.scale = 1.0f;
+    config.poseOffset = identity();
+    return config;
+}
+
+
+VuModelTargetConfig VU_API_CALL vuModelTargetConfigDefault()
+{
+    VuModelTargetConfig config {};
+    config.activate = VU_TRUE;
+    config.scale = 1.0f;
+    config.poseOffset = identity();
+    return config;
+}
+
+
+/*=== Engine ===*/
+
+VuResult VU_API_CALL vuEngineCreate(VuEngine** engine, const VuEngineConfigSet* configSet, VuErrorCode* errorCode)
+{
+    if (engine == nullptr || configSet == nullptr)
+    {
+        return VU_FAILED;
+    }
+
+    VuErrorCode error = VU_ENGINE_CREATION_ERROR_NONE;
+    if (!configSet->hasLicenseConfig)
+    {
+        error = VU_ENGINE_CREATION_ERROR_LICENSE_CONFIG_MISSING_KEY;
+    }
+    else if (configSet->hasDriverConfig)
+    {
+        // The stub can't load Vuforia Drivers
+        error = VU_ENGINE_CREATION_ERROR_DRIVER_CONFIG_LOAD_ERROR;
+    }
+    if (errorCode != nullptr)
+    {
+        *errorCode = error;
+    }
+    if (error != VU_ENGINE_CREATION_ERROR_NONE)
+    {
+        *engine = nullptr;
+        return VU_FAILED;
+    }
+
+    *engine = new VuEngine_;
+    (*engine)->cameraController.engine = *engine;
+    (*engine)->renderController.engine = *engine;
+    (*engine)->platformController.engine = *engine;
+    return VU_SUCCESS;
+}
+
+
+VuResult VU_API_CALL vuEngineDestroy(VuEngine* engine)
+{
+    if (engine == nullptr)
+    {
+        return VU_FAILED;
+    }
+    vuEngineStop(engine);
+    delete engine;
+    return VU_SUCCESS;
+}
+
+
+VuResult VU_API_CALL vuEngineStart(VuEngine* engine)
+{
+    if (engine == nullptr)
+    {
+        return VU_FAILED;
+    }
+
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    if (engine->running)
+    {
+        return VU_FAILED;
+    }
+    engine->running = true;
+    if (engine->stateHandler != nullptr)
+    {
+        engine->stateHandlerThread = std::thread(runStateHandler, engine);
+    }
+    return VU_SUCCESS;
+}
+
+
+VuResult VU_API_CALL vuEngineStop(VuEngine* engine)
+{
+    if (engine == nullptr)
+    {
+        return VU_FAILED;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(engine->mutex);
+        if (!engine->running)
+        {
+            return VU_FAILED;
+        }
+        engine->running = false;
+    }
+    engine->stopCondition.notify_all();
+    if (engine->stateHandlerThread.joinable())
+    {
+        engine->stateHandlerThread.join();
+    }
+    return VU_SUCCESS;
+}
+
+
+VuBool VU_API_CALL vuEngineIsRunning(const VuEngine* engine)
+{
+    if (engine == nullptr)
+    {
+        return VU_FALSE;
+    }
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    return engine->running ? VU_TRUE : VU_FALSE;
+}
+
+
+VuResult VU_API_CALL vuEngineRegisterStateHandler(VuEngine* engine, VuStateHandler* handler, void* clientData)
+{
+    if (engine == nullptr)
+    {
+        return VU_FAILED;
+    }
+
+    // As with the Vuforia Engine the handler can only be changed while the engine is stopped
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    if (engine->running)
+    {
+        return VU_FAILED;
+    }
+    engine->stateHandler = handler;
+    engine->stateHandlerClientData = clientData;
+    return VU_SUCCESS;
+}
+
+
+VuResult VU_API_CALL vuEngineAcquireLatestState(const VuEngine* engine, VuState** state)
+{
+    if (engine == nullptr || state == nullptr)
+    {
+        return VU_FAILED;
+    }
+
+    // Every call is a new camera frame, as if the camera was faster than the rendering
+    *state = createState(const_cast<VuEngine*>(engine));
+    return *state != nullptr ? VU_SUCCESS : VU_FAILED;
+}
+
+
+VuResult VU_API_CALL vuEngineGetCameraController(const VuEngine* engine, VuController** controller)
+{
+    if (engine == nullptr || controller == nullptr)
+    {
+        return VU_FAILED;
+    }
+    *controller = const_cast<VuController*>(&engine->cameraController);
+    return VU_SUCCESS;
+}
+
+
+VuResult VU_API_CALL vuEngineGetRenderController(const VuEngine* engine, VuController** controller)
+{
+    if (engine == nullptr || controller == nullptr)
+    {
+        return VU_FAILED;
+    }
+    *controller = const_cast<VuController*>(&engine->renderController);
+    return VU_SUCCESS;
+}
+
+
+VuResult VU_API_CALL vuEngineGetPlatformController(const VuEngine* engine, VuController** controller)
+{
+    if (engine == nullptr || controller == nullptr)
+    {
+        return VU_FAILED;
+    }
+    *controller = const_cast<VuController*>(&engine->platformController);
+    return VU_SUCCESS;
+}
+
+
+VuResult VU_API_CALL vuEngineResetWorldTracking(VuEngine* engine)
+{
+    return engine != nullptr ? VU_SUCCESS : VU_FAILED;
+}
+
+
+VuResult VU_API_CALL vuEngineSetMaximumSimultaneousTrackedImages(VuEngine* engine, int32_t maxNumberOfTargets)
+{
+    return engine != nullptr && maxNumberOfTargets > 0 ? VU_SUCCESS : VU_FAILED;
+}
+
+
+/*=== Controllers ===*/
+
+VuResult VU_API_CALL vuCameraControllerSetActiveVideoMode(VuController* controller, VuCameraVideoModePreset cameraVideoModePreset)
+{
+    (void)cameraVideoModePreset;
+    return controller != nullptr ? VU_SUCCESS : VU_FAILED;
+}
+
+
+VuResult VU_API_CALL vuCameraControllerSetFocusMode(VuController* controller, VuCameraFocusMode focusMode)
+{
+    (void)focusMode;
+    return controller != nullptr ? VU_SUCCESS : VU_FAILED;
+}
+
+
+VuResult VU_API_CALL vuPlatformControllerConvertPlatformViewOrientation(const VuController* controller, const void* platformOrientation,
+                                                                        VuViewOrientation* vuOrientation)
+{
+    (void)platformOrientation;
+    if (controller == nullptr || vuOrientation == nullptr)
+    {
+        return VU_FAILED;
+    }
+    *vuOrientation = VU_VIEW_ORIENTATION_PORTRAIT;
+    return VU_SUCCESS;
+}
+
+
+VuResult VU_API_CALL vuPlatformControllerSetViewOrientation(VuController* controller, VuViewOrientation orientation)
+{
+    (void)orientation;
+    return controller != nullptr ? VU_SUCCESS : VU_FAILED;
+}
+
+
+VuResult VU_API_CALL vuRenderControllerSetRenderViewConfig(VuController* controller, const VuRenderViewConfig* renderViewConfig)
+{
+    if (controller == nullptr || renderViewConfig == nullptr ||
+        renderViewConfig->resolution.data[0] <= 0 || renderViewConfig->resolution.data[1] <= 0)
+    {
+        return VU_FAILED;
+    }
+    std::lock_guard<std::mutex> lock(controller->engine->mutex);
+    controller->engine->viewSize = renderViewConfig->resolution;
+    return VU_SUCCESS;
+}
+
+
+VuResult VU_API_CALL vuRenderControllerSetProjectionMatrixNearFar(VuController* controller, float nearPlane, float farPlane)
+{
+    if (controller == nullptr || nearPlane <= 0.0f || farPlane <= nearPlane)
+    {
+        return VU_FAILED;
+    }
+    std::lock_guard<std::mutex> lock(controller->engine->mutex);
+    controller->engine->nearPlane = nearPlane;
+    controller->engine->farPlane = farPlane;
+    return VU_SUCCESS;
+}
+
+
+VuResult VU_API_CALL vuRenderControllerGetVideoBackgroundViewInfo(const VuController* controller, VuVideoBackgroundViewInfo* viewInfo)
+{
+    if (controller == nullptr || viewInfo == nullptr)
+    {
+        return VU_FAILED;
+    }
+    std::lock_guard<std::mutex> lock(controller->engine->mutex);
+    viewInfo->viewport = VuVector4I { { 0, 0, controller->engine->viewSize.data[0], controller->engine->viewSize.data[1] } };
+    viewInfo->cameraImageSize = VuVector2I { { CAMERA_WIDTH, CAMERA_HEIGHT } };
+    viewInfo->vBTextureSize = VuVector2I { { 1024, 512 } };
+    return VU_SUCCESS;
+}
+
+
+VuResult VU_API_CALL vuRenderControllerUpdateVideoBackgroundTexture(VuController* controller, const VuState* state,
+                                                                    const VuRenderVideoBackgroundData* renderVBData)
+{
+    (void)renderVBData;
+    return controller != nullptr && state != nullptr ? VU_SUCCESS : VU_FAILED;
+}
+
+
+/*=== State ===*/
+
+VuResult VU_API_CALL vuStateAcquireReference(const VuState* state, VuState** stateOut)
+{
+    if (state == nullptr || stateOut == nullptr)
+    {
+        return VU_FAILED;
+    }
+    state->refCount.fetch_add(1, std::memory_order_relaxed);
+    *stateOut = const_cast<VuState*>(state);
+    return VU_SUCCESS;
+}
+
+
+VuResult VU_API_CALL vuStateRelease(VuState* state)
+{
+    if (state == nullptr)
+    {
+        return VU_FAILED;
+    }
+    releaseState(state);
+    return VU_SUCCESS;
+}
+
+
+VuBool VU_API_CALL vuStateHasCameraFrame(const VuState* state)
+{
+    return state != nullptr ? VU_TRUE : VU_FALSE;
+}
+
+
+VuResult VU_API_CALL vuStateGetRenderState(const VuState* state, VuRenderState* renderState)
+{
+    if (state == nullptr || renderState == nullptr)
+    {
+        return VU_FAILED;
+    }
+    *renderState = state->renderState;
+    return VU_SUCCESS;
+}
+
+
+VuResult VU_API_CALL vuStateGetCameraIntrinsics(const VuState* state, VuCameraIntrinsics* cameraIntrinsics)
+{
+    if (state == nullptr || cameraIntrinsics == nullptr)
+    {
+        return VU_FAILED;
+    }
+    *cameraIntrinsics = state->cameraIntrinsics;
+    return VU_SUCCESS;
+}
+
+
+VuResult VU_API_CALL vuStateGetObservations(const VuState* state, VuObservationList* list)
+{
+    if (state == nullptr || list == nullptr)
+    {
+        return VU_FAILED;
+    }
+
+    // The list reserved room for all the observations when it was created
+    list->elements.clear();
+    for (int32_t i = 0; i < state->numObservations; ++i)
+    {
+        list->elements.push_back(const_cast<VuObservation_*>(&state->observations[i]));
+    }
+    return VU_SUCCESS;
+}
+
+
+VuVector2F VU_API_CALL vuCameraIntrinsicsGetFov(const VuCameraIntrinsics* intrinsics)
+{
+    VuVector2F fov {};
+    if (intrinsics != nullptr && intrinsics->focalLength.data[0] > 0.0f && intrinsics->focalLength.data[1] > 0.0f)
+    {
+        fov.data[0] = 2.0f * std::atan(intrinsics->size.data[0] / (2.0f * intrinsics->focalLength.data[0]));
+        fov.data[1] = 2.0f * std::atan(intrinsics->size.data[1] / (2.0f * intrinsics->focalLength.data[1]));
+    }
+    return fov;
+}
+
+
+/*=== Observations ===*/
+
+VuResult VU_API_CALL vuObservationListCreate(VuObservationList** list)
+{
+    if (list == nullptr)
+    {
+        return VU_FAILED;
+    }
+    *list = new VuObservationList_;
+    (*list)->elements.reserve(MAX_OBSERVATIONS);
+    return VU_SUCCESS;
+}
+
+
+VuResult VU_API_CALL vuObservationListDestroy(VuObservationList* list)
+{
+    delete list;
+    return list != nullptr ? VU_SUCCESS : VU_FAILED;
+}
+
+
+VuResult VU_API_CALL vuObservationListGetSize(const VuObservationList* list, int32_t* listSize)
+{
+    if (list == nullptr || listSize == nullptr)
+    {
+        return VU_FAILED;
+    }
+    *listSize = static_cast<int32_t>(list->elements.size());
+    return VU_SUCCESS;
+}
+
+
+VuResult VU_API_CALL vuObservationListGetElement(const VuObservationList* list, int32_t element, VuObservation** observation)
+{
+    return list != nullptr ? getElement(list->elements, element, observation) : VU_FAILED;
+}
+
+
+VuResult VU_API_CALL vuObservationGetType(const VuObservation* observation, VuObservationType* observationType)
+{
+    if (observation == nullptr || observationType == nullptr)
+    {
+        return VU_FAILED;
+    }
+    *observationType = observation->type;
+    return VU_SUCCESS;
+}
+
+
+VuBool VU_API_CALL vuObservationHasPoseInfo(const VuObservation* observation)
+{
+    return observation != nullptr ? VU_TRUE : VU_FALSE;
+}
+
+
+VuResult VU_API_CALL vuObservationGetPoseInfo(const VuObservation* observation, VuPoseInfo* poseInfo)
+{
+    if (observation == nullptr || poseInfo == nullptr)
+    {
+        return VU_FAILED;
+    }
+    *poseInfo = observation->poseInfo;
+    return VU_SUCCESS;
+}
+
+
+int32_t VU_API_CALL vuObservationGetObserverId(const VuObservation* observation)
+{
+    return observation != nullptr ? observation->observerId : -1;
+}
+
+
+VuResult VU_API_CALL vuDevicePoseObservationGetStatusInfo(const VuObservation* observation, VuDevicePoseObservationStatusInfo* statusInfo)
+{
+    if (observation == nullptr || statusInfo == nullptr || observation->type != VU_OBSERVATION_DEVICE_POSE_TYPE)
+    {
+        return VU_FAILED;
+    }
+    *statusInfo = observation->devicePoseStatusInfo;
+    return VU_SUCCESS;
+}
+
+
+VuResult VU_API_CALL vuImageTargetObservationGetTargetInfo(const VuObservation* observation, VuImageTargetObservationTargetInfo* targetInfo)
+{
+    if (observation == nullptr || targetInfo == nullptr || observation->type != VU_OBSERVATION_IMAGE_TARGET_TYPE)
+    {
+        return VU_FAILED;
+    }
+    *targetInfo = observation->imageTargetInfo;
+    return VU_SUCCESS;
+}
+
+
+VuResult VU_API_CALL vuModelTargetObservationGetTargetInfo(const VuObservation* observation, VuModelTargetObservationTargetInfo* targetInfo)
+{
+    if (observation == nullptr || targetInfo == nullptr || observation->type != VU_OBSERVATION_MODEL_TARGET_TYPE)
+    {
+        return VU_FAILED;
+    }
+    *targetInfo = observation->modelTargetInfo;
+    return VU_SUCCESS;
+}
+
+
+/*=== Observers ===*/
+
+VuResult VU_API_CALL vuEngineCreateDevicePoseObserver(VuEngine* engine, VuObserver** observer, const VuDevicePoseConfig* config,
+                                                      VuDevicePoseCreationError* errorCode)
+{
+    if (errorCode != nullptr)
+    {
+        *errorCode = VU_DEVICE_POSE_CREATION_ERROR_NONE;
+    }
+    return config != nullptr ? createObserver(engine, observer, VU_OBSERVATION_DEVICE_POSE_TYPE, nullptr) : VU_FAILED;
+}
+
+
+VuResult VU_API_CALL vuEngineCreateImageTargetObserver(VuEngine* engine, VuObserver** observer, const VuImageTargetConfig* config,
+                                                       VuImageTargetCreationError* errorCode)
+{
+    if (errorCode != nullptr)
+    {
+        *errorCode = VU_IMAGE_TARGET_CREATION_ERROR_NONE;
+    }
+    return config != nullptr ? createObserver(engine, observer, VU_OBSERVATION_IMAGE_TARGET_TYPE, config->targetName) : VU_FAILED;
+}
+
+
+VuResult VU_API_CALL vuEngineCreateModelTargetObserver(VuEngine* engine, VuObserver** observer, const VuModelTargetConfig* config,
+                                                       VuModelTargetCreationError* errorCode)
+{
+    if (errorCode != nullptr)
+    {
+        *errorCode = VU_MODEL_TARGET_CREATION_ERROR_NONE;
+    }
+    return config != nullptr ? createObserver(engine, observer, VU_OBSERVATION_MODEL_TARGET_TYPE, config->targetName) : VU_FAILED;
+}
+
+
+int32_t VU_API_CALL vuObserverGetId(const VuObserver* observer)
+{
+    return observer != nullptr ? observer->id : -1;
+}
+
+
+VuResult VU_API_CALL vuObserverDestroy(VuObserver* observer)
+{
+    if (observer == nullptr)
+    {
+        return VU_FAILED;
+    }
+
+    VuEngine* engine = observer->engine;
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    for (auto it = engine->observers.begin(); it != engine->observers.end(); ++it)
+    {
+        if (it->get() == observer)
+        {
+            engine->observers.erase(it);
+            return VU_SUCCESS;
+        }
+    }
+    return VU_FAILED;
+}
+
+
+VuResult VU_API_CALL vuModelTargetObserverGetGuideViews(const VuObserver* observer, VuGuideViewList* list)
+{
+    if (observer == nullptr || list == nullptr || observer->observationType != VU_OBSERVATION_MODEL_TARGET_TYPE)
+    {
+        return VU_FAILED;
+    }
+    list->elements.assign(1, const_cast<VuGuideView_*>(&observer->guideView));
+    return VU_SUCCESS;
+}
+
+
+/*=== Guide Views ===*/
+
+VuResult VU_API_CALL vuGuideViewListCreate(VuGuideViewList** list)
+{
+    if (list == nullptr)
+    {
+        return VU_FAILED;
+    }
+    *list = new VuGuideViewList_;
+    return VU_SUCCESS;
+}
+
+
+VuResult VU_API_CALL vuGuideViewListDestroy(VuGuideViewList* list)
+{
+    delete list;
+    return list != nullptr ? VU_SUCCESS : VU_FAILED;
+}
+
+
+VuResult VU_API_CALL vuGuideViewListGetSize(const VuGuideViewList* list, int32_t* listSize)
+{
+    if (list == nullptr || listSize == nullptr)
+    {
+        return VU_FAILED;
+    }
+    *listSize = static_cast<int32_t>(list->elements.size());
+    return VU_SUCCESS;
+}
+
+
+VuResult VU_API_CALL vuGuideViewListGetElement(const VuGuideViewList* list, int32_t element, VuGuideView** guideView)
+{
+    return list != nullptr ? getElement(list->elements, element, guideView) : VU_FAILED;
+}
+
+
+VuResult VU_API_CALL vuGuideViewGetName(const VuGuideView* guideView, const char** name)
+{
+    if (guideView == nullptr || name == nullptr)
+    {
+        return VU_FAILED;
+    }
+    *name = guideView->name.c_str();
+    return VU_SUCCESS;
+}
+
+
+VuResult VU_API_CALL vuGuideViewGetImage(const VuGuideView* guideView, VuImage** image)
+{
+    if (guideView == nullptr || image == nullptr)
+    {
+        return VU_FAILED;
+    }
+    *image = const_cast<VuImage_*>(&guideView->image);
+    return VU_SUCCESS;
+}
+
+
+VuResult VU_API_CALL vuImageGetImageInfo(const VuImage* image, VuImageInfo* imageInfo)
+{
+    if (image == nullptr || imageInfo == nullptr)
+    {
+        return VU_FAILED;
+    }
+    *imageInfo = image->info;
+    return VU_SUCCESS;
+}
+
+
+/*=== MathUtils ===*/
+
+VuMatrix44F VU_API_CALL vuIdentityMatrix44F()
+{
+    return identity();
+}
+
+
+VuMatrix44F VU_API_CALL vuMatrix44FMultiplyMatrix(VuMatrix44F mA, VuMatrix44F mB)
+{
+    return multiply(mA, mB);
+}
+
+
+VuMatrix44F VU_API_CALL vuMatrix44FScale(VuVector3F scale, VuMatrix44F m)
+{
+    // M * S scales the first three columns
+    for (int column = 0; column < 3; ++column)
+    {
+        for (int row = 0; row < 4; ++row)
+        {
+            m.data[column * 4 + row] *= scale.data[column];
+        }
+    }
+    return m;
+}
+
+
+VuMatrix44F VU_API_CALL vuMatrix44FScalingMatrix(VuVector3F scale)
+{
+    VuMatrix44F result = identity();
+    result.data[0] = scale.data[0];
+    result.data[5] = scale.data[1];
+    result.data[10] = scale.data[2];
+    return result;
+}
+
+
+VuMatrix44F VU_API_CALL vuMatrix44FTranslationMatrix(VuVector3F trans)
+{
+    VuMatrix44F result = identity();
+    result.data[12] = trans.data[0];
+    result.data[13] = trans.data[1];
+    result.data[14] = trans.data[2];
+    return result;
+}
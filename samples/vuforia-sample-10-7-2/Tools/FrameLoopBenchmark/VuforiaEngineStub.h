@@ -0,0 +1,31 @@
+/*===============================================================================
+Copyright (c) 2022 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#ifndef __VUFORIAENGINESTUB_H__
+#define __VUFORIAENGINESTUB_H__
+
+#include <VuforiaEngine/VuforiaEngine.h>
+
+/// Controls of the stub Vuforia Engine that aren't part of the Vuforia Engine API
+/**
+ * The stub implements the part of the Vuforia Engine C API used by the AppController. It has no
+ * camera and no tracking: every state it creates is a new camera frame with a device pose moving
+ * on a circle and an observation for each active Image and Model Target Observer. The Image
+ * Targets are always tracked, the Model Targets lose tracking for one of every three seconds of
+ * frames so that their Guide View is displayed. The states come from a fixed pool and the stub
+ * doesn't allocate memory per frame, so allocations measured around the frame loop are made
+ * by the app.
+ */
+
+/// Set the rate at which states are delivered to a registered state handler, 60 by default
+/// vuEngineAcquireLatestState creates a new state on every call regardless of the rate.
+VU_API void VU_API_CALL vuStubSetCameraFrameRate(VuEngine* engine, int32_t framesPerSecond);
+
+/// Number of states created by the engine since it was created
+VU_API int64_t VU_API_CALL vuStubGetNumStatesCreated(const VuEngine* engine);
+
+#endif // __VUFORIAENGINESTUB_H__
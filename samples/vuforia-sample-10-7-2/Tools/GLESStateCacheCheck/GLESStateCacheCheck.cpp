@@ -0,0 +1,184 @@
+/*===============================================================================
+Copyright (c) 2022 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+// Drives GLESStateCache against the recording fake GL and checks which GL calls it issues and
+// the counts of issued and skipped calls: redundant state changes must be skipped, changes and
+// the first setting of each state after reset must be issued, and untracked state always is.
+//
+// Usage: GLESStateCacheCheck
+
+#include "RecordingGL.h"
+
+#include <GLESStateCache.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+
+namespace
+{
+
+int gNumFailures = 0;
+
+/// Total number of GL calls recorded, which must always equal the issued count
+uint64_t gNumCalls = 0;
+
+
+/// Check the calls recorded during step and the counters of cache, then clear the recording
+void expect(const char* step, const GLESStateCache& cache, const std::vector<std::string>& calls,
+            uint64_t issued, uint64_t skipped)
+{
+    const std::vector<std::string>& recorded = RecordingGL::getCalls();
+    gNumCalls += recorded.size();
+
+    if (recorded != calls)
+    {
+        ++gNumFailures;
+        printf("%s: expected %zu GL calls, made %zu:\n", step, calls.size(), recorded.size());
+        for (const auto& call : recorded)
+        {
+            printf("    %s\n", call.c_str());
+        }
+    }
+    if (cache.getIssuedCallCount() != issued || cache.getSkippedCallCount() != skipped)
+    {
+        ++gNumFailures;
+        printf("%s: expected %llu issued and %llu skipped calls, counted %llu and %llu\n", step,
+               static_cast<unsigned long long>(issued), static_cast<unsigned long long>(skipped),
+               static_cast<unsigned long long>(cache.getIssuedCallCount()),
+               static_cast<unsigned long long>(cache.getSkippedCallCount()));
+    }
+    if (cache.getIssuedCallCount() != gNumCalls)
+    {
+        ++gNumFailures;
+        printf("%s: %llu calls counted as issued but %llu made\n", step,
+               static_cast<unsigned long long>(cache.getIssuedCallCount()),
+               static_cast<unsigned long long>(gNumCalls));
+    }
+
+    RecordingGL::clear();
+}
+
+
+std::string call(const char* name, unsigned int argument)
+{
+    return std::string(name) + " " + std::to_string(argument);
+}
+
+
+std::string call(const char* name, unsigned int argument0, unsigned int argument1)
+{
+    return call(name, argument0) + " " + std::to_string(argument1);
+}
+
+} // namespace
+
+
+int main()
+{
+    GLESStateCache cache;
+    RecordingGL::clear();
+
+    // Nothing is known initially, the first change of each state is issued
+    cache.useProgram(3);
+    cache.bindVertexArray(7);
+    cache.enable(GL_DEPTH_TEST);
+    cache.disable(GL_BLEND);
+    cache.blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    cache.cullFace(GL_BACK);
+    cache.frontFace(GL_CCW);
+    cache.lineWidth(4.0f);
+    expect("first use", cache,
+           { call("glUseProgram", 3), call("glBindVertexArray", 7), call("glEnable", GL_DEPTH_TEST),
+             call("glDisable", GL_BLEND), call("glBlendFunc", GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA),
+             call("glCullFace", GL_BACK), call("glFrontFace", GL_CCW), "glLineWidth 4" },
+           8, 0);
+
+    // Setting the same values again is skipped
+    cache.useProgram(3);
+    cache.bindVertexArray(7);
+    cache.enable(GL_DEPTH_TEST);
+    cache.disable(GL_BLEND);
+    cache.blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    cache.cullFace(GL_BACK);
+    cache.frontFace(GL_CCW);
+    cache.lineWidth(4.0f);
+    expect("redundant", cache, {}, 8, 8);
+
+    // Changed values are issued, including a blend function differing in one factor only
+    cache.useProgram(4);
+    cache.bindVertexArray(0);
+    cache.disable(GL_DEPTH_TEST);
+    cache.enable(GL_BLEND);
+    cache.blendFunc(GL_SRC_ALPHA, GL_ONE);
+    cache.lineWidth(2.0f);
+    cache.useProgram(4);
+    expect("changed", cache,
+           { call("glUseProgram", 4), call("glBindVertexArray", 0), call("glDisable", GL_DEPTH_TEST),
+             call("glEnable", GL_BLEND), call("glBlendFunc", GL_SRC_ALPHA, GL_ONE), "glLineWidth 2" },
+           14, 9);
+
+    // Capabilities that aren't tracked are always issued
+    cache.enable(GL_SCISSOR_TEST);
+    cache.enable(GL_SCISSOR_TEST);
+    expect("untracked capability", cache,
+           { call("glEnable", GL_SCISSOR_TEST), call("glEnable", GL_SCISSOR_TEST) }, 16, 9);
+
+    // Texture bindings are tracked per unit, and always issued while the active unit is unknown
+    cache.bindTexture(5);
+    cache.bindTexture(5);
+    cache.activeTexture(GL_TEXTURE0);
+    cache.bindTexture(5);
+    cache.bindTexture(5);
+    cache.activeTexture(GL_TEXTURE1);
+    cache.bindTexture(5);
+    cache.activeTexture(GL_TEXTURE0);
+    cache.bindTexture(5);
+    expect("textures", cache,
+           { call("glBindTexture", GL_TEXTURE_2D, 5), call("glBindTexture", GL_TEXTURE_2D, 5),
+             call("glActiveTexture", GL_TEXTURE0), call("glBindTexture", GL_TEXTURE_2D, 5),
+             call("glActiveTexture", GL_TEXTURE1), call("glBindTexture", GL_TEXTURE_2D, 5),
+             call("glActiveTexture", GL_TEXTURE0) },
+           23, 11);
+
+    // Units beyond MAX_TEXTURE_UNITS aren't tracked
+    GLenum untrackedUnit = GL_TEXTURE0 + GLESStateCache::MAX_TEXTURE_UNITS;
+    cache.activeTexture(untrackedUnit);
+    cache.bindTexture(6);
+    cache.bindTexture(6);
+    expect("untracked texture unit", cache,
+           { call("glActiveTexture", untrackedUnit), call("glBindTexture", GL_TEXTURE_2D, 6),
+             call("glBindTexture", GL_TEXTURE_2D, 6) },
+           26, 11);
+
+    // After reset the state is unknown, so the same values are issued again
+    cache.reset();
+    cache.useProgram(4);
+    cache.bindVertexArray(0);
+    cache.disable(GL_DEPTH_TEST);
+    cache.activeTexture(GL_TEXTURE0);
+    cache.bindTexture(5);
+    cache.lineWidth(2.0f);
+    cache.useProgram(4);
+    cache.bindTexture(5);
+    expect("after reset", cache,
+           { call("glUseProgram", 4), call("glBindVertexArray", 0), call("glDisable", GL_DEPTH_TEST),
+             call("glActiveTexture", GL_TEXTURE0), call("glBindTexture", GL_TEXTURE_2D, 5), "glLineWidth 2" },
+           32, 13);
+
+    if (gNumFailures != 0)
+    {
+        printf("%d checks failed\n", gNumFailures);
+        return 1;
+    }
+    printf("GLESStateCache issued %llu and skipped %llu calls as expected\n",
+           static_cast<unsigned long long>(cache.getIssuedCallCount()),
+           static_cast<unsigned long long>(cache.getSkippedCallCount()));
+    return 0;
+}
@@ -0,0 +1,54 @@
+/*===============================================================================
+Copyright (c) 2022 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#include "RecordingGL.h"
+
+#include <sstream>
+
+
+namespace
+{
+
+std::vector<std::string> gCalls;
+
+
+template <typename... Arguments>
+void record(const char* name, Arguments... arguments)
+{
+    std::ostringstream call;
+    call << name;
+    ((call << ' ' << arguments), ...);
+    gCalls.push_back(call.str());
+}
+
+} // namespace
+
+
+const std::vector<std::string>& RecordingGL::getCalls()
+{
+    return gCalls;
+}
+
+
+void RecordingGL::clear()
+{
+    gCalls.clear();
+}
+
+
+/*=== The GL functions used by GLESStateCache ===*/
+
+GL_APICALL void GL_APIENTRY glUseProgram(GLuint program) { record("glUseProgram", program); }
+GL_APICALL void GL_APIENTRY glBindVertexArray(GLuint array) { record("glBindVertexArray", array); }
+GL_APICALL void GL_APIENTRY glActiveTexture(GLenum texture) { record("glActiveTexture", texture); }
+GL_APICALL void GL_APIENTRY glBindTexture(GLenum target, GLuint texture) { record("glBindTexture", target, texture); }
+GL_APICALL void GL_APIENTRY glEnable(GLenum cap) { record("glEnable", cap); }
+GL_APICALL void GL_APIENTRY glDisable(GLenum cap) { record("glDisable", cap); }
+GL_APICALL void GL_APIENTRY glBlendFunc(GLenum sfactor, GLenum dfactor) { record("glBlendFunc", sfactor, dfactor); }
+GL_APICALL void GL_APIENTRY glCullFace(GLenum mode) { record("glCullFace", mode); }
+GL_APICALL void GL_APIENTRY glFrontFace(GLenum mode) { record("glFrontFace", mode); }
+GL_APICALL void GL_APIENTRY glLineWidth(GLfloat width) { record("glLineWidth", width); }
@@ -0,0 +1,33 @@
+/*===============================================================================
+Copyright (c) 2022 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#ifndef __RECORDING_GL_H__
+#define __RECORDING_GL_H__
+
+#include <GLES3/gl31.h>
+
+#include <string>
+#include <vector>
+
+
+/// Fake OpenGL ES library recording the state calls made through it
+/**
+ * Implements the GL functions used by GLESStateCache. Each call is recorded as its name
+ * followed by its arguments, e.g. "glEnable 2929", instead of reaching a GL context.
+ */
+namespace RecordingGL
+{
+
+/// The calls made since the last call to clear
+const std::vector<std::string>& getCalls();
+
+/// Forget the recorded calls
+void clear();
+
+} // namespace RecordingGL
+
+#endif // __RECORDING_GL_H__
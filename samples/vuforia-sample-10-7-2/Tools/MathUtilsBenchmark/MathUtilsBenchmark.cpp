@@ -0,0 +1,335 @@
+/*===============================================================================
+Copyright (c) 2022 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+// Measures the Vuforia MathUtils matrix functions used on the frame path against the inline
+// MatrixMath versions, scalar and SIMD, after checking that MatrixMath gives the same results
+// as MathUtils, bit for bit when linked with the Vuforia Engine and by value with the stub.
+// The TargetResults benchmarks run the matrix operations done per target by
+// AppController::getTargetResults and the renderer for a number of targets.
+//
+// Usage: MathUtilsBenchmark [Google Benchmark options]
+
+#include <MatrixMath.h>
+
+#include <VuforiaEngine/VuforiaEngine.h>
+
+#include <benchmark/benchmark.h>
+
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+
+namespace
+{
+
+constexpr int NUM_INPUTS = 64;
+constexpr int MAX_TARGETS = 32;
+
+
+/// The operations as called through the Vuforia Engine library
+struct MathUtils
+{
+    static void multiply(const VuMatrix44F& a, const VuMatrix44F& b, VuMatrix44F& result)
+    {
+        result = vuMatrix44FMultiplyMatrix(a, b);
+    }
+    static void scale(const VuVector3F& scale, const VuMatrix44F& m, VuMatrix44F& result)
+    {
+        result = vuMatrix44FScale(scale, m);
+    }
+    static VuMatrix44F scalingMatrix(const VuVector3F& scale) { return vuMatrix44FScalingMatrix(scale); }
+    static VuMatrix44F translationMatrix(const VuVector3F& translation) { return vuMatrix44FTranslationMatrix(translation); }
+};
+
+
+struct Scalar
+{
+    static void multiply(const VuMatrix44F& a, const VuMatrix44F& b, VuMatrix44F& result)
+    {
+        MatrixMath::Scalar::multiply(a, b, result);
+    }
+    static void scale(const VuVector3F& scale, const VuMatrix44F& m, VuMatrix44F& result)
+    {
+        MatrixMath::Scalar::scale(scale, m, result);
+    }
+    static VuMatrix44F scalingMatrix(const VuVector3F& scale) { return MatrixMath::scalingMatrix(scale); }
+    static VuMatrix44F translationMatrix(const VuVector3F& translation) { return MatrixMath::translationMatrix(translation); }
+};
+
+
+/// The MatrixMath functions, NEON or SSE where available
+struct Simd
+{
+    static void multiply(const VuMatrix44F& a, const VuMatrix44F& b, VuMatrix44F& result)
+    {
+        MatrixMath::multiply(a, b, result);
+    }
+    static void scale(const VuVector3F& scale, const VuMatrix44F& m, VuMatrix44F& result)
+    {
+        MatrixMath::scale(scale, m, result);
+    }
+    static VuMatrix44F scalingMatrix(const VuVector3F& scale) { return MatrixMath::scalingMatrix(scale); }
+    static VuMatrix44F translationMatrix(const VuVector3F& translation) { return MatrixMath::translationMatrix(translation); }
+};
+
+
+struct Inputs
+{
+    std::vector<VuMatrix44F> matrices;
+    std::vector<VuVector3F> vectors;
+};
+
+
+/// Random poses and sizes, the first matrices and vectors hold zeros of both signs, denormal
+/// products and large values so that the check covers the rounding corner cases
+const Inputs& getInputs()
+{
+    static const Inputs inputs = [] {
+        Inputs result;
+        std::mt19937 random(42);
+        std::uniform_real_distribution<float> distribution(-2.0f, 2.0f);
+        const float specialValues[] = { 0.0f, -0.0f, 1.0f, -1.0f, 1e-20f, -3e-25f, 1e18f, -7e15f };
+
+        for (int i = 0; i < NUM_INPUTS; ++i)
+        {
+            VuMatrix44F matrix;
+            for (int j = 0; j < 16; ++j)
+            {
+                matrix.data[j] = i < 4 ? specialValues[(i * 3 + j) % 8] : distribution(random);
+            }
+            result.matrices.push_back(matrix);
+
+            VuVector3F vector;
+            for (int j = 0; j < 3; ++j)
+            {
+                vector.data[j] = i < 4 ? specialValues[(i * 5 + j) % 8] : distribution(random);
+            }
+            result.vectors.push_back(vector);
+        }
+        return result;
+    }();
+    return inputs;
+}
+
+
+bool isSame(const VuMatrix44F& a, const VuMatrix44F& b)
+{
+#if defined(MATHUTILS_STUB)
+    // The stub sums its products starting from +0, turning a -0 result into +0
+    for (int i = 0; i < 16; ++i)
+    {
+        if (a.data[i] != b.data[i])
+        {
+            return false;
+        }
+    }
+    return true;
+#else
+    return memcmp(a.data, b.data, sizeof(a.data)) == 0;
+#endif
+}
+
+
+/// Compare the results of Implementation with those of MathUtils, returns the number of mismatches
+template <typename Implementation>
+int check(const char* name)
+{
+    const Inputs& inputs = getInputs();
+    int numMismatches = 0;
+    auto compare = [&numMismatches, name](const char* operation, const VuMatrix44F& expected, const VuMatrix44F& result) {
+        if (!isSame(expected, result) && numMismatches++ < 10)
+        {
+            printf("%s %s differs from MathUtils\n", name, operation);
+        }
+    };
+
+    for (int i = 0; i < NUM_INPUTS; ++i)
+    {
+        const VuMatrix44F& a = inputs.matrices[i];
+        const VuVector3F& v = inputs.vectors[i];
+        for (int j = 0; j < NUM_INPUTS; ++j)
+        {
+            const VuMatrix44F& b = inputs.matrices[j];
+            VuMatrix44F expected = vuMatrix44FMultiplyMatrix(a, b);
+            VuMatrix44F result;
+            Implementation::multiply(a, b, result);
+            compare("multiply", expected, result);
+
+            // The output may be either input
+            result = a;
+            Implementation::multiply(result, b, result);
+            compare("multiply into a", expected, result);
+            result = b;
+            Implementation::multiply(a, result, result);
+            compare("multiply into b", expected, result);
+
+            expected = vuMatrix44FScale(inputs.vectors[j], a);
+            Implementation::scale(inputs.vectors[j], a, result);
+            compare("scale", expected, result);
+        }
+
+        compare("scalingMatrix", vuMatrix44FScalingMatrix(v), Implementation::scalingMatrix(v));
+        compare("translationMatrix", vuMatrix44FTranslationMatrix(v), Implementation::translationMatrix(v));
+    }
+
+    printf("%-6s %s\n", name, numMismatches == 0 ? "matches MathUtils" : "MISMATCH");
+    return numMismatches;
+}
+
+
+template <typename Implementation>
+void BM_MultiplyMatrix(benchmark::State& state)
+{
+    const Inputs& inputs = getInputs();
+    VuMatrix44F result;
+    int i = 0;
+    for (auto _ : state)
+    {
+        Implementation::multiply(inputs.matrices[i], inputs.matrices[(i + 1) % NUM_INPUTS], result);
+        benchmark::DoNotOptimize(result);
+        i = (i + 1) % NUM_INPUTS;
+    }
+}
+
+
+template <typename Implementation>
+void BM_Scale(benchmark::State& state)
+{
+    const Inputs& inputs = getInputs();
+    VuMatrix44F result;
+    int i = 0;
+    for (auto _ : state)
+    {
+        Implementation::scale(inputs.vectors[i], inputs.matrices[i], result);
+        benchmark::DoNotOptimize(result);
+        i = (i + 1) % NUM_INPUTS;
+    }
+}
+
+
+template <typename Implementation>
+void BM_ScalingMatrix(benchmark::State& state)
+{
+    const Inputs& inputs = getInputs();
+    int i = 0;
+    for (auto _ : state)
+    {
+        VuMatrix44F result = Implementation::scalingMatrix(inputs.vectors[i]);
+        benchmark::DoNotOptimize(result);
+        i = (i + 1) % NUM_INPUTS;
+    }
+}
+
+
+template <typename Implementation>
+void BM_TranslationMatrix(benchmark::State& state)
+{
+    const Inputs& inputs = getInputs();
+    int i = 0;
+    for (auto _ : state)
+    {
+        VuMatrix44F result = Implementation::translationMatrix(inputs.vectors[i]);
+        benchmark::DoNotOptimize(result);
+        i = (i + 1) % NUM_INPUTS;
+    }
+}
+
+
+/// The matrix operations of a frame with state.range(0) targets, half of them Image Targets
+/// and half Model Targets: the model-view matrix and the scaled model-view matrix of each target
+/// as in AppController::getTargetResults and the model-view-projection matrix of the renderer
+template <typename Implementation>
+void BM_TargetResults(benchmark::State& state)
+{
+    const Inputs& inputs = getInputs();
+    const int numTargets = static_cast<int>(state.range(0));
+    const VuMatrix44F& projectionMatrix = inputs.matrices[NUM_INPUTS - 1];
+    VuMatrix44F modelViewMatrices[MAX_TARGETS];
+    VuMatrix44F modelViewProjectionMatrices[MAX_TARGETS];
+    int frame = 0;
+    for (auto _ : state)
+    {
+        const VuMatrix44F& viewMatrix = inputs.matrices[frame];
+        for (int i = 0; i < numTargets; ++i)
+        {
+            int input = (frame + i + 1) % NUM_INPUTS;
+            const VuMatrix44F& pose = inputs.matrices[input];
+            const VuVector3F& size = inputs.vectors[input];
+
+            VuMatrix44F& modelViewMatrix = modelViewMatrices[i];
+            Implementation::multiply(viewMatrix, pose, modelViewMatrix);
+
+            VuMatrix44F scaledModelViewMatrix;
+            if (i % 2 == 0)
+            {
+                Implementation::scale(size, modelViewMatrix, scaledModelViewMatrix);
+            }
+            else
+            {
+                VuMatrix44F scaleMatrix = Implementation::scalingMatrix(size);
+                VuMatrix44F translateMatrix = Implementation::translationMatrix(inputs.vectors[(input + 1) % NUM_INPUTS]);
+                Implementation::multiply(translateMatrix, scaleMatrix, scaledModelViewMatrix);
+                Implementation::multiply(modelViewMatrix, scaledModelViewMatrix, scaledModelViewMatrix);
+            }
+            Implementation::multiply(projectionMatrix, scaledModelViewMatrix, modelViewProjectionMatrices[i]);
+        }
+        benchmark::DoNotOptimize(modelViewMatrices);
+        benchmark::DoNotOptimize(modelViewProjectionMatrices);
+        benchmark::ClobberMemory();
+        frame = (frame + 1) % NUM_INPUTS;
+    }
+    state.SetItemsProcessed(state.iterations() * numTargets);
+}
+
+} // namespace
+
+
+BENCHMARK_TEMPLATE(BM_MultiplyMatrix, MathUtils);
+BENCHMARK_TEMPLATE(BM_MultiplyMatrix, Scalar);
+BENCHMARK_TEMPLATE(BM_MultiplyMatrix, Simd);
+BENCHMARK_TEMPLATE(BM_Scale, MathUtils);
+BENCHMARK_TEMPLATE(BM_Scale, Scalar);
+BENCHMARK_TEMPLATE(BM_Scale, Simd);
+BENCHMARK_TEMPLATE(BM_ScalingMatrix, MathUtils);
+BENCHMARK_TEMPLATE(BM_ScalingMatrix, Simd);
+BENCHMARK_TEMPLATE(BM_TranslationMatrix, MathUtils);
+BENCHMARK_TEMPLATE(BM_TranslationMatrix, Simd);
+BENCHMARK_TEMPLATE(BM_TargetResults, MathUtils)->Arg(1)->Arg(10)->Arg(MAX_TARGETS);
+BENCHMARK_TEMPLATE(BM_TargetResults, Scalar)->Arg(1)->Arg(10)->Arg(MAX_TARGETS);
+BENCHMARK_TEMPLATE(BM_TargetResults, Simd)->Arg(1)->Arg(10)->Arg(MAX_TARGETS);
+
+
+int main(int argc, char* argv[])
+{
+#if defined(MATRIXMATH_NEON)
+    printf("MatrixMath uses NEON\n");
+#elif defined(MATRIXMATH_SSE)
+    printf("MatrixMath uses SSE\n");
+#else
+    printf("MatrixMath uses scalar code\n");
+#endif
+#if defined(MATHUTILS_STUB)
+    printf("Checking the results by value against the stub Vuforia Engine, not bit for bit against MathUtils\n");
+#endif
+
+    // Don't measure functions that give different results
+    if (check<Scalar>("Scalar") + check<Simd>("Simd") != 0)
+    {
+        return 1;
+    }
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv))
+    {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
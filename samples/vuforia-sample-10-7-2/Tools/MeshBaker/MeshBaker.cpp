@@ -0,0 +1,58 @@
+/*===============================================================================
+Copyright (c) 2022 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+// Offline converter from OBJ models to the baked mesh format
+//
+// Usage: MeshBaker <input.obj> <output.mesh>
+
+#include <FileAssetReader.h>
+#include <Log.h>
+#include <MeshFile.h>
+#include <ObjLoader.h>
+
+#include <fstream>
+#include <vector>
+
+
+int main(int argc, char* argv[])
+{
+    if (argc != 3)
+    {
+        LOG("Usage: %s <input.obj> <output%s>", argv[0], MeshFile::EXTENSION);
+        return 1;
+    }
+
+    AssetData objData;
+    if (!FileAssetReader().read(argv[1], objData))
+    {
+        return 1;
+    }
+
+    MeshData mesh;
+    if (!ObjLoader::load(objData.data(), objData.size(), mesh))
+    {
+        LOG("Error loading %s", argv[1]);
+        return 1;
+    }
+
+    std::vector<char> meshData;
+    if (!MeshFile::write(mesh, meshData))
+    {
+        return 1;
+    }
+
+    std::ofstream output(argv[2], std::ios::binary);
+    if (!output.write(meshData.data(), meshData.size()))
+    {
+        LOG("Error writing %s", argv[2]);
+        return 1;
+    }
+
+    LOG("Baked %s: %d vertices, %d indices, %zu bytes",
+        argv[2], mesh.numVertices(), mesh.numIndices(), meshData.size());
+    return 0;
+}
@@ -0,0 +1,385 @@
+/*===============================================================================
+Copyright (c) 2022 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+// Measures ObjParser on 1 to all CPU cores against tinyobj::LoadObj reading from a
+// MemoryInputStream, as ObjLoader used to, after checking that both give identical attributes,
+// shapes, warnings and errors for the model, a generated grid of several hundred thousand
+// triangles and a set of small files exercising the corner cases of the format. ObjParser is
+// checked on a single thread and with the files split into many chunks.
+//
+// Usage: ObjParserBenchmark [Google Benchmark options] [model.obj]
+
+#include <FileAssetReader.h>
+#include <MemoryStream.h>
+#include <ObjParser.h>
+
+#include <tiny_obj_loader.h>
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+namespace
+{
+
+/// Quads per side of the generated grid
+constexpr int GRID_SIZE = 400;
+
+/// Threads used to check the merging of chunks
+constexpr unsigned int CHECK_THREADS = 4;
+
+
+struct ParseResult
+{
+    bool ret { false };
+    tinyobj::attrib_t attrib;
+    std::vector<tinyobj::shape_t> shapes;
+    std::string warn;
+    std::string err;
+};
+
+
+struct TinyObj
+{
+    static void parse(const char* data, size_t size, ParseResult& result, unsigned int /* numThreads */,
+                      size_t /* chunkSize */)
+    {
+        std::vector<tinyobj::material_t> materials;
+        MemoryInputStream stream(data, size);
+        result.ret = tinyobj::LoadObj(&result.attrib, &result.shapes, &materials, &result.warn,
+                                      &result.err, &stream);
+    }
+};
+
+
+struct Parser
+{
+    static void parse(const char* data, size_t size, ParseResult& result, unsigned int numThreads,
+                      size_t chunkSize)
+    {
+        result.ret = ObjParser::parse(data, size, result.attrib, result.shapes, result.warn, result.err,
+                                      numThreads, chunkSize);
+    }
+};
+
+
+template <typename Implementation>
+ParseResult parse(const std::string& data, unsigned int numThreads = 1,
+                  size_t chunkSize = ObjParser::DEFAULT_CHUNK_SIZE)
+{
+    ParseResult result;
+    Implementation::parse(data.data(), data.size(), result, numThreads, chunkSize);
+    return result;
+}
+
+
+constexpr char NUL_CHARACTERS[] = "v 0 0 0\nv 1 0 0 \0 ignored\nv 0 1 0\nf 1 2 3\0 4\n";
+
+
+/// Small files covering the parts of the format that ObjParser reimplements
+const std::string CORNER_CASES[] = {
+    // Triangle, no final line ending
+    "v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 3",
+    // Line endings, blank lines, comments and indentation
+    "# comment\r\n\r\n  v 0 0 0\r\n\tv 1 0 0\rv 0 1 0\n\n\nvt 0 0\r\nvt 1 0\rvt 0 1\n  f 1/1 2/2 3/3\r\n",
+    // Relative indices and all corner forms
+    "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\nvt 0 0\nvt 1 1\nvn 0 0 1\n"
+    "f -4/-2/-1 -3/-1/-1 -2/-2/-1\nf 1//1 3//1 4//1\nf 1/1 2/2 4/1\nf 2 3 4\n",
+    // Number formats, missing values and vertex colors
+    "v 1e3 -0 +3.1417e+2 0.5 0.25 1\nv .5 1. 1e\nv 1.0E-3 -2.5e-2 123456789.123456789 1 2\n"
+    "v 0.000000001 -1 1\nvt 0.5\nvn 1 2\nf 1 2 3 4\n",
+    // Quad, concave polygon and degenerate faces
+    "v 0 0 0\nv 2 0 0\nv 2 2 0\nv 1 0.5 0\nv 0 2 0\nv 1 1 0\nv 3 3 3\n"
+    "f 1 2 3 5\nf 1 2 3 4 5\nf 1 2\nf 1 1 1 1\nf 1 2 6 3 7 5\n",
+    // Polygon in the yz plane, polygon with invalid indices
+    "v 0 0 0\nv 0 1 0\nv 0 1 1\nv 0 0 1\nf 1 2 3 4\nf 1 2 9 3 4\n",
+    // Objects, groups, smoothing groups and tags
+    "o first\nv 0 0 0\nv 1 0 0\nv 0 1 0\nv 1 1 1\ns 1\nf 1 2 3\ng  left   right \ns off\nf 2 3 4\n"
+    "g\nt crease 2/1/0 1 2 0.5\nt name 0/0/2 a b\ns 12\nf 1 2 4\ns -1\nf 1 3 4\no second object\n"
+    "usemtl material\nmtllib file.mtl\nf 4 3 2\n",
+    // Lines and a group with only lines
+    "v 0 0 0\nv 1 0 0\nv 0 1 0\nl 1 2 3\nf 1 2 3\nl -1 2\ng lines\nl 1 2\ng faces\nf 1 2 3\no lines\nl 2 3\n",
+    // Out of range indices
+    "v 0 0 0\nv 1 0 0\nv 0 1 0\nvt 0 0\nvn 0 0 1\nf 1/1/1 2/2/2 5/3/3\n",
+    // Zero index
+    "v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 0\n",
+    // NUL characters end the line
+    std::string(NUL_CHARACTERS, sizeof(NUL_CHARACTERS) - 1),
+    // Empty file
+    "",
+};
+
+
+/// Model with the layout of an exported scan: a grid of quads with positions, texture
+/// coordinates and normals
+std::string makeGrid(int size)
+{
+    std::string obj;
+    obj.reserve(static_cast<size_t>(size + 1) * (size + 1) * 100 + static_cast<size_t>(size) * size * 60);
+    char line[128];
+    for (int y = 0; y <= size; ++y)
+    {
+        for (int x = 0; x <= size; ++x)
+        {
+            float u = static_cast<float>(x) / size;
+            float v = static_cast<float>(y) / size;
+            snprintf(line, sizeof(line), "v %f %f %f\nvt %f %f\nvn %f %f %f\n",
+                     u - 0.5f, v - 0.5f, 0.05f * (u * u - v), u, v, -0.1f * u, 0.05f, 0.99f);
+            obj += line;
+        }
+    }
+    for (int y = 0; y < size; ++y)
+    {
+        for (int x = 0; x < size; ++x)
+        {
+            int a = y * (size + 1) + x + 1;
+            int b = a + 1;
+            int c = b + size + 1;
+            int d = a + size + 1;
+            snprintf(line, sizeof(line), "f %d/%d/%d %d/%d/%d %d/%d/%d %d/%d/%d\n", a, a, a, b, b, b, c, c, c, d, d, d);
+            obj += line;
+        }
+    }
+    return obj;
+}
+
+
+template <typename T>
+bool isSame(const std::vector<T>& a, const std::vector<T>& b)
+{
+    return a.size() == b.size() && (a.empty() || memcmp(a.data(), b.data(), a.size() * sizeof(T)) == 0);
+}
+
+
+bool isSame(const tinyobj::index_t& a, const tinyobj::index_t& b)
+{
+    return a.vertex_index == b.vertex_index && a.normal_index == b.normal_index &&
+           a.texcoord_index == b.texcoord_index;
+}
+
+
+bool isSame(const tinyobj::tag_t& a, const tinyobj::tag_t& b)
+{
+    return a.name == b.name && isSame(a.intValues, b.intValues) && isSame(a.floatValues, b.floatValues) &&
+           a.stringValues == b.stringValues;
+}
+
+
+template <typename T>
+bool isSameElements(const std::vector<T>& a, const std::vector<T>& b)
+{
+    if (a.size() != b.size())
+    {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); ++i)
+    {
+        if (!isSame(a[i], b[i]))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+/// Describe the first difference between two results, empty if they are identical
+std::string findDifference(const ParseResult& expected, const ParseResult& result)
+{
+    if (expected.ret != result.ret)
+    {
+        return "return value";
+    }
+    if (expected.err != result.err)
+    {
+        return "errors '" + expected.err + "' and '" + result.err + "'";
+    }
+    if (!expected.ret)
+    {
+        // The output of a failed load is incomplete
+        return std::string();
+    }
+    if (expected.warn != result.warn)
+    {
+        return "warnings '" + expected.warn + "' and '" + result.warn + "'";
+    }
+    if (!isSame(expected.attrib.vertices, result.attrib.vertices))
+    {
+        return "vertices";
+    }
+    if (!isSame(expected.attrib.normals, result.attrib.normals))
+    {
+        return "normals";
+    }
+    if (!isSame(expected.attrib.texcoords, result.attrib.texcoords))
+    {
+        return "texture coordinates";
+    }
+    if (!isSame(expected.attrib.colors, result.attrib.colors))
+    {
+        return "colors";
+    }
+    if (expected.shapes.size() != result.shapes.size())
+    {
+        return "number of shapes " + std::to_string(expected.shapes.size()) + " and " +
+               std::to_string(result.shapes.size());
+    }
+    for (size_t s = 0; s < expected.shapes.size(); ++s)
+    {
+        const tinyobj::shape_t& a = expected.shapes[s];
+        const tinyobj::shape_t& b = result.shapes[s];
+        std::string shape = "shape " + std::to_string(s) + " ";
+        if (a.name != b.name)
+        {
+            return shape + "name '" + a.name + "' and '" + b.name + "'";
+        }
+        if (!isSameElements(a.mesh.indices, b.mesh.indices))
+        {
+            return shape + "indices";
+        }
+        if (!isSame(a.mesh.num_face_vertices, b.mesh.num_face_vertices))
+        {
+            return shape + "face sizes";
+        }
+        if (!isSame(a.mesh.material_ids, b.mesh.material_ids))
+        {
+            return shape + "material ids";
+        }
+        if (!isSame(a.mesh.smoothing_group_ids, b.mesh.smoothing_group_ids))
+        {
+            return shape + "smoothing groups";
+        }
+        if (!isSameElements(a.mesh.tags, b.mesh.tags))
+        {
+            return shape + "tags";
+        }
+        if (!isSame(a.path.indices, b.path.indices))
+        {
+            return shape + "lines";
+        }
+    }
+    return std::string();
+}
+
+
+/// Compare ObjParser with tinyobj for one file, returns false if they differ
+/**
+ * ObjParser parses the file on a single thread and split into chunks of chunkSize bytes.
+ */
+bool check(const char* name, const std::string& data, size_t chunkSize)
+{
+    ParseResult expected = parse<TinyObj>(data);
+    for (unsigned int numThreads : { 1u, CHECK_THREADS })
+    {
+        std::string difference = findDifference(expected, parse<Parser>(data, numThreads, chunkSize));
+        if (!difference.empty())
+        {
+            printf("%s: ObjParser with %u threads differs from tinyobj in %s\n", name, numThreads,
+                   difference.c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+
+void setCounters(benchmark::State& state, const std::string& data, const ParseResult& result)
+{
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * data.size()));
+    state.counters["triangles"] = static_cast<double>(result.shapes.empty() ? 0 : result.shapes[0].mesh.num_face_vertices.size());
+}
+
+
+void BM_TinyObj(benchmark::State& state, const std::string* data)
+{
+    ParseResult result;
+    for (auto _ : state)
+    {
+        result = ParseResult();
+        TinyObj::parse(data->data(), data->size(), result, 1, 0);
+        benchmark::DoNotOptimize(result);
+    }
+    setCounters(state, *data, result);
+}
+
+
+/// ObjParser on state.range(0) threads
+void BM_ObjParser(benchmark::State& state, const std::string* data)
+{
+    ParseResult result;
+    for (auto _ : state)
+    {
+        result = ParseResult();
+        Parser::parse(data->data(), data->size(), result, static_cast<unsigned int>(state.range(0)),
+                      ObjParser::DEFAULT_CHUNK_SIZE);
+        benchmark::DoNotOptimize(result);
+    }
+    setCounters(state, *data, result);
+}
+
+} // namespace
+
+
+int main(int argc, char* argv[])
+{
+    benchmark::Initialize(&argc, argv);
+    if (argc > 2)
+    {
+        fprintf(stderr, "Usage: %s [Google Benchmark options] [model.obj]\n", argv[0]);
+        return 1;
+    }
+
+    const char* modelPath = argc == 2 ? argv[1] : DEFAULT_MODEL;
+    AssetData model;
+    if (!FileAssetReader().read(modelPath, model))
+    {
+        return 1;
+    }
+    static const std::string modelData(model.data(), model.size());
+    static const std::string gridData = makeGrid(GRID_SIZE);
+
+    // Don't measure a parser that gives different results
+    int numMismatches = 0;
+    for (size_t i = 0; i < sizeof(CORNER_CASES) / sizeof(CORNER_CASES[0]); ++i)
+    {
+        std::string name = "Corner case " + std::to_string(i);
+        // A chunk per line
+        numMismatches += check(name.c_str(), CORNER_CASES[i], 1) ? 0 : 1;
+    }
+    numMismatches += check(modelPath, modelData, 4096) ? 0 : 1;
+    numMismatches += check("Grid", gridData, 4096) ? 0 : 1;
+    if (numMismatches != 0)
+    {
+        return 1;
+    }
+    printf("ObjParser matches tinyobj\n");
+
+    std::string modelName = modelPath;
+    modelName = modelName.substr(modelName.find_last_of("/\\") + 1);
+    const int maxThreads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    for (const auto& input : { std::make_pair(modelName, &modelData), std::make_pair(std::string("Grid"), &gridData) })
+    {
+        benchmark::RegisterBenchmark(("TinyObj/" + input.first).c_str(), BM_TinyObj, input.second)
+            ->Unit(benchmark::kMillisecond);
+        benchmark::RegisterBenchmark(("ObjParser/" + input.first).c_str(), BM_ObjParser, input.second)
+            ->ArgName("threads")
+            ->RangeMultiplier(2)
+            ->Range(1, maxThreads)
+            ->Unit(benchmark::kMillisecond)
+            ->UseRealTime();
+    }
+
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
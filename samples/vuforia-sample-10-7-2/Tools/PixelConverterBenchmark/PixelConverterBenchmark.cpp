@@ -0,0 +1,127 @@
+/*===============================================================================
+Copyright (c) 2022 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+// Measures the PixelConverter conversions with each implementation the CPU supports and
+// checks that every implementation produces the same output as the scalar one.
+//
+// Usage: PixelConverterBenchmark [width height [iterations]]
+
+#include <PixelConverter.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+
+namespace
+{
+
+struct Conversion
+{
+    PixelConverter::Format src;
+    PixelConverter::Format dst;
+    const char* name;
+};
+
+const Conversion CONVERSIONS[] = {
+    { PixelConverter::Format::YUYV, PixelConverter::Format::NV21, "YUYV -> NV21" },
+    { PixelConverter::Format::UYVY, PixelConverter::Format::NV12, "UYVY -> NV12" },
+    { PixelConverter::Format::RGB888, PixelConverter::Format::NV21, "RGB888 -> NV21" },
+    { PixelConverter::Format::RGBA8888, PixelConverter::Format::NV12, "RGBA8888 -> NV12" },
+    { PixelConverter::Format::YUV420P, PixelConverter::Format::NV21, "YUV420P -> NV21" },
+};
+
+const PixelConverter::Implementation IMPLEMENTATIONS[] = {
+    PixelConverter::Implementation::SCALAR,
+    PixelConverter::Implementation::SSE2,
+    PixelConverter::Implementation::AVX2,
+    PixelConverter::Implementation::NEON,
+};
+
+} // namespace
+
+
+int main(int argc, char* argv[])
+{
+    uint32_t width = 1920;
+    uint32_t height = 1080;
+    int iterations = 200;
+    if (argc >= 3)
+    {
+        width = static_cast<uint32_t>(atoi(argv[1]));
+        height = static_cast<uint32_t>(atoi(argv[2]));
+    }
+    if (argc >= 4)
+    {
+        iterations = atoi(argv[3]);
+    }
+    if (width == 0 || height == 0 || iterations <= 0)
+    {
+        fprintf(stderr, "Usage: %s [width height [iterations]]\n", argv[0]);
+        return 1;
+    }
+
+    // Pad the source rows so that arbitrary strides are exercised
+    std::mt19937 random(42);
+    bool mismatch = false;
+    printf("%ux%u, %d iterations\n", width, height, iterations);
+
+    for (const Conversion& conversion : CONVERSIONS)
+    {
+        uint32_t srcStride = PixelConverter::getPackedStride(conversion.src, width) + 32;
+        std::vector<uint8_t> src(PixelConverter::getImageSize(conversion.src, width, height, srcStride));
+        for (uint8_t& value : src)
+        {
+            value = static_cast<uint8_t>(random());
+        }
+
+        std::vector<uint8_t> expected;
+        for (PixelConverter::Implementation implementation : IMPLEMENTATIONS)
+        {
+            if (!PixelConverter::setImplementation(implementation))
+            {
+                continue;
+            }
+
+            std::vector<uint8_t> dst(PixelConverter::getImageSize(conversion.dst, width, height));
+            if (!PixelConverter::convert(conversion.src, src.data(), srcStride, conversion.dst, dst.data(), 0, width, height))
+            {
+                // e.g. the packed 4:2:2 formats with an odd width
+                printf("%-18s not supported at this size\n", conversion.name);
+                break;
+            }
+
+            auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < iterations; ++i)
+            {
+                PixelConverter::convert(conversion.src, src.data(), srcStride, conversion.dst, dst.data(), 0, width, height);
+            }
+            auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+            double msPerFrame = elapsed.count() / iterations;
+
+            const char* result = "";
+            if (expected.empty())
+            {
+                expected = dst;
+            }
+            else if (dst != expected)
+            {
+                result = "  MISMATCH";
+                mismatch = true;
+            }
+
+            printf("%-18s %-7s %8.3f ms/frame %9.1f Mpixel/s%s\n", conversion.name,
+                   PixelConverter::getImplementationName(implementation), msPerFrame,
+                   width * static_cast<double>(height) / (msPerFrame * 1000.0), result);
+        }
+    }
+
+    return mismatch ? 1 : 0;
+}
@@ -0,0 +1,344 @@
+/*===============================================================================
+Copyright (c) 2022 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+// Checks the poses PoseBuffer samples against hand computed ones: exact, interpolated and
+// extrapolated poses and the times no pose is available, before and after the ring wraps around,
+// rotations interpolated across +-pi, and the quaternion conversions and slerp used for them.
+//
+// Usage: PoseBufferCheck
+
+#include <PoseBuffer.h>
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+
+
+namespace
+{
+
+constexpr uint64_t SECOND = 1000000000ull;
+constexpr float PI = 3.14159265358979f;
+
+/// Largest difference accepted in a translation, rotation matrix or quaternion component
+constexpr float TOLERANCE = 1e-5f;
+
+const float Z_AXIS[3] = { 0.f, 0.f, 1.f };
+
+int gNumFailures = 0;
+
+
+const char* getResultName(PoseBuffer::Result result)
+{
+    switch (result)
+    {
+        case PoseBuffer::Result::NONE:
+            return "NONE";
+        case PoseBuffer::Result::EXACT:
+            return "EXACT";
+        case PoseBuffer::Result::INTERPOLATED:
+            return "INTERPOLATED";
+        case PoseBuffer::Result::EXTRAPOLATED:
+            return "EXTRAPOLATED";
+    }
+    return "unknown";
+}
+
+
+/// Row-major matrix of the rotation by angle around the unit vector axis
+void makeRotation(const float axis[3], float angle, float rotation[9])
+{
+    const float x = axis[0], y = axis[1], z = axis[2];
+    const float c = std::cos(angle), s = std::sin(angle), t = 1.f - c;
+
+    rotation[0] = t * x * x + c;
+    rotation[1] = t * x * y - s * z;
+    rotation[2] = t * x * z + s * y;
+    rotation[3] = t * x * y + s * z;
+    rotation[4] = t * y * y + c;
+    rotation[5] = t * y * z - s * x;
+    rotation[6] = t * x * z - s * y;
+    rotation[7] = t * y * z + s * x;
+    rotation[8] = t * z * z + c;
+}
+
+
+/// Unit quaternion (x, y, z, w) of the rotation by angle around the unit vector axis
+void makeQuaternion(const float axis[3], float angle, float quaternion[4])
+{
+    float s = std::sin(angle / 2.f);
+    quaternion[0] = axis[0] * s;
+    quaternion[1] = axis[1] * s;
+    quaternion[2] = axis[2] * s;
+    quaternion[3] = std::cos(angle / 2.f);
+}
+
+
+bool isNear(const float* values, const float* expected, int count)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        if (!(std::fabs(values[i] - expected[i]) <= TOLERANCE))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+/// Whether the quaternions are the same rotation, q and -q are
+bool isSameRotation(const float q0[4], const float q1[4])
+{
+    const float negated[4] = { -q1[0], -q1[1], -q1[2], -q1[3] };
+    return isNear(q0, q1, 4) || isNear(q0, negated, 4);
+}
+
+
+void expectQuaternion(const char* step, const float quaternion[4], const float axis[3], float angle)
+{
+    float expected[4];
+    makeQuaternion(axis, angle, expected);
+    if (!isSameRotation(quaternion, expected))
+    {
+        ++gNumFailures;
+        printf("%s: expected the quaternion (%f, %f, %f, %f), got (%f, %f, %f, %f)\n", step, expected[0],
+               expected[1], expected[2], expected[3], quaternion[0], quaternion[1], quaternion[2], quaternion[3]);
+    }
+}
+
+
+/// Add a pose translated by x along the x axis and rotated by angle around the z axis
+bool add(PoseBuffer& buffer, uint64_t timestamp, float x, float angle)
+{
+    const float translation[3] = { x, 2.f, -1.f };
+    float rotation[9];
+    makeRotation(Z_AXIS, angle, rotation);
+    return buffer.add(timestamp, translation, rotation);
+}
+
+
+/// Sample buffer and check the result and, unless it is NONE, the pose as add would have added it
+void expectSample(const char* step, const PoseBuffer& buffer, uint64_t timestamp, uint64_t maxExtrapolation,
+                  PoseBuffer::Result expected, float x = 0.f, float angle = 0.f)
+{
+    float translation[3];
+    float rotation[9];
+    PoseBuffer::Result result = buffer.sample(timestamp, translation, rotation, maxExtrapolation);
+    if (result != expected)
+    {
+        ++gNumFailures;
+        printf("%s: expected %s, got %s\n", step, getResultName(expected), getResultName(result));
+        return;
+    }
+    if (result == PoseBuffer::Result::NONE)
+    {
+        return;
+    }
+
+    const float expectedTranslation[3] = { x, 2.f, -1.f };
+    float expectedRotation[9];
+    makeRotation(Z_AXIS, angle, expectedRotation);
+    if (!isNear(translation, expectedTranslation, 3) || !isNear(rotation, expectedRotation, 9))
+    {
+        float sampledAngle = std::atan2(rotation[3], rotation[0]);
+        ++gNumFailures;
+        printf("%s: expected x %f rotated by %f, got x %f rotated by %f\n", step, x, angle, translation[0],
+               sampledAngle);
+    }
+}
+
+
+void checkConversions()
+{
+    // A rotation for each branch of matrixToQuaternion, picked by the largest diagonal element
+    const float axes[][3] = {
+        { 0.f, 0.f, 1.f },
+        { 1.f, 0.f, 0.f },
+        { 0.f, 1.f, 0.f },
+        { 0.f, 0.f, 1.f },
+        { 0.267261f, 0.534522f, 0.801784f },
+        { 0.267261f, -0.534522f, 0.801784f },
+    };
+    const float angles[] = { 0.5f, 3.f, 3.f, 3.f, 2.5f, -PI };
+
+    for (size_t i = 0; i < sizeof(angles) / sizeof(angles[0]); ++i)
+    {
+        char step[64];
+        snprintf(step, sizeof(step), "conversion %zu", i);
+
+        float rotation[9];
+        float quaternion[4];
+        float roundTrip[9];
+        makeRotation(axes[i], angles[i], rotation);
+        PoseBuffer::matrixToQuaternion(rotation, quaternion);
+        expectQuaternion(step, quaternion, axes[i], angles[i]);
+        PoseBuffer::quaternionToMatrix(quaternion, roundTrip);
+        if (!isNear(roundTrip, rotation, 9))
+        {
+            ++gNumFailures;
+            printf("%s: the matrix changed in the round trip through a quaternion\n", step);
+        }
+    }
+}
+
+
+void checkSlerp()
+{
+    float identity[4];
+    float q1[4];
+    float result[4];
+    makeQuaternion(Z_AXIS, 0.f, identity);
+    makeQuaternion(Z_AXIS, 2.f, q1);
+
+    PoseBuffer::slerp(identity, q1, 0.f, result);
+    expectQuaternion("slerp t=0", result, Z_AXIS, 0.f);
+    PoseBuffer::slerp(identity, q1, 1.f, result);
+    expectQuaternion("slerp t=1", result, Z_AXIS, 2.f);
+    PoseBuffer::slerp(identity, q1, 0.25f, result);
+    expectQuaternion("slerp t=0.25", result, Z_AXIS, 0.5f);
+    PoseBuffer::slerp(identity, q1, 1.5f, result);
+    expectQuaternion("slerp t=1.5", result, Z_AXIS, 3.f);
+
+    // -q1 is the same rotation in the other hemisphere, slerp must still take the shorter arc
+    const float negated[4] = { -q1[0], -q1[1], -q1[2], -q1[3] };
+    PoseBuffer::slerp(identity, negated, 0.25f, result);
+    expectQuaternion("slerp other hemisphere", result, Z_AXIS, 0.5f);
+
+    // Rotating from 3 to -3 crosses pi rather than going back through 0
+    float q2[4];
+    float q3[4];
+    makeQuaternion(Z_AXIS, 3.f, q2);
+    makeQuaternion(Z_AXIS, -3.f, q3);
+    PoseBuffer::slerp(q2, q3, 0.5f, result);
+    expectQuaternion("slerp across pi", result, Z_AXIS, PI);
+
+    // Nearly equal rotations use the normalized linear interpolation
+    float q4[4];
+    makeQuaternion(Z_AXIS, 2.0001f, q4);
+    PoseBuffer::slerp(q1, q4, 0.5f, result);
+    expectQuaternion("slerp nearly equal", result, Z_AXIS, 2.00005f);
+}
+
+
+void checkSampling()
+{
+    PoseBuffer buffer;
+    expectSample("empty", buffer, SECOND, SECOND, PoseBuffer::Result::NONE);
+
+    // A single pose is held for up to maxExtrapolation
+    add(buffer, SECOND, 0.f, 0.f);
+    expectSample("single pose", buffer, SECOND, 0, PoseBuffer::Result::EXACT, 0.f, 0.f);
+    expectSample("single pose held", buffer, SECOND * 3 / 2, SECOND, PoseBuffer::Result::EXTRAPOLATED, 0.f, 0.f);
+    expectSample("single pose expired", buffer, SECOND * 5 / 2, SECOND, PoseBuffer::Result::NONE);
+    expectSample("before single pose", buffer, SECOND - 1, SECOND, PoseBuffer::Result::NONE);
+
+    add(buffer, 2 * SECOND, 1.f, 0.4f);
+    add(buffer, 3 * SECOND, 3.f, 0.8f);
+    expectSample("exact", buffer, 2 * SECOND, 0, PoseBuffer::Result::EXACT, 1.f, 0.4f);
+    expectSample("exact newest", buffer, 3 * SECOND, 0, PoseBuffer::Result::EXACT, 3.f, 0.8f);
+    expectSample("interpolated", buffer, SECOND * 5 / 4, 0, PoseBuffer::Result::INTERPOLATED, 0.25f, 0.1f);
+    expectSample("interpolated second", buffer, SECOND * 5 / 2, 0, PoseBuffer::Result::INTERPOLATED, 2.f, 0.6f);
+    // t=1.5 along the motion from the pose at 2 s to the one at 3 s
+    expectSample("extrapolated", buffer, SECOND * 7 / 2, SECOND, PoseBuffer::Result::EXTRAPOLATED, 4.f, 1.f);
+    expectSample("extrapolated limit", buffer, 4 * SECOND, SECOND, PoseBuffer::Result::EXTRAPOLATED, 5.f, 1.2f);
+    expectSample("beyond extrapolation", buffer, 4 * SECOND + 1, SECOND, PoseBuffer::Result::NONE);
+    expectSample("not extrapolated", buffer, 3 * SECOND + 1, 0, PoseBuffer::Result::NONE);
+    expectSample("before oldest", buffer, SECOND / 2, SECOND, PoseBuffer::Result::NONE);
+
+    if (add(buffer, 3 * SECOND, 9.f, 0.f) || add(buffer, 2 * SECOND, 9.f, 0.f) || buffer.size() != 3)
+    {
+        ++gNumFailures;
+        printf("A pose not newer than the newest pose was added\n");
+    }
+    expectSample("after rejected add", buffer, 3 * SECOND, 0, PoseBuffer::Result::EXACT, 3.f, 0.8f);
+
+    buffer.clear();
+    expectSample("cleared", buffer, 3 * SECOND, SECOND, PoseBuffer::Result::NONE);
+}
+
+
+void checkWraparound()
+{
+    PoseBuffer buffer(3);
+    if (buffer.capacity() != 4)
+    {
+        ++gNumFailures;
+        printf("Expected the capacity 3 to be rounded up to 4, got %zu\n", buffer.capacity());
+    }
+
+    // The ring holds the poses at 7 to 10 s, starting in the middle of the arrays
+    for (int i = 1; i <= 10; ++i)
+    {
+        add(buffer, i * SECOND, static_cast<float>(i), 0.1f * i);
+    }
+    if (buffer.size() != 4 || buffer.getOldestTimestamp() != 7 * SECOND || buffer.getNewestTimestamp() != 10 * SECOND)
+    {
+        ++gNumFailures;
+        printf("Expected 4 poses from 7 to 10 s after wrapping around, got %zu\n", buffer.size());
+    }
+
+    expectSample("wrapped dropped", buffer, SECOND * 13 / 2, SECOND, PoseBuffer::Result::NONE);
+    expectSample("wrapped oldest", buffer, 7 * SECOND, 0, PoseBuffer::Result::EXACT, 7.f, 0.7f);
+    for (int i = 7; i < 10; ++i)
+    {
+        char step[64];
+        snprintf(step, sizeof(step), "wrapped interpolated %d.5 s", i);
+        expectSample(step, buffer, i * SECOND + SECOND / 2, 0, PoseBuffer::Result::INTERPOLATED, i + 0.5f,
+                     0.1f * i + 0.05f);
+    }
+    expectSample("wrapped newest", buffer, 10 * SECOND, 0, PoseBuffer::Result::EXACT, 10.f, 1.f);
+    expectSample("wrapped extrapolated", buffer, SECOND * 21 / 2, SECOND, PoseBuffer::Result::EXTRAPOLATED, 10.5f,
+                 1.05f);
+}
+
+
+void checkAcrossPi()
+{
+    // Quaternions of the rotations by 2 and -2 are in opposite hemispheres, blending them must
+    // cross pi, the shorter way, instead of turning back through 0
+    PoseBuffer buffer;
+    add(buffer, SECOND, 0.f, 2.f);
+    add(buffer, 2 * SECOND, 1.f, -2.f);
+    add(buffer, 3 * SECOND, 2.f, -3.f);
+
+    const float step = 2.f * PI - 4.f;
+    expectSample("hemisphere interpolated", buffer, SECOND * 3 / 2, 0, PoseBuffer::Result::INTERPOLATED, 0.5f, PI);
+    expectSample("hemisphere interpolated quarter", buffer, SECOND * 5 / 4, 0, PoseBuffer::Result::INTERPOLATED,
+                 0.25f, 2.f + step / 4.f);
+    expectSample("hemisphere exact", buffer, 2 * SECOND, 0, PoseBuffer::Result::EXACT, 1.f, -2.f);
+    // -2 to -3 turns by -1, extrapolating continues the same way across -pi
+    expectSample("extrapolated across pi", buffer, SECOND * 7 / 2, SECOND, PoseBuffer::Result::EXTRAPOLATED, 2.5f,
+                 -3.5f);
+
+    buffer.clear();
+    add(buffer, SECOND, 0.f, 3.f);
+    add(buffer, 2 * SECOND, 1.f, -3.f);
+    expectSample("interpolated across pi", buffer, SECOND * 3 / 2, 0, PoseBuffer::Result::INTERPOLATED, 0.5f, PI);
+    expectSample("extrapolated past pi", buffer, SECOND * 5 / 2, SECOND, PoseBuffer::Result::EXTRAPOLATED, 1.5f,
+                 3.f + 1.5f * (2.f * PI - 6.f));
+}
+
+} // namespace
+
+
+int main()
+{
+    checkConversions();
+    checkSlerp();
+    checkSampling();
+    checkWraparound();
+    checkAcrossPi();
+
+    if (gNumFailures != 0)
+    {
+        printf("%d checks failed\n", gNumFailures);
+        return 1;
+    }
+    printf("All PoseBuffer checks passed\n");
+    return 0;
+}